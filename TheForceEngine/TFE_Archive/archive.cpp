@@ -24,31 +24,8 @@ static const char* c_archiveExt[ARCHIVE_COUNT]=
 	"ZIP", // ARCHIVE_ZIP
 };
 
-ArchiveType Archive::getArchiveTypeFromName(const char* path)
+static Archive* newArchive(ArchiveType type)
 {
-	const size_t len = strlen(path);
-	for (u32 i = 0; i < ARCHIVE_COUNT; i++)
-	{
-		if (strcasecmp(&path[len - 3], c_archiveExt[i]) == 0)
-		{
-			return ArchiveType(i);
-		}
-	}
-	return ARCHIVE_UNKNOWN;
-}
-
-Archive* Archive::getArchive(ArchiveType type, const char* name, const char* path)
-{
-	ArchiveMap::iterator iArchive = s_archives[type].find(path);
-	if (iArchive != s_archives[type].end())
-	{
-		return iArchive->second;
-	}
-	if (!FileUtil::exists(path))
-	{
-		return nullptr;
-	}
-
 	Archive* archive = nullptr;
 	switch (type)
 	{
@@ -76,6 +53,35 @@ Archive* Archive::getArchive(ArchiveType type, const char* name, const char* pat
 			assert(0);
 		break;
 	};
+	return archive;
+}
+
+ArchiveType Archive::getArchiveTypeFromName(const char* path)
+{
+	const size_t len = strlen(path);
+	for (u32 i = 0; i < ARCHIVE_COUNT; i++)
+	{
+		if (strcasecmp(&path[len - 3], c_archiveExt[i]) == 0)
+		{
+			return ArchiveType(i);
+		}
+	}
+	return ARCHIVE_UNKNOWN;
+}
+
+Archive* Archive::getArchive(ArchiveType type, const char* name, const char* path)
+{
+	ArchiveMap::iterator iArchive = s_archives[type].find(path);
+	if (iArchive != s_archives[type].end())
+	{
+		return iArchive->second;
+	}
+	if (!FileUtil::exists(path))
+	{
+		return nullptr;
+	}
+
+	Archive* archive = newArchive(type);
 
 	if (archive)
 	{
@@ -127,33 +133,7 @@ Archive* Archive::createCustomArchive(ArchiveType type, const char* path)
 		return iArchive->second;
 	}
 
-	Archive* archive = nullptr;
-	switch (type)
-	{
-	case ARCHIVE_GOB:
-	{
-		archive = new GobArchive();
-	}
-	break;
-	case ARCHIVE_LFD:
-	{
-		archive = new LfdArchive();
-	}
-	break;
-	case ARCHIVE_LAB:
-	{
-		archive = new LabArchive();
-	}
-	break;
-	case ARCHIVE_ZIP:
-	{
-		archive = new ZipArchive();
-	}
-	break;
-	default:
-		assert(0);
-		break;
-	};
+	Archive* archive = newArchive(type);
 
 	if (archive)
 	{
@@ -176,3 +156,35 @@ void Archive::deleteCustomArchive(Archive* archive)
 	}
 	delete archive;
 }
+
+Archive* Archive::openCopy(const Archive* archive)
+{
+	if (!archive || archive->m_type >= ARCHIVE_COUNT) { return nullptr; }
+
+	// Only archives opened from disk through the archive map can be copied.
+	const ArchiveType type = archive->m_type;
+	ArchiveMap::iterator iArchive = s_archives[type].begin();
+	for (; iArchive != s_archives[type].end(); ++iArchive)
+	{
+		if (iArchive->second == archive) { break; }
+	}
+	if (iArchive == s_archives[type].end()) { return nullptr; }
+
+	Archive* copy = newArchive(type);
+	if (!copy) { return nullptr; }
+	strcpy(copy->m_name, archive->m_name);
+	copy->m_type = type;
+	if (!copy->open(iArchive->first.c_str()) || copy->getFileCount() != iArchive->second->getFileCount())
+	{
+		closeCopy(copy);
+		return nullptr;
+	}
+	return copy;
+}
+
+void Archive::closeCopy(Archive* archive)
+{
+	if (!archive) { return; }
+	archive->close();
+	delete archive;
+}
@@ -28,6 +28,11 @@ public:
 	static void deleteCustomArchive(Archive* archive);
 
 	static ArchiveType getArchiveTypeFromName(const char* path);
+
+	// Open a separate instance of an archive from getArchive() or createCustomArchive(), which can then be
+	// read from another thread. Returns null if the archive cannot be copied, such as memory archives.
+	static Archive* openCopy(const Archive* archive);
+	static void closeCopy(Archive* archive);
 	
 	// Public Archive API
 public:
@@ -0,0 +1,251 @@
+#include <cstring>
+
+#include "lfdMemoryArchive.h"
+#include <TFE_System/system.h>
+#include <assert.h>
+#include <algorithm>
+
+LfdMemoryArchive::~LfdMemoryArchive()
+{
+	close();
+}
+
+bool LfdMemoryArchive::create(const char *archivePath)
+{
+	// STUB
+	return false;
+}
+
+bool LfdMemoryArchive::open(const char *archivePath)
+{
+	return false;
+}
+
+bool LfdMemoryArchive::open(const u8* buffer, size_t size, const char* archivePath)
+{
+	close();
+	if (!buffer || size < sizeof(LFD_Entry_t))
+	{
+		free((void*)buffer);
+		return false;
+	}
+
+	m_buffer  = buffer;
+	m_size    = size;
+	m_readLoc = 0;
+	m_curFile = -1;
+	m_fileOffset = 0;
+	strcpy(m_archivePath, archivePath);
+
+	// Read the directory, the same way as LfdArchive but with the entries validated against the buffer size.
+	LFD_Entry_t root, entry;
+	memcpy(&root, m_buffer, sizeof(LFD_Entry_t));
+	const u32 count = root.LENGTH / sizeof(LFD_Entry_t);
+	if (sizeof(LFD_Entry_t) * (size_t(count) + 1) > m_size)
+	{
+		TFE_System::logWrite(LOG_ERROR, "LFD", "Invalid directory in \"%s\"", m_archivePath);
+		close();
+		return false;
+	}
+	m_fileList.resize(count);
+
+	size_t IX = sizeof(LFD_Entry_t) + root.LENGTH;
+	for (u32 i = 0; i < count; i++)
+	{
+		memcpy(&entry, m_buffer + sizeof(LFD_Entry_t) * (i + 1), sizeof(LFD_Entry_t));
+
+		char name[9] = { 0 };
+		char ext[5]  = { 0 };
+		memcpy(name, entry.NAME, 8);
+		memcpy(ext, entry.TYPE, 4);
+
+		sprintf(m_fileList[i].NAME, "%s.%s", name, ext);
+		m_fileList[i].LENGTH = entry.LENGTH;
+		m_fileList[i].IX = u32(IX + sizeof(LFD_Entry_t));
+
+		IX += sizeof(LFD_Entry_t) + entry.LENGTH;
+		if (IX > m_size)
+		{
+			TFE_System::logWrite(LOG_ERROR, "LFD", "File \"%s\" extends past the end of \"%s\"", m_fileList[i].NAME, m_archivePath);
+			m_fileList.resize(i);
+			break;
+		}
+	}
+
+	m_archiveOpen = true;
+	return true;
+}
+
+void LfdMemoryArchive::close()
+{
+	m_archiveOpen = false;
+	m_fileList.clear();
+	free((void*)m_buffer);
+	m_buffer = nullptr;
+	m_size = 0;
+}
+
+// File Access
+bool LfdMemoryArchive::openFile(const char *file)
+{
+	if (!m_archiveOpen) { return false; }
+
+	m_curFile = -1;
+	m_fileOffset = 0;
+
+	//search for this file.
+	const u32 count = getFileCount();
+	for (u32 i = 0; i < count; i++)
+	{
+		if (strcasecmp(file, m_fileList[i].NAME) == 0)
+		{
+			m_curFile = i;
+			break;
+		}
+	}
+
+	if (m_curFile == -1)
+	{
+		TFE_System::logWrite(LOG_ERROR, "LFD", "Failed to load \"%s\" from \"%s\"", file, m_archivePath);
+	}
+	else
+	{
+		m_readLoc = m_fileList[m_curFile].IX;
+	}
+	return m_curFile > -1 ? true : false;
+}
+
+bool LfdMemoryArchive::openFile(u32 index)
+{
+	if (index >= getFileCount()) { return false; }
+
+	m_curFile = s32(index);
+	m_fileOffset = 0;
+	m_readLoc = m_fileList[m_curFile].IX;
+	return true;
+}
+
+void LfdMemoryArchive::closeFile()
+{
+	m_curFile = -1;
+	m_readLoc = 0;
+}
+
+u32 LfdMemoryArchive::getFileIndex(const char* file)
+{
+	if (!m_archiveOpen) { return INVALID_FILE; }
+
+	//search for this file.
+	const u32 count = getFileCount();
+	for (u32 i = 0; i < count; i++)
+	{
+		if (strcasecmp(file, m_fileList[i].NAME) == 0)
+		{
+			return i;
+		}
+	}
+	return INVALID_FILE;
+}
+
+bool LfdMemoryArchive::fileExists(const char *file)
+{
+	if (!m_archiveOpen) { return false; }
+	m_curFile = -1;
+
+	//search for this file.
+	const u32 count = getFileCount();
+	for (u32 i = 0; i < count; i++)
+	{
+		if (strcasecmp(file, m_fileList[i].NAME) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool LfdMemoryArchive::fileExists(u32 index)
+{
+	if (index >= getFileCount()) { return false; }
+	return true;
+}
+
+size_t LfdMemoryArchive::getFileLength()
+{
+	if (m_curFile < 0) { return 0; }
+	return getFileLength(m_curFile);
+}
+
+size_t LfdMemoryArchive::readFile(void *data, size_t size)
+{
+	if (m_curFile < 0) { return false; }
+	const LFD_EntryFinal_t* entry = &m_fileList[m_curFile];
+	if (size == 0) { size = entry->LENGTH; }
+	const size_t sizeToRead = std::min(size, size_t(entry->IX + entry->LENGTH) - m_readLoc);
+
+	memcpy(data, m_buffer + m_readLoc, sizeToRead);
+	m_readLoc += sizeToRead;
+	m_fileOffset += (s32)sizeToRead;
+	return sizeToRead;
+}
+
+bool LfdMemoryArchive::seekFile(s32 offset, s32 origin)
+{
+	if (m_curFile < 0) { return false; }
+	size_t size = m_fileList[m_curFile].LENGTH;
+
+	switch (origin)
+	{
+		case SEEK_SET:
+		{
+			m_fileOffset = offset;
+		} break;
+		case SEEK_CUR:
+		{
+			m_fileOffset += offset;
+		} break;
+		case SEEK_END:
+		{
+			m_fileOffset = (s32)size - offset;
+		} break;
+	}
+	assert(m_fileOffset <= size && m_fileOffset >= 0);
+	if (m_fileOffset > size || m_fileOffset < 0)
+	{
+		m_fileOffset = 0;
+		return false;
+	}
+
+	m_readLoc = m_fileList[m_curFile].IX + m_fileOffset;
+	return true;
+}
+
+size_t LfdMemoryArchive::getLocInFile()
+{
+	return m_fileOffset;
+}
+
+// Directory
+u32 LfdMemoryArchive::getFileCount()
+{
+	if (!m_archiveOpen) { return 0; }
+	return (u32)m_fileList.size();
+}
+
+const char* LfdMemoryArchive::getFileName(u32 index)
+{
+	if (!m_archiveOpen) { return nullptr; }
+	return m_fileList[index].NAME;
+}
+
+size_t LfdMemoryArchive::getFileLength(u32 index)
+{
+	if (!m_archiveOpen) { return 0; }
+	return m_fileList[index].LENGTH;
+}
+
+// Edit
+void LfdMemoryArchive::addFile(const char* fileName, const char* filePath)
+{
+	// STUB
+}
@@ -0,0 +1,75 @@
+#pragma once
+///////////////////////////////////////////////
+// An LFD archive fully loaded into memory.
+///////////////////////////////////////////////
+
+#include <TFE_System/types.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
+#include "archive.h"
+#include <vector>
+
+class LfdMemoryArchive : public Archive
+{
+public:
+	LfdMemoryArchive() : Archive(ARCHIVE_LFD), m_buffer(nullptr), m_size(0), m_readLoc(0), m_archiveOpen(false), m_curFile(-1) {}
+	~LfdMemoryArchive() override;
+
+	// Archive
+	bool create(const char *archivePath) override;
+	bool open(const char *archivePath) override;
+	// Takes ownership of 'buffer', which must be allocated with malloc(), and frees it if the archive cannot be opened.
+	// 'archivePath' is the path the data was read from.
+	bool open(const u8* buffer, size_t size, const char* archivePath);
+	void close() override;
+
+	// File Access
+	bool openFile(const char *file) override;
+	bool openFile(u32 index) override;
+	void closeFile() override;
+
+	u32 getFileIndex(const char* file) override;
+	bool fileExists(const char *file) override;
+	bool fileExists(u32 index) override;
+
+	size_t getFileLength() override;
+	size_t readFile(void *data, size_t size) override;
+	bool seekFile(s32 offset, s32 origin = SEEK_SET) override;
+	size_t getLocInFile() override;
+
+	// Directory
+	u32 getFileCount() override;
+	const char* getFileName(u32 index) override;
+	size_t getFileLength(u32 index) override;
+
+	// Edit
+	void addFile(const char* fileName, const char* filePath) override;
+
+private:
+	#pragma pack(push)
+	#pragma pack(1)
+
+	typedef struct
+	{
+		char TYPE[4];
+		char NAME[8];
+		u32 LENGTH;		//length of the file.
+	} LFD_Entry_t;
+
+	#pragma pack(pop)
+
+	typedef struct
+	{
+		char NAME[16];
+		u32 LENGTH;		//length of the file.
+		u32 IX;
+	} LFD_EntryFinal_t;
+
+	const u8* m_buffer;
+	size_t m_size;
+	size_t m_readLoc;
+	bool m_archiveOpen;
+
+	std::vector<LFD_EntryFinal_t> m_fileList;
+	s32 m_curFile;
+};
@@ -10,6 +10,7 @@
 
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/Level/rtexture.h>
+#include <TFE_Jedi/Level/levelStaging.h>
 #include <TFE_Jedi/Serialization/serialization.h>
 // TODO: dependency on JediRenderer, this should be refactored...
 #include <TFE_Jedi/Renderer/rlimits.h>
@@ -178,20 +179,30 @@ namespace TFE_Model_Jedi
 		}
 
 		// It doesn't exist yet, try to load the model.
-		FilePath filePath;
-		if (!TFE_Paths::getFilePath(name, &filePath))
+		// TFE: Use the copy read ahead of time during level load if there is one.
+		const u8* stagedData;
+		size_t len;
+		if (levelStaging_get(LASSET_MODEL, name, &stagedData, &len))
 		{
-			return nullptr;
+			s_buffer.assign(stagedData, stagedData + len);
 		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
+		else
 		{
-			return nullptr;
+			FilePath filePath;
+			if (!TFE_Paths::getFilePath(name, &filePath))
+			{
+				return nullptr;
+			}
+			FileStream file;
+			if (!file.open(&filePath, Stream::MODE_READ))
+			{
+				return nullptr;
+			}
+			len = file.getSize();
+			s_buffer.resize(len);
+			file.readBuffer(s_buffer.data(), u32(len));
+			file.close();
 		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
 			
 		s_memRegion = (pool == POOL_GAME) ? s_gameRegion : s_levelRegion;
 		JediModel* model = (JediModel*)model_alloc(sizeof(JediModel));
@@ -7,6 +7,7 @@
 #include <TFE_Asset/assetSystem.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/Level/robject.h>
+#include <TFE_Jedi/Level/levelStaging.h>
 #include <TFE_Jedi/Serialization/serialization.h>
 // TODO: dependency on JediRenderer, this should be refactored...
 #include <TFE_Jedi/Renderer/rlimits.h>
@@ -44,20 +45,30 @@ namespace TFE_Sprite_Jedi
 		}
 
 		// It doesn't exist yet, try to load the frame.
-		FilePath filePath;
-		if (!TFE_Paths::getFilePath(name, &filePath))
+		// TFE: Use the copy read ahead of time during level load if there is one.
+		const u8* stagedData;
+		size_t len;
+		if (levelStaging_get(LASSET_FRAME, name, &stagedData, &len))
 		{
-			return nullptr;
+			s_buffer.assign(stagedData, stagedData + len);
 		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
+		else
 		{
-			return nullptr;
+			FilePath filePath;
+			if (!TFE_Paths::getFilePath(name, &filePath))
+			{
+				return nullptr;
+			}
+			FileStream file;
+			if (!file.open(&filePath, Stream::MODE_READ))
+			{
+				return nullptr;
+			}
+			len = file.getSize();
+			s_buffer.resize(len);
+			file.readBuffer(s_buffer.data(), u32(len));
+			file.close();
 		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
 
 		const u8* data = s_buffer.data();
 
@@ -244,20 +255,30 @@ namespace TFE_Sprite_Jedi
 		}
 
 		// It doesn't exist yet, try to load the frame.
-		FilePath filePath;
-		if (!TFE_Paths::getFilePath(name, &filePath))
+		// TFE: Use the copy read ahead of time during level load if there is one.
+		const u8* stagedData;
+		size_t len;
+		if (levelStaging_get(LASSET_WAX, name, &stagedData, &len))
 		{
-			return nullptr;
+			s_buffer.assign(stagedData, stagedData + len);
 		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
+		else
 		{
-			return nullptr;
+			FilePath filePath;
+			if (!TFE_Paths::getFilePath(name, &filePath))
+			{
+				return nullptr;
+			}
+			FileStream file;
+			if (!file.open(&filePath, Stream::MODE_READ))
+			{
+				return nullptr;
+			}
+			len = file.getSize();
+			s_buffer.resize(len);
+			file.readBuffer(s_buffer.data(), u32(len));
+			file.close();
 		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
 
 		const u8* data = s_buffer.data();
 		const Wax* srcWax = (Wax*)data;
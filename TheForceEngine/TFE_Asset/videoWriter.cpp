@@ -0,0 +1,483 @@
+#include "videoWriter.h"
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <TFE_FileSystem/filestream.h>
+#include <SDL_thread.h>
+#include <SDL_mutex.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace TFE_VideoWriter
+{
+	enum VideoWriterConstants
+	{
+		FRAME_RING_SIZE = 8,
+		GIF_CLEAR_CODE = 256,
+		GIF_END_CODE = 257,
+		GIF_MAX_CODE = 4095,
+		GIF_HASH_SIZE = 8191,	// Prime, about twice the number of LZW codes.
+		GIF_MAX_DELAY = 65535,
+	};
+
+	struct VideoFrame
+	{
+		std::vector<u8> image;
+		u32 palette[256];
+		u64 frameIndex;
+		bool end;
+	};
+
+	struct GifBitWriter
+	{
+		u32 bits;
+		u32 bitCount;
+		size_t blockStart;
+	};
+
+	static const char* c_videoExtension[VIDEO_FORMAT_COUNT] = { "gif", "y4m" };
+
+	static VideoFrame  s_frames[FRAME_RING_SIZE];
+	static u32         s_writeIndex = 0;
+	static SDL_sem*    s_freeFrames = nullptr;
+	static SDL_sem*    s_readyFrames = nullptr;
+	static SDL_Thread* s_thread = nullptr;
+	static bool        s_recording = false;
+
+	static FileStream  s_file;
+	static char        s_path[TFE_MAX_PATH];
+	static VideoFormat s_format;
+	static u32 s_width;
+	static u32 s_height;
+	static u32 s_fps;
+
+	// Worker state.
+	static std::vector<u8> s_output;
+	static std::vector<u8> s_prevImage;
+	static u32  s_prevPalette[256];
+	static u32  s_globalPalette[256];
+	static bool s_headerWritten;
+	static u32  s_frameCount;
+	static u64  s_firstFrame;
+	// LZW dictionary: (prefix code << 8 | pixel) + 1 -> code, 0 = empty.
+	static u32  s_lzwKey[GIF_HASH_SIZE];
+	static u16  s_lzwCode[GIF_HASH_SIZE];
+
+	/////////////////////////////////////////
+	// GIF
+	/////////////////////////////////////////
+	static void write8(u8 value)
+	{
+		s_output.push_back(value);
+	}
+
+	static void write16(u16 value)
+	{
+		s_output.push_back(value & 0xff);
+		s_output.push_back(value >> 8);
+	}
+
+	static void gif_writePalette(const u32* palette)
+	{
+		for (s32 i = 0; i < 256; i++)
+		{
+			write8(palette[i] & 0xff);
+			write8((palette[i] >> 8) & 0xff);
+			write8((palette[i] >> 16) & 0xff);
+		}
+	}
+
+	static void gif_writeHeader(const u32* palette)
+	{
+		const u8 signature[] = { 'G', 'I', 'F', '8', '9', 'a' };
+		s_output.insert(s_output.end(), signature, signature + sizeof(signature));
+		write16(s_width);
+		write16(s_height);
+		write8(0xf7);	// Global color table with 256 entries.
+		write8(0);		// Background color.
+		write8(0);		// Pixel aspect ratio.
+		gif_writePalette(palette);
+		memcpy(s_globalPalette, palette, sizeof(u32) * 256);
+
+		// Loop forever.
+		const u8 loop[] = { 0x21, 0xff, 0x0b, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00 };
+		s_output.insert(s_output.end(), loop, loop + sizeof(loop));
+	}
+
+	static void gif_writeByte(GifBitWriter* writer, u8 value)
+	{
+		if (s_output[writer->blockStart] == 255)
+		{
+			writer->blockStart = s_output.size();
+			s_output.push_back(0);
+		}
+		s_output.push_back(value);
+		s_output[writer->blockStart]++;
+	}
+
+	static void gif_writeCode(GifBitWriter* writer, u32 code, u32 codeSize)
+	{
+		writer->bits |= code << writer->bitCount;
+		writer->bitCount += codeSize;
+		while (writer->bitCount >= 8)
+		{
+			gif_writeByte(writer, writer->bits & 0xff);
+			writer->bits >>= 8;
+			writer->bitCount -= 8;
+		}
+	}
+
+	static void gif_clearDictionary()
+	{
+		memset(s_lzwKey, 0, sizeof(s_lzwKey));
+	}
+
+	// LZW compress the rect (x0, y0) - (x1, y1), inclusive, with 8 bit minimum code size.
+	static void gif_compress(const u8* image, s32 x0, s32 y0, s32 x1, s32 y1)
+	{
+		write8(8);
+		GifBitWriter writer = { 0, 0, s_output.size() };
+		s_output.push_back(0);
+
+		gif_clearDictionary();
+		u32 codeSize = 9;
+		u32 maxCode = GIF_END_CODE;
+		gif_writeCode(&writer, GIF_CLEAR_CODE, codeSize);
+
+		u32 prefix = image[y0 * s_width + x0];
+		bool first = true;
+		for (s32 y = y0; y <= y1; y++)
+		{
+			const u8* row = &image[y * s_width];
+			for (s32 x = x0; x <= x1; x++)
+			{
+				if (first) { first = false; continue; }
+
+				const u32 pixel = row[x];
+				const u32 key = ((prefix << 8) | pixel) + 1;
+				u32 slot = ((pixel << 12) ^ prefix) % GIF_HASH_SIZE;
+				while (s_lzwKey[slot] && s_lzwKey[slot] != key)
+				{
+					slot = (slot + 1 < GIF_HASH_SIZE) ? slot + 1 : 0;
+				}
+				if (s_lzwKey[slot])
+				{
+					prefix = s_lzwCode[slot];
+					continue;
+				}
+
+				gif_writeCode(&writer, prefix, codeSize);
+				maxCode++;
+				s_lzwKey[slot] = key;
+				s_lzwCode[slot] = u16(maxCode);
+				if (maxCode >= (1u << codeSize))
+				{
+					codeSize++;
+				}
+				if (maxCode == GIF_MAX_CODE)
+				{
+					gif_writeCode(&writer, GIF_CLEAR_CODE, codeSize);
+					gif_clearDictionary();
+					codeSize = 9;
+					maxCode = GIF_END_CODE;
+				}
+				prefix = pixel;
+			}
+		}
+		gif_writeCode(&writer, prefix, codeSize);
+		// The decoder adds a code after reading the last one, which may increase the code size.
+		maxCode++;
+		if (maxCode >= (1u << codeSize) && codeSize < 12)
+		{
+			codeSize++;
+		}
+		gif_writeCode(&writer, GIF_END_CODE, codeSize);
+		if (writer.bitCount)
+		{
+			gif_writeByte(&writer, writer.bits & 0xff);
+		}
+		// Block terminator, the empty block left after a full block already is one.
+		if (s_output[writer.blockStart])
+		{
+			s_output.push_back(0);
+		}
+	}
+
+	static void gif_writeFrame(const VideoFrame* frame, u32 frameCount)
+	{
+		if (!s_headerWritten)
+		{
+			gif_writeHeader(frame->palette);
+			s_headerWritten = true;
+		}
+
+		// Delays are in 1/100 of a second, compute them from the absolute frame so the errors don't accumulate.
+		const u64 start = frame->frameIndex - s_firstFrame;
+		const u64 end = start + frameCount;
+		const u64 delay = (end * 100 + s_fps / 2) / s_fps - (start * 100 + s_fps / 2) / s_fps;
+
+		// Only write the rect that changed, unless the palette changed, which affects all of the pixels.
+		s32 x0 = 0, y0 = 0, x1 = s_width - 1, y1 = s_height - 1;
+		if (s_frameCount && memcmp(frame->palette, s_prevPalette, sizeof(u32) * 256) == 0)
+		{
+			x0 = s_width; y0 = s_height; x1 = -1; y1 = -1;
+			for (s32 y = 0; y < (s32)s_height; y++)
+			{
+				const u8* row = &frame->image[y * s_width];
+				const u8* prevRow = &s_prevImage[y * s_width];
+				if (memcmp(row, prevRow, s_width) == 0) { continue; }
+
+				s32 left = 0, right = s_width - 1;
+				while (row[left] == prevRow[left]) { left++; }
+				while (row[right] == prevRow[right]) { right--; }
+				x0 = std::min(x0, left);
+				x1 = std::max(x1, right);
+				y0 = std::min(y0, y);
+				y1 = y;
+			}
+			// Nothing changed, write a single unchanged pixel to hold the delay.
+			if (y1 < 0)
+			{
+				x0 = x1 = y0 = y1 = 0;
+			}
+		}
+
+		// Graphic control extension: do not dispose, no transparency.
+		write8(0x21);
+		write8(0xf9);
+		write8(0x04);
+		write8(0x04);
+		write16(u16(std::min(delay, (u64)GIF_MAX_DELAY)));
+		write8(0);
+		write8(0);
+
+		// Image descriptor, with a local color table if the palette isn't the global one.
+		const bool localPalette = memcmp(frame->palette, s_globalPalette, sizeof(u32) * 256) != 0;
+		write8(0x2c);
+		write16(x0);
+		write16(y0);
+		write16(x1 - x0 + 1);
+		write16(y1 - y0 + 1);
+		write8(localPalette ? 0x87 : 0x00);
+		if (localPalette)
+		{
+			gif_writePalette(frame->palette);
+		}
+		gif_compress(frame->image.data(), x0, y0, x1, y1);
+		memcpy(s_prevPalette, frame->palette, sizeof(u32) * 256);
+	}
+
+	/////////////////////////////////////////
+	// Y4M
+	/////////////////////////////////////////
+	static void y4m_writeHeader()
+	{
+		char header[256];
+		sprintf(header, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444 XCOLORRANGE=FULL\n", s_width, s_height, s_fps);
+		s_file.writeBuffer(header, u32(strlen(header)));
+	}
+
+	static void y4m_writeFrame(const VideoFrame* frame)
+	{
+		// Convert the palette to full range BT.601 YCbCr once, then each pixel is a lookup.
+		u8 yuv[3][256];
+		for (s32 i = 0; i < 256; i++)
+		{
+			const f32 r = f32(frame->palette[i] & 0xff);
+			const f32 g = f32((frame->palette[i] >> 8) & 0xff);
+			const f32 b = f32((frame->palette[i] >> 16) & 0xff);
+			yuv[0][i] = u8(std::max(0.0f, std::min(255.0f,  0.299f*r + 0.587f*g + 0.114f*b + 0.5f)));
+			yuv[1][i] = u8(std::max(0.0f, std::min(255.0f, -0.168736f*r - 0.331264f*g + 0.5f*b + 128.5f)));
+			yuv[2][i] = u8(std::max(0.0f, std::min(255.0f,  0.5f*r - 0.418688f*g - 0.081312f*b + 128.5f)));
+		}
+
+		const size_t pixelCount = size_t(s_width) * s_height;
+		const char frameHeader[] = "FRAME\n";
+		const size_t frameStart = s_output.size();
+		s_output.insert(s_output.end(), frameHeader, frameHeader + 6);
+		s_output.resize(frameStart + 6 + pixelCount * 3);
+		u8* out = &s_output[frameStart + 6];
+		const u8* image = frame->image.data();
+		for (s32 p = 0; p < 3; p++, out += pixelCount)
+		{
+			for (size_t i = 0; i < pixelCount; i++)
+			{
+				out[i] = yuv[p][image[i]];
+			}
+		}
+	}
+
+	/////////////////////////////////////////
+	// Worker
+	/////////////////////////////////////////
+	static void writeFrame(VideoFrame* frame, u32 frameCount)
+	{
+		s_output.clear();
+		if (s_format == VIDEO_GIF)
+		{
+			gif_writeFrame(frame, frameCount);
+			// Keep the image to find the changed rect of the next frame.
+			std::swap(s_prevImage, frame->image);
+			frame->image.resize(size_t(s_width) * s_height);
+		}
+		else
+		{
+			y4m_writeFrame(frame);
+			// The stream has a constant framerate, so repeat the frame for as long as it is shown.
+			for (u32 i = 1; i < frameCount; i++)
+			{
+				s_file.writeBuffer(s_output.data(), u32(s_output.size()));
+			}
+		}
+		s_file.writeBuffer(s_output.data(), u32(s_output.size()));
+		s_frameCount++;
+	}
+
+	static int videoWriterThread(void* userData)
+	{
+		TFE_THREAD_NAME("Video Writer");
+		// A frame is written once the next one arrives, which determines how long it is shown.
+		VideoFrame* pending = nullptr;
+		u32 readIndex = 0;
+		while (1)
+		{
+			SDL_SemWait(s_readyFrames);
+			VideoFrame* frame = &s_frames[readIndex];
+			readIndex = (readIndex + 1) % FRAME_RING_SIZE;
+
+			if (pending)
+			{
+				const u64 frameCount = std::max(frame->frameIndex, pending->frameIndex + 1) - pending->frameIndex;
+				writeFrame(pending, u32(frameCount));
+				SDL_SemPost(s_freeFrames);
+			}
+			else if (!frame->end)
+			{
+				s_firstFrame = frame->frameIndex;
+			}
+
+			if (frame->end)
+			{
+				SDL_SemPost(s_freeFrames);
+				break;
+			}
+			pending = frame;
+		}
+		return 0;
+	}
+
+	/////////////////////////////////////////
+	// API
+	/////////////////////////////////////////
+	bool begin(const char* path, VideoFormat format, u32 width, u32 height, u32 fps)
+	{
+		if (s_recording) { return false; }
+		if (!s_file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "VideoWriter", "Cannot open '%s' for writing.", path);
+			return false;
+		}
+
+		strcpy(s_path, path);
+		s_format = format;
+		s_width  = width;
+		s_height = height;
+		s_fps = std::max(fps, 1u);
+		s_headerWritten = false;
+		s_frameCount = 0;
+		s_firstFrame = 0;
+		s_writeIndex = 0;
+		s_prevImage.resize(size_t(width) * height);
+		for (s32 i = 0; i < FRAME_RING_SIZE; i++)
+		{
+			s_frames[i].image.resize(size_t(width) * height);
+		}
+
+		s_freeFrames  = SDL_CreateSemaphore(FRAME_RING_SIZE);
+		s_readyFrames = SDL_CreateSemaphore(0);
+		if (s_freeFrames && s_readyFrames)
+		{
+			s_thread = SDL_CreateThread(videoWriterThread, "TFE_VideoWriter", nullptr);
+		}
+		if (!s_thread)
+		{
+			TFE_System::logWrite(LOG_ERROR, "VideoWriter", "Cannot create the video writer thread.");
+			if (s_freeFrames)  { SDL_DestroySemaphore(s_freeFrames); }
+			if (s_readyFrames) { SDL_DestroySemaphore(s_readyFrames); }
+			s_freeFrames = nullptr;
+			s_readyFrames = nullptr;
+			s_file.close();
+			return false;
+		}
+		if (format == VIDEO_Y4M)
+		{
+			y4m_writeHeader();
+		}
+		s_recording = true;
+		return true;
+	}
+
+	void addFrame(const u8* image, u32 stride, const u32* palette, u64 frameIndex)
+	{
+		if (!s_recording) { return; }
+
+		SDL_SemWait(s_freeFrames);
+		VideoFrame* frame = &s_frames[s_writeIndex];
+		s_writeIndex = (s_writeIndex + 1) % FRAME_RING_SIZE;
+
+		u8* output = frame->image.data();
+		for (u32 y = 0; y < s_height; y++, image += stride, output += s_width)
+		{
+			memcpy(output, image, s_width);
+		}
+		memcpy(frame->palette, palette, sizeof(u32) * 256);
+		frame->frameIndex = frameIndex;
+		frame->end = false;
+		SDL_SemPost(s_readyFrames);
+	}
+
+	void end(u64 frameIndex)
+	{
+		if (!s_recording) { return; }
+
+		SDL_SemWait(s_freeFrames);
+		VideoFrame* frame = &s_frames[s_writeIndex];
+		frame->frameIndex = frameIndex;
+		frame->end = true;
+		SDL_SemPost(s_readyFrames);
+
+		SDL_WaitThread(s_thread, nullptr);
+		s_thread = nullptr;
+		SDL_DestroySemaphore(s_freeFrames);
+		SDL_DestroySemaphore(s_readyFrames);
+		s_freeFrames = nullptr;
+		s_readyFrames = nullptr;
+
+		if (s_format == VIDEO_GIF && s_headerWritten)
+		{
+			const u8 trailer = 0x3b;
+			s_file.writeBuffer(&trailer, 1);
+		}
+		s_file.close();
+		s_recording = false;
+		TFE_System::logWrite(LOG_MSG, "VideoWriter", "Recorded %u frames to '%s'.", s_frameCount, s_path);
+
+		// Free the frame memory.
+		for (s32 i = 0; i < FRAME_RING_SIZE; i++)
+		{
+			std::vector<u8>().swap(s_frames[i].image);
+		}
+		std::vector<u8>().swap(s_prevImage);
+		std::vector<u8>().swap(s_output);
+	}
+
+	bool isRecording()
+	{
+		return s_recording;
+	}
+
+	const char* getExtension(VideoFormat format)
+	{
+		return c_videoExtension[format];
+	}
+}
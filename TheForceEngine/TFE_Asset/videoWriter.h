@@ -0,0 +1,32 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Video Writer
+// Streams 8-bit paletted frames to disk while recording, either as an
+// animated GIF or as an uncompressed YUV4MPEG2 (Y4M) stream.
+// The frames already use a 256 color palette so no quantization is
+// needed. Frames are copied into a small ring of buffers and encoded
+// on a worker thread, so memory use does not grow with the length of
+// the recording.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+enum VideoFormat
+{
+	VIDEO_GIF = 0,
+	VIDEO_Y4M,		// 4:4:4, full range - no chroma subsampling.
+	VIDEO_FORMAT_COUNT
+};
+
+namespace TFE_VideoWriter
+{
+	bool begin(const char* path, VideoFormat format, u32 width, u32 height, u32 fps);
+	// Add a frame which is shown from recording frame 'frameIndex' until the frame index of the next frame added.
+	// 'palette' holds 256 colors in the framebuffer format (red in the low byte).
+	// This only blocks if the worker has fallen behind by more than the ring of frames.
+	void addFrame(const u8* image, u32 stride, const u32* palette, u64 frameIndex);
+	// Finish the recording, the last frame is shown until 'frameIndex'.
+	void end(u64 frameIndex);
+	bool isRecording();
+
+	const char* getExtension(VideoFormat format);
+}
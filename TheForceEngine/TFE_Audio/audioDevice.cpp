@@ -123,6 +123,14 @@ namespace TFE_AudioDevice
 		}
 	}
 
+	void pauseOutput(bool pause)
+	{
+		if (s_streamStarted)
+		{
+			SDL_PauseAudioDevice(s_adevid, pause ? 1 : 0);
+		}
+	}
+
 	const OutputDeviceInfo* getOutputDeviceList(s32& count, s32& curOutput)
 	{
 		count = s32(s_outputDeviceList.size());
@@ -12,6 +12,8 @@ namespace TFE_AudioDevice
 
 	bool startOutput(SDL_AudioCallback callback, void* userData = 0, u32 channels = 2, u32 sampleRate = 44100);
 	void stopOutput();
+	// While paused the output callback is not called, once this returns the callback is no longer running.
+	void pauseOutput(bool pause);
 
 	s32 getDefaultOutputDevice();
 	s32 getOutputDeviceId();
@@ -8,8 +8,13 @@
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_System/profiler.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/paths.h>
 #include <assert.h>
 #include <algorithm>
+#include <ctime>
+#include <vector>
 
 // Comment out the desired sigmoid function and comment all of the others.
 //#define AUDIO_SIGMOID_CLIP 1
@@ -19,9 +24,6 @@
 // Volume level below which sound processing can be skipped.
 #define SND_CULL_VOLUME 0.0001f
 
-// Set to 1 to enable audio timing counters.
-#define AUDIO_TIMING 0
-
 enum SoundSourceFlags
 {
 	SND_FLAG_ONE_SHOT = (1 << 0),
@@ -31,11 +33,13 @@ enum SoundSourceFlags
 	SND_FLAG_FINISHED = (1 << 4),
 };
 
+// Game thread view of a sound source.
+// The audio thread has its own copy of the mixing state (see MixSource), which is only changed through commands.
 struct SoundSource
 {
 	SoundType type;
 	f32 volume;
-	u32 sampleIndex;
+	u32 playId;
 	u32 flags;
 	s32 slot;
 
@@ -60,52 +64,130 @@ namespace TFE_Audio
 		AUDIO_FRAME_SIZE = 1024,
 		AUDIO_CALLBACK_BUFFER_SIZE = 256,	// 256
 		BUFFERED_SILENT_FRAME_COUNT = 16,
+		AUDIO_CMD_QUEUE_SIZE = 1024,		// Must be a power of 2.
+	};
+
+	// Commands sent from the game thread to the audio thread.
+	enum AudioCmdType
+	{
+		ACMD_PLAY = 0,		// Start playing 'slot' from the beginning with the given buffer, volume, flags and callback.
+		ACMD_STOP,
+		ACMD_FREE,
+		ACMD_SET_VOLUME,
+		ACMD_SET_BUFFER,
+		ACMD_PAUSE,
+		ACMD_RESUME,
+		ACMD_STOP_ALL,
+	};
+
+	struct AudioCmd
+	{
+		AudioCmdType type;
+		s32 slot;
+		u32 playId;
+		u32 flags;
+		f32 volume;
+		const SoundBuffer* buffer;
+		SoundFinishedCallback finishedCallback;
+		void* finishedUserData;
+		s32 finishedArg;
+	};
+
+	// Audio thread mixing state.
+	struct MixSource
+	{
+		const SoundBuffer* buffer;
+		f32 volume;
+		u32 sampleIndex;
+		u32 flags;
+		u32 playId;
+
+		SoundFinishedCallback finishedCallback;
+		void* finishedUserData;
+		s32 finishedArg;
 	};
 
 	// Client volume controls, ranging from [0, 1]
 	static f32 s_soundFxVolume = 1.0f;
 
+	// Game thread state.
 	static u32 s_sourceCount;
 	static SoundSource s_sources[MAX_SOUND_SOURCES];
-	static SDL_mutex* s_mutex;
-	static bool s_paused = false;
+	// Play ids keep increasing across stopAllSounds(), so a finished id published for an earlier play never matches a new one.
+	static u32 s_playId = 0u;
 	static bool s_nullDevice = false;
 	static volatile s32 s_silentAudioFrames = 0;
 
+	// Single producer (game thread), single consumer (audio thread) command queue.
+	static AudioCmd s_cmdQueue[AUDIO_CMD_QUEUE_SIZE];
+	static atomic_u32 s_cmdWrite;
+	static atomic_u32 s_cmdRead;
+	// The playId of the last play that finished in each slot, published by the audio thread.
+	static atomic_u32 s_finishedId[MAX_SOUND_SOURCES];
+	// Commands that did not fit in the queue, these are applied after the queue so no command is lost.
+	static std::vector<AudioCmd> s_cmdOverflow;
+	static atomic_u32 s_cmdOverflowCount;
+	static SDL_mutex* s_cmdOverflowMutex;
+
+	// Audio thread state.
+	static MixSource s_mixSources[MAX_SOUND_SOURCES];
+	static u32 s_mixCount = 0;
+	static bool s_paused = false;
+
+	// Only guards the audio thread callback (iMuse), the rest of the mix runs without locking.
+	static SDL_mutex* s_callbackMutex;
 	static AudioUpsampleFilter s_upsampleFilter = AUF_DEFAULT;
 	static AudioThreadCallback s_audioThreadCallback = nullptr;
 
+	// Counters.
+	static s32 s_cmdQueueDepth = 0;
+	static s32 s_cmdQueueDepthMax = 0;
+	static s32 s_cmdQueueOverflow = 0;
+	static s32 s_callbackTimeAve = 0;
+	static s32 s_callbackTimeMax = 0;
+	static f64 s_callbackTimeAveF = 0.0;
+	static f64 s_callbackTimeMaxF = 0.0;
+
 	static void audioCallback(void*, unsigned char*, int);
 	void setSoundVolumeConsole(const ConsoleArgList& args);
 	void getSoundVolumeConsole(const ConsoleArgList& args);
-
-#if AUDIO_TIMING == 1
-	static f64 s_soundIterMaxF = 0.0;
-	static f64 s_soundIterAveF = 0.0;
-	static s32 s_soundIterMax = 0;
-	static s32 s_soundIterAve = 0;
-#endif
+	void renderOfflineConsole(const ConsoleArgList& args);
+	void resetSources();
+	void pushCommand(const AudioCmd& cmd);
+	void updateSourceState(SoundSource* source);
 
 	bool init(bool useNullDevice/*=false*/, s32 outputId/*=-1*/)
 	{
 		TFE_System::logWrite(LOG_MSG, "Startup", "TFE_AudioSystem::init");
-		s_sourceCount = 0u;
 
 		CCMD("setSoundVolume", setSoundVolumeConsole, 1, "Sets the sound volume, range is 0.0 to 1.0");
 		CCMD("getSoundVolume", getSoundVolumeConsole, 0, "Get the current sound volume.");
+		CCMD("audioRender", renderOfflineConsole, 1, "Render the next N seconds of audio (sound and music) offline as fast as possible to Documents/AudioCaptures - audioRender seconds [fileName]");
 
-	#if AUDIO_TIMING == 1
-		TFE_COUNTER(s_soundIterMax, "SoundIterMax-MicroSec");
-		TFE_COUNTER(s_soundIterAve, "SoundIterAve-MicroSec");
-	#endif
+		TFE_COUNTER(s_cmdQueueDepth,    "AudioCmdQueueDepth");
+		TFE_COUNTER(s_cmdQueueDepthMax, "AudioCmdQueueDepthMax");
+		TFE_COUNTER(s_cmdQueueOverflow, "AudioCmdQueueOverflow");
+		TFE_COUNTER(s_callbackTimeAve,  "AudioCallbackAve-MicroSec");
+		TFE_COUNTER(s_callbackTimeMax,  "AudioCallbackMax-MicroSec");
 
 		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
 		setVolume(soundSettings->soundFxVolume);
 
-		memset(s_sources, 0, sizeof(SoundSource) * MAX_SOUND_SOURCES);
-		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
+		// The audio device is not running yet, so both sides can be reset directly.
+		resetSources();
+		s_cmdWrite.store(0u);
+		s_cmdRead.store(0u);
+		s_cmdOverflow.clear();
+		s_cmdOverflowCount.store(0u);
+		s_paused = false;
+
+		s_callbackMutex = SDL_CreateMutex();
+		s_cmdOverflowMutex = SDL_CreateMutex();
+		if (!s_callbackMutex || !s_cmdOverflowMutex)
 		{
-			s_sources[i].slot = i;
+			TFE_System::logWrite(LOG_ERROR, "Audio", "Cannot init SDL_mutex.");
+			s_nullDevice = true;
+			return false;
 		}
 
 		bool audDev = TFE_AudioDevice::init(AUDIO_FRAME_SIZE, outputId, useNullDevice);
@@ -124,15 +206,6 @@ namespace TFE_Audio
 			return false;
 		}
 
-		s_mutex = SDL_CreateMutex();
-		if (!s_mutex)
-		{
-			TFE_System::logWrite(LOG_ERROR, "Audio", "Cannot init SDL_mutex.");
-			TFE_AudioDevice::destroy();
-			s_nullDevice = true;
-			return false;
-		}
-
 		s_nullDevice = false;
 		return true;
 	}
@@ -140,26 +213,32 @@ namespace TFE_Audio
 	void shutdown()
 	{
 		TFE_System::logWrite(LOG_MSG, "Audio", "Shutdown");
-		if (s_nullDevice) { return; }
-
-		stopAllSounds();
-
-		TFE_AudioDevice::destroy();
-		SDL_DestroyMutex(s_mutex);
+		if (!s_nullDevice)
+		{
+			stopAllSounds();
+			TFE_AudioDevice::destroy();
+		}
+		// The mutex exists even without an audio device, so the callback can still be used by renderOffline().
+		SDL_DestroyMutex(s_callbackMutex);
+		SDL_DestroyMutex(s_cmdOverflowMutex);
+		s_callbackMutex = nullptr;
+		s_cmdOverflowMutex = nullptr;
 	}
 
 	void stopAllSounds()
 	{
 		if (s_nullDevice) { return; }
 
-		SDL_LockMutex(s_mutex);
 		s_sourceCount = 0u;
 		memset(s_sources, 0, sizeof(SoundSource) * MAX_SOUND_SOURCES);
 		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
 		{
 			s_sources[i].slot = i;
 		}
-		SDL_UnlockMutex(s_mutex);
+
+		AudioCmd cmd = {};
+		cmd.type = ACMD_STOP_ALL;
+		pushCommand(cmd);
 	}
 
 	void selectDevice(s32 id)
@@ -198,16 +277,16 @@ namespace TFE_Audio
 
 	void pause()
 	{
-		SDL_LockMutex(s_mutex);
-		s_paused = true;
-		SDL_UnlockMutex(s_mutex);
+		AudioCmd cmd = {};
+		cmd.type = ACMD_PAUSE;
+		pushCommand(cmd);
 	}
 
 	void resume()
 	{
-		SDL_LockMutex(s_mutex);
-		s_paused = false;
-		SDL_UnlockMutex(s_mutex);
+		AudioCmd cmd = {};
+		cmd.type = ACMD_RESUME;
+		pushCommand(cmd);
 	}
 
 	// Really the buffered audio will continue to process so time advances properly.
@@ -217,14 +296,15 @@ namespace TFE_Audio
 	{
 		s_silentAudioFrames = BUFFERED_SILENT_FRAME_COUNT;
 	}
-		
+
+	// This is applied immediately rather than queued, so the previous callback is never called once this returns.
 	void setAudioThreadCallback(AudioThreadCallback callback)
 	{
-		if (s_nullDevice) { return; }
+		if (!s_callbackMutex) { return; }
 
-		SDL_LockMutex(s_mutex);
+		SDL_LockMutex(s_callbackMutex);
 		s_audioThreadCallback = callback;
-		SDL_UnlockMutex(s_mutex);
+		SDL_UnlockMutex(s_callbackMutex);
 	}
 
 	const OutputDeviceInfo* getOutputDeviceList(s32& count, s32& curOutput)
@@ -234,40 +314,75 @@ namespace TFE_Audio
 
 	void lock()
 	{
-		if (s_nullDevice) { return; }
-		SDL_LockMutex(s_mutex);
+		if (!s_callbackMutex) { return; }
+		SDL_LockMutex(s_callbackMutex);
 	}
 
 	void unlock()
 	{
-		if (s_nullDevice) { return; }
-		SDL_UnlockMutex(s_mutex);
+		if (!s_callbackMutex) { return; }
+		SDL_UnlockMutex(s_callbackMutex);
 	}
 
-	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
-	// Note that looping one shots are valid.
-	bool playOneShot(SoundType type, f32 volume, const SoundBuffer* buffer, bool looping, SoundFinishedCallback finishedCallback, void* cbUserData, s32 cbArg)
+	SoundSource* allocateSource()
 	{
-		if (!buffer || s_nullDevice) { return false; }
-
-		SDL_LockMutex(s_mutex);
 		// Find the first inactive source.
 		SoundSource* snd = s_sources;
-		SoundSource* newSource = nullptr;
 		for (u32 s = 0; s < s_sourceCount; s++, snd++)
 		{
+			updateSourceState(snd);
 			if (!(snd->flags&SND_FLAG_ACTIVE))
 			{
-				newSource = snd;
-				break;
+				return snd;
 			}
 		}
-		if (!newSource && s_sourceCount < MAX_SOUND_SOURCES)
+		if (s_sourceCount < MAX_SOUND_SOURCES)
 		{
-			newSource = &s_sources[s_sourceCount];
+			SoundSource* newSource = &s_sources[s_sourceCount];
 			s_sourceCount++;
+			return newSource;
 		}
+		return nullptr;
+	}
+
+	void playCommand(SoundSource* source)
+	{
+		// Skip 0 when wrapping around, since that is the initial finished id.
+		s_playId++;
+		if (!s_playId) { s_playId++; }
+		source->playId = s_playId;
+
+		AudioCmd cmd;
+		cmd.type = ACMD_PLAY;
+		cmd.slot = source->slot;
+		cmd.playId = source->playId;
+		cmd.flags = source->flags;
+		cmd.volume = source->volume;
+		cmd.buffer = source->buffer;
+		cmd.finishedCallback = source->finishedCallback;
+		cmd.finishedUserData = source->finishedUserData;
+		cmd.finishedArg = source->finishedArg;
+		pushCommand(cmd);
+	}
+
+	void sourceCommand(AudioCmdType type, SoundSource* source)
+	{
+		AudioCmd cmd = {};
+		cmd.type = type;
+		cmd.slot = source->slot;
+		cmd.playId = source->playId;
+		cmd.volume = source->volume;
+		cmd.buffer = source->buffer;
+		pushCommand(cmd);
+	}
+
+	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
+	// Note that looping one shots are valid.
+	bool playOneShot(SoundType type, f32 volume, const SoundBuffer* buffer, bool looping, SoundFinishedCallback finishedCallback, void* cbUserData, s32 cbArg)
+	{
+		if (!buffer || s_nullDevice) { return false; }
 
+		SoundSource* newSource = allocateSource();
 		if (newSource)
 		{
 			newSource->type = type;
@@ -278,13 +393,11 @@ namespace TFE_Audio
 			}
 			newSource->volume = type == SOUND_3D ? 0.0f : volume;
 			newSource->buffer = buffer;
-			newSource->sampleIndex = 0u;
 			newSource->finishedCallback = finishedCallback;
 			newSource->finishedUserData = cbUserData;
 			newSource->finishedArg = cbArg;
+			playCommand(newSource);
 		}
-		SDL_UnlockMutex(s_mutex);
-
 		return newSource != nullptr;
 	}
 
@@ -294,36 +407,17 @@ namespace TFE_Audio
 		if (!buffer || s_nullDevice) { return nullptr; }
 		assert(volume >= 0.0f && volume <= 1.0f);
 
-		SDL_LockMutex(s_mutex);
-		// Find the first inactive source.
-		SoundSource* snd = s_sources;
-		SoundSource* newSource = nullptr;
-		for (u32 s = 0; s < s_sourceCount; s++, snd++)
-		{
-			if (!(snd->flags&SND_FLAG_ACTIVE))
-			{
-				newSource = snd;
-				break;
-			}
-		}
-		if (!newSource && s_sourceCount < MAX_SOUND_SOURCES)
-		{
-			newSource = &s_sources[s_sourceCount];
-			s_sourceCount++;
-		}
-
+		SoundSource* newSource = allocateSource();
 		if (newSource)
 		{
 			newSource->type = type;
 			newSource->flags = SND_FLAG_ACTIVE;
 			newSource->volume = volume;
 			newSource->buffer = buffer;
-			newSource->sampleIndex = 0u;
 			newSource->finishedCallback = callback;
 			newSource->finishedUserData = userData;
+			newSource->finishedArg = 0;
 		}
-		SDL_UnlockMutex(s_mutex);
-
 		return newSource;
 	}
 
@@ -341,6 +435,7 @@ namespace TFE_Audio
 		{
 			return nullptr;
 		}
+		updateSourceState(&s_sources[slot]);
 		if (!(s_sources[slot].flags & SND_FLAG_ACTIVE))
 		{
 			return nullptr;
@@ -351,55 +446,50 @@ namespace TFE_Audio
 
 	void playSource(SoundSource* source, bool looping)
 	{
-		if (!source || (source->flags & SND_FLAG_PLAYING) || s_nullDevice)
-		{
-			return;
-		}
-		
-		SDL_LockMutex(s_mutex);
-			source->flags |= SND_FLAG_PLAYING;
-			if (looping) { source->flags |= SND_FLAG_LOOPING; }
-			source->sampleIndex = 0u;
-		SDL_UnlockMutex(s_mutex);
+		if (!source || s_nullDevice) { return; }
+		updateSourceState(source);
+		if (source->flags & SND_FLAG_PLAYING) { return; }
+
+		source->flags |= SND_FLAG_PLAYING;
+		if (looping) { source->flags |= SND_FLAG_LOOPING; }
+		playCommand(source);
 	}
 
 	void stopSource(SoundSource* source)
 	{
 		if (!source || s_nullDevice) { return; }
-		SDL_LockMutex(s_mutex);
-			source->flags &= ~SND_FLAG_PLAYING;
-		SDL_UnlockMutex(s_mutex);
+		source->flags &= ~SND_FLAG_PLAYING;
+		sourceCommand(ACMD_STOP, source);
 	}
 	
 	void freeSource(SoundSource* source)
 	{
 		if (!source || s_nullDevice) { return; }
-		SDL_LockMutex(s_mutex);
-			source->flags &= ~SND_FLAG_PLAYING;
-			source->flags &= ~SND_FLAG_ACTIVE;
-			source->buffer = nullptr;
-		SDL_UnlockMutex(s_mutex);
+		source->flags &= ~SND_FLAG_PLAYING;
+		source->flags &= ~SND_FLAG_ACTIVE;
+		source->buffer = nullptr;
+		sourceCommand(ACMD_FREE, source);
 	}
 
 	void setSourceVolume(SoundSource* source, f32 volume)
 	{
 		if (s_nullDevice) { return; }
 		source->volume = std::max(0.0f, std::min(1.0f, volume));
+		sourceCommand(ACMD_SET_VOLUME, source);
 	}
 
 	// This will restart the sound and change the buffer.
 	void setSourceBuffer(SoundSource* source, const SoundBuffer* buffer)
 	{
 		if (s_nullDevice) { return; }
-		SDL_LockMutex(s_mutex);
-			source->sampleIndex = 0u;
-			source->buffer = buffer;
-		SDL_UnlockMutex(s_mutex);
+		source->buffer = buffer;
+		sourceCommand(ACMD_SET_BUFFER, source);
 	}
 
 	bool isSourcePlaying(SoundSource* source)
 	{
 		if (s_nullDevice) { return false; }
+		updateSourceState(source);
 		return (source->flags & SND_FLAG_PLAYING) != 0u;
 	}
 
@@ -409,35 +499,173 @@ namespace TFE_Audio
 		return source->volume;
 	}
 
+	/////////////////////////////////////////////
+	// Command Queue
+	/////////////////////////////////////////////
+	void resetSources()
+	{
+		s_sourceCount = 0u;
+		memset(s_sources, 0, sizeof(SoundSource) * MAX_SOUND_SOURCES);
+		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
+		{
+			s_sources[i].slot = i;
+			s_finishedId[i].store(0u);
+		}
+		memset(s_mixSources, 0, sizeof(MixSource) * MAX_SOUND_SOURCES);
+		s_mixCount = 0u;
+	}
+
+	// Game thread: if the queue is full, the command goes to the locked overflow list instead so it is never dropped.
+	// Once there are overflow commands, the following commands go there too until the audio thread catches up, keeping them in order.
+	void pushCommand(const AudioCmd& cmd)
+	{
+		if (s_nullDevice) { return; }
+
+		const u32 write = s_cmdWrite.load(std::memory_order_relaxed);
+		const u32 read = s_cmdRead.load(std::memory_order_acquire);
+		if (!s_cmdOverflowCount.load(std::memory_order_acquire) && write - read < AUDIO_CMD_QUEUE_SIZE)
+		{
+			s_cmdQueue[write & (AUDIO_CMD_QUEUE_SIZE - 1)] = cmd;
+			s_cmdWrite.store(write + 1, std::memory_order_release);
+			return;
+		}
+
+		if (!s_cmdQueueOverflow)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Audio", "Audio command queue is full, using the overflow list.");
+		}
+		s_cmdQueueOverflow++;
+
+		SDL_LockMutex(s_cmdOverflowMutex);
+		s_cmdOverflow.push_back(cmd);
+		s_cmdOverflowCount.store(u32(s_cmdOverflow.size()), std::memory_order_release);
+		SDL_UnlockMutex(s_cmdOverflowMutex);
+	}
+
+	// Game thread: pick up sounds that the audio thread has finished playing.
+	// Finished sources become inactive, matching the behavior of the audio thread.
+	void updateSourceState(SoundSource* source)
+	{
+		if ((source->flags & SND_FLAG_PLAYING) && s_finishedId[source->slot].load(std::memory_order_acquire) == source->playId)
+		{
+			source->flags = 0;
+			source->buffer = nullptr;
+		}
+	}
+
+	// Audio thread: apply a single command.
+	static void applyCommand(const AudioCmd* cmd)
+	{
+		MixSource* snd = cmd->slot >= 0 ? &s_mixSources[cmd->slot] : nullptr;
+		switch (cmd->type)
+		{
+			case ACMD_PLAY:
+			{
+				snd->buffer = cmd->buffer;
+				snd->volume = cmd->volume;
+				snd->sampleIndex = 0u;
+				snd->flags = cmd->flags;
+				snd->playId = cmd->playId;
+				snd->finishedCallback = cmd->finishedCallback;
+				snd->finishedUserData = cmd->finishedUserData;
+				snd->finishedArg = cmd->finishedArg;
+				s_mixCount = std::max(s_mixCount, u32(cmd->slot + 1));
+			} break;
+			case ACMD_STOP:
+			{
+				snd->flags &= ~SND_FLAG_PLAYING;
+			} break;
+			case ACMD_FREE:
+			{
+				snd->flags = 0;
+				snd->buffer = nullptr;
+			} break;
+			case ACMD_SET_VOLUME:
+			{
+				snd->volume = cmd->volume;
+			} break;
+			case ACMD_SET_BUFFER:
+			{
+				snd->sampleIndex = 0u;
+				snd->buffer = cmd->buffer;
+			} break;
+			case ACMD_PAUSE:
+			{
+				s_paused = true;
+			} break;
+			case ACMD_RESUME:
+			{
+				s_paused = false;
+			} break;
+			case ACMD_STOP_ALL:
+			{
+				memset(s_mixSources, 0, sizeof(MixSource) * MAX_SOUND_SOURCES);
+				s_mixCount = 0u;
+			} break;
+		}
+	}
+
+	// Audio thread: apply the commands in the queue, returns the number of commands.
+	static u32 processQueue()
+	{
+		const u32 read = s_cmdRead.load(std::memory_order_relaxed);
+		const u32 write = s_cmdWrite.load(std::memory_order_acquire);
+		for (u32 c = read; c != write; c++)
+		{
+			applyCommand(&s_cmdQueue[c & (AUDIO_CMD_QUEUE_SIZE - 1)]);
+		}
+		s_cmdRead.store(write, std::memory_order_release);
+		return write - read;
+	}
+
+	// Audio thread: apply all of the pending commands before mixing.
+	void processCommands()
+	{
+		u32 count = processQueue();
+		if (s_cmdOverflowCount.load(std::memory_order_acquire))
+		{
+			// The game thread only adds to the overflow list while it is not empty, so finish the queue first to keep the commands in order.
+			SDL_LockMutex(s_cmdOverflowMutex);
+			count += processQueue();
+			for (size_t c = 0; c < s_cmdOverflow.size(); c++)
+			{
+				applyCommand(&s_cmdOverflow[c]);
+			}
+			count += u32(s_cmdOverflow.size());
+			s_cmdOverflow.clear();
+			s_cmdOverflowCount.store(0u, std::memory_order_release);
+			SDL_UnlockMutex(s_cmdOverflowMutex);
+		}
+		s_cmdQueueDepth = s32(count);
+		s_cmdQueueDepthMax = std::max(s_cmdQueueDepthMax, s_cmdQueueDepth);
+	}
+
 	// Internal
 	static const f32 c_scale[] = { 2.0f / 255.0f, 2.0f / 65535.0f, 1.0f };
 	static const f32 c_offset[] = { -1.0f, -1.0f, 0.0f };
 
 	void cleanupSources()
 	{
-		// call any finished callbacks.
-		for (u32 s = 0; s < s_sourceCount; s++)
+		// publish finished sounds and call any finished callbacks.
+		for (u32 s = 0; s < s_mixCount; s++)
 		{
-			if (s_sources[s].flags&SND_FLAG_FINISHED)
+			MixSource* snd = &s_mixSources[s];
+			if (snd->flags&SND_FLAG_FINISHED)
 			{
-				s_sources[s].flags = 0;
-				s_sources[s].buffer = nullptr;
-				if (s_sources[s].finishedCallback)
+				snd->flags = 0;
+				snd->buffer = nullptr;
+				s_finishedId[s].store(snd->playId, std::memory_order_release);
+				if (snd->finishedCallback)
 				{
-					s_sources[s].finishedCallback(s_sources[s].finishedUserData, s_sources[s].finishedArg);
+					snd->finishedCallback(snd->finishedUserData, snd->finishedArg);
 				}
 			}
 		}
 
-		const s32 end = (s32)s_sourceCount - 1;
-		//shrink the number of sources until an active source is found.
-		for (s32 s = end; s >= 0; s--)
+		//shrink the number of sources until a playing source is found.
+		while (s_mixCount > 0 && !(s_mixSources[s_mixCount - 1].flags&SND_FLAG_PLAYING))
 		{
-			if (s_sources[s].flags&SND_FLAG_ACTIVE)
-			{
-				break;
-			}
-			s_sourceCount--;
+			s_mixCount--;
 		}
 	}
 		
@@ -454,48 +682,49 @@ namespace TFE_Audio
 		return sampleValue * c_scale[type] + c_offset[type];
 	}
 			
-	// Audio callback
-	static void audioCallback(void* userData, unsigned char* outputBuffer, int bufsize)
+	// Mix 'frames' stereo frames into 'output', this is called from the audio callback or by renderOffline().
+	// Note the audio thread callback (iMuse) always generates AUDIO_FRAME_SIZE frames.
+	static void mixAudio(f32* output, u32 frames)
 	{
-		f32* buffer = (f32*)outputBuffer;
-		u32 bufferSize = (u32)bufsize;
-		u32 frames = bufferSize / (AUDIO_CHANNEL_COUNT * sizeof(f32));
-
-	#if AUDIO_TIMING == 1
-		u64 soundIterStart = TFE_System::getCurrentTimeInTicks();
-	#endif
+		TFE_ZONE("Audio Mix");
+		f32* buffer = output;
 
 		// First clear samples
-		memset(buffer, 0, bufferSize);
-			   
-		SDL_LockMutex(s_mutex);
+		memset(buffer, 0, frames * AUDIO_CHANNEL_COUNT * sizeof(f32));
+		processCommands();
+
 		// Then call the audio thread callback
-		if (s_audioThreadCallback && !s_paused)
+		if (!s_paused)
 		{
-			static f32 callbackBuffer[(AUDIO_CALLBACK_BUFFER_SIZE + 2)*AUDIO_CHANNEL_COUNT];	// 256 stereo + oversampling.
-			s_audioThreadCallback(callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE, s_soundFxVolume * c_soundHeadroom);
-			// The audio buffer is 1/4 as large as it should be.
-			// This means that in-between samples must be interpolated.
-			if (!s_silentAudioFrames)
+			SDL_LockMutex(s_callbackMutex);
+			if (s_audioThreadCallback)
 			{
-				if (s_upsampleFilter == AUF_NONE)
+				static f32 callbackBuffer[(AUDIO_CALLBACK_BUFFER_SIZE + 2)*AUDIO_CHANNEL_COUNT];	// 256 stereo + oversampling.
+				s_audioThreadCallback(callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE, s_soundFxVolume * c_soundHeadroom);
+				// The audio buffer is 1/4 as large as it should be.
+				// This means that in-between samples must be interpolated.
+				if (!s_silentAudioFrames)
 				{
-					upsample4x_point(buffer, callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
-				}
-				else if (s_upsampleFilter == AUF_LINEAR)
-				{
-					upsample4x_linear(buffer, callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
+					if (s_upsampleFilter == AUF_NONE)
+					{
+						upsample4x_point(buffer, callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
+					}
+					else if (s_upsampleFilter == AUF_LINEAR)
+					{
+						upsample4x_linear(buffer, callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
+					}
 				}
 			}
+			SDL_UnlockMutex(s_callbackMutex);
 		}
 
 		// Then loop through the sources.
 		// Note: this is no longer used by Dark Forces. However I decided to keep direct sound support around
 		// so it can be used for tools.
-		SoundSource* snd = s_sources;
-		for (u32 s = 0; s < s_sourceCount && !s_paused; s++, snd++)
+		MixSource* snd = s_mixSources;
+		for (u32 s = 0; s < s_mixCount && !s_paused; s++, snd++)
 		{
-			if (!(snd->flags&SND_FLAG_PLAYING)) { continue; }
+			if (!(snd->flags&SND_FLAG_PLAYING) || !snd->buffer) { continue; }
 			assert(snd->buffer->data);
 
 			// Skip sound sample processing the sound is too quiet...
@@ -521,7 +750,7 @@ namespace TFE_Audio
 			}
 
 			// Sample loop.
-			buffer = (f32*)outputBuffer;
+			buffer = output;
 			// The sound may be split into multiple iterations if it loops or the loop
 			// may end early, once we reach the end.
 			for (u32 i = 0; i < frames;)
@@ -554,19 +783,17 @@ namespace TFE_Audio
 				snd->sampleIndex = sIndex;
 			}
 		}
-		// Cleanup sound sources while we are still in the mutex.
 		cleanupSources();
 		
 		// Handle midi synthesis results.
 		if (!s_paused)
 		{
-			TFE_MidiPlayer::synthesizeMidi((f32*)outputBuffer, frames, !s_silentAudioFrames);
+			TFE_MidiPlayer::synthesizeMidi(output, frames, !s_silentAudioFrames);
 		}
 		if (s_silentAudioFrames > 0) { s_silentAudioFrames--; }
-		SDL_UnlockMutex(s_mutex);
 
 		// Handle out of range audio samples.
-		buffer = (f32*)outputBuffer;
+		buffer = output;
 		for (u32 i = 0; i < frames; i++, buffer += 2)
 		{
 			const f32 valueLeft  = buffer[0];
@@ -588,16 +815,106 @@ namespace TFE_Audio
 			buffer[1] = valueRight / sqrtf(1.0f + valueRight * valueRight);
 		#endif
 		}
+	}
+
+	// Audio callback
+	static void audioCallback(void* userData, unsigned char* outputBuffer, int bufsize)
+	{
+		const u32 frames = u32(bufsize) / (AUDIO_CHANNEL_COUNT * sizeof(f32));
+		u64 callbackStart = TFE_System::getCurrentTimeInTicks();
+		TFE_THREAD_NAME("Audio");
+		mixAudio((f32*)outputBuffer, frames);
 
 		// Timing
-	#if AUDIO_TIMING == 1
-		u64 soundIterEnd = TFE_System::getCurrentTimeInTicks();
-		f64 soundIterDeltaMS = 1000000.0 * TFE_System::convertFromTicksToSeconds(soundIterEnd - soundIterStart);
-		s_soundIterAveF = soundIterDeltaMS * 0.01 + s_soundIterAveF * 0.99;
-		s_soundIterMaxF = std::max(s_soundIterMaxF, soundIterDeltaMS);
-		s_soundIterAve = s32(s_soundIterAveF);
-		s_soundIterMax = s32(s_soundIterMaxF);
-	#endif
+		u64 callbackEnd = TFE_System::getCurrentTimeInTicks();
+		f64 callbackDeltaUS = 1000000.0 * TFE_System::convertFromTicksToSeconds(callbackEnd - callbackStart);
+		s_callbackTimeAveF = callbackDeltaUS * 0.01 + s_callbackTimeAveF * 0.99;
+		s_callbackTimeMaxF = std::max(s_callbackTimeMaxF, callbackDeltaUS);
+		s_callbackTimeAve = s32(s_callbackTimeAveF);
+		s_callbackTimeMax = s32(s_callbackTimeMaxF);
+	}
+
+	#pragma pack(push)
+	#pragma pack(1)
+	struct WavHeader
+	{
+		char riff[4];
+		u32  riffSize;
+		char wave[4];
+		char fmt[4];
+		u32  fmtSize;
+		u16  format;
+		u16  channels;
+		u32  sampleRate;
+		u32  byteRate;
+		u16  blockAlign;
+		u16  bitsPerSample;
+		char data[4];
+		u32  dataSize;
+	};
+	#pragma pack(pop)
+
+	enum
+	{
+		WAV_FORMAT_IEEE_FLOAT = 3,
+	};
+
+	bool renderOffline(const char* path, f64 seconds)
+	{
+		if (!s_callbackMutex || seconds <= 0.0) { return false; }
+
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Audio", "Cannot open '%s' for offline rendering.", path);
+			return false;
+		}
+
+		// Render whole frames, since the audio thread callback always generates AUDIO_FRAME_SIZE samples.
+		const u32 blockCount = u32(seconds * f64(AUDIO_FREQ) / f64(AUDIO_FRAME_SIZE)) + 1;
+		const u32 frameCount = blockCount * AUDIO_FRAME_SIZE;
+		const u32 dataSize = frameCount * AUDIO_CHANNEL_COUNT * sizeof(f32);
+
+		WavHeader header;
+		memcpy(header.riff, "RIFF", 4);
+		header.riffSize = sizeof(WavHeader) - 8 + dataSize;
+		memcpy(header.wave, "WAVE", 4);
+		memcpy(header.fmt, "fmt ", 4);
+		header.fmtSize = 16;
+		header.format = WAV_FORMAT_IEEE_FLOAT;
+		header.channels = AUDIO_CHANNEL_COUNT;
+		header.sampleRate = AUDIO_FREQ;
+		header.byteRate = AUDIO_FREQ * AUDIO_CHANNEL_COUNT * sizeof(f32);
+		header.blockAlign = AUDIO_CHANNEL_COUNT * sizeof(f32);
+		header.bitsPerSample = 32;
+		memcpy(header.data, "data", 4);
+		header.dataSize = dataSize;
+		file.writeBuffer(&header, sizeof(WavHeader));
+
+		// Stop the device callback, from here on the mix only runs on this thread and the music
+		// is driven from the same clock, so the output does not depend on the speed of the machine.
+		TFE_AudioDevice::pauseOutput(true);
+		TFE_MidiPlayer::setOfflineClock(true);
+
+		static f32 block[AUDIO_FRAME_SIZE * AUDIO_CHANNEL_COUNT];
+		const f64 blockTime = f64(AUDIO_FRAME_SIZE) / f64(AUDIO_FREQ);
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (u32 b = 0; b < blockCount; b++)
+		{
+			TFE_MidiPlayer::advanceOfflineClock(blockTime);
+			mixAudio(block, AUDIO_FRAME_SIZE);
+			file.writeBuffer(block, sizeof(block));
+		}
+		const f64 renderTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		file.close();
+
+		TFE_MidiPlayer::setOfflineClock(false);
+		TFE_AudioDevice::pauseOutput(false);
+
+		const f64 audioTime = f64(frameCount) / f64(AUDIO_FREQ);
+		TFE_System::logWrite(LOG_MSG, "Audio", "Rendered %0.2f seconds of audio to '%s' in %0.3f seconds (%0.1fx realtime, %0.1f microseconds per %d frames).",
+			audioTime, path, renderTime, audioTime / std::max(renderTime, 0.000001), 1000000.0 * renderTime / f64(blockCount), AUDIO_FRAME_SIZE);
+		return true;
 	}
 
 	// Console functions.
@@ -618,4 +935,38 @@ namespace TFE_Audio
 		sprintf(res, "Sound Volume: %2.3f", s_soundFxVolume);
 		TFE_Console::addToHistory(res);
 	}
+
+	void renderOfflineConsole(const ConsoleArgList& args)
+	{
+		if (args.size() < 2) { return; }
+		const f64 seconds = f64(TFE_Console::getFloatArg(args[1]));
+
+		char captureDir[TFE_MAX_PATH];
+		TFE_Paths::appendPath(TFE_PathType::PATH_USER_DOCUMENTS, "AudioCaptures/", captureDir);
+		FileUtil::makeDirectory(captureDir);
+
+		char path[TFE_MAX_PATH];
+		if (args.size() >= 3)
+		{
+			snprintf(path, TFE_MAX_PATH, "%s%s", captureDir, args[2].c_str());
+		}
+		else
+		{
+			char dateTime[64];
+			const time_t curTime = time(nullptr);
+			strftime(dateTime, sizeof(dateTime), "%Y%m%d_%H%M%S", localtime(&curTime));
+			snprintf(path, TFE_MAX_PATH, "%saudio_%s.wav", captureDir, dateTime);
+		}
+
+		char res[TFE_MAX_PATH + 64];
+		if (renderOffline(path, seconds))
+		{
+			snprintf(res, sizeof(res), "Rendered audio to '%s'.", path);
+		}
+		else
+		{
+			snprintf(res, sizeof(res), "Cannot render audio to '%s'.", path);
+		}
+		TFE_Console::addToHistory(res);
+	}
 }
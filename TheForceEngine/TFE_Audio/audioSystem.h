@@ -70,12 +70,19 @@ namespace TFE_Audio
 	void pause();
 	void resume();
 
+	// Guards state shared with the audio thread callback, the callback is never called while locked.
+	// Source and parameter changes do not need the lock, they are queued and applied at the start of the next mix.
 	void lock();
 	void unlock();
 
 	void bufferedAudioClear();
 
 	void setAudioThreadCallback(AudioThreadCallback callback = nullptr);
+
+	// Render 'seconds' of audio offline, as fast as possible, and write it to 'path' as a stereo 32-bit float WAV file.
+	// The audio device is paused and the music (midi callback) is driven from the same fixed clock, so the output is
+	// deterministic and this works without an audio device. The calling thread is blocked until rendering is done.
+	bool renderOffline(const char* path, f64 seconds);
 	const OutputDeviceInfo* getOutputDeviceList(s32& count, s32& curOutput);
 
 	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
@@ -10,6 +10,7 @@
 #include <TFE_System/system.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
+#include <TFE_System/profiler.h>
 #include <TFE_Audio/MidiSynth/soundFontDevice.h>
 #include <TFE_Audio/MidiSynth/fm4Opl3Device.h>
 #include <algorithm>
@@ -58,6 +59,8 @@ namespace TFE_MidiPlayer
 	static f32 s_masterVolumeScaled = s_masterVolume * c_musicVolumeScale;
 	static SDL_Thread* s_thread = nullptr;
 	static bool s_tPaused = false;
+	static bool s_isPaused = false;
+	static bool s_offlineClock = false;
 
 	static atomic_bool s_runMusicThread;
 	static u8 s_channelSrcVolume[MIDI_CHANNEL_COUNT] = { 0 };
@@ -81,6 +84,7 @@ namespace TFE_MidiPlayer
 	int midiUpdateFunc(void* userData);
 	void stopAllNotes();
 	void changeVolume();
+	void updateCallback(f64 dt);
 	void allocateMidiDevice(MidiDeviceType type);
 
 	// Console Functions
@@ -124,7 +128,8 @@ namespace TFE_MidiPlayer
 		}
 
 		s_runMusicThread.store(true);
-
+		s_isPaused = false;
+		s_offlineClock = false;
 
 		s_thread = SDL_CreateThread(midiUpdateFunc, "TFE_MidiThread", nullptr);
 		if (!s_thread)
@@ -243,6 +248,24 @@ namespace TFE_MidiPlayer
 		}
 	}
 
+	void setOfflineClock(bool enable)
+	{
+		SDL_LockMutex(s_mutex);
+		s_offlineClock = enable;
+		SDL_UnlockMutex(s_mutex);
+	}
+
+	void advanceOfflineClock(f64 dt)
+	{
+		SDL_LockMutex(s_mutex);
+		if (s_offlineClock && s_midiCallback.callback && !s_isPaused)
+		{
+			TFE_ZONE("Midi Update");
+			updateCallback(dt);
+		}
+		SDL_UnlockMutex(s_mutex);
+	}
+
 	void pause()
 	{
 		SDL_LockMutex(s_mutex);
@@ -444,17 +467,32 @@ namespace TFE_MidiPlayer
 		}
 	}
 
+	// Advance the midi callback time by 'dt' seconds, the mutex must be held.
+	void updateCallback(f64 dt)
+	{
+		s_midiCallback.accumulator += dt;
+		while (s_midiCallback.callback && s_midiCallback.accumulator >= s_midiCallback.timeStep)
+		{
+			s_midiCallback.callback();
+			s_midiCallback.accumulator -= s_midiCallback.timeStep;
+			s_curNoteTime += s_midiCallback.timeStep;
+		}
+
+		// Check for hanging notes.
+		detectHangingNotes();
+	}
+
 	// Thread Function
 	int midiUpdateFunc(void* userData)
 	{
 		bool runThread  = true;
 		bool wasPlaying = false;
 		bool isPlaying  = false;
-		bool isPaused = false;
 		s32 loopStart = -1;
 		u64 localTime = 0;
 		u64 localTimeCallback = 0;
 		f64 dt = 0.0;
+		TFE_THREAD_NAME("Midi");
 		while (runThread)
 		{
 			SDL_LockMutex(s_mutex);
@@ -468,12 +506,12 @@ namespace TFE_MidiPlayer
 					case MIDI_PAUSE:
 					{
 						localTimeCallback = 0;
-						isPaused = true;
+						s_isPaused = true;
 						stopAllNotes();
 					} break;
 					case MIDI_RESUME:
 					{
-						isPaused = false;
+						s_isPaused = false;
 					} break;
 					case MIDI_CHANGE_VOL:
 					{
@@ -493,18 +531,15 @@ namespace TFE_MidiPlayer
 			s_midiCmdCount = 0;
 
 			// Process the midi callback, if it exists.
-			if (s_midiCallback.callback && !isPaused)
+			// Time is advanced by advanceOfflineClock() instead when using the offline clock.
+			if (s_offlineClock)
 			{
-				s_midiCallback.accumulator += TFE_System::updateThreadLocal(&localTimeCallback);
-				while (s_midiCallback.callback && s_midiCallback.accumulator >= s_midiCallback.timeStep)
-				{
-					s_midiCallback.callback();
-					s_midiCallback.accumulator -= s_midiCallback.timeStep;
-					s_curNoteTime += s_midiCallback.timeStep;
-				}
-
-				// Check for hanging notes.
-				detectHangingNotes();
+				localTimeCallback = 0;
+			}
+			else if (s_midiCallback.callback && !s_isPaused)
+			{
+				TFE_ZONE("Midi Update");
+				updateCallback(TFE_System::updateThreadLocal(&localTimeCallback));
 			}
 
 			SDL_UnlockMutex(s_mutex);
@@ -34,6 +34,11 @@ namespace TFE_MidiPlayer
 	void pauseThread();
 	void resumeThread();
 
+	// Offline clock: while enabled the midi callback is no longer driven by the midi thread (wall clock time),
+	// instead time only advances when advanceOfflineClock() is called. This is used to render audio offline.
+	void setOfflineClock(bool enable);
+	void advanceOfflineClock(f64 dt);
+
 	// Pause the midi player, which also stops all sound channels.
 	void pause();
 	// Resume midi playback from where it left off.
@@ -29,6 +29,7 @@
 #include <TFE_Jedi/Memory/list.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 
 using namespace TFE_Jedi;
 
@@ -88,6 +89,13 @@ namespace TFE_DarkForces
 		welder_exit();
 	}
 
+	void actor_registerRewindState()
+	{
+		REWIND_STATE(s_istate);
+		REWIND_STATE(s_physicsActors);
+		REWIND_STATE(s_actorState);
+	}
+
 	void actor_loadSounds()
 	{
 		s_alertSndSrc[ALERT_GAMOR]    = sound_load("gamor-3.voc",  SOUND_PRIORITY_MED5);
@@ -145,6 +145,7 @@ namespace TFE_DarkForces
 {
 	void actor_clearState();
 	void actor_exitState();
+	void actor_registerRewindState();
 
 	void actor_loadSounds();
 	void actor_allocatePhysicsActorList();
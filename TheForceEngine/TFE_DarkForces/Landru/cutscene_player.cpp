@@ -1,5 +1,6 @@
 #include "cutscene_player.h"
 #include "cutscene_film.h"
+#include "cutscene_prefetch.h"
 #include "lcanvas.h"
 #include "lmusic.h"
 #include "lsound.h"
@@ -103,6 +104,24 @@ namespace TFE_DarkForces
 		return JFALSE;
 	}
 		
+	// Start reading the archive of the scene that plays next, unless it is skipped.
+	static void cutscenePlayer_prefetchNext()
+	{
+		s32 nextId = s_playSeq[s_playId].nextId;
+		if (nextId == SCENE_EXIT) { return; }
+
+		s32 nextPlayId = 0;
+		while (nextId != s_playSeq[nextPlayId].id && s_playSeq[nextPlayId].id != SCENE_EXIT)
+		{
+			nextPlayId++;
+		}
+		FilePath path;
+		if (s_playSeq[nextPlayId].id != SCENE_EXIT && TFE_Paths::getFilePath(s_playSeq[nextPlayId].archive, &path))
+		{
+			cutscenePrefetch_begin(path.path);
+		}
+	}
+
 	void cutscenePlayer_start(s32 sceneId)
 	{
 		s_scene = sceneId;
@@ -130,12 +149,18 @@ namespace TFE_DarkForces
 				s_scene = SCENE_EXIT;
 				return;
 			}
-			lfd = new LfdArchive();
-			if (!lfd->open(path.path))
+			// Use the prefetched archive data if available, otherwise read from disk.
+			lfd = cutscenePrefetch_take(path.path);
+			if (!lfd)
 			{
-				delete lfd;
-				s_scene = SCENE_EXIT;
-				return;
+				cutscenePrefetch_cancel();
+				lfd = new LfdArchive();
+				if (!lfd->open(path.path))
+				{
+					delete lfd;
+					s_scene = SCENE_EXIT;
+					return;
+				}
 			}
 			TFE_Paths::addLocalArchiveToFront(lfd);
 
@@ -173,6 +198,8 @@ namespace TFE_DarkForces
 			// Close the archive.
 			TFE_Paths::removeFirstArchive();
 			delete lfd;
+			// Read the next scene while this one plays.
+			cutscenePlayer_prefetchNext();
 					   			
 			// Text Crawl handling
 			if (sceneId == TEXTCRAWL_SCENE)
@@ -270,6 +297,7 @@ namespace TFE_DarkForces
 
 		if (s_scene == SCENE_EXIT)
 		{
+			cutscenePrefetch_cancel();
 			lmusic_stop();
 			lsystem_clearAllocator(LALLOC_CUTSCENE);
 			lsystem_setAllocator(LALLOC_PERSISTENT);
@@ -0,0 +1,133 @@
+#include "cutscene_prefetch.h"
+#include <TFE_Archive/lfdMemoryArchive.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <SDL_thread.h>
+#include <algorithm>
+#include <cstring>
+
+namespace TFE_DarkForces
+{
+	enum PrefetchConstants
+	{
+		PREFETCH_CHUNK_SIZE = 256 * 1024,	// Read in chunks so the read can be cancelled.
+	};
+
+	enum PrefetchState
+	{
+		PREFETCH_NONE = 0,
+		PREFETCH_RUNNING,
+		PREFETCH_READY,
+		PREFETCH_FAILED,
+	};
+
+	static SDL_Thread* s_prefetchThread = nullptr;
+	static char s_prefetchPath[TFE_MAX_PATH] = { 0 };
+	// Staging memory, allocated with malloc() so ownership can be passed to the archive.
+	static u8* s_staging = nullptr;
+	static size_t s_stagingSize = 0;
+	static atomic_s32 s_prefetchState;
+	static atomic_bool s_prefetchCancel;
+
+	static int cutscenePrefetch_thread(void* userData)
+	{
+		TFE_THREAD_NAME("Cutscene Prefetch");
+		FileStream file;
+		if (!file.open(s_prefetchPath, Stream::MODE_READ))
+		{
+			s_prefetchState.store(PREFETCH_FAILED);
+			return 0;
+		}
+
+		const size_t size = file.getSize();
+		u8* staging = (u8*)malloc(size);
+		size_t offset = 0;
+		while (staging && offset < size && !s_prefetchCancel.load())
+		{
+			const u32 readSize = u32(std::min(size - offset, (size_t)PREFETCH_CHUNK_SIZE));
+			if (file.readBuffer(staging + offset, readSize) != readSize) { break; }
+			offset += readSize;
+		}
+		file.close();
+
+		if (staging && offset == size)
+		{
+			s_staging = staging;
+			s_stagingSize = size;
+			s_prefetchState.store(PREFETCH_READY);
+		}
+		else
+		{
+			free(staging);
+			s_prefetchState.store(PREFETCH_FAILED);
+		}
+		return 0;
+	}
+
+	static void cutscenePrefetch_wait()
+	{
+		if (s_prefetchThread)
+		{
+			SDL_WaitThread(s_prefetchThread, nullptr);
+			s_prefetchThread = nullptr;
+		}
+	}
+
+	void cutscenePrefetch_begin(const char* archivePath)
+	{
+		cutscenePrefetch_cancel();
+		if (!archivePath || !archivePath[0]) { return; }
+
+		strcpy(s_prefetchPath, archivePath);
+		s_prefetchCancel.store(false);
+		s_prefetchState.store(PREFETCH_RUNNING);
+		s_prefetchThread = SDL_CreateThread(cutscenePrefetch_thread, "TFE_CutscenePrefetch", nullptr);
+		if (!s_prefetchThread)
+		{
+			TFE_System::logWrite(LOG_WARNING, "CutscenePrefetch", "Cannot create the prefetch thread, '%s' will be loaded when needed.", archivePath);
+			s_prefetchState.store(PREFETCH_NONE);
+			s_prefetchPath[0] = 0;
+		}
+	}
+
+	Archive* cutscenePrefetch_take(const char* archivePath)
+	{
+		if (s_prefetchState.load() == PREFETCH_NONE || strcasecmp(archivePath, s_prefetchPath) != 0)
+		{
+			return nullptr;
+		}
+		// This only blocks if the scene was skipped before the read finished, which then takes less time than reading it again.
+		cutscenePrefetch_wait();
+
+		LfdMemoryArchive* archive = nullptr;
+		if (s_prefetchState.load() == PREFETCH_READY)
+		{
+			archive = new LfdMemoryArchive();
+			// The archive takes ownership of the staging memory.
+			if (!archive->open(s_staging, s_stagingSize, archivePath))
+			{
+				delete archive;
+				archive = nullptr;
+			}
+			s_staging = nullptr;
+			s_stagingSize = 0;
+		}
+		s_prefetchState.store(PREFETCH_NONE);
+		s_prefetchPath[0] = 0;
+		return archive;
+	}
+
+	void cutscenePrefetch_cancel()
+	{
+		s_prefetchCancel.store(true);
+		cutscenePrefetch_wait();
+
+		free(s_staging);
+		s_staging = nullptr;
+		s_stagingSize = 0;
+		s_prefetchState.store(PREFETCH_NONE);
+		s_prefetchPath[0] = 0;
+	}
+}  // TFE_DarkForces
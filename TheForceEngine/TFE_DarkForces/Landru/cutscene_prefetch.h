@@ -0,0 +1,21 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Dark Forces Cutscene Prefetch
+// While a scene plays, the LFD archive of the next scene is read into
+// memory on a worker thread. When that scene starts, its resources are
+// then loaded from memory instead of hitting the disk.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+class Archive;
+
+namespace TFE_DarkForces
+{
+	// Start reading the archive at 'archivePath' (a full path) in the background, replacing any previous prefetch.
+	void cutscenePrefetch_begin(const char* archivePath);
+	// Returns an archive reading from the prefetched data if 'archivePath' was prefetched, otherwise nullptr.
+	// Waits for the read if it is still in progress. The caller owns the archive and deletes it when done.
+	Archive* cutscenePrefetch_take(const char* archivePath);
+	// Stop any prefetch in progress and free the data.
+	void cutscenePrefetch_cancel();
+}  // TFE_DarkForces
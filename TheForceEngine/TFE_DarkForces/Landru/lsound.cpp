@@ -4,6 +4,7 @@
 #include <TFE_A11y/accessibility.h>
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/IMuse/imuse.h>
+#include <TFE_Jedi/Level/levelStaging.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_FileSystem/filestream.h>
 #include <TFE_System/system.h>
@@ -282,6 +283,25 @@ namespace TFE_DarkForces
 
 	u8* readVocFileData(const char* name, u32* sizeOut)
 	{
+		// TFE: Use the copy read ahead of time during level load if there is one.
+		const u8* stagedData;
+		size_t stagedSize;
+		if (levelStaging_get(LASSET_SOUND, name, &stagedData, &stagedSize))
+		{
+			u8* data = (u8*)game_alloc(stagedSize);
+			if (!data)
+			{
+				return nullptr;
+			}
+			memcpy(data, stagedData, stagedSize);
+
+			if (sizeOut)
+			{
+				*sizeOut = u32(stagedSize);
+			}
+			return data;
+		}
+
 		FilePath path;
 		if (strstr(name, ".voc") || strstr(name, ".VOC"))
 		{
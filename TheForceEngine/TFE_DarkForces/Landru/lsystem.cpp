@@ -12,6 +12,7 @@
 #include "lsound.h"
 #include "lview.h"
 #include "ldraw.h"
+#include "cutscene_prefetch.h"
 #include <TFE_Archive/lfdArchive.h>
 #include <TFE_System/system.h>
 #include <TFE_FileSystem/paths.h>
@@ -88,6 +89,7 @@ namespace TFE_DarkForces
 		vfb_forceToBlack();
 
 		s_lsystemInit = JFALSE;
+		cutscenePrefetch_cancel();
 		lcanvas_destroy();
 		lview_destroy();
 		lpalette_destroy();
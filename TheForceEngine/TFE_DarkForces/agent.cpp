@@ -11,6 +11,7 @@
 #include <TFE_System/system.h>
 #include <TFE_System/parser.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <assert.h>
 
 namespace TFE_DarkForces
@@ -142,6 +143,12 @@ namespace TFE_DarkForces
 		}
 	}
 
+	void agent_registerRewindState()
+	{
+		REWIND_STATE(s_levelComplete);
+		REWIND_STATE(s_levelEndTask);
+	}
+
 	s32 agent_loadData()
 	{
 		FileStream file;
@@ -3,6 +3,7 @@
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/InfSystem/message.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 
 using namespace TFE_Jedi;
 
@@ -17,6 +18,12 @@ namespace TFE_DarkForces
 		s_spriteAnimList = spriteAnimAlloc;
 	}
 	
+	void animLogic_registerRewindState()
+	{
+		REWIND_STATE(s_spriteAnimList);
+		REWIND_STATE(s_spriteAnimTask);
+	}
+
 	void spriteAnimLogicCleanupFunc(Logic* logic)
 	{
 		SpriteAnimLogic* animLogic = (SpriteAnimLogic*)logic;
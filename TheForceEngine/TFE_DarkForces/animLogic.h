@@ -37,4 +37,5 @@ namespace TFE_DarkForces
 
 	// Serialization
 	void animLogic_serialize(Logic*& logic, SecObject* obj, Stream* stream);
+	void animLogic_registerRewindState();
 }  // namespace TFE_DarkForces
\ No newline at end of file
@@ -3,20 +3,25 @@
 #include "darkForcesMain.h"
 #include "agent.h"
 #include "automap.h"
+#include "animLogic.h"
 #include "config.h"
 #include "briefingList.h"
 #include "gameMessage.h"
 #include "gameMusic.h"
 #include "hud.h"
+#include "hitEffect.h"
 #include "item.h"
 #include "mission.h"
 #include "player.h"
 #include "pickup.h"
 #include "projectile.h"
+#include "sound.h"
 #include "random.h"
 #include "time.h"
 #include "weapon.h"
+#include "weaponFireFunc.h"
 #include "vueLogic.h"
+#include "updateLogic.h"
 #include "GameUI/menu.h"
 #include "GameUI/agentMenu.h"
 #include "GameUI/escapeMenu.h"
@@ -29,6 +34,7 @@
 #include <TFE_DarkForces/Landru/cutsceneList.h>
 #include <TFE_DarkForces/Actor/actor.h>
 #include <TFE_Game/reticle.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_Input/inputMapping.h>
 #include <TFE_Memory/memoryRegion.h>
 #include <TFE_System/system.h>
@@ -46,6 +52,8 @@
 #include <TFE_Archive/gobMemoryArchive.h>
 #include <TFE_Jedi/Level/rfont.h>
 #include <TFE_Jedi/Level/level.h>
+#include <TFE_Jedi/Level/levelData.h>
+#include <TFE_Jedi/Level/robjData.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
 #include <TFE_Jedi/Task/task.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
@@ -466,6 +474,102 @@ namespace TFE_DarkForces
 		strcpy(modList, s_sharedState.customGobName);
 	}
 
+	u32 DarkForces::getRandomSeed()
+	{
+		return random_getSeed();
+	}
+
+	void DarkForces::setRandomSeed(u32 seed)
+	{
+		random_seed(seed);
+	}
+
+	u32 DarkForces::getGameTick()
+	{
+		return s_curTick;
+	}
+
+	static void rewindFixup(Stream* stream, bool writeState)
+	{
+		if (writeState) { return; }
+		// Sound instances are not part of the snapshot, and the frame time restarts from the restored tick.
+		sound_stopAll();
+		task_updateTime();
+	}
+
+	void DarkForces::registerRewindState()
+	{
+		task_registerRewindState();
+		level_registerRewindState();
+		objData_registerRewindState();
+		inf_registerRewindState();
+
+		time_registerRewindState();
+		random_registerRewindState();
+		mission_registerRewindState();
+		agent_registerRewindState();
+		player_registerRewindState();
+		weapon_registerRewindState();
+		weaponFire_registerRewindState();
+		projectile_registerRewindState();
+		pickup_registerRewindState();
+		hitEffect_registerRewindState();
+		hud_registerRewindState();
+		actor_registerRewindState();
+		animLogic_registerRewindState();
+		updateLogic_registerRewindState();
+		sound_registerRewindState();
+
+		TFE_RewindBuffer::addStateFunc(rewindFixup);
+	}
+
+	// FNV-1a
+	static u32 hashData(u32 hash, const void* data, size_t size)
+	{
+		const u8* bytes = (const u8*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		return hash;
+	}
+
+	// Hash the state that diverges quickly when a replay desyncs: time, the random seed, the player,
+	// sector heights and object positions.
+	u32 DarkForces::getStateHash()
+	{
+		u32 hash = 2166136261u;
+		const u32 seed = random_getSeed();
+		hash = hashData(hash, &s_curTick, sizeof(Tick));
+		hash = hashData(hash, &seed, sizeof(u32));
+		hash = hashData(hash, &s_runGameState.state, sizeof(s_runGameState.state));
+		if (s_runGameState.state != GSTATE_MISSION || !s_levelState.sectors)
+		{
+			return hash;
+		}
+
+		hash = hashData(hash, &s_playerInfo.health, sizeof(s32));
+		hash = hashData(hash, &s_playerInfo.shields, sizeof(s32));
+		RSector* sector = s_levelState.sectors;
+		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		{
+			hash = hashData(hash, &sector->floorHeight, sizeof(fixed16_16));
+			hash = hashData(hash, &sector->ceilingHeight, sizeof(fixed16_16));
+
+			SecObject** objList = sector->objectList;
+			for (s32 o = 0, n = 0; o < sector->objectCapacity && n < sector->objectCount; o++)
+			{
+				SecObject* obj = objList[o];
+				if (!obj) { continue; }
+				n++;
+
+				hash = hashData(hash, &obj->posWS, sizeof(vec3_fixed));
+				hash = hashData(hash, &obj->yaw, sizeof(angle14_32));
+			}
+		}
+		return hash;
+	}
+
 	/**********The basic structure of the Dark Forces main loop is as follows:***************
 	while (1)  // <- This will be replaced by the function call from the main TFE loop.
 	{
@@ -1303,25 +1407,29 @@ namespace TFE_DarkForces
 		SERIALIZE_VERSION(SaveVersionInit);
 	}
 
-	bool DarkForces::serializeGameState(Stream* stream, const char* filename, bool writeState)
+	void DarkForces::saveComplete(const char* filename, bool success)
 	{
-		if (!stream) { return false; }
-		if (writeState && filename)
+		if (!filename) { return; }
+
+		// Write the save message.
+		const char* msg = TFE_System::getMessage(success ? TFE_MSG_SAVE : TFE_MSG_SAVE_FAILED);
+		if (msg)
 		{
-			// Write the save message.
-			const char* msg = TFE_System::getMessage(TFE_MSG_SAVE);
-			if (msg)
-			{
-				char fullMsg[TFE_MAX_PATH];
-				sprintf(fullMsg, "%s [%s]", msg, filename);
-				hud_sendTextMessage(fullMsg, 0);
-			}
+			char fullMsg[TFE_MAX_PATH];
+			sprintf(fullMsg, "%s [%s]", msg, filename);
+			hud_sendTextMessage(fullMsg, 0);
 		}
+	}
+
+	bool DarkForces::serializeGameState(Stream* stream, const char* filename, bool writeState)
+	{
+		if (!stream) { return false; }
 
 		time_pause(JTRUE);
 		if (writeState)
 		{
 			serialization_setMode(SMODE_WRITE);
+			serialization_buildPointerMaps();
 		}
 		else
 		{
@@ -1353,7 +1461,11 @@ namespace TFE_DarkForces
 		}
 
 		time_pause(JFALSE);
-		if (!writeState)
+		if (writeState)
+		{
+			serialization_clearPointerMaps();
+		}
+		else
 		{
 			task_updateTime();
 			mission_pause(JFALSE);
@@ -19,9 +19,15 @@ namespace TFE_DarkForces
 		void loopGame() override;
 		bool serializeGameState(Stream* stream, const char* filename, bool writeState) override;
 		bool canSave() override;
+		void saveComplete(const char* filename, bool success) override;
 		bool isPaused() override;
 		void getLevelName(char* name) override;
 		void getModList(char* modList) override;
+		u32  getRandomSeed() override;
+		void setRandomSeed(u32 seed) override;
+		u32  getStateHash() override;
+		u32  getGameTick() override;
+		void registerRewindState() override;
 	};
 
 	extern void saveLevelStatus();
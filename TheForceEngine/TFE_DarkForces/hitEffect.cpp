@@ -8,6 +8,7 @@
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/robject.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Task/task.h>
 
@@ -52,6 +53,14 @@ namespace TFE_DarkForces
 		s_genExplosion = nullptr;
 	}
 
+	void hitEffect_registerRewindState()
+	{
+		REWIND_STATE(s_hitEffects);
+		REWIND_STATE(s_hitEffectTask);
+		REWIND_STATE(s_explodePos);
+		REWIND_STATE(s_curEffectData);
+	}
+
 	void hitEffect_startup()
 	{
 		// TODO: Move Hit Effect data to an external file instead of hardcoding here.
@@ -9,6 +9,7 @@
 #include "weapon.h"
 #include <TFE_FileSystem/paths.h>
 #include <TFE_System/system.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
@@ -127,6 +128,20 @@ namespace TFE_DarkForces
 	///////////////////////////////////////////
 	// API Implementation
 	///////////////////////////////////////////
+	// The previous values shown on the HUD are left as-is, so the HUD redraws the values that changed.
+	void hud_registerRewindState()
+	{
+		REWIND_STATE(s_hudMessage);
+		REWIND_STATE(s_hudCurrentMsgId);
+		REWIND_STATE(s_hudMsgPriority);
+		REWIND_STATE(s_hudMsgExpireTick);
+		REWIND_STATE(s_flashEffect);
+		REWIND_STATE(s_healthDamageFx);
+		REWIND_STATE(s_shieldDamageFx);
+		REWIND_STATE(s_secretsFound);
+		REWIND_STATE(s_secretsPercent);
+	}
+
 	void hud_sendTextMessage(s32 msgId)
 	{
 		GameMessage* msg = getGameMessage(&s_hudMessages, msgId);
@@ -21,6 +21,7 @@ namespace TFE_DarkForces
 	void hud_loadGameMessages();
 	void hud_loadGraphics();
 	void hud_reset();
+	void hud_registerRewindState();
 
 	void hud_startup(JBool fromSave);
 	void hud_initAnimation();
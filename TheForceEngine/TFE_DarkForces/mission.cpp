@@ -31,6 +31,7 @@
 #include <TFE_Jedi/Renderer/RClassic_Fixed/rclassicFixed.h>
 #include <TFE_RenderShared/texturePacker.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Settings/settings.h>
@@ -288,6 +289,27 @@ namespace TFE_DarkForces
 		setCurrentColorMap(s_levelColorMap, s_levelLightRamp);
 	}
 
+	void mission_rewindFixup(Stream* stream, bool writeState)
+	{
+		if (writeState) { return; }
+		// Rebuild the palette and luminance mask from the restored effect levels.
+		s_lumMaskChanged = JTRUE;
+		s_palModified = JTRUE;
+	}
+
+	void mission_registerRewindState()
+	{
+		REWIND_STATE(s_exitLevel);
+		REWIND_STATE(s_levelEndTask);
+		REWIND_STATE(s_visionFxCountdown);
+		REWIND_STATE(s_visionFxEndCountdown);
+		REWIND_STATE(s_flashFxLevel);
+		REWIND_STATE(s_healthFxLevel);
+		REWIND_STATE(s_shieldFxLevel);
+		REWIND_STATE(s_luminanceMask);
+		TFE_RewindBuffer::addStateFunc(mission_rewindFixup);
+	}
+
 	void mission_serialize(Stream* stream)
 	{
 		SERIALIZE(SaveVersionInit, s_palModified, JTRUE);
@@ -40,6 +40,7 @@ namespace TFE_DarkForces
 	void mission_setupTasks();
 	void mission_serialize(Stream* stream);
 	void mission_serializeColorMap(Stream* stream);
+	void mission_registerRewindState();
 
 	void cheat_revealMap();
 	void cheat_supercharge();
@@ -9,6 +9,7 @@
 #include <TFE_Jedi/Level/levelData.h>
 #include <TFE_Jedi/Task/task.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <cstring>
 
 using namespace TFE_Jedi;
@@ -62,6 +63,18 @@ namespace TFE_DarkForces
 	}
 
 	// TODO: Move keyword to pickup mapping to a datafile to avoid hardcoding.
+	void pickup_registerRewindState()
+	{
+		REWIND_STATE(s_playerDying);
+		REWIND_STATE(s_pickupTask);
+		REWIND_STATE(s_superchargeTask);
+		REWIND_STATE(s_invincibilityTask);
+		REWIND_STATE(s_gasmaskTask);
+		REWIND_STATE(s_gasSectorTask);
+		REWIND_STATE(s_listToFree);
+		REWIND_STATE(s_listToFreeCnt);
+	}
+
 	ItemId getPickupItemId(const char* keyword)
 	{
 		const KEYWORD kw = getKeywordIndex(keyword);
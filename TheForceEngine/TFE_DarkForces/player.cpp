@@ -16,6 +16,7 @@
 #include <TFE_Settings/settings.h>
 #include <TFE_Input/inputMapping.h>
 #include <TFE_Game/igame.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_DarkForces/mission.h>
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/levelData.h>
@@ -319,6 +320,99 @@ namespace TFE_DarkForces
 		initPlayerCollision();
 	}
 
+	// Cheats, settings and the sounds loaded with the level are not part of the rewind state.
+	void player_registerRewindState()
+	{
+		REWIND_STATE(s_externalYawSpd);
+		REWIND_STATE(s_playerPitch);
+		REWIND_STATE(s_playerRoll);
+		REWIND_STATE(s_forwardSpd);
+		REWIND_STATE(s_strafeSpd);
+		REWIND_STATE(s_maxMoveDist);
+		REWIND_STATE(s_playerStopAccel);
+		REWIND_STATE(s_minEyeDistFromFloor);
+		REWIND_STATE(s_postLandVel);
+		REWIND_STATE(s_landUpVel);
+		REWIND_STATE(s_playerVelX);
+		REWIND_STATE(s_playerUpVel);
+		REWIND_STATE(s_playerUpVel2);
+		REWIND_STATE(s_playerVelZ);
+		REWIND_STATE(s_externalVelX);
+		REWIND_STATE(s_externalVelZ);
+		REWIND_STATE(s_playerCrouchSpd);
+		REWIND_STATE(s_playerSpeedAve);
+		REWIND_STATE(s_prevDistFromFloor);
+		REWIND_STATE(s_wpnSin);
+		REWIND_STATE(s_wpnCos);
+		REWIND_STATE(s_moveDirX);
+		REWIND_STATE(s_moveDirZ);
+		REWIND_STATE(s_dist);
+		REWIND_STATE(s_distScale);
+		REWIND_STATE(s_levelAtten);
+		REWIND_STATE(s_curSafe);
+		REWIND_STATE(s_playerUse);
+		REWIND_STATE(s_playerActionUse);
+		REWIND_STATE(s_playerPrimaryFire);
+		REWIND_STATE(s_playerSecFire);
+		REWIND_STATE(s_playerJumping);
+		REWIND_STATE(s_playerInWater);
+		REWIND_STATE(s_crushSoundId);
+		REWIND_STATE(s_kyleScreamSoundId);
+		REWIND_STATE(s_playerPos);
+		REWIND_STATE(s_playerObjHeight);
+		REWIND_STATE(s_playerObjPitch);
+		REWIND_STATE(s_playerObjYaw);
+		REWIND_STATE(s_playerObjSector);
+		REWIND_STATE(s_playerSlideWall);
+		REWIND_STATE(s_playerInfo);
+		REWIND_STATE(s_playerLogic);
+		REWIND_STATE(s_batteryPower);
+		REWIND_STATE(s_lifeCount);
+		REWIND_STATE(s_playerLight);
+		REWIND_STATE(s_headwaveVerticalOffset);
+		REWIND_STATE(s_onFloor);
+		REWIND_STATE(s_weaponLight);
+		REWIND_STATE(s_baseAtten);
+		REWIND_STATE(s_gravityAccel);
+		REWIND_STATE(s_invincibility);
+		REWIND_STATE(s_weaponFiring);
+		REWIND_STATE(s_weaponFiringSec);
+		REWIND_STATE(s_wearingCleats);
+		REWIND_STATE(s_wearingGasmask);
+		REWIND_STATE(s_nightvisionActive);
+		REWIND_STATE(s_headlampActive);
+		REWIND_STATE(s_superCharge);
+		REWIND_STATE(s_superChargeHud);
+		REWIND_STATE(s_playerSecMoved);
+		REWIND_STATE(s_playerSector);
+		REWIND_STATE(s_playerObject);
+		REWIND_STATE(s_playerEye);
+		REWIND_STATE(s_eyePos);
+		REWIND_STATE(s_pitch);
+		REWIND_STATE(s_yaw);
+		REWIND_STATE(s_roll);
+		REWIND_STATE(s_playerEyeFlags);
+		REWIND_STATE(s_playerTick);
+		REWIND_STATE(s_prevPlayerTick);
+		REWIND_STATE(s_nextShieldDmgTick);
+		REWIND_STATE(s_reviveTick);
+		REWIND_STATE(s_nextPainSndTick);
+		REWIND_STATE(s_playerTask);
+		REWIND_STATE(s_playerYPos);
+		REWIND_STATE(s_camOffset);
+		REWIND_STATE(s_camOffsetPitch);
+		REWIND_STATE(s_camOffsetYaw);
+		REWIND_STATE(s_camOffsetRoll);
+		REWIND_STATE(s_playerYaw);
+		REWIND_STATE(s_itemUnknown1);
+		REWIND_STATE(s_itemUnknown2);
+		REWIND_STATE(s_playerHeight);
+		REWIND_STATE(s_playerRun);
+		REWIND_STATE(s_jumpScale);
+		REWIND_STATE(s_playerSlow);
+		REWIND_STATE(s_onMovingSurface);
+	}
+
 	void player_setPitchLimit(PitchLimit limit)
 	{
 		if (limit < PITCH_VANILLA || limit > PITCH_COUNT)
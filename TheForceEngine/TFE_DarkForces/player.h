@@ -138,6 +138,7 @@ namespace TFE_DarkForces
 	extern SoundSourceId s_playerShieldHitSoundSource;
 
 	void player_init();
+	void player_registerRewindState();
 	void player_readInfo(u8* inv, s32* ammo);
 	void player_writeInfo(u8* inv, s32* ammo);
 	void player_clearEyeObject();
@@ -13,6 +13,7 @@
 #include <TFE_Jedi/Level/rwall.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 
 using namespace TFE_Jedi;
 
@@ -146,10 +147,16 @@ namespace TFE_DarkForces
 		s_projReflectOverrideYaw = 0;
 	}
 
+	void projectile_registerRewindState()
+	{
+		REWIND_STATE(s_projectiles);
+		REWIND_STATE(s_projectileTask);
+	}
+
 	void projectile_createTask()
 	{
 		projectile_clearState();
-		s_projectiles = allocator_create(sizeof(ProjectileLogic));
+		s_projectiles = allocator_createSlab(sizeof(ProjectileLogic), 64);
 		s_projectileTask = createSubTask("projectiles", projectileTaskFunc);
 	}
 
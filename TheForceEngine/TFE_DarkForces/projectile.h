@@ -108,6 +108,7 @@ namespace TFE_DarkForces
 	// Startup the projectile system.
 	void projectile_startup();
 	void projectile_createTask();
+	void projectile_registerRewindState();
 
 	// Create a new projectile.
 	Logic* createProjectile(ProjectileType type, RSector* sector, fixed16_16 x, fixed16_16 y, fixed16_16 z, SecObject* obj);
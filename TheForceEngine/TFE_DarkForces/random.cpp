@@ -1,5 +1,6 @@
 #include "random.h"
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 
 namespace TFE_DarkForces
 {
@@ -12,6 +13,11 @@ namespace TFE_DarkForces
 		SERIALIZE(SaveVersionInit, s_seed, 0xf444bb3b);
 	}
 
+	void random_registerRewindState()
+	{
+		REWIND_STATE(s_seed);
+	}
+
 	s32 random_next()
 	{
 		// Shift the seed by 1 (divide by two), and
@@ -47,4 +53,9 @@ namespace TFE_DarkForces
 	{
 		s_seed = seed;
 	}
+
+	u32 random_getSeed()
+	{
+		return s_seed;
+	}
 }  // TFE_DarkForces
\ No newline at end of file
@@ -16,6 +16,8 @@ namespace TFE_DarkForces
 	s32 random(s32 value);
 	s32 random_next();
 	void random_serialize(Stream* stream);
+	void random_registerRewindState();
 
 	void random_seed(u32 seed);
+	u32  random_getSeed();
 }  // namespace TFE_DarkForces
\ No newline at end of file
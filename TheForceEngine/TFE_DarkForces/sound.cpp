@@ -6,6 +6,7 @@
 #include <TFE_DarkForces/Landru/lsound.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_Game/igame.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_Asset/vocAsset.h>
 #include <TFE_Audio/audioSystem.h>
 #include <TFE_Audio/midiPlayer.h>
@@ -65,7 +66,7 @@ namespace TFE_DarkForces
 	void sound_open(MemoryRegion* memRegion)
 	{
 		s_state = {};
-		s_state.gameSoundList = allocator_create(sizeof(GameSound), s_gameRegion);
+		s_state.gameSoundList = allocator_createSlab(sizeof(GameSound), 64, s_gameRegion);
 		ImInitialize(memRegion);
 		
 		TFE_Settings_Sound* sound = TFE_Settings::getSoundSettings();
@@ -84,6 +85,11 @@ namespace TFE_DarkForces
 	}
 
 	// Called at level startup and shutdown.
+	void sound_registerRewindState()
+	{
+		REWIND_STATE(s_state);
+	}
+
 	void sound_levelStart()
 	{
 		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
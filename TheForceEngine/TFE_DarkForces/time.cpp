@@ -1,6 +1,7 @@
 #include "time.h"
 #include <TFE_System/system.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <cstring>
 
 using namespace TFE_Jedi;
@@ -23,6 +24,15 @@ namespace TFE_DarkForces
 		SERIALIZE_BUF(SaveVersionInit, s_frameTicks, sizeof(fixed16_16) * TFE_ARRAYSIZE(s_frameTicks));
 	}
 
+	void time_registerRewindState()
+	{
+		REWIND_STATE(s_curTick);
+		REWIND_STATE(s_prevTick);
+		REWIND_STATE(s_timeAccum);
+		REWIND_STATE(s_deltaTime);
+		REWIND_STATE(s_frameTicks);
+	}
+
 	Tick time_frameRateToDelay(u32 frameRate)
 	{
 		return Tick(SECONDS_TO_TICKS_ROUNDED / f32(frameRate));
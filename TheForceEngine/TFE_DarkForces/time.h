@@ -54,4 +54,5 @@ namespace TFE_DarkForces
 	void time_pause(JBool pause);
 
 	void time_serialize(Stream* stream);
+	void time_registerRewindState();
 }  // namespace TFE_DarkForces
\ No newline at end of file
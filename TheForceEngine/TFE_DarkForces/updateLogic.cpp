@@ -7,6 +7,7 @@
 #include <TFE_Jedi/InfSystem/infSystem.h>
 #include <TFE_Jedi/Collision/collision.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 
 using namespace TFE_Jedi;
 
@@ -47,6 +48,12 @@ namespace TFE_DarkForces
 		s_logicUpdateTask = nullptr;
 	}
 
+	void updateLogic_registerRewindState()
+	{
+		REWIND_STATE(s_logicUpdateTask);
+		REWIND_STATE(s_logicUpdateList);
+	}
+
 	JBool updateLogic_setupFunc(Logic* logic, KEYWORD key)
 	{
 		UpdateLogic* updateLogic = (UpdateLogic*)logic;
@@ -18,4 +18,5 @@ namespace TFE_DarkForces
 
 	// Serialization
 	void updateLogic_serialize(Logic*& logic, SecObject* obj, Stream* stream);
+	void updateLogic_registerRewindState();
 }  // namespace TFE_DarkForces
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 #include <TFE_Jedi/Renderer/screenDraw.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 
 namespace TFE_DarkForces
 {
@@ -165,6 +166,32 @@ namespace TFE_DarkForces
 		}
 	}
 
+	void weapon_registerRewindState()
+	{
+		REWIND_STATE(s_switchWeapons);
+		REWIND_STATE(s_queWeaponSwitch);
+		REWIND_STATE(s_playerWeaponList);
+		REWIND_STATE(s_weaponDelayPrimary);
+		REWIND_STATE(s_weaponDelaySeconary);
+		REWIND_STATE(s_canFirePrimPtr);
+		REWIND_STATE(s_canFireSecPtr);
+		REWIND_STATE(s_weaponAnimState);
+		REWIND_STATE(s_prevWeapon);
+		REWIND_STATE(s_curWeapon);
+		REWIND_STATE(s_nextWeapon);
+		REWIND_STATE(s_lastWeapon);
+		REWIND_STATE(s_weaponAutoMount2);
+		REWIND_STATE(s_secondaryFire);
+		REWIND_STATE(s_weaponOffAnim);
+		REWIND_STATE(s_isShooting);
+		REWIND_STATE(s_canFireWeaponSec);
+		REWIND_STATE(s_canFireWeaponPrim);
+		REWIND_STATE(s_fireFrame);
+		REWIND_STATE(s_repeaterFireSndID);
+		REWIND_STATE(s_curPlayerWeapon);
+		REWIND_STATE(s_playerWeaponTask);
+	}
+
 	void weapon_startup()
 	{
 		// TODO: Move this into data instead of hard coding it like vanilla Dark Forces.
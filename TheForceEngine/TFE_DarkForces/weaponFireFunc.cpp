@@ -9,6 +9,7 @@
 #include <TFE_Jedi/Renderer/jediRenderer.h>
 // TFE
 #include <TFE_Settings/settings.h>
+#include <TFE_Game/rewindBuffer.h>
 
 namespace TFE_DarkForces
 {
@@ -143,6 +144,12 @@ namespace TFE_DarkForces
 
 	// Adjust the speed - in TFE the framerate may be higher than expected by the original code, which means that this
 	// step (proj->delta) is too large for the 'speed'.
+	void weaponFire_registerRewindState()
+	{
+		REWIND_STATE(s_fusionCylinder);
+		REWIND_STATE(s_fusionCycleForward);
+	}
+
 	void tfe_adjustWeaponCollisionSpeed(ProjectileLogic* proj)
 	{
 		fixed16_16 initSpeed = div16(vec3Length(proj->delta.x, proj->delta.y, proj->delta.z), max(1, s_deltaTime));
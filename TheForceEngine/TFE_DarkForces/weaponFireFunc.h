@@ -20,4 +20,6 @@ namespace TFE_DarkForces
 	void weaponFire_mine(MessageType msg);
 	void weaponFire_concussion(MessageType msg);
 	void weaponFire_cannon(MessageType msg);
+
+	void weaponFire_registerRewindState();
 }  // namespace TFE_DarkForces
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "groups.h"
 #include "sharedState.h"
 #include "selection.h"
+#include "sectorBvh.h"
 #include <TFE_Input/input.h>
 #include <TFE_Editor/editor.h>
 #include <TFE_Editor/errorMessages.h>
@@ -291,6 +292,14 @@ namespace LevelEditor
 		ImGui::Text("Bounds: (%0.3f, %0.3f, %0.3f)\n        (%0.3f, %0.3f, %0.3f)", s_level.bounds[0].x, s_level.bounds[0].y, s_level.bounds[0].z,
 			s_level.bounds[1].x, s_level.bounds[1].y, s_level.bounds[1].z);
 		ImGui::Text("Layer Range: [%d, %d]", s_level.layerRange[0], s_level.layerRange[1]);
+
+		HistoryMemory historyMem;
+		history_getMemoryUsage(&historyMem);
+		const f32 toMb = 1.0f / (1024.0f * 1024.0f);
+		ImGui::Text("Undo History: %u entries, %u snapshots, %0.2f MB", historyMem.entryCount, historyMem.snapshotCount,
+			f32(historyMem.commandBytes + historyMem.snapshotBytes + historyMem.cacheBytes) * toMb);
+		ImGui::Text("        Snapshots %0.2f MB (%0.2f MB uncompressed), cache %0.2f MB", f32(historyMem.snapshotBytes) * toMb,
+			f32(historyMem.uncompressedBytes) * toMb, f32(historyMem.cacheBytes) * toMb);
 		ImGui::LabelText("##GridLabel", "Grid Height");
 		ImGui::SameLine(128.0f);
 		ImGui::SetNextItemWidth(196.0f);
@@ -938,6 +947,8 @@ namespace LevelEditor
 		sector->ambient = std::max(0, std::min(31, ambient));
 
 		// Heights
+		const f32 prevFloorHeight = sector->floorHeight;
+		const f32 prevCeilHeight = sector->ceilHeight;
 		infoLabel("##FloorHeightLabel", "Floor Ht", 66);
 		infoFloatInput("##FloorHeight", 64, &sector->floorHeight);
 		ImGui::SameLine();
@@ -948,6 +959,12 @@ namespace LevelEditor
 
 		infoLabel("##CeilHeightLabel", "Ceiling Ht", 80);
 		infoFloatInput("##CeilHeight", 64, &sector->ceilHeight);
+		if (sector->floorHeight != prevFloorHeight || sector->ceilHeight != prevCeilHeight)
+		{
+			sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
+			sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+			sectorBvh_markDirty(sector->id);
+		}
 
 		ImGui::Separator();
 
@@ -1161,6 +1178,8 @@ namespace LevelEditor
 				break;
 			}
 		}
+		// The object bounds depend on the entity.
+		sectorBvh_markDirty(sector->id);
 		if (entityIndex >= 0)
 		{
 			obj->entityId = entityIndex;
@@ -1390,7 +1409,10 @@ namespace LevelEditor
 		ImGui::Separator();
 
 		ImGui::Text("%s", "Position"); ImGui::SameLine(0.0f, 8.0f);
-		ImGui::InputFloat3("##Position", &obj->pos.x);
+		if (ImGui::InputFloat3("##Position", &obj->pos.x))
+		{
+			sectorBvh_markDirty(sector->id);
+		}
 
 		bool orientAdjusted = false;
 		ImGui::Text("%s", "Angle"); ImGui::SameLine(0.0f, 32.0f);
@@ -10,6 +10,7 @@
 #include "camera.h"
 #include "error.h"
 #include "sharedState.h"
+#include "sectorBvh.h"
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_Editor/AssetBrowser/assetBrowser.h>
 #include <TFE_Asset/imageAsset.h>
@@ -1416,6 +1417,7 @@ namespace LevelEditor
 			// Get the ID and then erase it from the level.
 			s32 delId = sector->id;
 			s_level.sectors.erase(s_level.sectors.begin() + delId);
+			sectorBvh_invalidate();
 
 			// Update Sector IDs
 			const s32 levSectorCount = (s32)s_level.sectors.size();
@@ -1682,6 +1684,7 @@ namespace LevelEditor
 
 		// Then erase the sector.
 		s_level.sectors.erase(s_level.sectors.begin() + sectorId);
+		sectorBvh_invalidate();
 
 		// Finally fix-up any references.
 		sectorCount = (s32)s_level.sectors.size();
@@ -4163,6 +4166,7 @@ namespace LevelEditor
 		obj.transform.m1.y = 1.0f;
 		obj.transform.m2.z = 1.0f;
 		sector->obj.push_back(obj);
+		sectorBvh_markDirty(sector->id);
 	}
 
 	void deleteObject(EditorSector* sector, s32 index)
@@ -4174,6 +4178,7 @@ namespace LevelEditor
 			sector->obj[i] = sector->obj[i + 1];
 		}
 		sector->obj.pop_back();
+		sectorBvh_markDirty(sector->id);
 	}
 
 	bool pointInsideOBB2d(const Vec2f pt, const Vec3f* bounds, const Vec3f* pos, const Mat3* mtx)
@@ -4414,6 +4419,7 @@ namespace LevelEditor
 					obj = &s_featureCur.sector->obj[s_featureCur.featureIndex];
 					obj->pos.y = max(s_featureCur.sector->floorHeight, obj->pos.y);
 					obj->pos.y = min(s_featureCur.sector->ceilHeight,  obj->pos.y);
+					sectorBvh_markDirty(s_featureCur.sector->id);
 				}
 			}
 			else
@@ -6424,6 +6430,7 @@ namespace LevelEditor
 			EditorSector* sector = sectorList[i];
 			sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
 			sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+			sectorBvh_markDirty(sector->id);
 		}
 	}
 		
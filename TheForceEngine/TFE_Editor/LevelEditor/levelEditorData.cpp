@@ -4,6 +4,7 @@
 #include "error.h"
 #include "shell.h"
 #include "levelEditorInf.h"
+#include "sectorBvh.h"
 #include <TFE_Editor/history.h>
 #include <TFE_Editor/errorMessages.h>
 #include <TFE_Editor/editorConfig.h>
@@ -65,6 +66,7 @@ namespace LevelEditor
 	static EditorLevel s_curSnapshot;
 	static SnapshotBuffer* s_buffer = nullptr;
 	static const u8* s_readBuffer;
+	static std::vector<s32> s_sectorQuery;
 
 	EditorLevel s_level = {};
 
@@ -476,6 +478,7 @@ namespace LevelEditor
 		EditorLevel* level = &s_level;
 		char slotName[256];
 		FileUtil::stripExtension(asset->name.c_str(), slotName);
+		sectorBvh_invalidate();
 
 		// Clear the INF data.
 		s_levelInf.elevator.clear();
@@ -1792,6 +1795,7 @@ namespace LevelEditor
 		sector->bounds[1] = { poly.bounds[1].x, 0.0f, poly.bounds[1].z };
 		sector->bounds[0].y = min(sector->floorHeight, sector->ceilHeight);
 		sector->bounds[1].y = max(sector->floorHeight, sector->ceilHeight);
+		sectorBvh_markDirty(sector->id);
 	}
 
 	// Update the sector itself from the sector's polygon.
@@ -1820,11 +1824,14 @@ namespace LevelEditor
 	{
 		if (s_level.sectors.empty()) { return -1; }
 
-		const s32 sectorCount = (s32)s_level.sectors.size();
+		const Vec3f pos3d = { pos->x, 0.0f, pos->z };
+		sectorBvh_pointQuery(&pos3d, true, &s_sectorQuery);
+		const s32 candidateCount = (s32)s_sectorQuery.size();
 		EditorSector* sectors = s_level.sectors.data();
 
-		for (s32 i = 0; i < sectorCount; i++)
+		for (s32 c = 0; c < candidateCount; c++)
 		{
+			const s32 i = s_sectorQuery[c];
 			if (sectors[i].layer != layer) { continue; }
 			if (TFE_Polygon::pointInsidePolygon(&sectors[i].poly, *pos))
 			{
@@ -2028,8 +2035,6 @@ namespace LevelEditor
 	{
 		EditorLevel* level = &s_level;
 		if (level->sectors.empty()) { return false; }
-		const s32 sectorCount = (s32)level->sectors.size();
-		EditorSector* sector = level->sectors.data();
 
 		f32 maxDist  = ray->maxDist;
 		Vec3f origin = ray->origin;
@@ -2045,17 +2050,18 @@ namespace LevelEditor
 		hitInfo->hitPos = { 0 };
 		hitInfo->dist = FLT_MAX;
 
-		// Loop through sectors in the world.
-		for (s32 s = 0; s < sectorCount; s++, sector++)
+		// Loop through the sectors whose bounds the ray passes through.
+		// Objects are tested when the ray crosses the sector walls at any height, so only the XZ bounds can be used in that case.
+		sectorBvh_rayQuery(ray, canHitObjects, &s_sectorQuery);
+		const s32 candidateCount = (s32)s_sectorQuery.size();
+		for (s32 c = 0; c < candidateCount; c++)
 		{
+			EditorSector* sector = &level->sectors[s_sectorQuery[c]];
 			if (ray->layer != LAYER_ANY && ray->layer != sector->layer) { continue; }
 
 			// Make sure the sector is in a visible/unlocked group.
 			if (!sector_isInteractable(sector)) { continue; }
 
-			// Check the bounds.
-			//if (!rayHitAABB(ray, sector->bounds)) { continue; }
-
 			// Now check against the walls.
 			const u32 wallCount = (u32)sector->walls.size();
 			const EditorWall* wall = sector->walls.data();
@@ -2333,16 +2339,16 @@ namespace LevelEditor
 		return true;
 	}
 
-	// TODO: Spatial data structure to handle cases where there are 10k, 100k, etc. sectors.
 	bool getOverlappingSectorsPt(const Vec3f* pos, SectorList* result)
 	{
 		if (!pos || !result) { return false; }
 
 		result->clear();
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < count; i++, sector++)
+		sectorBvh_pointQuery(pos, false, &s_sectorQuery);
+		const s32 count = (s32)s_sectorQuery.size();
+		for (s32 i = 0; i < count; i++)
 		{
+			EditorSector* sector = &s_level.sectors[s_sectorQuery[i]];
 			if (pos->x < sector->bounds[0].x || pos->x > sector->bounds[1].x ||
 				pos->y < sector->bounds[0].y || pos->y > sector->bounds[1].y ||
 				pos->z < sector->bounds[0].z || pos->z > sector->bounds[1].z)
@@ -2360,10 +2366,11 @@ namespace LevelEditor
 		if (!bounds || !result) { return false; }
 
 		result->clear();
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < count; i++, sector++)
+		sectorBvh_boundsQuery(bounds, &s_sectorQuery);
+		const s32 count = (s32)s_sectorQuery.size();
+		for (s32 i = 0; i < count; i++)
 		{
+			EditorSector* sector = &s_level.sectors[s_sectorQuery[i]];
 			if (aabbOverlap3d(sector->bounds, bounds))
 			{
 				result->push_back(sector);
@@ -2581,6 +2588,7 @@ namespace LevelEditor
 		}
 		// Then copy the snapshot to the level data itself. Its the new state.
 		s_level = s_curSnapshot;
+		sectorBvh_invalidate();
 
 		// For now until the way snapshot memory is handled is refactored, to avoid duplicate code that will be removed later.
 		// TODO: Handle edit state properly here too.
@@ -9,6 +9,7 @@
 #include "camera.h"
 #include "error.h"
 #include "sharedState.h"
+#include "sectorBvh.h"
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_Editor/AssetBrowser/assetBrowser.h>
 #include <TFE_Asset/imageAsset.h>
@@ -5400,6 +5401,13 @@ namespace LevelEditor
 				}
 			} break;
 		}
+
+		// Floor and ceiling heights may have changed.
+		sectorBvh_markDirty(sector->id);
+		for (s32 m = 0; m < mirrorCount; m++)
+		{
+			sectorBvh_markDirty(s_sectorMod.mirrorState[m].id);
+		}
 	}
 
 	bool elevHasAutogeneratedStops(Editor_InfElevator* elev)
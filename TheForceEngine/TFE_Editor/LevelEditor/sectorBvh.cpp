@@ -0,0 +1,463 @@
+#include "sectorBvh.h"
+#include "sharedState.h"
+#include <TFE_System/system.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace LevelEditor
+{
+	struct BvhNode
+	{
+		Vec3f bounds[2];
+		s32 parent;
+		s32 child[2];
+		s32 sectorId;	// -1 for internal nodes.
+	};
+
+	// Leaves are padded slightly so the query tolerances used by the callers are always covered.
+	static const f32 c_leafMargin = 0.01f;
+
+	static std::vector<BvhNode> s_nodes;
+	static std::vector<s32> s_freeNodes;
+	static std::vector<s32> s_leaves;	// sector ID -> leaf node.
+	static std::vector<s32> s_dirty;
+	static std::vector<s32> s_stack;
+	static std::vector<s32> s_buildIds;
+	static s32 s_root = -1;
+	static bool s_valid = false;
+
+	void sectorBvh_update();
+	void mergeBounds(const Vec3f* a, const Vec3f* b, Vec3f* result);
+
+	/////////////////////////////////////////////
+	// API
+	/////////////////////////////////////////////
+	void sectorBvh_invalidate()
+	{
+		s_valid = false;
+		s_dirty.clear();
+	}
+
+	void sectorBvh_markDirty(s32 sectorId)
+	{
+		// New sectors are picked up on the next update anyway.
+		if (!s_valid || sectorId < 0 || sectorId >= (s32)s_leaves.size()) { return; }
+		s_dirty.push_back(sectorId);
+	}
+
+	bool rayOverlapsBounds(const Ray* ray, const Vec3f* bounds, bool ignoreHeight)
+	{
+		f32 tmin = 0.0f;
+		f32 tmax = ray->maxDist;
+		for (s32 i = 0; i < 3; i++)
+		{
+			if (ignoreHeight && i == 1) { continue; }
+
+			const f32 o = ray->origin.m[i];
+			const f32 d = ray->dir.m[i];
+			if (fabsf(d) < FLT_EPSILON)
+			{
+				if (o < bounds[0].m[i] || o > bounds[1].m[i]) { return false; }
+				continue;
+			}
+
+			const f32 invD = 1.0f / d;
+			f32 t0 = (bounds[0].m[i] - o) * invD;
+			f32 t1 = (bounds[1].m[i] - o) * invD;
+			if (t0 > t1) { std::swap(t0, t1); }
+			tmin = std::max(tmin, t0);
+			tmax = std::min(tmax, t1);
+			if (tmin > tmax) { return false; }
+		}
+		return true;
+	}
+
+	bool pointInsideBounds(const Vec3f* pos, const Vec3f* bounds, bool ignoreHeight)
+	{
+		return pos->x >= bounds[0].x && pos->x <= bounds[1].x && pos->z >= bounds[0].z && pos->z <= bounds[1].z &&
+			(ignoreHeight || (pos->y >= bounds[0].y && pos->y <= bounds[1].y));
+	}
+
+	void sectorBvh_rayQuery(const Ray* ray, bool ignoreHeight, std::vector<s32>* result)
+	{
+		result->clear();
+		sectorBvh_update();
+		if (s_root < 0) { return; }
+
+		s_stack.clear();
+		s_stack.push_back(s_root);
+		while (!s_stack.empty())
+		{
+			const BvhNode* node = &s_nodes[s_stack.back()];
+			s_stack.pop_back();
+			if (!rayOverlapsBounds(ray, node->bounds, ignoreHeight)) { continue; }
+
+			if (node->sectorId >= 0)
+			{
+				result->push_back(node->sectorId);
+			}
+			else
+			{
+				s_stack.push_back(node->child[0]);
+				s_stack.push_back(node->child[1]);
+			}
+		}
+		// Keep the sector order, so ties are resolved the same way as a linear search.
+		std::sort(result->begin(), result->end());
+	}
+
+	void sectorBvh_pointQuery(const Vec3f* pos, bool ignoreHeight, std::vector<s32>* result)
+	{
+		result->clear();
+		sectorBvh_update();
+		if (s_root < 0) { return; }
+
+		s_stack.clear();
+		s_stack.push_back(s_root);
+		while (!s_stack.empty())
+		{
+			const BvhNode* node = &s_nodes[s_stack.back()];
+			s_stack.pop_back();
+			if (!pointInsideBounds(pos, node->bounds, ignoreHeight)) { continue; }
+
+			if (node->sectorId >= 0)
+			{
+				result->push_back(node->sectorId);
+			}
+			else
+			{
+				s_stack.push_back(node->child[0]);
+				s_stack.push_back(node->child[1]);
+			}
+		}
+		std::sort(result->begin(), result->end());
+	}
+
+	void sectorBvh_boundsQuery(const Vec3f bounds[2], std::vector<s32>* result)
+	{
+		result->clear();
+		sectorBvh_update();
+		if (s_root < 0) { return; }
+
+		s_stack.clear();
+		s_stack.push_back(s_root);
+		while (!s_stack.empty())
+		{
+			const BvhNode* node = &s_nodes[s_stack.back()];
+			s_stack.pop_back();
+			if (!aabbOverlap3d(node->bounds, bounds)) { continue; }
+
+			if (node->sectorId >= 0)
+			{
+				result->push_back(node->sectorId);
+			}
+			else
+			{
+				s_stack.push_back(node->child[0]);
+				s_stack.push_back(node->child[1]);
+			}
+		}
+		std::sort(result->begin(), result->end());
+	}
+
+	/////////////////////////////////////////////
+	// Internal
+	/////////////////////////////////////////////
+	void computeSectorBounds(const EditorSector* sector, Vec3f* bounds)
+	{
+		// Include the cached sector bounds as well, so queries that test against them are never culled.
+		bounds[0] = sector->bounds[0];
+		bounds[1] = sector->bounds[1];
+		bounds[0].y = std::min(bounds[0].y, std::min(sector->floorHeight, sector->ceilHeight));
+		bounds[1].y = std::max(bounds[1].y, std::max(sector->floorHeight, sector->ceilHeight));
+
+		const size_t vtxCount = sector->vtx.size();
+		const Vec2f* vtx = sector->vtx.data();
+		for (size_t v = 0; v < vtxCount; v++, vtx++)
+		{
+			bounds[0].x = std::min(bounds[0].x, vtx->x);
+			bounds[0].z = std::min(bounds[0].z, vtx->z);
+			bounds[1].x = std::max(bounds[1].x, vtx->x);
+			bounds[1].z = std::max(bounds[1].z, vtx->z);
+		}
+
+		// Objects may extend past the sector walls, so include them to avoid culling them from picking.
+		const s32 entityCount = (s32)s_level.entities.size();
+		const size_t objCount = sector->obj.size();
+		const EditorObject* obj = sector->obj.data();
+		for (size_t o = 0; o < objCount; o++, obj++)
+		{
+			if (obj->entityId < 0 || obj->entityId >= entityCount) { continue; }
+			const Entity* entity = &s_level.entities[obj->entityId];
+
+			Vec3f objBounds[2];
+			if (entity->type == ETYPE_3D && entity->obj3d)
+			{
+				// Any orientation of the model bounds fits in a sphere around the origin.
+				const Vec3f* modelBounds = entity->obj3d->bounds;
+				const Vec3f ext = { std::max(fabsf(modelBounds[0].x), fabsf(modelBounds[1].x)), std::max(fabsf(modelBounds[0].y), fabsf(modelBounds[1].y)),
+					std::max(fabsf(modelBounds[0].z), fabsf(modelBounds[1].z)) };
+				const f32 radius = sqrtf(ext.x*ext.x + ext.y*ext.y + ext.z*ext.z);
+				objBounds[0] = { obj->pos.x - radius, obj->pos.y - radius, obj->pos.z - radius };
+				objBounds[1] = { obj->pos.x + radius, obj->pos.y + radius, obj->pos.z + radius };
+			}
+			else
+			{
+				// Sprites may be offset vertically when picked, see traceRay().
+				const f32 width = entity->size.x * 0.5f;
+				const f32 height = entity->size.z;
+				const f32 offset = fabsf((entity->offset.y + fabsf(entity->st[1].z - entity->st[0].z)) * 0.1f);
+				objBounds[0] = { obj->pos.x - width, obj->pos.y - offset, obj->pos.z - width };
+				objBounds[1] = { obj->pos.x + width, obj->pos.y + height + offset, obj->pos.z + width };
+			}
+			mergeBounds(bounds, objBounds, bounds);
+		}
+
+		bounds[0] = { bounds[0].x - c_leafMargin, bounds[0].y - c_leafMargin, bounds[0].z - c_leafMargin };
+		bounds[1] = { bounds[1].x + c_leafMargin, bounds[1].y + c_leafMargin, bounds[1].z + c_leafMargin };
+	}
+
+	void mergeBounds(const Vec3f* a, const Vec3f* b, Vec3f* result)
+	{
+		result[0] = { std::min(a[0].x, b[0].x), std::min(a[0].y, b[0].y), std::min(a[0].z, b[0].z) };
+		result[1] = { std::max(a[1].x, b[1].x), std::max(a[1].y, b[1].y), std::max(a[1].z, b[1].z) };
+	}
+
+	f32 surfaceArea(const Vec3f* bounds)
+	{
+		const f32 dx = bounds[1].x - bounds[0].x;
+		const f32 dy = bounds[1].y - bounds[0].y;
+		const f32 dz = bounds[1].z - bounds[0].z;
+		return 2.0f * (dx*dy + dy*dz + dz*dx);
+	}
+
+	s32 allocNode()
+	{
+		s32 index;
+		if (!s_freeNodes.empty())
+		{
+			index = s_freeNodes.back();
+			s_freeNodes.pop_back();
+		}
+		else
+		{
+			index = (s32)s_nodes.size();
+			s_nodes.push_back({});
+		}
+		BvhNode* node = &s_nodes[index];
+		node->parent = -1;
+		node->child[0] = -1;
+		node->child[1] = -1;
+		node->sectorId = -1;
+		return index;
+	}
+
+	void refitAncestors(s32 index)
+	{
+		while (index >= 0)
+		{
+			BvhNode* node = &s_nodes[index];
+			mergeBounds(s_nodes[node->child[0]].bounds, s_nodes[node->child[1]].bounds, node->bounds);
+			index = node->parent;
+		}
+	}
+
+	// Insert a leaf next to the sibling with the lowest surface area cost.
+	void insertLeaf(s32 leaf)
+	{
+		if (s_root < 0)
+		{
+			s_root = leaf;
+			s_nodes[leaf].parent = -1;
+			return;
+		}
+
+		const Vec3f* leafBounds = s_nodes[leaf].bounds;
+		s32 index = s_root;
+		while (s_nodes[index].sectorId < 0)
+		{
+			const BvhNode* node = &s_nodes[index];
+			Vec3f combined[2];
+			mergeBounds(node->bounds, leafBounds, combined);
+			const f32 area = surfaceArea(node->bounds);
+			const f32 combinedArea = surfaceArea(combined);
+
+			// Cost of creating a new parent for this node and the new leaf.
+			const f32 cost = 2.0f * combinedArea;
+			// Minimum cost of pushing the leaf further down the tree.
+			const f32 inheritanceCost = 2.0f * (combinedArea - area);
+
+			f32 childCost[2];
+			for (s32 c = 0; c < 2; c++)
+			{
+				const BvhNode* child = &s_nodes[node->child[c]];
+				Vec3f childCombined[2];
+				mergeBounds(child->bounds, leafBounds, childCombined);
+				childCost[c] = surfaceArea(childCombined) + inheritanceCost;
+				if (child->sectorId < 0)
+				{
+					childCost[c] -= surfaceArea(child->bounds);
+				}
+			}
+
+			if (cost < childCost[0] && cost < childCost[1]) { break; }
+			index = childCost[0] < childCost[1] ? node->child[0] : node->child[1];
+		}
+
+		const s32 sibling = index;
+		const s32 oldParent = s_nodes[sibling].parent;
+		const s32 newParent = allocNode();
+		BvhNode* parent = &s_nodes[newParent];
+		parent->parent = oldParent;
+		parent->child[0] = sibling;
+		parent->child[1] = leaf;
+		s_nodes[sibling].parent = newParent;
+		s_nodes[leaf].parent = newParent;
+
+		if (oldParent >= 0)
+		{
+			BvhNode* grandParent = &s_nodes[oldParent];
+			grandParent->child[grandParent->child[0] == sibling ? 0 : 1] = newParent;
+		}
+		else
+		{
+			s_root = newParent;
+		}
+		refitAncestors(newParent);
+	}
+
+	void removeLeaf(s32 leaf)
+	{
+		if (leaf == s_root)
+		{
+			s_root = -1;
+			return;
+		}
+
+		const s32 parent = s_nodes[leaf].parent;
+		const s32 grandParent = s_nodes[parent].parent;
+		const s32 sibling = s_nodes[parent].child[0] == leaf ? s_nodes[parent].child[1] : s_nodes[parent].child[0];
+		if (grandParent >= 0)
+		{
+			BvhNode* node = &s_nodes[grandParent];
+			node->child[node->child[0] == parent ? 0 : 1] = sibling;
+			s_nodes[sibling].parent = grandParent;
+			refitAncestors(grandParent);
+		}
+		else
+		{
+			s_root = sibling;
+			s_nodes[sibling].parent = -1;
+		}
+		s_freeNodes.push_back(parent);
+		s_nodes[leaf].parent = -1;
+	}
+
+	// Top-down build, splitting at the median sector center along the longest axis.
+	s32 buildNode(s32* ids, s32 count, s32 parent)
+	{
+		if (count == 1)
+		{
+			const s32 leaf = s_leaves[ids[0]];
+			s_nodes[leaf].parent = parent;
+			return leaf;
+		}
+
+		Vec3f centerBounds[2] = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+		for (s32 i = 0; i < count; i++)
+		{
+			const Vec3f* bounds = s_nodes[s_leaves[ids[i]]].bounds;
+			const Vec3f center = { (bounds[0].x + bounds[1].x) * 0.5f, (bounds[0].y + bounds[1].y) * 0.5f, (bounds[0].z + bounds[1].z) * 0.5f };
+			const Vec3f centerExt[2] = { center, center };
+			mergeBounds(centerBounds, centerExt, centerBounds);
+		}
+		s32 axis = 0;
+		const Vec3f size = { centerBounds[1].x - centerBounds[0].x, centerBounds[1].y - centerBounds[0].y, centerBounds[1].z - centerBounds[0].z };
+		if (size.y > size.m[axis]) { axis = 1; }
+		if (size.z > size.m[axis]) { axis = 2; }
+
+		const s32 half = count / 2;
+		std::nth_element(ids, ids + half, ids + count, [axis](s32 a, s32 b)
+		{
+			const Vec3f* boundsA = s_nodes[s_leaves[a]].bounds;
+			const Vec3f* boundsB = s_nodes[s_leaves[b]].bounds;
+			return boundsA[0].m[axis] + boundsA[1].m[axis] < boundsB[0].m[axis] + boundsB[1].m[axis];
+		});
+
+		const s32 index = allocNode();
+		s_nodes[index].parent = parent;
+		const s32 child0 = buildNode(ids, half, index);
+		const s32 child1 = buildNode(ids + half, count - half, index);
+		BvhNode* node = &s_nodes[index];
+		node->child[0] = child0;
+		node->child[1] = child1;
+		mergeBounds(s_nodes[child0].bounds, s_nodes[child1].bounds, node->bounds);
+		return index;
+	}
+
+	s32 createLeaf(s32 sectorId)
+	{
+		const s32 leaf = allocNode();
+		s_nodes[leaf].sectorId = sectorId;
+		computeSectorBounds(&s_level.sectors[sectorId], s_nodes[leaf].bounds);
+		return leaf;
+	}
+
+	void buildTree()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		s_nodes.clear();
+		s_nodes.reserve(size_t(sectorCount) * 2);
+		s_freeNodes.clear();
+		s_leaves.resize(sectorCount);
+		s_buildIds.resize(sectorCount);
+		for (s32 s = 0; s < sectorCount; s++)
+		{
+			s_leaves[s] = createLeaf(s);
+			s_buildIds[s] = s;
+		}
+		s_root = sectorCount ? buildNode(s_buildIds.data(), sectorCount, -1) : -1;
+	}
+
+	void sectorBvh_update()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		if (!s_valid || sectorCount < (s32)s_leaves.size())
+		{
+			buildTree();
+			s_dirty.clear();
+			s_valid = true;
+			return;
+		}
+
+		// Reinsert changed sectors, which refits the nodes along the way.
+		if (!s_dirty.empty())
+		{
+			std::sort(s_dirty.begin(), s_dirty.end());
+			s_dirty.erase(std::unique(s_dirty.begin(), s_dirty.end()), s_dirty.end());
+			const size_t dirtyCount = s_dirty.size();
+			for (size_t i = 0; i < dirtyCount; i++)
+			{
+				const s32 leaf = s_leaves[s_dirty[i]];
+				Vec3f bounds[2];
+				computeSectorBounds(&s_level.sectors[s_dirty[i]], bounds);
+				if (memcmp(bounds, s_nodes[leaf].bounds, sizeof(Vec3f) * 2) == 0) { continue; }
+
+				removeLeaf(leaf);
+				s_nodes[leaf].bounds[0] = bounds[0];
+				s_nodes[leaf].bounds[1] = bounds[1];
+				insertLeaf(leaf);
+			}
+			s_dirty.clear();
+		}
+
+		// New sectors are always added to the end.
+		for (s32 s = (s32)s_leaves.size(); s < sectorCount; s++)
+		{
+			s_leaves.push_back(createLeaf(s));
+			insertLeaf(s_leaves.back());
+		}
+	}
+}
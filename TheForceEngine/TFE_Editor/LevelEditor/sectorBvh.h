@@ -0,0 +1,34 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Editor
+// A dynamic bounding volume hierarchy over the level sectors, used to
+// accelerate ray, point and box queries.
+//
+// Each leaf holds one sector, bounding its vertices and floor/ceiling
+// heights (and so all of its walls) as well as its objects. When sector
+// geometry or objects change the sector is marked dirty; before the
+// next query each dirty leaf whose bounds changed is removed and
+// reinserted. Adding sectors inserts new leaves, while removing
+// sectors (which changes sector IDs), loading a level and undo/redo
+// (which replace the level with a snapshot) rebuild the tree.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "levelEditorData.h"
+#include <vector>
+
+namespace LevelEditor
+{
+	// Rebuild the tree before the next query.
+	void sectorBvh_invalidate();
+	// The geometry, heights or objects of a sector changed.
+	void sectorBvh_markDirty(s32 sectorId);
+
+	// Queries, the results are sector IDs in ascending order.
+	// Get the sectors whose bounds are hit by the ray within ray->maxDist.
+	// If 'ignoreHeight' is true only the XZ bounds are tested.
+	void sectorBvh_rayQuery(const Ray* ray, bool ignoreHeight, std::vector<s32>* result);
+	// Get the sectors whose bounds contain the point, if 'ignoreHeight' is true pos->y is ignored.
+	void sectorBvh_pointQuery(const Vec3f* pos, bool ignoreHeight, std::vector<s32>* result);
+	// Get the sectors whose bounds overlap the input bounds.
+	void sectorBvh_boundsQuery(const Vec3f bounds[2], std::vector<s32>* result);
+}
@@ -1,15 +1,23 @@
 #include "history.h"
 #include "errorMessages.h"
+#include <TFE_System/system.h>
 #include <assert.h>
 #include <algorithm>
 #include <cstring>
 #include <string>
+// The miniz implementation is compiled with the zip library.
+#define MINIZ_HEADER_FILE_ONLY
+#include <TFE_Archive/zip/miniz.h>
 
 namespace TFE_Editor
 {
 	enum
 	{
 		CMD_MAX_DEPTH = 64,
+		// Every Nth snapshot is stored in full, the others as deltas against the previous snapshot.
+		SNAPSHOT_KEYFRAME_INTERVAL = 16,
+		// Number of decompressed snapshots kept around for undo/redo.
+		SNAPSHOT_CACHE_SIZE = 4,
 	};
 
 	struct Snapshot
@@ -17,9 +25,22 @@ namespace TFE_Editor
 		std::string name;
 		u32 uncompressedSize;
 		u32 compressedSize;
+		// Delta snapshots only store the bytes that differ from the base snapshot,
+		// after trimming the prefix and suffix that both share.
+		s32 baseId;			// -1 if this is a full snapshot.
+		u32 prefixSize;
+		u32 suffixSize;
+		bool compressed;	// false if compression didn't make the data smaller.
 		std::vector<u8> compressedData;
 	};
 
+	struct SnapshotCache
+	{
+		s32 id;
+		u32 lastUse;
+		std::vector<u8> data;
+	};
+
 	struct CommandHeader
 	{
 		u16 cmdId;
@@ -38,10 +59,21 @@ namespace TFE_Editor
 	std::vector<u8> s_historyBuffer;
 	std::vector<u8> s_snapshotBuffer;
 
+	// The most recent snapshot is kept uncompressed as the base for the next delta.
+	std::vector<u8> s_lastSnapshot;
+	s32 s_lastSnapshotId = -1;
+	SnapshotCache s_snapshotCache[SNAPSHOT_CACHE_SIZE];
+	u32 s_snapshotCacheTime = 0;
+	std::vector<u8> s_deltaBuffer;
+	std::vector<u8> s_compressBuffer;
+
 	u32 s_curPosInHistory = 0;
 	u32 s_curBufferAddr = 0;
 	u32 s_curSnapshot = 0;
 
+	void snapshot_clearCache();
+	const u8* snapshot_getData(s32 id);
+
 	void history_init(UnpackSnapshotFunc snapshotUnpackFunc, CreateSnapshotFunc createSnapshotFunc)
 	{
 		s_snapshotUnpack = snapshotUnpackFunc;
@@ -56,6 +88,11 @@ namespace TFE_Editor
 
 	void history_destroy()
 	{
+		history_clear();
+		s_snapShots.shrink_to_fit();
+		s_lastSnapshot.shrink_to_fit();
+		s_deltaBuffer.shrink_to_fit();
+		s_compressBuffer.shrink_to_fit();
 	}
 
 	void history_clear()
@@ -63,11 +100,35 @@ namespace TFE_Editor
 		s_snapShots.clear();
 		s_history.clear();
 		s_historyBuffer.clear();
+		s_lastSnapshot.clear();
+		s_lastSnapshotId = -1;
+		snapshot_clearCache();
 		s_curPosInHistory = 0;
 		s_curBufferAddr = 0;
 		s_curSnapshot = 0;
 	}
 
+	void history_getMemoryUsage(HistoryMemory* memory)
+	{
+		*memory = {};
+		memory->entryCount = (u32)s_history.size();
+		memory->snapshotCount = (u32)s_snapShots.size();
+		memory->commandBytes = s_historyBuffer.capacity() + s_history.capacity() * sizeof(u32);
+
+		const size_t snapshotCount = s_snapShots.size();
+		for (size_t i = 0; i < snapshotCount; i++)
+		{
+			memory->snapshotBytes += s_snapShots[i].compressedData.capacity();
+			memory->uncompressedBytes += s_snapShots[i].uncompressedSize;
+		}
+
+		memory->cacheBytes = s_lastSnapshot.capacity() + s_deltaBuffer.capacity() + s_compressBuffer.capacity() + s_snapshotBuffer.capacity();
+		for (s32 i = 0; i < SNAPSHOT_CACHE_SIZE; i++)
+		{
+			memory->cacheBytes += s_snapshotCache[i].data.capacity();
+		}
+	}
+
 	// Register general commands and names.
 	void history_registerCommand(u16 id, CmdApplyFunc func)
 	{
@@ -116,21 +177,196 @@ namespace TFE_Editor
 		return (CommandHeader*)(s_historyBuffer.data() + addr);
 	}
 		
+	/////////////////////////////////////////////
+	// Snapshot storage
+	/////////////////////////////////////////////
+	void snapshot_clearCache()
+	{
+		for (s32 i = 0; i < SNAPSHOT_CACHE_SIZE; i++)
+		{
+			s_snapshotCache[i].id = -1;
+			s_snapshotCache[i].lastUse = 0;
+			s_snapshotCache[i].data.clear();
+		}
+		s_snapshotCacheTime = 0;
+	}
+
+	// Compress 'size' bytes into the snapshot, falling back to a copy if it doesn't help.
+	void snapshot_compress(Snapshot* snapshot, const u8* data, u32 size)
+	{
+		mz_ulong compressedSize = mz_compressBound(size);
+		s_compressBuffer.resize(compressedSize);
+		if (size && mz_compress2(s_compressBuffer.data(), &compressedSize, data, size, MZ_BEST_SPEED) == MZ_OK && compressedSize < size)
+		{
+			snapshot->compressed = true;
+			snapshot->compressedData.assign(s_compressBuffer.data(), s_compressBuffer.data() + compressedSize);
+		}
+		else
+		{
+			snapshot->compressed = false;
+			snapshot->compressedData.assign(data, data + size);
+		}
+		snapshot->compressedSize = (u32)snapshot->compressedData.size();
+	}
+
+	// Decompress the snapshot data (the full data or the delta) into 'output'.
+	bool snapshot_decompress(const Snapshot* snapshot, u8* output, u32 size)
+	{
+		if (!snapshot->compressed)
+		{
+			memcpy(output, snapshot->compressedData.data(), size);
+			return true;
+		}
+		mz_ulong outputSize = size;
+		if (mz_uncompress(output, &outputSize, snapshot->compressedData.data(), snapshot->compressedSize) != MZ_OK || outputSize != size)
+		{
+			TFE_System::logWrite(LOG_ERROR, "History", "Failed to decompress snapshot '%s'.", snapshot->name.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	// Encode 'data' as a delta against 'base': the shared prefix and suffix are skipped and the
+	// remaining bytes are XOR'd against the base, so unchanged runs compress to almost nothing.
+	void snapshot_encodeDelta(Snapshot* snapshot, const u8* data, u32 size, const u8* base, u32 baseSize)
+	{
+		const u32 maxShared = std::min(size, baseSize);
+		u32 prefix = 0;
+		while (prefix < maxShared && data[prefix] == base[prefix]) { prefix++; }
+		u32 suffix = 0;
+		while (suffix < maxShared - prefix && data[size - suffix - 1] == base[baseSize - suffix - 1]) { suffix++; }
+
+		const u32 deltaSize = size - prefix - suffix;
+		const u32 baseDeltaSize = baseSize - prefix - suffix;
+		s_deltaBuffer.resize(deltaSize);
+		for (u32 i = 0; i < deltaSize; i++)
+		{
+			s_deltaBuffer[i] = data[prefix + i] ^ (i < baseDeltaSize ? base[prefix + i] : 0);
+		}
+
+		snapshot->prefixSize = prefix;
+		snapshot->suffixSize = suffix;
+		snapshot_compress(snapshot, s_deltaBuffer.data(), deltaSize);
+	}
+
+	bool snapshot_decodeDelta(const Snapshot* snapshot, const std::vector<u8>& base, std::vector<u8>& output)
+	{
+		const u32 size = snapshot->uncompressedSize;
+		const u32 baseSize = (u32)base.size();
+		const u32 prefix = snapshot->prefixSize;
+		const u32 suffix = snapshot->suffixSize;
+		const u32 deltaSize = size - prefix - suffix;
+		const u32 baseDeltaSize = baseSize - prefix - suffix;
+
+		s_deltaBuffer.resize(deltaSize);
+		if (!snapshot_decompress(snapshot, s_deltaBuffer.data(), deltaSize)) { return false; }
+
+		output.resize(size);
+		memcpy(output.data(), base.data(), prefix);
+		for (u32 i = 0; i < deltaSize; i++)
+		{
+			output[prefix + i] = s_deltaBuffer[i] ^ (i < baseDeltaSize ? base[prefix + i] : 0);
+		}
+		memcpy(output.data() + size - suffix, base.data() + baseSize - suffix, suffix);
+		return true;
+	}
+
+	SnapshotCache* snapshot_findCache(s32 id)
+	{
+		for (s32 i = 0; i < SNAPSHOT_CACHE_SIZE; i++)
+		{
+			if (s_snapshotCache[i].id == id)
+			{
+				s_snapshotCache[i].lastUse = ++s_snapshotCacheTime;
+				return &s_snapshotCache[i];
+			}
+		}
+		return nullptr;
+	}
+
+	SnapshotCache* snapshot_allocCache(s32 id)
+	{
+		SnapshotCache* entry = &s_snapshotCache[0];
+		for (s32 i = 1; i < SNAPSHOT_CACHE_SIZE; i++)
+		{
+			if (s_snapshotCache[i].lastUse < entry->lastUse) { entry = &s_snapshotCache[i]; }
+		}
+		entry->id = id;
+		entry->lastUse = ++s_snapshotCacheTime;
+		return entry;
+	}
+
+	// Get the uncompressed snapshot data, rebuilding it from the closest full or cached snapshot if needed.
+	const u8* snapshot_getData(s32 id)
+	{
+		if (id == s_lastSnapshotId) { return s_lastSnapshot.data(); }
+		SnapshotCache* cache = snapshot_findCache(id);
+		if (cache) { return cache->data.data(); }
+
+		// Walk back through the deltas until reaching data that is already available.
+		std::vector<s32> chain;
+		const std::vector<u8>* base = nullptr;
+		s32 baseId = id;
+		while (baseId >= 0)
+		{
+			if (baseId == s_lastSnapshotId) { base = &s_lastSnapshot; break; }
+			SnapshotCache* baseCache = baseId != id ? snapshot_findCache(baseId) : nullptr;
+			if (baseCache) { base = &baseCache->data; break; }
+
+			chain.push_back(baseId);
+			baseId = s_snapShots[baseId].baseId;
+		}
+
+		// Then apply them going forward, ping-ponging between two buffers.
+		std::vector<u8> work[2];
+		s32 cur = 0;
+		for (s32 i = (s32)chain.size() - 1; i >= 0; i--)
+		{
+			const Snapshot* snapshot = &s_snapShots[chain[i]];
+			std::vector<u8>& output = work[cur];
+			if (snapshot->baseId < 0)
+			{
+				output.resize(snapshot->uncompressedSize);
+				if (!snapshot_decompress(snapshot, output.data(), snapshot->uncompressedSize)) { return nullptr; }
+			}
+			else if (!base || !snapshot_decodeDelta(snapshot, *base, output))
+			{
+				return nullptr;
+			}
+			base = &output;
+			cur ^= 1;
+		}
+		if (!base) { return nullptr; }
+
+		cache = snapshot_allocCache(id);
+		cache->data.swap(*(std::vector<u8>*)base);
+		return cache->data.data();
+	}
+
 	// Create new commands and snapshots.
 	s32 history_createSnapshotInternal(u32 size, void* data, const char* name/*=nullptr*/)
 	{
+		s32 id = (s32)s_snapShots.size();
 		Snapshot snapshot = {};
 		snapshot.uncompressedSize = size;
-		// TODO: Compress
-		// For now just pretend and copy the data.
-		snapshot.compressedSize = size;
-		snapshot.compressedData.resize(size);
 		snapshot.name = name ? name : "";
-		memcpy(snapshot.compressedData.data(), data, size);
+		snapshot.baseId = -1;
+
+		const u8* bytes = (const u8*)data;
+		if (s_lastSnapshotId >= 0 && (id % SNAPSHOT_KEYFRAME_INTERVAL) != 0)
+		{
+			snapshot.baseId = s_lastSnapshotId;
+			snapshot_encodeDelta(&snapshot, bytes, size, s_lastSnapshot.data(), (u32)s_lastSnapshot.size());
+		}
+		else
+		{
+			snapshot_compress(&snapshot, bytes, size);
+		}
 
-		s32 id = (s32)s_snapShots.size();
 		s_snapShots.push_back(std::move(snapshot));
 		s_curSnapshot = u32(id);
+		s_lastSnapshot.assign(bytes, bytes + size);
+		s_lastSnapshotId = id;
 
 		CommandHeader* header = hBuffer_createHeader();
 		header->cmdId = CMD_SNAPSHOT;
@@ -159,8 +395,6 @@ namespace TFE_Editor
 			s_snapshotBuffer.clear();
 			s_snapshotCreate(&s_snapshotBuffer);
 
-			// TODO: Compress
-
 			// Create the snapshot itself.
 			history_createSnapshotInternal((u32)s_snapshotBuffer.size(), s_snapshotBuffer.data(), "");
 			// Return false to let the caller know a snapshot was created instead of the command.
@@ -209,10 +443,10 @@ namespace TFE_Editor
 
 			if (cmdHeader->cmdId == CMD_SNAPSHOT)
 			{
-				Snapshot* snapshot = &s_snapShots[cmdHeader->parentId];
-				// TODO: decompress data if snapshot ID != cached ID.
-				// For now we aren't compressing so just pass it along...
-				s_snapshotUnpack(cmdHeader->parentId, snapshot->compressedSize, snapshot->compressedData.data());
+				const Snapshot* snapshot = &s_snapShots[cmdHeader->parentId];
+				const u8* data = snapshot_getData(cmdHeader->parentId);
+				if (!data) { return; }
+				s_snapshotUnpack(cmdHeader->parentId, snapshot->uncompressedSize, (void*)data);
 			}
 			else
 			{
@@ -23,6 +23,16 @@ namespace TFE_Editor
 		CMD_START = 1,
 	};
 
+	struct HistoryMemory
+	{
+		u32 entryCount;
+		u32 snapshotCount;
+		size_t commandBytes;		// Command buffer.
+		size_t snapshotBytes;		// Compressed snapshots and deltas.
+		size_t uncompressedBytes;	// What the snapshots would take uncompressed.
+		size_t cacheBytes;			// Decompressed snapshots and work buffers.
+	};
+
 	// TODO: Add load and save functionality.
 	void history_init(UnpackSnapshotFunc snapshotUnpackFunc, CreateSnapshotFunc createSnapshotFunc);
 	void history_destroy();
@@ -39,6 +49,7 @@ namespace TFE_Editor
 	void history_setPos(s32 pos);
 	s32  history_getPos();
 	s32  history_getSize();
+	void history_getMemoryUsage(HistoryMemory* memory);
 
 	// Handle merging commands.
 	bool history_canMergeCommand(u16 cmd, u16 name, const void* dataToMatch, u32 matchSize);
@@ -0,0 +1,163 @@
+#include "fileIndex.h"
+#include "fileutil.h"
+#include <TFE_Archive/archive.h>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace TFE_FileIndex
+{
+	struct FileIndexEntry
+	{
+		Archive* archive;	// archive or null for loose files.
+		u32 index;			// index into the archive.
+		u32 pathIndex;		// index into s_paths for loose files.
+		std::string name;	// file name with its original case.
+	};
+
+	struct DirectoryListing
+	{
+		u64 modifiedTime;
+		FileList files;
+	};
+
+	struct IndexedSearchPath
+	{
+		std::string path;
+		u64 modifiedTime;
+	};
+
+	static std::unordered_map<std::string, FileIndexEntry> s_index;
+	static std::vector<std::string> s_paths;
+	static std::vector<IndexedSearchPath> s_searchPaths;
+	// Directory listings are cached so that rebuilding the index, as archives come and go, only has to read
+	// the directories that changed.
+	static std::unordered_map<std::string, DirectoryListing> s_directoryCache;
+
+	// Copy 'src' to 'dst' in lowercase, returns false if the name is too long.
+	bool toLower(const char* src, char* dst)
+	{
+		size_t i = 0;
+		for (; src[i]; i++)
+		{
+			if (i >= TFE_MAX_PATH - 1) { return false; }
+			dst[i] = tolower(src[i]);
+		}
+		dst[i] = 0;
+		return true;
+	}
+
+	void addEntry(const char* name, const FileIndexEntry& entry)
+	{
+		char key[TFE_MAX_PATH];
+		if (!toLower(name, key)) { return; }
+		// Sources are added in priority order, so existing entries are never replaced.
+		s_index.emplace(key, entry);
+	}
+
+	void clear()
+	{
+		s_index.clear();
+		s_paths.clear();
+		s_searchPaths.clear();
+	}
+
+	void clearDirectoryCache()
+	{
+		s_directoryCache.clear();
+	}
+
+	void addFileMapping(const char* fileName, const char* realPath)
+	{
+		const u32 pathIndex = (u32)s_paths.size();
+		s_paths.push_back("");
+		addEntry(fileName, { nullptr, INVALID_FILE, pathIndex, realPath });
+	}
+
+	void addSearchPath(const char* path)
+	{
+		const u64 modifiedTime = FileUtil::getModifiedTime(path);
+		auto iDir = s_directoryCache.find(path);
+		if (iDir == s_directoryCache.end() || iDir->second.modifiedTime != modifiedTime)
+		{
+			DirectoryListing& listing = s_directoryCache[path];
+			listing.modifiedTime = modifiedTime;
+			listing.files.clear();
+			FileUtil::readDirectoryFiles(path, listing.files);
+			iDir = s_directoryCache.find(path);
+		}
+		const FileList& files = iDir->second.files;
+
+		const u32 pathIndex = (u32)s_paths.size();
+		s_paths.push_back(path);
+		s_searchPaths.push_back({ path, modifiedTime });
+		const size_t count = files.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			addEntry(files[i].c_str(), { nullptr, INVALID_FILE, pathIndex, files[i] });
+		}
+	}
+
+	void addArchive(Archive* archive)
+	{
+		if (!archive) { return; }
+
+		const u32 count = archive->getFileCount();
+		for (u32 i = 0; i < count; i++)
+		{
+			const char* name = archive->getFileName(i);
+			if (!name || !name[0]) { continue; }
+			addEntry(name, { archive, i, 0, "" });
+		}
+	}
+
+	void removeArchive(Archive* archive)
+	{
+		for (auto iEntry = s_index.begin(); iEntry != s_index.end();)
+		{
+			if (iEntry->second.archive == archive) { iEntry = s_index.erase(iEntry); }
+			else { ++iEntry; }
+		}
+	}
+
+	bool isStale()
+	{
+		const size_t count = s_searchPaths.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (FileUtil::getModifiedTime(s_searchPaths[i].path.c_str()) != s_searchPaths[i].modifiedTime)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool find(const char* fileName, FilePath* outPath)
+	{
+		char key[TFE_MAX_PATH];
+		if (!toLower(fileName, key)) { return false; }
+
+		const auto iEntry = s_index.find(key);
+		if (iEntry == s_index.end()) { return false; }
+
+		const FileIndexEntry& entry = iEntry->second;
+		if (entry.archive)
+		{
+			outPath->archive = entry.archive;
+			outPath->index = entry.index;
+		}
+		else
+		{
+			snprintf(outPath->path, TFE_MAX_PATH, "%s%s", s_paths[entry.pathIndex].c_str(), entry.name.c_str());
+		}
+		return true;
+	}
+
+	u32 getEntryCount()
+	{
+		return (u32)s_index.size();
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Global file index
+// A single case-insensitive hash index over the file mappings, search
+// paths and archives mounted by TFE_Paths. Sources are added in
+// priority order and the first source to provide a name wins, so a
+// lookup is a single hash probe.
+// The index only holds the files at the top level of each search path,
+// and the modification time of each search path directory is recorded
+// so the index can be rebuilt when loose files are added or removed.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "paths.h"
+
+namespace TFE_FileIndex
+{
+	void clear();
+	// Search path directory listings are cached until this is called or the directory changes.
+	void clearDirectoryCache();
+
+	// Add sources, from highest to lowest priority.
+	void addFileMapping(const char* fileName, const char* realPath);
+	void addSearchPath(const char* path);
+	void addArchive(Archive* archive);
+	// Remove the entries provided by an archive, only valid for the lowest priority archive.
+	void removeArchive(Archive* archive);
+
+	// Returns true if files were added to or removed from a search path since it was indexed.
+	bool isStale();
+	bool find(const char* fileName, FilePath* outPath);
+	u32  getEntryCount();
+}
@@ -15,6 +15,7 @@ FileStream::FileStream() : Stream()
 	m_file = nullptr;
 	m_archive = nullptr;
 	m_mode = MODE_INVALID;
+	m_writeError = false;
 }
 
 FileStream::~FileStream()
@@ -59,16 +60,17 @@ bool FileStream::open(const FilePath* filePath, AccessMode mode)
 	}
 }
 
-void FileStream::close()
+bool FileStream::close()
 {
+	bool result = !m_writeError;
 	if (m_file)
 	{
 		if (m_mode == MODE_WRITE || m_mode == MODE_READWRITE) 
 		{ 
-			fflush(m_file); 
+			if (fflush(m_file) != 0) { result = false; }
 		}
 
-		fclose(m_file);
+		if (fclose(m_file) != 0) { result = false; }
 		m_file = nullptr;
 	}
 	else if (m_archive)
@@ -77,6 +79,8 @@ void FileStream::close()
 		m_archive = nullptr;
 	}
 	m_mode = MODE_INVALID;
+	m_writeError = false;
+	return result;
 }
 
 u32 FileStream::readContents(const char* filePath, void** output)
@@ -219,7 +223,7 @@ void FileStream::writeBuffer(const void* ptr, u32 size, u32 count)
 	assert(m_mode == MODE_WRITE || m_mode == MODE_READWRITE);
 	if (m_file)
 	{
-		fwrite(ptr, size, count, m_file);
+		writeData(ptr, size, count);
 	}
 }
 
@@ -236,7 +240,7 @@ void FileStream::writeString(const char* fmt, ...)
 		va_end(arg);
 
 		const size_t len = strlen(tmpStr);
-		fwrite(tmpStr, len, 1, m_file);
+		writeData(tmpStr, len, 1);
 	}
 }
 
@@ -276,11 +280,11 @@ void FileStream::writeString(const std::string* ptr, u32 count)
 	{
 		s_workBufferU32[s] = (u32)ptr[s].length();
 	}
-	fwrite(s_workBufferU32, sizeof(u32), count, m_file);
+	writeData(s_workBufferU32, sizeof(u32), count);
 
 	//then write the string data.
 	for (u32 s=0; s<count; s++)
 	{
-		fwrite(ptr[s].data(), 1, s_workBufferU32[s], m_file);
+		writeData(ptr[s].data(), 1, s_workBufferU32[s]);
 	}
 }
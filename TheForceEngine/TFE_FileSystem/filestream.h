@@ -18,7 +18,8 @@ public:
 	bool exists(const char* filename);
 	bool open(const char* filename, AccessMode mode);
 	bool open(const FilePath* filePath, AccessMode mode);
-	void close();
+	// Returns false if any write, or flushing and closing the file, failed since it was opened.
+	bool close();
 
 	static u32 readContents(const char* filePath, void** output);
 	static u32 readContents(const char* filePath, void* output, size_t size);
@@ -74,7 +75,16 @@ private:
 	{
 		assert(m_mode == MODE_WRITE || m_mode == MODE_READWRITE);
 		assert(m_file);	// TODO: Add Archive support.
-		fwrite(ptr, sizeof(T), count, m_file);
+		writeData(ptr, sizeof(T), count);
+	}
+
+	// Write errors are remembered so close() can report them.
+	void writeData(const void* ptr, size_t size, size_t count)
+	{
+		if (size && count && fwrite(ptr, size, count, m_file) != count)
+		{
+			m_writeError = true;
+		}
 	}
 
 	void readString(std::string* ptr, u32 count);
@@ -84,4 +94,5 @@ private:
 	FILE*    m_file;
 	Archive* m_archive;
 	AccessMode m_mode;
+	bool m_writeError;
 };
@@ -58,6 +58,33 @@ namespace FileUtil
 		closedir(d);
 	}
 
+	void readDirectoryFiles(const char *dir, FileList& fileList)
+	{
+		char buf[PATH_MAX];
+		struct dirent *de;
+		struct stat st;
+		DIR *d;
+
+		d = opendir(dir);
+		if (!d) {
+			TFE_System::logWrite(LOG_ERROR, "readDirectoryFiles", "opendir(%s) failed with %d\n", dir, errno);
+			return;
+		}
+
+		while (NULL != (de = readdir(d))) {
+			// only stat() if the filesystem does not report the type.
+			if (de->d_type == DT_UNKNOWN || de->d_type == DT_LNK) {
+				snprintf(buf, PATH_MAX - 1, "%s%s", dir, de->d_name);
+				if (stat(buf, &st) || !S_ISREG(st.st_mode))
+					continue;
+			} else if (de->d_type != DT_REG) {
+				continue;
+			}
+			fileList.push_back(string(de->d_name));
+		}
+		closedir(d);
+	}
+
 	void readSubdirectories(const char *dir, FileList& dirList)
 	{
 		char *dn, fp[PATH_MAX];
@@ -361,6 +388,16 @@ namespace FileUtil
 		return mtim;
 	}
 
+	u64 getFileSize(const char *path)
+	{
+		struct stat st;
+		if (stat(path, &st))
+		{
+			return 0;
+		}
+		return (u64)st.st_size;
+	}
+
 	void fixupPath(char *path)
 	{
 		char *c = path;
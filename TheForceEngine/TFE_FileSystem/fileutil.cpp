@@ -30,6 +30,26 @@ namespace FileUtil
 		}
 	}
 
+	void readDirectoryFiles(const char* dir, FileList& fileList)
+	{
+		char searchStr[TFE_MAX_PATH];
+		_finddata_t fileInfo;
+
+		sprintf(searchStr, "%s*", dir);
+		intptr_t hFile = _findfirst(searchStr, &fileInfo);
+		if (hFile != -1)
+		{
+			do
+			{
+				if (!(fileInfo.attrib & _A_SUBDIR))
+				{
+					fileList.push_back( string(fileInfo.name) );
+				}
+			} while ( _findnext(hFile, &fileInfo) == 0 );
+			_findclose(hFile);
+		}
+	}
+
 	void readSubdirectories(const char* dir, FileList& dirList)
 	{
 		#ifdef _WIN32
@@ -233,27 +253,25 @@ namespace FileUtil
 		return !(GetFileAttributesA(path)==INVALID_FILE_ATTRIBUTES && GetLastError()==ERROR_FILE_NOT_FOUND);
 	}
 
+	// Works for directories as well, whose time changes when files are added or removed.
 	u64 getModifiedTime( const char* path )
 	{
-		FILETIME creationTime;
-		FILETIME lastAccessTime;
-		FILETIME lastWriteTime;
-
-		HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
-		if (fileHandle == INVALID_HANDLE_VALUE)
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
 		{
 			return 0;
 		}
+		return u64(attributes.ftLastWriteTime.dwHighDateTime) << 32ULL | u64(attributes.ftLastWriteTime.dwLowDateTime);
+	}
 
-		u64 modTime = 0;
-		if ( GetFileTime(fileHandle, &creationTime, &lastAccessTime, &lastWriteTime) )
+	u64 getFileSize(const char* path)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
 		{
-			modTime = u64(lastWriteTime.dwHighDateTime) << 32ULL | u64(lastWriteTime.dwLowDateTime);
+			return 0;
 		}
-		
-		CloseHandle(fileHandle);
-
-		return modTime;
+		return u64(attributes.nFileSizeHigh) << 32ULL | u64(attributes.nFileSizeLow);
 	}
 
 	void fixupPath(char* path)
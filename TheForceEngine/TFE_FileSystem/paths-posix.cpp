@@ -3,6 +3,7 @@
 #include "paths.h"
 #include "fileutil.h"
 #include "filestream.h"
+#include "fileIndex.h"
 #include <TFE_System/system.h>
 #include <TFE_Archive/archive.h>
 #include <algorithm>
@@ -27,6 +28,7 @@ namespace TFE_Paths
 	static std::deque<std::string> s_searchPaths;
 	static std::deque<FileMapping> s_fileMappings;
 	static std::deque<std::string> s_systemPaths;	// TFE Support data paths
+	static bool s_fileIndexDirty = true;
 
 	void setPath(TFE_PathType pathType, const char* path)
 	{
@@ -196,6 +198,7 @@ namespace TFE_Paths
 			}
 		}
 		s_searchPaths.push_back(workpath);
+		s_fileIndexDirty = true;
 	}
 
 	void addSearchPathToHead(const char *fullPath)
@@ -214,12 +217,14 @@ namespace TFE_Paths
 			}
 		}
 		s_searchPaths.push_front(workpath);
+		s_fileIndexDirty = true;
 	}
 
 	void clearSearchPaths(void)
 	{
 		s_searchPaths.clear();
 		s_fileMappings.clear();
+		invalidateFileIndex();
 	}
 
 	void clearLocalArchives(void)
@@ -227,6 +232,7 @@ namespace TFE_Paths
 		std::for_each(s_localArchives.begin(), s_localArchives.end(),
 				[](Archive *a) { Archive::freeArchive(a); });
 		s_localArchives.clear();
+		s_fileIndexDirty = true;
 	}
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
@@ -242,6 +248,7 @@ namespace TFE_Paths
 
 		FileMapping mapping = { fileNameLC, filePathFixed };
 		s_fileMappings.push_back(mapping);
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalSearchPath(const char *locpath)
@@ -274,21 +281,56 @@ namespace TFE_Paths
 	void addLocalArchiveToFront(Archive *a)
 	{
 		s_localArchives.push_front(a);
+		s_fileIndexDirty = true;
 	}
 
 	void removeFirstArchive(void)
 	{
 		s_localArchives.pop_front();
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalArchive(Archive *a)
 	{
 		s_localArchives.push_back(a);
+		// The new archive has the lowest priority, so it can be added to the index directly.
+		if (!s_fileIndexDirty) { TFE_FileIndex::addArchive(a); }
 	}
 
 	void removeLastArchive(void)
 	{
+		Archive* a = s_localArchives.back();
 		s_localArchives.pop_back();
+		// Entries can only be removed directly if no other copy of the archive provided them.
+		if (!s_fileIndexDirty && std::find(s_localArchives.begin(), s_localArchives.end(), a) == s_localArchives.end())
+		{
+			TFE_FileIndex::removeArchive(a);
+		}
+		else
+		{
+			s_fileIndexDirty = true;
+		}
+	}
+
+	void invalidateFileIndex()
+	{
+		s_fileIndexDirty = true;
+		TFE_FileIndex::clearDirectoryCache();
+	}
+
+	void buildFileIndex()
+	{
+		TFE_FileIndex::clear();
+		for (auto it = s_fileMappings.begin(); it != s_fileMappings.end(); it++) {
+			TFE_FileIndex::addFileMapping(it->fileName.c_str(), it->realPath.c_str());
+		}
+		for (auto it = s_searchPaths.begin(); it != s_searchPaths.end(); it++) {
+			TFE_FileIndex::addSearchPath(it->c_str());
+		}
+		for (auto it = s_localArchives.begin(); it != s_localArchives.end(); it++) {
+			TFE_FileIndex::addArchive(*it);
+		}
+		s_fileIndexDirty = false;
 	}
 
 	bool getFilePath(const char *fileName, FilePath *outPath)
@@ -299,6 +341,19 @@ namespace TFE_Paths
 		outPath->index = INVALID_FILE;
 		outPath->path[0] = 0;
 
+		// Plain file names are resolved with a single lookup in the file index,
+		// which only holds the top level of each search path.
+		// The index is rebuilt if loose files were added or removed since it was built, and a miss falls back
+		// to the full search below.
+		if (!strpbrk(fileName, "/\\")) {
+			if (s_fileIndexDirty || TFE_FileIndex::isStale()) {
+				buildFileIndex();
+			}
+			if (TFE_FileIndex::find(fileName, outPath)) {
+				return true;
+			}
+		}
+
 		// Search for any filemappings.
 		// This is usually only used with mods and usually limited to 0-3 files.
 		for (auto it = s_fileMappings.begin(); it != s_fileMappings.end(); it++) {
@@ -2,8 +2,10 @@
 #include "paths.h"
 #include "fileutil.h"
 #include "filestream.h"
+#include "fileIndex.h"
 #include <TFE_System/system.h>
 #include <TFE_Archive/archive.h>
+#include <algorithm>
 #include <string>
 
 #ifdef _WIN32
@@ -31,6 +33,7 @@ namespace TFE_Paths
 	static std::vector<Archive*> s_localArchives;
 	static std::vector<std::string> s_searchPaths;
 	static std::vector<FileMapping> s_fileMappings;
+	static bool s_fileIndexDirty = true;
 
 	void setPath(TFE_PathType pathType, const char* path)
 	{
@@ -170,6 +173,7 @@ namespace TFE_Paths
 			}
 
 			s_searchPaths.push_back(fullPath);
+			s_fileIndexDirty = true;
 		}
 	}
 
@@ -189,6 +193,7 @@ namespace TFE_Paths
 			}
 
 			s_searchPaths.insert(s_searchPaths.begin(), fullPath);
+			s_fileIndexDirty = true;
 		}
 	}
 
@@ -196,6 +201,7 @@ namespace TFE_Paths
 	{
 		s_searchPaths.clear();
 		s_fileMappings.clear();
+		invalidateFileIndex();
 	}
 
 	void clearLocalArchives()
@@ -207,6 +213,7 @@ namespace TFE_Paths
 			Archive::freeArchive(archive[i]);
 		}
 		s_localArchives.clear();
+		s_fileIndexDirty = true;
 	}
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
@@ -222,6 +229,7 @@ namespace TFE_Paths
 
 		FileMapping mapping = { fileNameLC, filePathFixed };
 		s_fileMappings.push_back(mapping);
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalSearchPath(const char* localSearchPath)
@@ -254,21 +262,63 @@ namespace TFE_Paths
 	void addLocalArchiveToFront(Archive* archive)
 	{
 		s_localArchives.insert(s_localArchives.begin(), archive);
+		s_fileIndexDirty = true;
 	}
 
 	void removeFirstArchive()
 	{
 		s_localArchives.erase(s_localArchives.begin());
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalArchive(Archive* archive)
 	{
 		s_localArchives.push_back(archive);
+		// The new archive has the lowest priority, so it can be added to the index directly.
+		if (!s_fileIndexDirty) { TFE_FileIndex::addArchive(archive); }
 	}
 
 	void removeLastArchive()
 	{
+		Archive* archive = s_localArchives.back();
 		s_localArchives.pop_back();
+		// Entries can only be removed directly if no other copy of the archive provided them.
+		if (!s_fileIndexDirty && std::find(s_localArchives.begin(), s_localArchives.end(), archive) == s_localArchives.end())
+		{
+			TFE_FileIndex::removeArchive(archive);
+		}
+		else
+		{
+			s_fileIndexDirty = true;
+		}
+	}
+
+	void invalidateFileIndex()
+	{
+		s_fileIndexDirty = true;
+		TFE_FileIndex::clearDirectoryCache();
+	}
+
+	void buildFileIndex()
+	{
+		TFE_FileIndex::clear();
+
+		const size_t mappingCount = s_fileMappings.size();
+		for (size_t i = 0; i < mappingCount; i++)
+		{
+			TFE_FileIndex::addFileMapping(s_fileMappings[i].fileName.c_str(), s_fileMappings[i].realPath.c_str());
+		}
+		const size_t pathCount = s_searchPaths.size();
+		for (size_t i = 0; i < pathCount; i++)
+		{
+			TFE_FileIndex::addSearchPath(s_searchPaths[i].c_str());
+		}
+		const size_t archiveCount = s_localArchives.size();
+		for (size_t i = 0; i < archiveCount; i++)
+		{
+			TFE_FileIndex::addArchive(s_localArchives[i]);
+		}
+		s_fileIndexDirty = false;
 	}
 
 	bool getFilePath(const char* fileName, FilePath* outPath)
@@ -277,6 +327,16 @@ namespace TFE_Paths
 		outPath->index = INVALID_FILE;
 		outPath->path[0] = 0;
 
+		// Plain file names are resolved with a single lookup in the file index,
+		// which only holds the top level of each search path.
+		// The index is rebuilt if loose files were added or removed since it was built, and a miss falls back
+		// to the full search below.
+		if (!strpbrk(fileName, "/\\"))
+		{
+			if (s_fileIndexDirty || TFE_FileIndex::isStale()) { buildFileIndex(); }
+			if (TFE_FileIndex::find(fileName, outPath)) { return true; }
+		}
+
 		// Search for any filemappings.
 		// This is usually only used with mods and usually limited to 0-3 files.
 		const size_t mappingCount  = s_fileMappings.size();
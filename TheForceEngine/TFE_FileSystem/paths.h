@@ -53,6 +53,9 @@ namespace TFE_Paths
 	void addLocalArchiveToFront(Archive* archive);
 	void removeFirstArchive();
 	bool getFilePath(const char* fileName, FilePath* path);
+	// Force the file index to be rebuilt, including the search path directory listings.
+	// Call this after writing new files into a search path.
+	void invalidateFileIndex();
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
 	void addSingleFilePath(const char* fileName, const char* filePath);
@@ -226,6 +226,12 @@ namespace TFE_FrontEndUI
 		"Mouselook"
 	};
 
+	static const char* c_recordingFormat[] =
+	{
+		"GIF",
+		"Y4M (Uncompressed)",
+	};
+
 	static const char* c_fontSize[] =
 	{
 		"Small",
@@ -1351,6 +1357,8 @@ namespace TFE_FrontEndUI
 	///////////////////////////////////////////////////////////////////////////////
 	static std::vector<TFE_SaveSystem::SaveHeader> s_saveDir;
 	static TextureGpu* s_saveImageView = nullptr;
+	static std::vector<u32> s_saveImage;
+	static s32 s_saveImagePending = -1;
 	static s32 s_selectedSave = -1;
 	static s32 s_selectedSaveSlot = -1;
 	static bool s_hasQuicksave = false;
@@ -1366,11 +1374,40 @@ namespace TFE_FrontEndUI
 		u32 zero[TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT];
 		memset(zero, 0, sizeof(u32) * TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT);
 		s_saveImageView->update(zero, TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT * 4);
+		s_saveImagePending = -1;
 	}
 
+	// Show the thumbnail from the save index immediately, the full image is loaded once the selection settles.
 	void updateSaveImage(s32 index)
 	{
-		s_saveImageView->update(s_saveDir[index].imageData, TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT * 4);
+		const s32 width  = TFE_SaveSystem::SAVE_IMAGE_WIDTH;
+		const s32 height = TFE_SaveSystem::SAVE_IMAGE_HEIGHT;
+		const u32* thumbnail = s_saveDir[index].thumbnail;
+		s_saveImage.resize(width * height);
+
+		u32* outPixel = s_saveImage.data();
+		for (s32 y = 0; y < height; y++)
+		{
+			const u32* thumbRow = &thumbnail[(y * TFE_SaveSystem::SAVE_THUMB_HEIGHT / height) * TFE_SaveSystem::SAVE_THUMB_WIDTH];
+			for (s32 x = 0; x < width; x++, outPixel++)
+			{
+				*outPixel = thumbRow[x * TFE_SaveSystem::SAVE_THUMB_WIDTH / width];
+			}
+		}
+		s_saveImageView->update(s_saveImage.data(), width * height * 4);
+		s_saveImagePending = index;
+	}
+
+	void updateSaveImageFull()
+	{
+		if (s_saveImagePending < 0 || s_saveImagePending >= (s32)s_saveDir.size()) { return; }
+
+		s_saveImage.resize(TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT);
+		if (TFE_SaveSystem::loadSaveImage(s_saveDir[s_saveImagePending].fileName, s_saveImage.data()))
+		{
+			s_saveImageView->update(s_saveImage.data(), TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT * 4);
+		}
+		s_saveImagePending = -1;
 	}
 
 	void openLoadConfirmPopup()
@@ -1611,6 +1648,10 @@ namespace TFE_FrontEndUI
 					clearSaveImage();
 				}
 			}
+			else
+			{
+				updateSaveImageFull();
+			}
 			prevSelected = s_selectedSave;
 
 			if (ImGui::BeginPopupModal(s_saveGameConfirmMsg, NULL, ImGuiWindowFlags_AlwaysAutoResize))
@@ -2747,6 +2788,13 @@ namespace TFE_FrontEndUI
 		s32 framerate = (s32)system->gifRecordingFramerate;
 		DrawLabelledIntSlider(labelW, valueW - 2, "GIF Recording Framerate", "##CBO", &framerate, 10, 30);
 		system->gifRecordingFramerate = (f32)framerate;
+
+		ImGui::SetNextItemWidth(labelW);
+		ImGui::LabelText("##ConfigLabel", "Recording Format");
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(valueW);
+		ImGui::Combo("##RecordingFormat", &system->recordingFormat, c_recordingFormat, IM_ARRAYSIZE(c_recordingFormat));
+		Tooltip("Used when recording the software renderer, which records the 8-bit frames directly while playing. The GPU renderer always records GIFs.");
 	}
 
 	void DrawFontSizeCombo(float labelWidth, float valueWidth, const char* label, const char* comboTag, s32* currentValue)
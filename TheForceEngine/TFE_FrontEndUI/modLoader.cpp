@@ -3,6 +3,7 @@
 #include "console.h"
 #include "uiTexture.h"
 #include "profilerView.h"
+#include <TFE_System/profiler.h>
 #include <TFE_DarkForces/config.h>
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_System/system.h>
@@ -14,6 +15,7 @@
 #include <TFE_Settings/settings.h>
 #include <TFE_Asset/imageAsset.h>
 #include <TFE_Archive/zipArchive.h>
+#include <TFE_Archive/gobArchive.h>
 #include <TFE_Archive/gobMemoryArchive.h>
 #include <TFE_Input/inputMapping.h>
 #include <TFE_Asset/imageAsset.h>
@@ -23,7 +25,11 @@
 // Game
 #include <TFE_DarkForces/mission.h>
 #include <TFE_Jedi/Renderer/jediRenderer.h>
+#include <SDL_thread.h>
+#include <SDL_mutex.h>
+#include <SDL_cpuinfo.h>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 
 using namespace TFE_Input;
@@ -36,7 +42,21 @@ namespace TFE_FrontEndUI
 		QREAD_ZIP,
 		QREAD_COUNT
 	};
-	const u32 c_itemsPerFrame = 1;
+
+	enum ModCatalogConstants
+	{
+		MAX_SCAN_THREADS = 4,
+		// Posters are downscaled to fit, they are displayed at 256x192 or smaller in the mod list.
+		POSTER_MAX_WIDTH = 160,
+		POSTER_MAX_HEIGHT = 120,
+	};
+
+	enum ModCatalogVersion
+	{
+		MCVER_INIT = 1,
+		MCVER_CUR = MCVER_INIT
+	};
+	static const char c_modCatalogSig[4] = { 'T', 'F', 'M', 'C' };
 
 	struct QueuedRead
 	{
@@ -58,16 +78,53 @@ namespace TFE_FrontEndUI
 
 		bool invertImage = true;
 	};
+
+	struct ModPoster
+	{
+		u32 width = 0;
+		u32 height = 0;
+		std::vector<u32> pixels;
+	};
+
+	// The result of scanning one read queue entry, produced by the scan workers or read from the catalog.
+	struct ModScan
+	{
+		bool valid = false;		// false if the entry is not a mod.
+		u64 modifiedTime = 0;	// Used to detect changes to the zip (or gob for directories).
+		u64 fileSize = 0;
+		ModData mod;			// Everything except the GPU texture, which is created on the main thread.
+		ModPoster poster;
+	};
+
+	// Per-thread buffers used while scanning.
+	struct ModScanBuffers
+	{
+		std::vector<char> text;
+		std::vector<u8> read[2];
+		std::vector<u8> image;
+		std::vector<u32> pixels;
+	};
+
 	static std::vector<ModData> s_mods;
 	static std::vector<ModData*> s_filteredMods;
-
-	static std::vector<char> s_fileBuffer;
-	static std::vector<u8> s_readBuffer[2];
 	static s32 s_selectedMod;
 
 	static std::vector<QueuedRead> s_readQueue;
-	static std::vector<u8> s_imageBuffer;
-	static size_t s_readIndex = 0;
+	static std::vector<ModScan> s_scans;	// One per read queue entry.
+
+	// Scan workers.
+	static SDL_Thread* s_scanThreads[MAX_SCAN_THREADS] = { 0 };
+	static s32 s_scanThreadCount = 0;
+	static SDL_mutex* s_scanMutex = nullptr;
+	static std::vector<size_t> s_scanJobs;		// Read queue indices to scan, fixed while the workers are running.
+	static atomic_u32 s_scanNext;
+	static atomic_bool s_scanCancel;
+	static std::vector<size_t> s_scanDone;		// Finished jobs not yet added to the mod list, guarded by s_scanMutex.
+	static size_t s_scanPending = 0;			// Jobs not yet added to the mod list.
+	static bool s_catalogDirty = false;
+
+	// Default poster (wait.bm and wait.pal from the base game), used when a mod doesn't override it.
+	static std::vector<u8> s_defaultPoster[2];
 
 	static ViewMode s_viewMode = VIEW_IMAGES;
 
@@ -78,10 +135,17 @@ namespace TFE_FrontEndUI
 	static bool s_modsRead = false;
 
 	void fixupName(char* name);
-	void readFromQueue(size_t itemsPerFrame);
-	bool parseNameFromText(const char* textFileName, const char* path, char* name, std::string* fullText);
-	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, UiTexture* poster);
-	void extractPosterFromMod(const char* baseDir, const char* archiveFileName, UiTexture* poster);
+	void updateScans();
+	void startScanWorkers();
+	void stopScanWorkers();
+	void readCatalog(std::unordered_map<std::string, ModScan>& catalog);
+	void writeCatalog();
+	void getCatalogKey(const QueuedRead& read, char* key);
+	bool getStampPath(const QueuedRead& read, const ModScan& scan, char* path);
+	void addMod(ModScan& scan);
+	bool parseNameFromText(const char* textFileName, const char* path, char* name, std::string* fullText, std::vector<char>& fileBuffer);
+	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, ModScanBuffers* buffers, ModPoster* poster);
+	void extractPosterFromMod(const char* baseDir, const char* archiveFileName, ModScanBuffers* buffers, ModPoster* poster);
 	void filterMods(bool filterByName, bool sort = true);
 
 	bool sortQueueByName(QueuedRead& a, QueuedRead& b)
@@ -99,8 +163,9 @@ namespace TFE_FrontEndUI
 		s_selectedMod = -1;
 		clearSelectedMod();
 
+		stopScanWorkers();
 		s_readQueue.clear();
-		s_readIndex = 0;
+		s_scans.clear();
 
 		// There are 3 possible mod directory locations:
 		// In the TFE directory,
@@ -219,10 +284,68 @@ namespace TFE_FrontEndUI
 		}
 
 		std::sort(s_readQueue.begin(), s_readQueue.end(), sortQueueByName);
+
+		// Load the default poster now, since the base archives cannot be shared with the scan workers.
+		for (s32 i = 0; i < 2; i++)
+		{
+			s_defaultPoster[i].clear();
+			const char* archiveName = i == 0 ? "TEXTURES.GOB" : "DARK.GOB";
+			char archivePath[TFE_MAX_PATH];
+			sprintf(archivePath, "%s%s", TFE_Paths::getPath(PATH_SOURCE_DATA), archiveName);
+			Archive* archive = Archive::getArchive(ARCHIVE_GOB, archiveName, archivePath);
+			if (archive && archive->openFile(i == 0 ? "wait.bm" : "wait.pal"))
+			{
+				s_defaultPoster[i].resize(archive->getFileLength());
+				archive->readFile(s_defaultPoster[i].data(), archive->getFileLength());
+				archive->closeFile();
+			}
+		}
+
+		// Mods that haven't changed since they were last scanned are read from the catalog, which is
+		// fast enough to fill in the whole list right away. Everything else is scanned in the background.
+		std::unordered_map<std::string, ModScan> catalog;
+		readCatalog(catalog);
+
+		const size_t count = s_readQueue.size();
+		s_scans.resize(count);
+		s_scanJobs.clear();
+		size_t cachedCount = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			char key[TFE_MAX_PATH], stampPath[TFE_MAX_PATH];
+			getCatalogKey(s_readQueue[i], key);
+
+			std::unordered_map<std::string, ModScan>::iterator iScan = catalog.find(key);
+			if (iScan != catalog.end() && getStampPath(s_readQueue[i], iScan->second, stampPath) &&
+				FileUtil::getModifiedTime(stampPath) == iScan->second.modifiedTime && FileUtil::getFileSize(stampPath) == iScan->second.fileSize)
+			{
+				s_scans[i] = std::move(iScan->second);
+				addMod(s_scans[i]);
+				cachedCount++;
+			}
+			else
+			{
+				s_scanJobs.push_back(i);
+			}
+		}
+		// Rewrite the catalog if mods were removed, so stale entries don't accumulate.
+		s_catalogDirty = cachedCount != catalog.size();
+		filterMods(s_viewMode != VIEW_FILE_LIST, s_scanJobs.empty() || s_viewMode == VIEW_FILE_LIST);
+
+		if (!s_scanJobs.empty())
+		{
+			startScanWorkers();
+		}
+		else if (s_catalogDirty)
+		{
+			writeCatalog();
+		}
 	}
 
 	void modLoader_cleanupResources()
 	{
+		stopScanWorkers();
+		s_scans.clear();
 		for (size_t i = 0; i < s_mods.size(); i++)
 		{
 			if (s_mods[i].image.texture)
@@ -385,7 +508,7 @@ namespace TFE_FrontEndUI
 
 	void modLoader_preLoad()
 	{
-		readFromQueue(c_itemsPerFrame);
+		updateScans();
 	}
 		
 	bool modLoader_selectionUI()
@@ -393,8 +516,8 @@ namespace TFE_FrontEndUI
 		bool stayOpen = true;
 		f32 uiScale = (f32)TFE_Ui::getUiScale() * 0.01f;
 
-		// Load in the mod data a few at a time so to limit waiting for loading.
-		readFromQueue(c_itemsPerFrame);
+		// Add mods as they are scanned by the workers.
+		updateScans();
 		clearSelectedMod();
 		if (s_mods.empty()) { return stayOpen; }
 
@@ -578,7 +701,7 @@ namespace TFE_FrontEndUI
 		}
 	}
 
-	bool parseNameFromText(const char* textFileName, const char* path, char* name, std::string* fullText)
+	bool parseNameFromText(const char* textFileName, const char* path, char* name, std::string* fullText, std::vector<char>& fileBuffer)
 	{
 		if (!textFileName || textFileName[0] == 0) { return false; }
 
@@ -609,9 +732,9 @@ namespace TFE_FrontEndUI
 				if (txtIndex >= 0 && zipArchive.openFile(txtIndex))
 				{
 					textLen = zipArchive.getFileLength();
-					s_fileBuffer.resize(textLen + 1);
-					s_fileBuffer[0] = 0;
-					zipArchive.readFile(s_fileBuffer.data(), textLen);
+					fileBuffer.resize(textLen + 1);
+					fileBuffer[0] = 0;
+					zipArchive.readFile(fileBuffer.data(), textLen);
 					zipArchive.closeFile();
 				}
 			}
@@ -627,12 +750,12 @@ namespace TFE_FrontEndUI
 				return false;
 			}
 			textLen = textFile.getSize();
-			s_fileBuffer.resize(textLen + 1);
-			s_fileBuffer[0] = 0;
-			textFile.readBuffer(s_fileBuffer.data(), (u32)textLen);
+			fileBuffer.resize(textLen + 1);
+			fileBuffer[0] = 0;
+			textFile.readBuffer(fileBuffer.data(), (u32)textLen);
 			textFile.close();
 		}
-		if (!textLen || s_fileBuffer[0] == 0)
+		if (!textLen || fileBuffer[0] == 0)
 		{
 			return false;
 		}
@@ -640,9 +763,9 @@ namespace TFE_FrontEndUI
 		// Some files start with garbage at the beginning...
 		// So try a small probe first to see if such fixup is reqiured.
 		bool needsFixup = false;
-		for (size_t i = 0; i < 10 && i < s_fileBuffer.size(); i++)
+		for (size_t i = 0; i < 10 && i < fileBuffer.size(); i++)
 		{
-			if (s_fileBuffer[i] == 0)
+			if (fileBuffer[i] == 0)
 			{
 				needsFixup = true;
 				break;
@@ -652,8 +775,8 @@ namespace TFE_FrontEndUI
 		size_t lastZero = 0;
 		if (needsFixup)
 		{
-			size_t len = s_fileBuffer.size();
-			const char* text = s_fileBuffer.data();
+			size_t len = fileBuffer.size();
+			const char* text = fileBuffer.data();
 			for (size_t i = 0; i < len - 1 && i < 128; i++)
 			{
 				if (text[i] == 0)
@@ -663,7 +786,7 @@ namespace TFE_FrontEndUI
 			}
 			if (lastZero) { lastZero++; }
 		}
-		*fullText = std::string(s_fileBuffer.data() + lastZero, s_fileBuffer.data() + s_fileBuffer.size());
+		*fullText = std::string(fileBuffer.data() + lastZero, fileBuffer.data() + fileBuffer.size());
 
 		TFE_Parser parser;
 		parser.init(fullText->c_str(), fullText->length());
@@ -850,156 +973,307 @@ namespace TFE_FrontEndUI
 		}
 	}
 
-	void readFromQueue(size_t itemsPerFrame)
+	/////////////////////////////////////////////
+	// Scanning
+	// This runs on the scan worker threads, so
+	// only local archives and buffers are used.
+	/////////////////////////////////////////////
+	void scanDirectory(const QueuedRead& read, ModScanBuffers* buffers, ModScan* scan)
 	{
 		FileList gobFiles, txtFiles, imgFiles;
-		const size_t readEnd = min(s_readIndex + itemsPerFrame, s_readQueue.size());
-		const QueuedRead* reads = s_readQueue.data();
-		bool updateFilter = false;
-		for (size_t i = s_readIndex; i < readEnd; i++, s_readIndex++)
+		const char* subDir = read.path.c_str();
+		FileUtil::readDirectory(subDir, "gob", gobFiles);
+		FileUtil::readDirectory(subDir, "txt", txtFiles);
+		FileUtil::readDirectory(subDir, "jpg", imgFiles);
+
+		// No gob files = no mod.
+		if (gobFiles.size() != 1)
+		{
+			return;
+		}
+		scan->valid = true;
+		ModData& mod = scan->mod;
+
+		mod.gobFiles = gobFiles;
+		mod.textFile = txtFiles.empty() ? "" : txtFiles[0];
+		mod.imageFile = imgFiles.empty() ? "" : imgFiles[0];
+		mod.text = "";
+
+		size_t fullDirLen = strlen(subDir);
+		for (size_t i = 0; i < fullDirLen; i++)
 		{
-			updateFilter = true;
-			if (reads[i].type == QREAD_DIR)
+			if (strncasecmp("Mods", &subDir[i], 4) == 0)
 			{
-				// Clear doesn't deallocate in most implementations, so doing it this way should reduce memory allocations.
-				gobFiles.clear();
-				txtFiles.clear();
-				imgFiles.clear();
-
-				const char* subDir = reads[i].path.c_str();
-				FileUtil::readDirectory(subDir, "gob", gobFiles);
-				FileUtil::readDirectory(subDir, "txt", txtFiles);
-				FileUtil::readDirectory(subDir, "jpg", imgFiles);
-
-				// No gob files = no mod.
-				if (gobFiles.size() != 1)
-				{
-					continue;
-				}
-				s_mods.push_back({});
-				ModData& mod = s_mods.back();
+				mod.relativePath = &subDir[i + 5];
+				break;
+			}
+		}
 
-				mod.gobFiles = gobFiles;
-				mod.textFile = txtFiles.empty() ? "" : txtFiles[0];
-				mod.imageFile = imgFiles.empty() ? "" : imgFiles[0];
-				mod.text = "";
+		if (mod.imageFile.empty())
+		{
+			extractPosterFromMod(subDir, mod.gobFiles[0].c_str(), buffers, &scan->poster);
+			mod.invertImage = true;
+		}
+		else
+		{
+			extractPosterFromImage(subDir, nullptr, mod.imageFile.c_str(), buffers, &scan->poster);
+			mod.invertImage = false;
+		}
 
-				size_t fullDirLen = strlen(subDir);
-				for (size_t i = 0; i < fullDirLen; i++)
-				{
-					if (strncasecmp("Mods", &subDir[i], 4) == 0)
-					{
-						mod.relativePath = &subDir[i + 5];
-						break;
-					}
-				}
+		char name[TFE_MAX_PATH];
+		if (!parseNameFromText(mod.textFile.c_str(), subDir, name, &mod.text, buffers->text))
+		{
+			const char* gobFileName = mod.gobFiles[0].c_str();
+			memcpy(name, gobFileName, strlen(gobFileName) - 4);
+			name[strlen(gobFileName) - 4] = 0;
+			fixupName(name);
+		}
+		mod.name = name;
 
-				if (mod.imageFile.empty())
-				{
-					extractPosterFromMod(subDir, mod.gobFiles[0].c_str(), &mod.image);
-					mod.invertImage = true;
-				}
-				else
-				{
-					extractPosterFromImage(subDir, nullptr, mod.imageFile.c_str(), &mod.image);
-					mod.invertImage = false;
-				}
+		char gobPath[TFE_MAX_PATH];
+		sprintf(gobPath, "%s%s", subDir, mod.gobFiles[0].c_str());
+		scan->modifiedTime = FileUtil::getModifiedTime(gobPath);
+		scan->fileSize = FileUtil::getFileSize(gobPath);
+	}
 
-				char name[TFE_MAX_PATH];
-				if (!parseNameFromText(mod.textFile.c_str(), subDir, name, &mod.text))
-				{
-					const char* gobFileName = mod.gobFiles[0].c_str();
-					memcpy(name, gobFileName, strlen(gobFileName) - 4);
-					name[strlen(gobFileName) - 4] = 0;
-					fixupName(name);
-				}
+	void scanZip(const QueuedRead& read, ModScanBuffers* buffers, ModScan* scan)
+	{
+		const char* modPath = read.path.c_str();
+		const char* zipName = read.fileName.c_str();
+
+		char zipPath[TFE_MAX_PATH];
+		sprintf(zipPath, "%s%s", modPath, zipName);
+		// Invalid zip files are cached too, so they are not opened again until they change.
+		scan->modifiedTime = FileUtil::getModifiedTime(zipPath);
+		scan->fileSize = FileUtil::getFileSize(zipPath);
+
+		ZipArchive zipArchive;
+		if (!zipArchive.open(zipPath)) { return; }
+
+		s32 gobFileIndex = -1;
+		s32 txtFileIndex = -1;
+		s32 jpgFileIndex = -1;
+
+		// Look for the following:
+		// 1. Gob File.
+		// 2. Text File.
+		// 3. JPG
+		for (u32 f = 0; f < zipArchive.getFileCount(); f++)
+		{
+			const char* fileName = zipArchive.getFileName(f);
+			size_t len = strlen(fileName);
+			if (len <= 4)
+			{
+				continue;
+			}
+			const char* ext = &fileName[len - 3];
+			if (strcasecmp(ext, "gob") == 0)
+			{
+				gobFileIndex = s32(f);
+			}
+			else if (strcasecmp(ext, "txt") == 0)
+			{
+				txtFileIndex = s32(f);
+			}
+			else if (strcasecmp(ext, "jpg") == 0)
+			{
+				jpgFileIndex = s32(f);
+			}
+		}
+		if (gobFileIndex >= 0)
+		{
+			scan->valid = true;
+			ModData& mod = scan->mod;
+			mod.gobFiles.push_back(zipName);
+			mod.text = "";
 
-				mod.name = name;
+			char name[TFE_MAX_PATH];
+			if (!parseNameFromText(mod.gobFiles[0].c_str(), modPath, name, &mod.text, buffers->text))
+			{
+				const char* gobFileName = mod.gobFiles[0].c_str();
+				memcpy(name, gobFileName, strlen(gobFileName) - 4);
+				name[strlen(gobFileName) - 4] = 0;
+				fixupName(name);
+			}
+			mod.name = name;
+
+			if (jpgFileIndex < 0)
+			{
+				extractPosterFromMod(modPath, mod.gobFiles[0].c_str(), buffers, &scan->poster);
+				mod.invertImage = true;
 			}
 			else
 			{
-				ZipArchive zipArchive;
-				const char* modPath = reads[i].path.c_str();
-				const char* zipName = reads[i].fileName.c_str();
-
-				char zipPath[TFE_MAX_PATH];
-				sprintf(zipPath, "%s%s", modPath, zipName);
-				if (!zipArchive.open(zipPath)) { continue; }
-
-				s32 gobFileIndex = -1;
-				s32 txtFileIndex = -1;
-				s32 jpgFileIndex = -1;
-
-				// Look for the following:
-				// 1. Gob File.
-				// 2. Text File.
-				// 3. JPG
-				for (u32 f = 0; f < zipArchive.getFileCount(); f++)
-				{
-					const char* fileName = zipArchive.getFileName(f);
-					size_t len = strlen(fileName);
-					if (len <= 4)
-					{
-						continue;
-					}
-					const char* ext = &fileName[len - 3];
-					if (strcasecmp(ext, "gob") == 0)
-					{
-						gobFileIndex = s32(f);
-					}
-					else if (strcasecmp(ext, "txt") == 0)
-					{
-						txtFileIndex = s32(f);
-					}
-					else if (strcasecmp(ext, "jpg") == 0)
-					{
-						jpgFileIndex = s32(f);
-					}
-				}
-				if (gobFileIndex >= 0)
-				{
-					s_mods.push_back({});
-					ModData& mod = s_mods.back();
-					mod.gobFiles.push_back(zipName);
-					mod.text = "";
+				extractPosterFromImage(modPath, mod.gobFiles[0].c_str(), zipArchive.getFileName(jpgFileIndex), buffers, &scan->poster);
+				mod.invertImage = false;
+			}
+		}
 
-					char name[TFE_MAX_PATH];
-					if (!parseNameFromText(mod.gobFiles[0].c_str(), modPath, name, &mod.text))
-					{
-						const char* gobFileName = mod.gobFiles[0].c_str();
-						memcpy(name, gobFileName, strlen(gobFileName) - 4);
-						name[strlen(gobFileName) - 4] = 0;
-						fixupName(name);
-					}
-					mod.name = name;
+		zipArchive.close();
+	}
 
-					if (jpgFileIndex < 0)
-					{
-						extractPosterFromMod(modPath, mod.gobFiles[0].c_str(), &mod.image);
-						mod.invertImage = true;
-					}
-					else
-					{
-						extractPosterFromImage(modPath, mod.gobFiles[0].c_str(), zipArchive.getFileName(jpgFileIndex), &mod.image);
-						mod.invertImage = false;
-					}
-				}
+	int scanWorkerThread(void* userData)
+	{
+		TFE_THREAD_NAME("Mod Scan");
+		ModScanBuffers buffers;
+		while (!s_scanCancel.load())
+		{
+			const u32 job = s_scanNext.fetch_add(1u);
+			if (job >= s_scanJobs.size()) { break; }
 
-				zipArchive.close();
+			const size_t index = s_scanJobs[job];
+			const QueuedRead& read = s_readQueue[index];
+			ModScan* scan = &s_scans[index];
+			if (read.type == QREAD_DIR)
+			{
+				scanDirectory(read, &buffers, scan);
 			}
+			else
+			{
+				scanZip(read, &buffers, scan);
+			}
+
+			SDL_LockMutex(s_scanMutex);
+			s_scanDone.push_back(index);
+			SDL_UnlockMutex(s_scanMutex);
+		}
+		return 0;
+	}
+
+	void startScanWorkers()
+	{
+		if (!s_scanMutex)
+		{
+			s_scanMutex = SDL_CreateMutex();
+		}
+		s_scanDone.clear();
+		s_scanPending = s_scanJobs.size();
+		s_scanNext.store(0u);
+		s_scanCancel.store(false);
+
+		// Leave a core for the main thread.
+		const s32 threadCount = std::max(1, std::min((s32)MAX_SCAN_THREADS, std::min(SDL_GetCPUCount() - 1, s32(s_scanJobs.size()))));
+		s_scanThreadCount = 0;
+		for (s32 i = 0; i < threadCount; i++)
+		{
+			s_scanThreads[s_scanThreadCount] = SDL_CreateThread(scanWorkerThread, "TFE_ModScan", nullptr);
+			if (s_scanThreads[s_scanThreadCount])
+			{
+				s_scanThreadCount++;
+			}
+		}
+		if (!s_scanThreadCount)
+		{
+			// Scan on the main thread if no workers can be created.
+			TFE_System::logWrite(LOG_WARNING, "ModLoader", "Cannot create mod scan threads, scanning on the main thread.");
+			scanWorkerThread(nullptr);
+		}
+		TFE_System::logWrite(LOG_MSG, "ModLoader", "Scanning %zu mods with %d threads.", s_scanJobs.size(), s_scanThreadCount);
+	}
+
+	void stopScanWorkers()
+	{
+		s_scanCancel.store(true);
+		for (s32 i = 0; i < s_scanThreadCount; i++)
+		{
+			SDL_WaitThread(s_scanThreads[i], nullptr);
+			s_scanThreads[i] = nullptr;
+		}
+		s_scanThreadCount = 0;
+		s_scanJobs.clear();
+		s_scanDone.clear();
+		s_scanPending = 0;
+	}
+
+	// Add the results of finished scans to the mod list, this must be called on the main thread.
+	void updateScans()
+	{
+		if (!s_scanPending) { return; }
+
+		static std::vector<size_t> done;
+		done.clear();
+		SDL_LockMutex(s_scanMutex);
+		done.swap(s_scanDone);
+		SDL_UnlockMutex(s_scanMutex);
+		if (done.empty()) { return; }
+
+		const size_t count = done.size();
+		char stampPath[TFE_MAX_PATH];
+		for (size_t i = 0; i < count; i++)
+		{
+			addMod(s_scans[done[i]]);
+			// Directories that are not mods are not cached, so they don't require a catalog update.
+			s_catalogDirty |= getStampPath(s_readQueue[done[i]], s_scans[done[i]], stampPath);
+		}
+		s_scanPending -= count;
+
+		if (!s_scanPending)
+		{
+			stopScanWorkers();
+			writeCatalog();
 		}
 
-		// Update the filtered list.
-		if (updateFilter)
+		// Only sort once the full list is loaded, otherwise the entries constantly suffle around since the name sorting doesn't
+		// match file name sorting very well.
+		filterMods(s_viewMode != VIEW_FILE_LIST, /*sort*/!s_scanPending || s_viewMode == VIEW_FILE_LIST);
+	}
+
+	void addMod(ModScan& scan)
+	{
+		if (!scan.valid) { return; }
+
+		s_mods.push_back(scan.mod);
+		ModData& mod = s_mods.back();
+		mod.image = {};
+		if (!scan.poster.pixels.empty())
 		{
-			// Only sort once the full list is loaded, otherwise the entries constantly suffle around since the name sorting doesn't
-			// match file name sorting very well.
-			filterMods(s_viewMode != VIEW_FILE_LIST, /*sort*/s_readIndex == s_readQueue.size() || s_viewMode == VIEW_FILE_LIST);
+			mod.image.texture = TFE_RenderBackend::createTexture(scan.poster.width, scan.poster.height, scan.poster.pixels.data(), MAG_FILTER_LINEAR);
+			mod.image.width = scan.poster.width;
+			mod.image.height = scan.poster.height;
 		}
 	}
 
-	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, UiTexture* poster)
+	// Box filter the image down so it fits in POSTER_MAX_WIDTH x POSTER_MAX_HEIGHT.
+	void downscalePoster(const u32* image, u32 width, u32 height, ModPoster* poster)
 	{
+		if (!width || !height) { return; }
+
+		poster->width  = std::min(width,  (u32)POSTER_MAX_WIDTH);
+		poster->height = std::min(height, (u32)POSTER_MAX_HEIGHT);
+		poster->pixels.resize(poster->width * poster->height);
+
+		u32* dst = poster->pixels.data();
+		for (u32 y = 0; y < poster->height; y++)
+		{
+			const u32 y0 = y * height / poster->height;
+			const u32 y1 = std::max(y0 + 1, (y + 1) * height / poster->height);
+			for (u32 x = 0; x < poster->width; x++, dst++)
+			{
+				const u32 x0 = x * width / poster->width;
+				const u32 x1 = std::max(x0 + 1, (x + 1) * width / poster->width);
+
+				u32 sum[4] = { 0 };
+				for (u32 sy = y0; sy < y1; sy++)
+				{
+					const u32* src = &image[sy * width];
+					for (u32 sx = x0; sx < x1; sx++)
+					{
+						sum[0] += (src[sx]) & 0xff;
+						sum[1] += (src[sx] >> 8u) & 0xff;
+						sum[2] += (src[sx] >> 16u) & 0xff;
+						sum[3] += (src[sx] >> 24u) & 0xff;
+					}
+				}
+				const u32 area = (x1 - x0) * (y1 - y0);
+				*dst = (sum[0] / area) | ((sum[1] / area) << 8u) | ((sum[2] / area) << 16u) | ((sum[3] / area) << 24u);
+			}
+		}
+	}
+
+	void extractPosterFromImage(const char* baseDir, const char* zipFile, const char* imageFileName, ModScanBuffers* buffers, ModPoster* poster)
+	{
+		std::vector<u8>& imageBuffer = buffers->image;
+		imageBuffer.clear();
 		if (zipFile && zipFile[0])
 		{
 			char zipPath[TFE_MAX_PATH];
@@ -1010,57 +1284,49 @@ namespace TFE_FrontEndUI
 			if (zipArchive.openFile(imageFileName))
 			{
 				size_t imageSize = zipArchive.getFileLength();
-				s_imageBuffer.resize(imageSize);
-				zipArchive.readFile(s_imageBuffer.data(), imageSize);
+				imageBuffer.resize(imageSize);
+				zipArchive.readFile(imageBuffer.data(), imageSize);
 				zipArchive.closeFile();
-
-				SDL_Surface* image = TFE_Image::loadFromMemory((u8*)s_imageBuffer.data(), imageSize);
-				if (image)
-				{
-					TextureGpu* gpuImage = TFE_RenderBackend::createTexture(image->w, image->h, (u32*)image->pixels, MAG_FILTER_LINEAR);
-					poster->texture = gpuImage;
-					poster->width = image->w;
-					poster->height = image->h;
-
-					TFE_Image::free(image);
-				}
 			}
 			zipArchive.close();
 		}
 		else
 		{
+			// Read the file directly rather than going through the image cache, which is not thread safe.
 			char imagePath[TFE_MAX_PATH];
 			sprintf(imagePath, "%s%s", baseDir, imageFileName);
 
-			SDL_Surface* image = TFE_Image::get(imagePath);
-			if (image)
+			FileStream file;
+			if (file.open(imagePath, Stream::MODE_READ))
 			{
-				TextureGpu* gpuImage = TFE_RenderBackend::createTexture(image->w, image->h, (u32*)image->pixels, MAG_FILTER_LINEAR);
-				poster->texture = gpuImage;
-				poster->width = image->w;
-				poster->height = image->h;
+				imageBuffer.resize(file.getSize());
+				file.readBuffer(imageBuffer.data(), u32(imageBuffer.size()));
+				file.close();
 			}
 		}
+		if (imageBuffer.empty()) { return; }
+
+		SDL_Surface* image = TFE_Image::loadFromMemory(imageBuffer.data(), imageBuffer.size());
+		if (image)
+		{
+			downscalePoster((u32*)image->pixels, image->w, image->h, poster);
+			TFE_Image::free(image);
+		}
 	}
 
-	void extractPosterFromMod(const char* baseDir, const char* archiveFileName, UiTexture* poster)
+	void extractPosterFromMod(const char* baseDir, const char* archiveFileName, ModScanBuffers* buffers, ModPoster* poster)
 	{
 		// Extract a "poster", if possible, from the GOB file.
-		// And then save it as a JPG in /ProgramData/TheForceEngine/ModPosters/NAME.jpg
-		char modPath[TFE_MAX_PATH], srcPath[TFE_MAX_PATH], srcPathTex[TFE_MAX_PATH];
+		char modPath[TFE_MAX_PATH];
 		sprintf(modPath, "%s%s", baseDir, archiveFileName);
-		sprintf(srcPath, "%s%s", TFE_Paths::getPath(PATH_SOURCE_DATA), "DARK.GOB");
-		sprintf(srcPathTex, "%s%s", TFE_Paths::getPath(PATH_SOURCE_DATA), "TEXTURES.GOB");
 
+		GobArchive gobArchive;
 		GobMemoryArchive gobMemArchive;
 		const size_t len = strlen(archiveFileName);
 		const char* archiveExt = &archiveFileName[len - 3];
 		Archive* archiveMod = nullptr;
-		bool archiveIsGob = true;
 		if (strcasecmp(archiveExt, "zip") == 0)
 		{
-			archiveIsGob = false;
-
 			ZipArchive zipArchive;
 			if (zipArchive.open(modPath))
 			{
@@ -1094,6 +1360,7 @@ namespace TFE_FrontEndUI
 					}
 					else
 					{
+						free(buffer);
 						TFE_System::logWrite(LOG_ERROR, "ModLoader", "Cannot open zip: '%s'", modPath);
 					}
 				}
@@ -1101,55 +1368,235 @@ namespace TFE_FrontEndUI
 				zipArchive.close();
 			}
 		}
-		else
+		else if (gobArchive.open(modPath))
 		{
-			archiveMod = Archive::getArchive(ARCHIVE_GOB, archiveFileName, modPath);
+			// Use a local archive rather than the shared archive list, which is not thread safe.
+			archiveMod = &gobArchive;
 		}
-		Archive* archiveTex = Archive::getArchive(ARCHIVE_GOB, "TEXTURES.GOB", srcPathTex);
-		Archive* archiveBase = Archive::getArchive(ARCHIVE_GOB, "DARK.GOB", srcPath);
 
-		s_readBuffer[0].clear();
-		s_readBuffer[1].clear();
-		if (archiveMod || archiveBase)
+		const char* fileNames[2] = { "wait.bm", "wait.pal" };
+		const u8* data[2];
+		size_t size[2];
+		for (s32 i = 0; i < 2; i++)
 		{
-			if (archiveMod && archiveMod->fileExists("wait.bm") && archiveMod->openFile("wait.bm"))
+			std::vector<u8>& readBuffer = buffers->read[i];
+			readBuffer.clear();
+			if (archiveMod && archiveMod->fileExists(fileNames[i]) && archiveMod->openFile(fileNames[i]))
 			{
-				s_readBuffer[0].resize(archiveMod->getFileLength());
-				archiveMod->readFile(s_readBuffer[0].data(), archiveMod->getFileLength());
+				readBuffer.resize(archiveMod->getFileLength());
+				archiveMod->readFile(readBuffer.data(), archiveMod->getFileLength());
 				archiveMod->closeFile();
 			}
-			else if (archiveTex->openFile("wait.bm"))
-			{
-				s_readBuffer[0].resize(archiveTex->getFileLength());
-				archiveTex->readFile(s_readBuffer[0].data(), archiveTex->getFileLength());
-				archiveTex->closeFile();
-			}
+			const std::vector<u8>& src = readBuffer.empty() ? s_defaultPoster[i] : readBuffer;
+			data[i] = src.data();
+			size[i] = src.size();
+		}
+		if (!size[0] || !size[1]) { return; }
+
+		TextureData* imageData = bitmap_loadFromMemory(data[0], size[0], 1);
+		if (imageData)
+		{
+			u32 palette[256];
+			convertPalette(data[1], palette);
+			buffers->pixels.resize(imageData->width * imageData->height);
+			convertDfTextureToTrueColor(imageData, palette, buffers->pixels.data());
+			downscalePoster(buffers->pixels.data(), imageData->width, imageData->height, poster);
+
+			free(imageData->image);
+			free(imageData->columns);
+			free(imageData);
+		}
+	}
+
+	/////////////////////////////////////////////
+	// Catalog
+	// The scan results are cached on disk, keyed
+	// by the mod path and validated by the
+	// modified time and size of the mod file.
+	/////////////////////////////////////////////
+	void getCatalogPath(char* path)
+	{
+		char cacheDir[TFE_MAX_PATH];
+		TFE_Paths::appendPath(PATH_PROGRAM_DATA, "Cache/", cacheDir);
+		FileUtil::makeDirectory(cacheDir);
+		sprintf(path, "%smodCatalog.cache", cacheDir);
+	}
+
+	void getCatalogKey(const QueuedRead& read, char* key)
+	{
+		sprintf(key, "%s%s", read.path.c_str(), read.fileName.c_str());
+	}
+
+	// Get the file used to detect changes: the zip file or the gob inside of the mod directory.
+	bool getStampPath(const QueuedRead& read, const ModScan& scan, char* path)
+	{
+		if (read.type == QREAD_ZIP)
+		{
+			sprintf(path, "%s%s", read.path.c_str(), read.fileName.c_str());
+			return true;
+		}
+		else if (scan.valid && !scan.mod.gobFiles.empty())
+		{
+			sprintf(path, "%s%s", read.path.c_str(), scan.mod.gobFiles[0].c_str());
+			return true;
+		}
+		// Directories without a mod are always scanned again, which is cheap.
+		return false;
+	}
+
+	void writeCatalogString(FileStream& file, const std::string& str)
+	{
+		const u32 len = u32(str.length());
+		file.writeBuffer(&len, sizeof(u32));
+		if (len) { file.writeBuffer(str.data(), len); }
+	}
+
+	void writeCatalog()
+	{
+		if (!s_catalogDirty) { return; }
+		s_catalogDirty = false;
+
+		char path[TFE_MAX_PATH];
+		getCatalogPath(path);
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "ModLoader", "Cannot write the mod catalog '%s'.", path);
+			return;
+		}
 
-			if (archiveMod && archiveMod->fileExists("wait.pal") && archiveMod->openFile("wait.pal"))
+		const u32 version = MCVER_CUR;
+		u32 count = 0;
+		char stampPath[TFE_MAX_PATH];
+		for (size_t i = 0; i < s_scans.size(); i++)
+		{
+			count += getStampPath(s_readQueue[i], s_scans[i], stampPath) ? 1 : 0;
+		}
+		file.writeBuffer(c_modCatalogSig, 4);
+		file.writeBuffer(&version, sizeof(u32));
+		file.writeBuffer(&count, sizeof(u32));
+
+		for (size_t i = 0; i < s_scans.size(); i++)
+		{
+			const ModScan& scan = s_scans[i];
+			if (!getStampPath(s_readQueue[i], scan, stampPath)) { continue; }
+
+			char key[TFE_MAX_PATH];
+			getCatalogKey(s_readQueue[i], key);
+			writeCatalogString(file, key);
+			file.writeBuffer(&scan.modifiedTime, sizeof(u64));
+			file.writeBuffer(&scan.fileSize, sizeof(u64));
+
+			const u8 valid = scan.valid ? 1 : 0;
+			file.writeBuffer(&valid, 1);
+			if (!valid) { continue; }
+
+			const ModData& mod = scan.mod;
+			const u32 gobCount = u32(mod.gobFiles.size());
+			file.writeBuffer(&gobCount, sizeof(u32));
+			for (u32 g = 0; g < gobCount; g++)
 			{
-				s_readBuffer[1].resize(archiveMod->getFileLength());
-				archiveMod->readFile(s_readBuffer[1].data(), archiveMod->getFileLength());
-				archiveMod->closeFile();
+				writeCatalogString(file, mod.gobFiles[g]);
 			}
-			else if (archiveBase->openFile("wait.pal"))
+			writeCatalogString(file, mod.textFile);
+			writeCatalogString(file, mod.imageFile);
+			writeCatalogString(file, mod.name);
+			writeCatalogString(file, mod.relativePath);
+			writeCatalogString(file, mod.text);
+
+			const u8 invertImage = mod.invertImage ? 1 : 0;
+			file.writeBuffer(&invertImage, 1);
+			file.writeBuffer(&scan.poster.width, sizeof(u32));
+			file.writeBuffer(&scan.poster.height, sizeof(u32));
+			if (!scan.poster.pixels.empty())
 			{
-				s_readBuffer[1].resize(archiveBase->getFileLength());
-				archiveBase->readFile(s_readBuffer[1].data(), archiveBase->getFileLength());
-				archiveBase->closeFile();
+				file.writeBuffer(scan.poster.pixels.data(), u32(scan.poster.pixels.size() * sizeof(u32)));
 			}
 		}
+		file.close();
+	}
+
+	// Reads from the in-memory catalog, returns false if reading past the end.
+	bool readCatalogData(const std::vector<u8>& data, size_t& offset, void* dst, size_t size)
+	{
+		if (offset + size > data.size()) { return false; }
+		memcpy(dst, data.data() + offset, size);
+		offset += size;
+		return true;
+	}
+
+	bool readCatalogString(const std::vector<u8>& data, size_t& offset, std::string& str)
+	{
+		u32 len;
+		if (!readCatalogData(data, offset, &len, sizeof(u32)) || offset + len > data.size()) { return false; }
+		str.assign((const char*)data.data() + offset, len);
+		offset += len;
+		return true;
+	}
 
-		if (!s_readBuffer[0].empty() && !s_readBuffer[1].empty())
+	void readCatalog(std::unordered_map<std::string, ModScan>& catalog)
+	{
+		char path[TFE_MAX_PATH];
+		getCatalogPath(path);
+		FileStream file;
+		if (!file.open(path, Stream::MODE_READ)) { return; }
+
+		// Read the whole catalog at once and then parse it.
+		std::vector<u8> data(file.getSize());
+		file.readBuffer(data.data(), u32(data.size()));
+		file.close();
+
+		size_t offset = 0;
+		char sig[4];
+		u32 version, count;
+		if (!readCatalogData(data, offset, sig, 4) || memcmp(sig, c_modCatalogSig, 4) != 0 ||
+			!readCatalogData(data, offset, &version, sizeof(u32)) || version != MCVER_CUR ||
+			!readCatalogData(data, offset, &count, sizeof(u32)))
 		{
-			TextureData* imageData = bitmap_loadFromMemory(s_readBuffer[0].data(), s_readBuffer[0].size(), 1);
-			u32 palette[256];
-			convertPalette(s_readBuffer[1].data(), palette);
-			createTexture(imageData, palette, poster, MAG_FILTER_LINEAR);
+			return;
 		}
 
-		if (archiveMod && archiveIsGob)
+		std::string key;
+		for (u32 i = 0; i < count; i++)
 		{
-			Archive::freeArchive(archiveMod);
+			ModScan scan;
+			u8 valid;
+			if (!readCatalogString(data, offset, key) ||
+				!readCatalogData(data, offset, &scan.modifiedTime, sizeof(u64)) ||
+				!readCatalogData(data, offset, &scan.fileSize, sizeof(u64)) ||
+				!readCatalogData(data, offset, &valid, 1))
+			{
+				break;
+			}
+			scan.valid = valid != 0;
+			if (scan.valid)
+			{
+				ModData& mod = scan.mod;
+				u32 gobCount;
+				if (!readCatalogData(data, offset, &gobCount, sizeof(u32)) || !gobCount) { break; }
+				mod.gobFiles.resize(gobCount);
+
+				bool success = true;
+				for (u32 g = 0; g < gobCount && success; g++)
+				{
+					success = readCatalogString(data, offset, mod.gobFiles[g]);
+				}
+				u8 invertImage;
+				success = success && readCatalogString(data, offset, mod.textFile) && readCatalogString(data, offset, mod.imageFile) &&
+					readCatalogString(data, offset, mod.name) && readCatalogString(data, offset, mod.relativePath) &&
+					readCatalogString(data, offset, mod.text) && readCatalogData(data, offset, &invertImage, 1) &&
+					readCatalogData(data, offset, &scan.poster.width, sizeof(u32)) && readCatalogData(data, offset, &scan.poster.height, sizeof(u32)) &&
+					scan.poster.width <= POSTER_MAX_WIDTH && scan.poster.height <= POSTER_MAX_HEIGHT;
+				if (!success) { break; }
+				mod.invertImage = invertImage != 0;
+
+				scan.poster.pixels.resize(scan.poster.width * scan.poster.height);
+				if (!scan.poster.pixels.empty() && !readCatalogData(data, offset, scan.poster.pixels.data(), scan.poster.pixels.size() * sizeof(u32)))
+				{
+					break;
+				}
+			}
+			catalog[key] = std::move(scan);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -9,19 +9,50 @@
 #include <TFE_Ui/ui.h>
 #include <TFE_Ui/markdown.h>
 #include <TFE_System/parser.h>
+#include <TFE_FrontEndUI/console.h>
 
 #include <TFE_Ui/imGUI/imgui.h>
 #include <algorithm>
+#include <ctime>
 
 namespace TFE_ProfilerView
 {
 	static bool s_open = false;
 
+	void profilerCaptureConsole(const ConsoleArgList& args);
+
 	bool init()
 	{
+		CCMD("profilerCapture", profilerCaptureConsole, 0, "Capture a Chrome trace (JSON) of the next N frames to Documents/Traces, default N = 10 - profilerCapture [frames]");
 		return true;
 	}
 
+	void profilerCaptureConsole(const ConsoleArgList& args)
+	{
+		const u32 frameCount = args.size() >= 2 ? u32(std::max(1.0f, TFE_Console::getFloatArg(args[1]))) : 10u;
+
+		char traceDir[TFE_MAX_PATH];
+		TFE_Paths::appendPath(TFE_PathType::PATH_USER_DOCUMENTS, "Traces/", traceDir);
+		FileUtil::makeDirectory(traceDir);
+
+		char dateTime[64];
+		const time_t curTime = time(nullptr);
+		strftime(dateTime, sizeof(dateTime), "%Y%m%d_%H%M%S", localtime(&curTime));
+
+		char tracePath[TFE_MAX_PATH];
+		snprintf(tracePath, TFE_MAX_PATH, "%stfe_trace_%s.json", traceDir, dateTime);
+		if (TFE_Profiler::beginCapture(frameCount, tracePath))
+		{
+			char res[TFE_MAX_PATH];
+			snprintf(res, TFE_MAX_PATH, "Capturing %u frames to '%s'.", frameCount, tracePath);
+			TFE_Console::addToHistory(res);
+		}
+		else
+		{
+			TFE_Console::addToHistory("A trace capture is already in progress.");
+		}
+	}
+
 	void destroy()
 	{
 	}
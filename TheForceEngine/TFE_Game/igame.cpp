@@ -1,7 +1,10 @@
 #include "igame.h"
+#include "saveSystem.h"
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_DarkForces/darkForcesMain.h>
 #include <TFE_Outlaws/outlawsMain.h>
+#include <TFE_System/system.h>
+#include <algorithm>
 
 enum GameConstants
 {
@@ -31,12 +34,80 @@ void displayMemoryUsage(const ConsoleArgList& args)
 	TFE_Console::addToHistory("-------------------------------------------------------------------");
 }
 
+MemoryRegion* getRegionArg(const ConsoleArgList& args)
+{
+	if (args.size() >= 2 && strcasecmp(args[1].c_str(), "game") == 0)
+	{
+		return s_gameRegion;
+	}
+	return s_levelRegion;
+}
+
+void displayMemoryStats(const ConsoleArgList& args)
+{
+	MemoryRegion* region = getRegionArg(args);
+	MemoryRegionStats stats;
+	region_getStats(region, &stats);
+
+	char res[256];
+	TFE_Console::addToHistory("-------------------------------------------------------------------");
+	sprintf(res, "%s region: %zu used, %zu peak, %zu capacity, %u allocations", region == s_gameRegion ? "Game" : "Level", stats.used, stats.peakUsed, stats.capacity, stats.allocCount);
+	TFE_Console::addToHistory(res);
+	sprintf(res, "Free: %zu bytes, largest range %zu, fragmentation %0.1f%%", stats.freeBytes, stats.largestFree, stats.fragmentation * 100.0f);
+	TFE_Console::addToHistory(res);
+	for (s32 b = 0; b < REGION_BIN_COUNT; b++)
+	{
+		sprintf(res, "  Bin %d: %u free ranges, %zu bytes", b, stats.binFreeCount[b], stats.binFreeBytes[b]);
+		TFE_Console::addToHistory(res);
+	}
+	for (s32 c = 0; c < REGION_SLAB_CLASS_COUNT; c++)
+	{
+		sprintf(res, "  Slab %2u bytes: %u slabs, %u slots used, %u free", stats.slabSlotSize[c], stats.slabCount[c], stats.slabSlotsUsed[c], stats.slabSlotsFree[c]);
+		TFE_Console::addToHistory(res);
+	}
+	TFE_Console::addToHistory("-------------------------------------------------------------------");
+}
+
+void memoryTrace(const ConsoleArgList& args)
+{
+	MemoryRegion* region = getRegionArg(args);
+	region_beginTrace(region);
+	TFE_Console::addToHistory("Recording allocations, run memoryBenchmark to stop and replay them.");
+}
+
+void memoryBenchmark(const ConsoleArgList& args)
+{
+	MemoryRegion* region = getRegionArg(args);
+	const s32 runCount = args.size() >= 3 ? std::max(1, s32(TFE_Console::getFloatArg(args[2]))) : 10;
+	region_endTrace(region);
+
+	MemoryRegionBenchmark result;
+	if (!region_benchmarkTrace(region, runCount, &result))
+	{
+		TFE_Console::addToHistory("memoryBenchmark - no allocations have been recorded, use memoryTrace first.");
+		return;
+	}
+
+	char res[256];
+	sprintf(res, "memoryBenchmark - %zu operations, %d runs:", result.opCount, result.runCount);
+	TFE_Console::addToHistory(res);
+	sprintf(res, "  malloc:            %0.3f ms per run", result.mallocTime * 1000.0 / f64(runCount));
+	TFE_Console::addToHistory(res);
+	sprintf(res, "  region:            %0.3f ms per run, %zu bytes peak", result.regionTime * 1000.0 / f64(runCount), result.regionPeak);
+	TFE_Console::addToHistory(res);
+	sprintf(res, "  region with slabs: %0.3f ms per run, %zu bytes peak", result.slabTime * 1000.0 / f64(runCount), result.slabPeak);
+	TFE_Console::addToHistory(res);
+}
+
 void game_init()
 {
 	s_gameRegion  = region_create("game",  GAME_MEMORY_BASE);	// Region for "permanent" game allocations.
 	s_levelRegion = region_create("level", LEVEL_MEMORY_BASE);	// Region for "per-level" game allocations.
 
 	CCMD("displayMemoryUsage", displayMemoryUsage, 0, "Display memory usage.");
+	CCMD("displayMemoryStats", displayMemoryStats, 0, "Display the free ranges, fragmentation and slabs of a region, default = level - displayMemoryStats [game|level]");
+	CCMD("memoryTrace", memoryTrace, 0, "Record the allocations made in a region, for example while loading a level, default = level - memoryTrace [game|level]");
+	CCMD("memoryBenchmark", memoryBenchmark, 0, "Stop recording and replay the allocations N times with malloc and in new regions, default N = 10 - memoryBenchmark [game|level] [count]");
 }
 
 void game_destroy()
@@ -79,6 +150,8 @@ void freeGame(IGame* game)
 {
 	if (game)
 	{
+		// Make sure the save completion is reported before the game goes away.
+		TFE_SaveSystem::flushSaves();
 		game->exitGame();
 		delete game;
 	}
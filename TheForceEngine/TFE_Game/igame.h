@@ -28,9 +28,19 @@ struct IGame
 	virtual void loopGame() {};
 	virtual bool serializeGameState(Stream* stream, const char* filename, bool writeState) { return false; };
 	virtual bool canSave() { return false; }
+	// Called on the game thread once a save has been written (or failed).
+	virtual void saveComplete(const char* filename, bool success) {};
 	virtual bool isPaused() { return false; }
 	virtual void getLevelName(char* name) {};
 	virtual void getModList(char* modList) {};
+	// Input replay: the game random seed and a hash of the current game state used to detect desyncs.
+	virtual u32  getRandomSeed() { return 0; }
+	virtual void setRandomSeed(u32 seed) {};
+	virtual u32  getStateHash() { return 0; }
+	// The current game tick, used to schedule rewind snapshots.
+	virtual u32  getGameTick() { return 0; }
+	// Register the game state outside of the game and level regions with the rewind buffer.
+	virtual void registerRewindState() {};
 
 	GameID id;
 };
@@ -0,0 +1,344 @@
+#include "inputReplay.h"
+#include <TFE_Input/input.h>
+#include <TFE_System/system.h>
+#include <TFE_FileSystem/filestream.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace TFE_Input;
+
+namespace TFE_InputReplay
+{
+	enum ReplayVersion
+	{
+		RVER_INIT = 1,
+		RVER_CUR = RVER_INIT
+	};
+
+	enum ReplayFrameFlags
+	{
+		RFRAME_SEED = FLAG_BIT(0),	// The game was created this frame, with the recorded random seed.
+		RFRAME_HASH = FLAG_BIT(1),	// The frame includes a game state hash.
+	};
+
+	static const char c_replayHdr[4] = { 'T', 'F', 'E', 'R' };
+
+	static ReplayMode s_mode = REPLAY_NONE;
+	static FileStream s_file;
+	static bool s_recordHash = false;
+	static u32  s_frameCount = 0;
+	static u32  s_totalFrames = 0;
+
+	// Current frame.
+	static InputState s_prevInput;
+	static InputState s_curInput;
+	static u8  s_frameFlags = 0;
+	static f64 s_frameTime = 0.0;
+	static f64 s_frameDt = 0.0;
+	static u32 s_frameSeed = 0;
+	static u32 s_frameHash = 0;
+
+	// Timing.
+	static u64 s_frameStart = 0;
+	static f64 s_frameTaskTime = 0.0;
+	static std::vector<f64> s_frameTimes;
+	static std::vector<f64> s_taskTimes;
+	static u32 s_hashMismatchCount = 0;
+	static u32 s_firstMismatchFrame = 0;
+
+	void writeFrame();
+	bool readFrame();
+	void reportTimings();
+
+	/////////////////////////////////////////////
+	// API Implementation
+	/////////////////////////////////////////////
+	bool startRecording(const char* filename, bool recordStateHash)
+	{
+		stop();
+		if (!s_file.open(filename, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Replay", "Cannot open '%s' for recording.", filename);
+			return false;
+		}
+
+		const u32 version = RVER_CUR;
+		const u32 frameCount = 0;
+		s_file.writeBuffer(c_replayHdr, 4);
+		s_file.write(&version);
+		// The frame count is filled in when recording stops.
+		s_file.write(&frameCount);
+
+		s_mode = REPLAY_RECORD;
+		s_recordHash = recordStateHash;
+		s_frameCount = 0;
+		s_prevInput = {};
+		s_frameFlags = 0;
+		TFE_System::logWrite(LOG_MSG, "Replay", "Recording input to '%s'.", filename);
+		return true;
+	}
+
+	bool startPlayback(const char* filename)
+	{
+		stop();
+		if (!s_file.open(filename, Stream::MODE_READ))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Replay", "Cannot open replay '%s'.", filename);
+			return false;
+		}
+
+		char hdr[4];
+		u32 version;
+		s_file.readBuffer(hdr, 4);
+		s_file.read(&version);
+		s_file.read(&s_totalFrames);
+		if (memcmp(hdr, c_replayHdr, 4) != 0 || version > RVER_CUR)
+		{
+			TFE_System::logWrite(LOG_ERROR, "Replay", "'%s' is not a valid replay.", filename);
+			s_file.close();
+			return false;
+		}
+
+		s_mode = REPLAY_PLAYBACK;
+		s_frameCount = 0;
+		s_prevInput = {};
+		s_frameFlags = 0;
+		s_frameTimes.clear();
+		s_taskTimes.clear();
+		s_frameTimes.reserve(s_totalFrames);
+		s_taskTimes.reserve(s_totalFrames);
+		s_hashMismatchCount = 0;
+		s_firstMismatchFrame = 0;
+		TFE_System::logWrite(LOG_MSG, "Replay", "Playing back '%s', %u frames.", filename, s_totalFrames);
+		return true;
+	}
+
+	void stop()
+	{
+		if (s_mode == REPLAY_RECORD)
+		{
+			s_file.seek(8);
+			s_file.write(&s_frameCount);
+			TFE_System::logWrite(LOG_MSG, "Replay", "Recorded %u frames.", s_frameCount);
+		}
+		else if (s_mode == REPLAY_PLAYBACK)
+		{
+			reportTimings();
+			TFE_System::clearFrameTime();
+		}
+
+		if (s_mode != REPLAY_NONE)
+		{
+			s_file.close();
+		}
+		s_mode = REPLAY_NONE;
+	}
+
+	ReplayMode getMode()
+	{
+		return s_mode;
+	}
+
+	void beginFrame()
+	{
+		if (s_mode == REPLAY_NONE) { return; }
+
+		s_frameStart = TFE_System::getCurrentTimeInTicks();
+		s_frameTaskTime = 0.0;
+		if (s_mode == REPLAY_RECORD)
+		{
+			s_frameFlags = 0;
+			getInputState(&s_curInput);
+		}
+		else if (readFrame())
+		{
+			setInputState(&s_curInput);
+		}
+	}
+
+	void updateTime()
+	{
+		if (s_mode == REPLAY_RECORD)
+		{
+			s_frameTime = TFE_System::getTime();
+			s_frameDt = TFE_System::getDeltaTime();
+		}
+		else if (s_mode == REPLAY_PLAYBACK)
+		{
+			TFE_System::setFrameTime(s_frameTime, s_frameDt);
+		}
+	}
+
+	void setGame(IGame* game)
+	{
+		if (!game) { return; }
+
+		if (s_mode == REPLAY_RECORD)
+		{
+			s_frameFlags |= RFRAME_SEED;
+			s_frameSeed = game->getRandomSeed();
+		}
+		else if (s_mode == REPLAY_PLAYBACK && (s_frameFlags & RFRAME_SEED))
+		{
+			game->setRandomSeed(s_frameSeed);
+		}
+	}
+
+	void addTaskTime(f64 seconds)
+	{
+		s_frameTaskTime += seconds;
+	}
+
+	bool endFrame(IGame* game)
+	{
+		if (s_mode == REPLAY_RECORD)
+		{
+			if (s_recordHash && game)
+			{
+				s_frameFlags |= RFRAME_HASH;
+				s_frameHash = game->getStateHash();
+			}
+			writeFrame();
+		}
+		else if (s_mode == REPLAY_PLAYBACK)
+		{
+			if ((s_frameFlags & RFRAME_HASH) && game && game->getStateHash() != s_frameHash)
+			{
+				if (!s_hashMismatchCount)
+				{
+					s_firstMismatchFrame = s_frameCount;
+					TFE_System::logWrite(LOG_ERROR, "Replay", "Game state desync detected at frame %u.", s_frameCount);
+				}
+				s_hashMismatchCount++;
+			}
+
+			s_frameTimes.push_back(TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - s_frameStart));
+			if (s_frameTaskTime > 0.0)
+			{
+				s_taskTimes.push_back(s_frameTaskTime);
+			}
+
+			if (s_frameCount >= s_totalFrames)
+			{
+				stop();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/////////////////////////////////////////////
+	// Internal
+	/////////////////////////////////////////////
+	// Frames only store the ranges of the input state that changed since the previous frame.
+	void writeFrame()
+	{
+		s_file.write(&s_frameFlags);
+		s_file.write(&s_frameTime);
+		s_file.write(&s_frameDt);
+
+		const u8* cur  = (const u8*)&s_curInput;
+		const u8* prev = (const u8*)&s_prevInput;
+		const u32 size = sizeof(InputState);
+
+		std::vector<u16> spans;
+		for (u32 i = 0; i < size;)
+		{
+			if (cur[i] == prev[i]) { i++; continue; }
+
+			const u32 start = i;
+			while (i < size && cur[i] != prev[i]) { i++; }
+			spans.push_back(u16(start));
+			spans.push_back(u16(i - start));
+		}
+
+		const u16 spanCount = u16(spans.size() / 2);
+		s_file.write(&spanCount);
+		for (u32 s = 0; s < spanCount; s++)
+		{
+			s_file.write(&spans[s * 2], 2);
+			s_file.writeBuffer(cur + spans[s * 2], spans[s * 2 + 1]);
+		}
+
+		if (s_frameFlags & RFRAME_SEED) { s_file.write(&s_frameSeed); }
+		if (s_frameFlags & RFRAME_HASH) { s_file.write(&s_frameHash); }
+
+		s_prevInput = s_curInput;
+		s_frameCount++;
+	}
+
+	bool readFrame()
+	{
+		if (s_frameCount >= s_totalFrames)
+		{
+			s_frameFlags = 0;
+			return false;
+		}
+
+		s_file.read(&s_frameFlags);
+		s_file.read(&s_frameTime);
+		s_file.read(&s_frameDt);
+
+		u16 spanCount;
+		s_file.read(&spanCount);
+		u8* cur = (u8*)&s_curInput;
+		s_curInput = s_prevInput;
+		for (u32 s = 0; s < spanCount; s++)
+		{
+			u16 span[2];
+			s_file.read(span, 2);
+			if (u32(span[0]) + u32(span[1]) > sizeof(InputState))
+			{
+				TFE_System::logWrite(LOG_ERROR, "Replay", "Invalid input data at frame %u.", s_frameCount);
+				s_totalFrames = s_frameCount;
+				return false;
+			}
+			s_file.readBuffer(cur + span[0], span[1]);
+		}
+
+		if (s_frameFlags & RFRAME_SEED) { s_file.read(&s_frameSeed); }
+		if (s_frameFlags & RFRAME_HASH) { s_file.read(&s_frameHash); }
+
+		s_prevInput = s_curInput;
+		s_frameCount++;
+		return true;
+	}
+
+	void reportTimes(const char* name, std::vector<f64>& times)
+	{
+		if (times.empty())
+		{
+			TFE_System::logWrite(LOG_MSG, "Timedemo", "%s: no samples.", name);
+			return;
+		}
+
+		std::sort(times.begin(), times.end());
+		f64 total = 0.0;
+		for (size_t i = 0; i < times.size(); i++)
+		{
+			total += times[i];
+		}
+		const size_t p99 = std::min(times.size() - 1, (times.size() * 99) / 100);
+		TFE_System::logWrite(LOG_MSG, "Timedemo", "%s: min %.3fms, avg %.3fms, p99 %.3fms, max %.3fms (%u samples).", name,
+			times.front() * 1000.0, total * 1000.0 / f64(times.size()), times[p99] * 1000.0, times.back() * 1000.0, u32(times.size()));
+	}
+
+	void reportTimings()
+	{
+		f64 total = 0.0;
+		for (size_t i = 0; i < s_frameTimes.size(); i++)
+		{
+			total += s_frameTimes[i];
+		}
+		TFE_System::logWrite(LOG_MSG, "Timedemo", "Played %u of %u frames in %.3f seconds (%.1f fps).", s_frameCount, s_totalFrames,
+			total, total > 0.0 ? f64(s_frameTimes.size()) / total : 0.0);
+		reportTimes("Frame", s_frameTimes);
+		reportTimes("Tasks", s_taskTimes);
+
+		if (s_hashMismatchCount)
+		{
+			TFE_System::logWrite(LOG_ERROR, "Timedemo", "Game state desynced on %u frames, starting at frame %u.", s_hashMismatchCount, s_firstMismatchFrame);
+		}
+	}
+}
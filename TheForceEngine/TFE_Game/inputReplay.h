@@ -0,0 +1,38 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Input recording and replay.
+// Records the low level input state, frame time and game random seed
+// every frame so that a session can be replayed deterministically.
+// Playback runs as a timedemo - as fast as possible - and reports
+// frame and task timings when complete. Optionally a hash of the game
+// state is recorded every frame and verified during playback to catch
+// desyncs.
+//////////////////////////////////////////////////////////////////////
+#include "igame.h"
+
+namespace TFE_InputReplay
+{
+	enum ReplayMode
+	{
+		REPLAY_NONE = 0,
+		REPLAY_RECORD,
+		REPLAY_PLAYBACK,
+	};
+
+	bool startRecording(const char* filename, bool recordStateHash);
+	bool startPlayback(const char* filename);
+	// Finish recording or playback, during playback this reports the timing results.
+	void stop();
+	ReplayMode getMode();
+
+	// Called after the raw input has been updated for the frame.
+	void beginFrame();
+	// Called after TFE_System::update().
+	void updateTime();
+	// Called when a new game is created.
+	void setGame(IGame* game);
+	// Add the time spent running tasks this frame.
+	void addTaskTime(f64 seconds);
+	// Returns false once playback has completed.
+	bool endFrame(IGame* game);
+}
@@ -0,0 +1,537 @@
+#include "rewindBuffer.h"
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <TFE_FileSystem/memorystream.h>
+#include <TFE_FrontEndUI/console.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+// The miniz implementation is compiled with the zip library.
+#define MINIZ_HEADER_FILE_ONLY
+#include <TFE_Archive/zip/miniz.h>
+
+using namespace TFE_Memory;
+
+namespace TFE_RewindBuffer
+{
+	enum RewindConst
+	{
+		REWIND_MAX_SNAPSHOTS = 64,
+		REWIND_PAGE_SIZE = 4 * 1024,
+		REWIND_DEFAULT_INTERVAL = 290,	// Game ticks, 2 seconds at 145 ticks per second.
+	};
+
+	enum RewindRegion
+	{
+		REWIND_REGION_GAME = 0,
+		REWIND_REGION_LEVEL,
+		REWIND_REGION_COUNT
+	};
+
+	struct RewindPage
+	{
+		u64 hash;			// Hash of the uncompressed data, see hashPage().
+		u32 refCount;		// 0 if the page is unused.
+		u32 size;			// Uncompressed size.
+		bool compressed;	// false if compression didn't make the data smaller.
+		std::vector<u8> data;
+	};
+
+	// The pages of each block in the region, -1 for pages that only hold free memory.
+	struct RegionSnapshot
+	{
+		MemoryRegionState state;
+		std::vector<s32> pages;
+	};
+
+	struct Snapshot
+	{
+		u32 tick;
+		u32 stateSize;
+		RegionSnapshot regions[REWIND_REGION_COUNT];
+		std::vector<s32> statePages;	// Game state outside of the regions.
+	};
+
+	struct StateRange
+	{
+		void* data;
+		size_t size;
+	};
+
+	static IGame* s_game = nullptr;
+	static bool s_rewindEnable = false;
+	static s32  s_rewindInterval = REWIND_DEFAULT_INTERVAL;
+
+	// Ring buffer of snapshots, from oldest to newest.
+	static Snapshot s_snapshots[REWIND_MAX_SNAPSHOTS];
+	static s32 s_snapshotHead = 0;
+	static s32 s_snapshotCount = 0;
+	static s32 s_pendingSnapshot = -1;
+	static u32 s_lastTick = 0;
+
+	static std::vector<RewindPage> s_pages;
+	static std::vector<s32> s_freePages;
+	static std::unordered_map<u64, s32> s_pageMap;	// Page hash -> page.
+	static std::vector<u8> s_pageUsed;
+	static std::vector<u8> s_compressBuffer;
+	static MemoryStream s_stream;
+
+	static std::vector<StateRange> s_stateRanges;
+	static std::vector<RewindStateFunc> s_stateFuncs;
+
+	static f64 s_captureTime = 0.0;
+	static f64 s_restoreTime = 0.0;
+
+	void rewindConsole(const ConsoleArgList& args);
+	void rewindStatsConsole(const ConsoleArgList& args);
+
+	void init()
+	{
+		CVAR_BOOL(s_rewindEnable, "g_rewindEnable", CVFLAG_NONE, "Take in-memory snapshots of the game state so it can be rewound with the rewind command.");
+		CVAR_INT(s_rewindInterval, "g_rewindInterval", CVFLAG_NONE, "Game ticks between rewind snapshots, 145 ticks = 1 second.");
+		CCMD("rewind", rewindConsole, 0, "Rewind the game to an earlier snapshot, 1 = the newest, default = 1 - rewind [steps]");
+		CCMD("rewindStats", rewindStatsConsole, 0, "Display the rewind snapshot count, memory use and timings.");
+	}
+
+	void destroy()
+	{
+		clear();
+		s_pages.clear();
+		s_freePages.clear();
+		s_pageMap.clear();
+		s_compressBuffer.clear();
+		s_stateRanges.clear();
+		s_stateFuncs.clear();
+		s_game = nullptr;
+	}
+
+	void addState(void* data, size_t size)
+	{
+		s_stateRanges.push_back({ data, size });
+	}
+
+	void addStateFunc(RewindStateFunc func)
+	{
+		s_stateFuncs.push_back(func);
+	}
+
+	MemoryRegion* getRegion(s32 index)
+	{
+		return index == REWIND_REGION_GAME ? s_gameRegion : s_levelRegion;
+	}
+
+	Snapshot* getSnapshot(s32 age)
+	{
+		return &s_snapshots[(s_snapshotHead + s_snapshotCount - 1 - age) % REWIND_MAX_SNAPSHOTS];
+	}
+
+	static inline u64 rotl64(u64 x, s32 r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+
+	// 64-bit hash of the page contents, using four independent multiply-rotate lanes so that
+	// hashing runs close to memory speed.
+	u64 hashPage(const u8* data, u32 size)
+	{
+		const u64 c_prime1 = 0x9e3779b185ebca87ull;
+		const u64 c_prime2 = 0xc2b2ae3d27d4eb4full;
+		u64 lane[4] = { c_prime1 + c_prime2, c_prime2, 0, 0 - c_prime1 };
+
+		const u32 stripeCount = size / 32;
+		for (u32 s = 0; s < stripeCount; s++, data += 32)
+		{
+			for (s32 l = 0; l < 4; l++)
+			{
+				u64 word;
+				memcpy(&word, data + l * 8, sizeof(u64));
+				lane[l] = rotl64(lane[l] + word * c_prime2, 31) * c_prime1;
+			}
+		}
+		u64 hash = rotl64(lane[0], 1) + rotl64(lane[1], 7) + rotl64(lane[2], 12) + rotl64(lane[3], 18) + size;
+		for (u32 i = stripeCount * 32; i < size; i++, data++)
+		{
+			hash = rotl64(hash ^ (*data * c_prime1), 11) * c_prime2;
+		}
+
+		hash ^= hash >> 33;
+		hash *= c_prime2;
+		hash ^= hash >> 29;
+		return hash;
+	}
+
+	// Returns the page holding the data, sharing an existing page with the same contents if there is one.
+	s32 addPage(const u8* data, u32 size)
+	{
+		const u64 hash = hashPage(data, size);
+		std::unordered_map<u64, s32>::iterator iPage = s_pageMap.find(hash);
+		if (iPage != s_pageMap.end())
+		{
+			s_pages[iPage->second].refCount++;
+			return iPage->second;
+		}
+
+		s32 id;
+		if (!s_freePages.empty())
+		{
+			id = s_freePages.back();
+			s_freePages.pop_back();
+		}
+		else
+		{
+			id = s32(s_pages.size());
+			s_pages.push_back({});
+		}
+		RewindPage* page = &s_pages[id];
+		page->hash = hash;
+		page->refCount = 1;
+		page->size = size;
+
+		mz_ulong compressedSize = mz_compressBound(size);
+		s_compressBuffer.resize(compressedSize);
+		page->compressed = mz_compress2(s_compressBuffer.data(), &compressedSize, data, size, MZ_BEST_SPEED) == MZ_OK && compressedSize < size;
+		if (page->compressed)
+		{
+			page->data.assign(s_compressBuffer.data(), s_compressBuffer.data() + compressedSize);
+		}
+		else
+		{
+			page->data.assign(data, data + size);
+		}
+		s_pageMap[hash] = id;
+		return id;
+	}
+
+	void releasePage(s32 id)
+	{
+		if (id < 0) { return; }
+		RewindPage* page = &s_pages[id];
+		assert(page->refCount > 0);
+		page->refCount--;
+		if (!page->refCount)
+		{
+			s_pageMap.erase(page->hash);
+			page->data.clear();
+			page->data.shrink_to_fit();
+			s_freePages.push_back(id);
+		}
+	}
+
+	void releaseSnapshot(Snapshot* snapshot)
+	{
+		for (s32 r = 0; r < REWIND_REGION_COUNT; r++)
+		{
+			std::vector<s32>& pages = snapshot->regions[r].pages;
+			for (size_t p = 0; p < pages.size(); p++)
+			{
+				releasePage(pages[p]);
+			}
+			pages.clear();
+		}
+		for (size_t p = 0; p < snapshot->statePages.size(); p++)
+		{
+			releasePage(snapshot->statePages[p]);
+		}
+		snapshot->statePages.clear();
+	}
+
+	bool unpackPage(const RewindPage* page, u8* output)
+	{
+		if (!page->compressed)
+		{
+			memcpy(output, page->data.data(), page->size);
+			return true;
+		}
+		mz_ulong outputSize = page->size;
+		if (mz_uncompress(output, &outputSize, page->data.data(), mz_ulong(page->data.size())) != MZ_OK || outputSize != page->size)
+		{
+			TFE_System::logWrite(LOG_ERROR, "Rewind", "Failed to decompress a snapshot page.");
+			return false;
+		}
+		return true;
+	}
+
+	void serializeState(Stream* stream, bool writeState)
+	{
+		for (size_t i = 0; i < s_stateRanges.size(); i++)
+		{
+			if (writeState)
+			{
+				stream->writeBuffer(s_stateRanges[i].data, u32(s_stateRanges[i].size));
+			}
+			else
+			{
+				stream->readBuffer(s_stateRanges[i].data, u32(s_stateRanges[i].size));
+			}
+		}
+		for (size_t i = 0; i < s_stateFuncs.size(); i++)
+		{
+			s_stateFuncs[i](stream, writeState);
+		}
+	}
+
+	void captureRegion(MemoryRegion* region, RegionSnapshot* snapshot)
+	{
+		region_getState(region, &snapshot->state);
+		snapshot->pages.clear();
+		for (size_t b = 0; b < snapshot->state.blockCount; b++)
+		{
+			size_t memSize;
+			const u8* mem = region_getBlockMemory(region, b, &memSize);
+			region_getUsedPages(region, b, REWIND_PAGE_SIZE, s_pageUsed);
+			for (size_t p = 0; p < s_pageUsed.size(); p++)
+			{
+				const size_t offset = p * REWIND_PAGE_SIZE;
+				const u32 size = u32(std::min(size_t(REWIND_PAGE_SIZE), memSize - offset));
+				snapshot->pages.push_back(s_pageUsed[p] ? addPage(mem + offset, size) : -1);
+			}
+		}
+	}
+
+	bool canRestoreRegion(MemoryRegion* region, const RegionSnapshot* snapshot)
+	{
+		MemoryRegionState state;
+		region_getState(region, &state);
+		return state.generation == snapshot->state.generation && state.blockCount >= snapshot->state.blockCount;
+	}
+
+	// Write back the pages that differ from the current memory.
+	bool restoreRegion(MemoryRegion* region, const RegionSnapshot* snapshot)
+	{
+		size_t index = 0;
+		for (size_t b = 0; b < snapshot->state.blockCount; b++)
+		{
+			size_t memSize;
+			u8* mem = region_getBlockMemory(region, b, &memSize);
+			for (size_t offset = 0; offset < memSize; offset += REWIND_PAGE_SIZE, index++)
+			{
+				const s32 id = snapshot->pages[index];
+				if (id < 0) { continue; }
+
+				const RewindPage* page = &s_pages[id];
+				if (hashPage(mem + offset, page->size) == page->hash) { continue; }
+				if (!unpackPage(page, mem + offset)) { return false; }
+			}
+		}
+		return region_restoreState(region, &snapshot->state);
+	}
+
+	void capture(u32 tick)
+	{
+		TFE_ZONE("Rewind Capture");
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		s_stream.clear();
+		s_stream.open(Stream::MODE_WRITE);
+		serializeState(&s_stream, true);
+		s_stream.close();
+
+		// Drop the oldest snapshot when the buffer is full.
+		if (s_snapshotCount == REWIND_MAX_SNAPSHOTS)
+		{
+			releaseSnapshot(&s_snapshots[s_snapshotHead]);
+			s_snapshotHead = (s_snapshotHead + 1) % REWIND_MAX_SNAPSHOTS;
+			s_snapshotCount--;
+		}
+		Snapshot* snapshot = &s_snapshots[(s_snapshotHead + s_snapshotCount) % REWIND_MAX_SNAPSHOTS];
+		snapshot->tick = tick;
+		snapshot->stateSize = u32(s_stream.getSize());
+		for (s32 r = 0; r < REWIND_REGION_COUNT; r++)
+		{
+			captureRegion(getRegion(r), &snapshot->regions[r]);
+		}
+
+		const u8* state = (const u8*)s_stream.data();
+		snapshot->statePages.clear();
+		for (u32 offset = 0; offset < snapshot->stateSize; offset += REWIND_PAGE_SIZE)
+		{
+			snapshot->statePages.push_back(addPage(state + offset, std::min(u32(REWIND_PAGE_SIZE), snapshot->stateSize - offset)));
+		}
+		s_snapshotCount++;
+
+		s_lastTick = tick;
+		s_captureTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+	}
+
+	bool restore(const Snapshot* snapshot)
+	{
+		TFE_ZONE("Rewind Restore");
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 r = 0; r < REWIND_REGION_COUNT; r++)
+		{
+			if (!canRestoreRegion(getRegion(r), &snapshot->regions[r]))
+			{
+				TFE_System::logWrite(LOG_ERROR, "Rewind", "The snapshot at tick %u is from a different level.", snapshot->tick);
+				return false;
+			}
+		}
+
+		if (snapshot->stateSize && !s_stream.allocate(snapshot->stateSize))
+		{
+			return false;
+		}
+		u8* state = (u8*)s_stream.data();
+		for (size_t p = 0; p < snapshot->statePages.size(); p++)
+		{
+			if (!unpackPage(&s_pages[snapshot->statePages[p]], state + p * REWIND_PAGE_SIZE))
+			{
+				return false;
+			}
+		}
+
+		for (s32 r = 0; r < REWIND_REGION_COUNT; r++)
+		{
+			if (!restoreRegion(getRegion(r), &snapshot->regions[r]))
+			{
+				// The regions are partially restored, so the game state is no longer valid.
+				TFE_System::logWrite(LOG_CRITICAL, "Rewind", "Failed to restore the snapshot at tick %u.", snapshot->tick);
+				return false;
+			}
+		}
+		if (snapshot->stateSize)
+		{
+			s_stream.open(Stream::MODE_READ);
+			serializeState(&s_stream, false);
+			s_stream.close();
+		}
+
+		s_restoreTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		TFE_System::logWrite(LOG_MSG, "Rewind", "Restored snapshot at tick %u in %0.3f ms.", snapshot->tick, s_restoreTime * 1000.0);
+		return true;
+	}
+
+	void restorePending()
+	{
+		const Snapshot* snapshot = &s_snapshots[s_pendingSnapshot];
+		s_pendingSnapshot = -1;
+		if (!restore(snapshot))
+		{
+			clear();
+			return;
+		}
+
+		// The game continues from the restored snapshot, so the newer snapshots are dropped.
+		while (s_snapshotCount && getSnapshot(0) != snapshot)
+		{
+			releaseSnapshot(getSnapshot(0));
+			s_snapshotCount--;
+		}
+		s_lastTick = snapshot->tick;
+	}
+
+	void setCurrentGame(IGame* game)
+	{
+		s_game = game;
+		clear();
+
+		s_stateRanges.clear();
+		s_stateFuncs.clear();
+		if (game)
+		{
+			game->registerRewindState();
+		}
+	}
+
+	void update()
+	{
+		if (!s_game) { return; }
+		if (s_pendingSnapshot >= 0)
+		{
+			restorePending();
+		}
+		if (!s_rewindEnable || !s_game->canSave() || s_game->isPaused())
+		{
+			return;
+		}
+
+		// Snapshots cannot be restored once a new level has been loaded.
+		if (s_snapshotCount && !canRestoreRegion(s_levelRegion, &getSnapshot(0)->regions[REWIND_REGION_LEVEL]))
+		{
+			clear();
+		}
+		const u32 tick = s_game->getGameTick();
+		if (s_snapshotCount && tick >= s_lastTick && tick - s_lastTick < u32(std::max(1, s_rewindInterval)))
+		{
+			return;
+		}
+		capture(tick);
+	}
+
+	bool requestRewind(s32 steps)
+	{
+		if (steps < 1 || steps > s_snapshotCount)
+		{
+			return false;
+		}
+		s_pendingSnapshot = (s_snapshotHead + s_snapshotCount - steps) % REWIND_MAX_SNAPSHOTS;
+		return true;
+	}
+
+	void clear()
+	{
+		for (s32 i = 0; i < s_snapshotCount; i++)
+		{
+			releaseSnapshot(getSnapshot(i));
+		}
+		s_snapshotHead = 0;
+		s_snapshotCount = 0;
+		s_pendingSnapshot = -1;
+		s_lastTick = 0;
+	}
+
+	void getStats(RewindStats* stats)
+	{
+		memset(stats, 0, sizeof(RewindStats));
+		stats->snapshotCount = s_snapshotCount;
+		for (size_t p = 0; p < s_pages.size(); p++)
+		{
+			if (!s_pages[p].refCount) { continue; }
+			stats->pageCount++;
+			stats->memoryUsed += s_pages[p].data.size();
+		}
+		if (s_snapshotCount)
+		{
+			const Snapshot* snapshot = getSnapshot(0);
+			stats->stateSize = snapshot->stateSize;
+			for (s32 r = 0; r < REWIND_REGION_COUNT; r++)
+			{
+				const std::vector<s32>& pages = snapshot->regions[r].pages;
+				for (size_t p = 0; p < pages.size(); p++)
+				{
+					stats->stateSize += pages[p] >= 0 ? s_pages[pages[p]].size : 0;
+				}
+			}
+		}
+		stats->captureTime = s_captureTime;
+		stats->restoreTime = s_restoreTime;
+	}
+
+	void rewindConsole(const ConsoleArgList& args)
+	{
+		const s32 steps = args.size() >= 2 ? s32(TFE_Console::getFloatArg(args[1])) : 1;
+		if (!s_snapshotCount)
+		{
+			TFE_Console::addToHistory(s_rewindEnable ? "rewind - no snapshots have been taken yet." : "rewind - snapshots are disabled, set g_rewindEnable to true.");
+			return;
+		}
+		if (!requestRewind(steps))
+		{
+			char res[256];
+			sprintf(res, "rewind - steps must be between 1 and %d.", s_snapshotCount);
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	void rewindStatsConsole(const ConsoleArgList& args)
+	{
+		RewindStats stats;
+		getStats(&stats);
+
+		char res[256];
+		sprintf(res, "Rewind: %d snapshots, %d pages, %zu bytes stored, %zu bytes per snapshot uncompressed.", stats.snapshotCount, stats.pageCount, stats.memoryUsed, stats.stateSize);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "Last capture: %0.3f ms, last restore: %0.3f ms.", stats.captureTime * 1000.0, stats.restoreTime * 1000.0);
+		TFE_Console::addToHistory(res);
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// In-memory rewind buffer.
+// Snapshots of the game state are taken every N game ticks and kept
+// in a ring buffer, so the game can be rewound without going through
+// save files or reloading the level.
+//
+// A snapshot holds the memory of the game and level regions, split
+// into pages, and the game state outside of the regions registered
+// by the game. Pages are shared by content hash, so only the pages
+// that changed since any stored snapshot are compressed and stored.
+// Restoring writes the changed pages back in place, so pointers
+// into the regions stay valid.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_FileSystem/stream.h>
+#include "igame.h"
+
+// Register a global that is part of the game state, see TFE_RewindBuffer::addState().
+#define REWIND_STATE(x) TFE_RewindBuffer::addState(&(x), sizeof(x))
+
+namespace TFE_RewindBuffer
+{
+	struct RewindStats
+	{
+		s32    snapshotCount;
+		s32    pageCount;		// Unique pages held by all snapshots.
+		size_t memoryUsed;		// Compressed size of all pages.
+		size_t stateSize;		// Uncompressed size of the newest snapshot.
+		f64    captureTime;		// Time taken by the last capture, in seconds.
+		f64    restoreTime;		// Time taken by the last restore, in seconds.
+	};
+
+	// Reads or writes state that cannot be copied as raw memory, such as containers.
+	typedef void(*RewindStateFunc)(Stream* stream, bool writeState);
+
+	void init();
+	void destroy();
+
+	// Called by the save system.
+	void setCurrentGame(IGame* game);
+	void update();
+
+	// Game state outside of the game and level regions, registered from IGame::registerRewindState().
+	// The memory is copied as-is, so it may hold pointers into the regions.
+	void addState(void* data, size_t size);
+	// State functions are called in the order they were added, after the memory has been restored.
+	void addStateFunc(RewindStateFunc func);
+
+	// Rewind to the snapshot 'steps' back from the newest (1 = newest).
+	// The restore happens at the start of the next update.
+	bool requestRewind(s32 steps);
+
+	void clear();
+	void getStats(RewindStats* stats);
+}
@@ -1,13 +1,20 @@
 #include "saveSystem.h"
+#include "rewindBuffer.h"
 #include <TFE_Input/inputMapping.h>
 #include <TFE_System/system.h>
 #include <TFE_Settings/gameSourceData.h>
 #include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/memorystream.h>
+#include <TFE_FrontEndUI/console.h>
 
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Asset/imageAsset.h>
+#include <SDL_thread.h>
+#include <SDL_mutex.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <unordered_map>
 
 using namespace TFE_Input;
 
@@ -33,67 +40,94 @@ namespace TFE_SaveSystem
 	static IGame* s_game = nullptr;
 	static s32 s_saveDelay = 0;
 
+	enum SaveJobState
+	{
+		SJOB_IDLE = 0,		// No save in flight, the game thread owns the job.
+		SJOB_PENDING,		// The worker owns the job.
+		SJOB_DONE,			// The worker is finished, waiting for the game thread to report the result.
+	};
+
+	// Everything needed to write a save file, captured on the game thread.
+	// The thumbnail encoding and file write happen on the save worker.
+	struct SaveJob
+	{
+		char filePath[TFE_MAX_PATH];
+		char fileName[TFE_MAX_PATH];
+		char saveName[SAVE_MAX_NAME_LEN];
+		char dateTime[256];
+		char levelName[256];
+		char modList[256];
+		IGame* game;
+
+		u32 screenWidth;
+		u32 screenHeight;
+		std::vector<u32> screenshot;
+		MemoryStream state;
+		bool success;
+	};
+
 	static u32* s_imageBuffer[2] = { nullptr, nullptr };
 	static size_t s_imageBufferSize[2] = { 0 };
 
-	void saveHeader(Stream* stream, const char* saveName)
+	static SaveJob s_saveJob;
+	static atomic_s32 s_saveJobState(SJOB_IDLE);
+	static SDL_Thread* s_saveThread = nullptr;
+	static SDL_sem* s_saveStart = nullptr;
+	static SDL_sem* s_saveDone = nullptr;
+	static bool s_saveThreadExit = false;
+
+	void captureSaveJob(SaveJob* job, const char* filename, const char* saveName)
 	{
-		// Generate a screenshot.
+		sprintf(job->filePath, "%s%s", s_gameSavePath, filename);
+		strcpy(job->fileName, filename);
+		job->game = s_game;
+		job->success = false;
+
+		size_t saveNameLen = strlen(saveName);
+		if (saveNameLen > SAVE_MAX_NAME_LEN - 1) { saveNameLen = SAVE_MAX_NAME_LEN - 1; }
+		memcpy(job->saveName, saveName, saveNameLen);
+		job->saveName[saveNameLen] = 0;
+		TFE_System::getDateTimeString(job->dateTime);
+		s_game->getLevelName(job->levelName);
+		s_game->getModList(job->modList);
+
+		// Generate a screenshot, the thumbnail is encoded later.
 		DisplayInfo displayInfo;
 		TFE_RenderBackend::getDisplayInfo(&displayInfo);
-		size_t size = displayInfo.width * displayInfo.height * 4;
-		if (size > s_imageBufferSize[0])
-		{
-			s_imageBuffer[0] = (u32*)realloc(s_imageBuffer[0], size);
-			s_imageBufferSize[0] = size;
-		}
-		TFE_RenderBackend::captureScreenToMemory(s_imageBuffer[0]);
+		job->screenWidth = displayInfo.width;
+		job->screenHeight = displayInfo.height;
+		job->screenshot.resize(displayInfo.width * displayInfo.height);
+		TFE_RenderBackend::captureScreenToMemory(job->screenshot.data());
+	}
+
+	void writeString(Stream* stream, const char* str)
+	{
+		u8 len = (u8)strlen(str);
+		stream->write(&len);
+		stream->writeBuffer(str, len);
+	}
+
+	void saveHeader(Stream* stream, const SaveJob* job)
+	{
 		// Save to memory.
 		u8* png = (u8*)malloc(SAVE_IMAGE_WIDTH * SAVE_IMAGE_HEIGHT * 4);
 		u32 pngSize = 0;
 		if (png)
 		{
-			pngSize = (u32)TFE_Image::writeImageToMemory(png, displayInfo.width, displayInfo.height,
+			pngSize = (u32)TFE_Image::writeImageToMemory(png, job->screenWidth, job->screenHeight,
 								 SAVE_IMAGE_WIDTH, SAVE_IMAGE_HEIGHT,
-								 s_imageBuffer[0]);
-		}
-		else
-		{
-			pngSize = 0;
-			png = (u8*)s_imageBuffer[0];
+								 job->screenshot.data());
 		}
 
 		// Master version.
 		u32 version = SVER_CUR;
 		stream->write(&version);
 
-		// Save Name.
-		size_t saveNameLen = strlen(saveName);
-		if (saveNameLen > SAVE_MAX_NAME_LEN - 1) { saveNameLen = SAVE_MAX_NAME_LEN - 1; }
-		u8 len = (u8)saveNameLen;
-		stream->write(&len);
-		stream->writeBuffer(saveName, len);
-
-		// Time and Date of Save.
-		char timeDate[256];
-		TFE_System::getDateTimeString(timeDate);
-		len = (u8)strlen(timeDate);
-		stream->write(&len);
-		stream->writeBuffer(timeDate, len);
-
-		// Level Name
-		char levelName[256];
-		s_game->getLevelName(levelName);
-		len = (u8)strlen(levelName);
-		stream->write(&len);
-		stream->writeBuffer(levelName, len);
-
-		// Mod List
-		char modList[256];
-		s_game->getModList(modList);
-		len = (u8)strlen(modList);
-		stream->write(&len);
-		stream->writeBuffer(modList, len);
+		// Save Name, Time and Date of Save, Level Name and Mod List
+		writeString(stream, job->saveName);
+		writeString(stream, job->dateTime);
+		writeString(stream, job->levelName);
+		writeString(stream, job->modList);
 
 		// Image.
 		stream->write(&pngSize);
@@ -101,6 +135,97 @@ namespace TFE_SaveSystem
 		free(png);
 	}
 
+	// Encode the thumbnail and write the file, this may be called on the save worker.
+	void writeSaveJob(SaveJob* job)
+	{
+		FileStream stream;
+		if (!stream.open(job->filePath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "SaveSystem", "Cannot open '%s' for writing.", job->filePath);
+			job->success = false;
+			return;
+		}
+		saveHeader(&stream, job);
+		stream.writeBuffer(job->state.data(), u32(job->state.getSize()));
+		if (!stream.close())
+		{
+			// Do not leave a truncated save behind.
+			TFE_System::logWrite(LOG_ERROR, "SaveSystem", "Cannot write '%s', removing the partial file.", job->filePath);
+			FileUtil::deleteFile(job->filePath);
+			job->success = false;
+		}
+	}
+
+	int saveWorkerThread(void* userData)
+	{
+		while (1)
+		{
+			SDL_SemWait(s_saveStart);
+			if (s_saveThreadExit) { break; }
+
+			writeSaveJob(&s_saveJob);
+			s_saveJobState.store(SJOB_DONE);
+			SDL_SemPost(s_saveDone);
+		}
+		return 0;
+	}
+
+	bool startSaveWorker()
+	{
+		if (s_saveThread) { return true; }
+
+		s_saveStart = SDL_CreateSemaphore(0);
+		s_saveDone = SDL_CreateSemaphore(0);
+		s_saveThreadExit = false;
+		if (s_saveStart && s_saveDone)
+		{
+			s_saveThread = SDL_CreateThread(saveWorkerThread, "SaveWorker", nullptr);
+		}
+		if (!s_saveThread)
+		{
+			TFE_System::logWrite(LOG_WARNING, "SaveSystem", "Cannot create the save worker thread, saving synchronously.");
+			if (s_saveStart) { SDL_DestroySemaphore(s_saveStart); }
+			if (s_saveDone)  { SDL_DestroySemaphore(s_saveDone); }
+			s_saveStart = nullptr;
+			s_saveDone = nullptr;
+			return false;
+		}
+		return true;
+	}
+
+	// Report the result of a finished save to the game that requested it.
+	void finishSaveJob()
+	{
+		if (s_saveJob.game && s_saveJob.game == s_game)
+		{
+			s_game->saveComplete(s_saveJob.fileName, s_saveJob.success);
+		}
+		if (!s_saveJob.success)
+		{
+			TFE_System::logWrite(LOG_ERROR, "SaveSystem", "Failed to save '%s'.", s_saveJob.fileName);
+		}
+		s_saveJob.state.clear();
+		s_saveJobState.store(SJOB_IDLE);
+	}
+
+	// Wait for the save in flight, if any, and report the result.
+	void waitForSave()
+	{
+		if (s_saveJobState.load() == SJOB_IDLE) { return; }
+
+		// The worker posts once per job, after the job is marked as done.
+		SDL_SemWait(s_saveDone);
+		finishSaveJob();
+	}
+
+	void readString(Stream* stream, char* str)
+	{
+		u8 len;
+		stream->read(&len);
+		stream->readBuffer(str, len);
+		str[len] = 0;
+	}
+
 	void loadHeader(Stream* stream, SaveHeader* header, const char* fileName)
 	{
 		// Master version.
@@ -108,10 +233,7 @@ namespace TFE_SaveSystem
 		stream->read(&version);
 
 		// Save Name.
-		u8 len;
-		stream->read(&len);
-		stream->readBuffer(header->saveName, len);
-		header->saveName[len] = 0;
+		readString(stream, header->saveName);
 		// Fix existing invalid save names.
 		header->saveName[SAVE_MAX_NAME_LEN - 1] = 0;
 
@@ -121,24 +243,22 @@ namespace TFE_SaveSystem
 			FileUtil::getFileNameFromPath(fileName, header->saveName);
 		}
 
-		// Time and Date of Save.
-		stream->read(&len);
-		stream->readBuffer(header->dateTime, len);
-		header->dateTime[len] = 0;
-
-		// Level Name
-		stream->read(&len);
-		stream->readBuffer(header->levelName, len);
-		header->levelName[len] = 0;
-
-		// Mod List
-		stream->read(&len);
-		stream->readBuffer(header->modNames, len);
-		header->modNames[len] = 0;
+		// Time and Date of Save, Level Name and Mod List
+		readString(stream, header->dateTime);
+		readString(stream, header->levelName);
+		readString(stream, header->modNames);
+	}
 
+	// Read the image that follows the header strings, returns false if there is no valid image.
+	bool loadHeaderImage(Stream* stream, u32* imageData)
+	{
 		// Image, re-use buffer 0 for the PNG.
-		u32 pngSize;
+		u32 pngSize = 0;
 		stream->read(&pngSize);
+		if (!pngSize || pngSize > stream->getSize() - stream->getLoc())
+		{
+			return false;
+		}
 		if (pngSize > s_imageBufferSize[0])
 		{
 			s_imageBuffer[0] = (u32*)realloc(s_imageBuffer[0], pngSize);
@@ -146,18 +266,133 @@ namespace TFE_SaveSystem
 		}
 		stream->readBuffer(s_imageBuffer[0], pngSize);
 
-		SDL_Surface* image;
+		SDL_Surface* image = nullptr;
 		TFE_Image::readImageFromMemory(&image, pngSize, s_imageBuffer[0]);
-		if (image)
+		if (!image) { return false; }
+
+		bool result = false;
+		if (image->w == SAVE_IMAGE_WIDTH && image->h == SAVE_IMAGE_HEIGHT && image->format->BytesPerPixel == 4)
 		{
 			const u32 sz = SAVE_IMAGE_WIDTH * SAVE_IMAGE_HEIGHT * sizeof(u32);
-			memcpy(header->imageData, image->pixels, sz);
-			TFE_Image::free(image);
+			memcpy(imageData, image->pixels, sz);
+			result = true;
+		}
+		TFE_Image::free(image);
+		return result;
+	}
+
+	// Box filter the save image down to the thumbnail size.
+	void buildThumbnail(const u32* imageData, u32* thumbnail)
+	{
+		for (s32 y = 0; y < SAVE_THUMB_HEIGHT; y++)
+		{
+			const s32 y0 = y * SAVE_IMAGE_HEIGHT / SAVE_THUMB_HEIGHT;
+			const s32 y1 = (y + 1) * SAVE_IMAGE_HEIGHT / SAVE_THUMB_HEIGHT;
+			for (s32 x = 0; x < SAVE_THUMB_WIDTH; x++)
+			{
+				const s32 x0 = x * SAVE_IMAGE_WIDTH / SAVE_THUMB_WIDTH;
+				const s32 x1 = (x + 1) * SAVE_IMAGE_WIDTH / SAVE_THUMB_WIDTH;
+
+				u32 sum[4] = { 0 };
+				for (s32 sy = y0; sy < y1; sy++)
+				{
+					const u32* src = &imageData[sy * SAVE_IMAGE_WIDTH];
+					for (s32 sx = x0; sx < x1; sx++)
+					{
+						const u32 pixel = src[sx];
+						sum[0] += pixel & 0xff;
+						sum[1] += (pixel >> 8) & 0xff;
+						sum[2] += (pixel >> 16) & 0xff;
+						sum[3] += pixel >> 24;
+					}
+				}
+				const u32 count = (x1 - x0) * (y1 - y0);
+				thumbnail[y * SAVE_THUMB_WIDTH + x] = (sum[0] / count) | ((sum[1] / count) << 8) | ((sum[2] / count) << 16) | ((sum[3] / count) << 24);
+			}
+		}
+	}
+
+	/////////////////////////////////////////////
+	// Save Index
+	/////////////////////////////////////////////
+	// The save index caches the headers and thumbnails of all of the saves in a game save directory,
+	// so the saves themselves only need to be opened when they are added or modified.
+	enum SaveIndexVersion
+	{
+		SIVER_INIT = 1,
+		SIVER_CUR = SIVER_INIT
+	};
+
+	static const char c_saveIndexSig[4] = { 'T', 'F', 'S', 'I' };
+	static const char* c_saveIndexName = "saves.idx";
+
+	bool readSaveIndex(std::vector<SaveHeader>& index)
+	{
+		char indexPath[TFE_MAX_PATH];
+		sprintf(indexPath, "%s%s", s_gameSavePath, c_saveIndexName);
+
+		FileStream file;
+		if (!file.open(indexPath, Stream::MODE_READ))
+		{
+			return false;
+		}
+
+		char sig[4];
+		u32 version, headerSize, count;
+		file.readBuffer(sig, 4);
+		file.read(&version);
+		file.read(&headerSize);
+		file.read(&count);
+
+		bool result = false;
+		if (memcmp(sig, c_saveIndexSig, 4) == 0 && version == SIVER_CUR && headerSize == sizeof(SaveHeader) &&
+			file.getSize() == 16 + size_t(count) * sizeof(SaveHeader))
+		{
+			index.resize(count);
+			result = count == 0 || file.readBuffer(index.data(), sizeof(SaveHeader), count) == sizeof(SaveHeader) * count;
+		}
+		file.close();
+		return result;
+	}
+
+	void writeSaveIndex(const std::vector<SaveHeader>& index)
+	{
+		char indexPath[TFE_MAX_PATH];
+		sprintf(indexPath, "%s%s", s_gameSavePath, c_saveIndexName);
+
+		FileStream file;
+		if (!file.open(indexPath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "SaveSystem", "Cannot write the save index '%s'.", indexPath);
+			return;
 		}
+
+		const u32 version = SIVER_CUR;
+		const u32 headerSize = sizeof(SaveHeader);
+		const u32 count = u32(index.size());
+		file.writeBuffer(c_saveIndexSig, 4);
+		file.write(&version);
+		file.write(&headerSize);
+		file.write(&count);
+		if (count)
+		{
+			file.writeBuffer(index.data(), sizeof(SaveHeader), count);
+		}
+		file.close();
 	}
 
 	void populateSaveDirectory(std::vector<SaveHeader>& dir)
 	{
+		waitForSave();
+
+		std::vector<SaveHeader> index;
+		readSaveIndex(index);
+		std::unordered_map<std::string, const SaveHeader*> indexMap;
+		for (size_t i = 0; i < index.size(); i++)
+		{
+			indexMap[index[i].fileName] = &index[i];
+		}
+
 		dir.clear();
 		FileList fileList;
 		FileUtil::readDirectory(s_gameSavePath, "tfe", fileList);
@@ -166,18 +401,92 @@ namespace TFE_SaveSystem
 
 		const std::string* filenames = fileList.data();
 		SaveHeader* headers = dir.data();
+		size_t validCount = 0;
+		bool indexDirty = saveCount != index.size();
 		for (size_t i = 0; i < saveCount; i++)
 		{
-			loadGameHeader(filenames[i].c_str(), &headers[i]);
+			char filePath[TFE_MAX_PATH];
+			sprintf(filePath, "%s%s", s_gameSavePath, filenames[i].c_str());
+			const u64 modifiedTime = FileUtil::getModifiedTime(filePath);
+			const u64 fileSize = FileUtil::getFileSize(filePath);
+
+			// Use the index entry if the save has not changed since it was indexed.
+			std::unordered_map<std::string, const SaveHeader*>::iterator iEntry = indexMap.find(filenames[i]);
+			if (iEntry != indexMap.end() && iEntry->second->modifiedTime == modifiedTime && iEntry->second->fileSize == fileSize)
+			{
+				headers[validCount++] = *iEntry->second;
+				continue;
+			}
+
+			indexDirty = true;
+			if (loadGameHeader(filenames[i].c_str(), &headers[validCount]))
+			{
+				headers[validCount].modifiedTime = modifiedTime;
+				headers[validCount].fileSize = fileSize;
+				validCount++;
+			}
+		}
+		dir.resize(validCount);
+
+		if (indexDirty)
+		{
+			writeSaveIndex(dir);
+		}
+	}
+
+	// Serialize the current game state N times in memory and report the time taken, the file is never written.
+	void saveBenchmark(const ConsoleArgList& args)
+	{
+		if (!s_game || !s_game->canSave())
+		{
+			TFE_Console::addToHistory("saveBenchmark - a level must be loaded.");
+			return;
+		}
+		const s32 count = args.size() >= 2 ? std::max(1, s32(TFE_Console::getFloatArg(args[1]))) : 100;
+		waitForSave();
+
+		MemoryStream stream;
+		size_t stateSize = 0;
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 i = 0; i < count; i++)
+		{
+			stream.clear();
+			stream.open(Stream::MODE_WRITE);
+			s_game->serializeGameState(&stream, "benchmark", true);
+			stateSize = stream.getSize();
+			stream.close();
 		}
+		const f64 totalTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		char res[256];
+		sprintf(res, "saveBenchmark - %d saves, %zu bytes each: %0.3f ms total, %0.3f ms per save.", count, stateSize, totalTime * 1000.0, totalTime * 1000.0 / f64(count));
+		TFE_Console::addToHistory(res);
+		TFE_System::logWrite(LOG_MSG, "SaveSystem", "%s", res);
 	}
 
 	void init()
 	{
+		CCMD("saveBenchmark", saveBenchmark, 0, "Serialize the current level N times without writing to disk and report the time, default N = 100 - saveBenchmark [count]");
+		TFE_RewindBuffer::init();
 	}
 
 	void destroy()
 	{
+		waitForSave();
+		TFE_RewindBuffer::destroy();
+		if (s_saveThread)
+		{
+			s_saveThreadExit = true;
+			SDL_SemPost(s_saveStart);
+			SDL_WaitThread(s_saveThread, nullptr);
+			SDL_DestroySemaphore(s_saveStart);
+			SDL_DestroySemaphore(s_saveDone);
+			s_saveThread = nullptr;
+			s_saveStart = nullptr;
+			s_saveDone = nullptr;
+		}
+		s_saveJob.screenshot.clear();
+
 		for (s32 i = 0; i < 2; i++)
 		{
 			free(s_imageBuffer[i]);
@@ -188,22 +497,67 @@ namespace TFE_SaveSystem
 
 	bool saveGame(const char* filename, const char* saveName)
 	{
-		char filePath[TFE_MAX_PATH];
-		sprintf(filePath, "%s%s", s_gameSavePath, filename);
-
-		bool ret = false;
-		FileStream stream;
-		if (stream.open(filePath, Stream::MODE_WRITE))
+		waitForSave();
+		captureSaveJob(&s_saveJob, filename, saveName);
+
+		MemoryStream* state = &s_saveJob.state;
+		state->clear();
+		state->open(Stream::MODE_WRITE);
+		bool ret = s_game->serializeGameState(state, filename, true);
+		state->close();
+		if (ret)
 		{
-			saveHeader(&stream, saveName);
-			ret = s_game->serializeGameState(&stream, filename, true);
-			stream.close();
+			s_saveJob.success = true;
+			writeSaveJob(&s_saveJob);
+			ret = s_saveJob.success;
 		}
+		s_saveJobState.store(SJOB_DONE);
+		finishSaveJob();
 		return ret;
 	}
 
+	bool saveGameAsync(const char* filename, const char* saveName)
+	{
+		if (!startSaveWorker())
+		{
+			return saveGame(filename, saveName);
+		}
+		waitForSave();
+		captureSaveJob(&s_saveJob, filename, saveName);
+
+		// The game state is serialized into memory on the game thread, which is fast.
+		MemoryStream* state = &s_saveJob.state;
+		state->clear();
+		state->open(Stream::MODE_WRITE);
+		const bool ret = s_game->serializeGameState(state, filename, true);
+		state->close();
+		if (!ret)
+		{
+			s_saveJobState.store(SJOB_DONE);
+			finishSaveJob();
+			return false;
+		}
+
+		// Then the thumbnail encoding and file write are handed off to the worker.
+		s_saveJob.success = true;
+		s_saveJobState.store(SJOB_PENDING);
+		SDL_SemPost(s_saveStart);
+		return true;
+	}
+
+	bool isSaving()
+	{
+		return s_saveJobState.load() != SJOB_IDLE;
+	}
+
+	void flushSaves()
+	{
+		waitForSave();
+	}
+
 	bool loadGame(const char* filename)
 	{
+		waitForSave();
 		char filePath[TFE_MAX_PATH];
 		sprintf(filePath, "%s%s", s_gameSavePath, filename);
 
@@ -211,8 +565,12 @@ namespace TFE_SaveSystem
 		FileStream stream;
 		if (stream.open(filePath, Stream::MODE_READ))
 		{
+			// Skip past the header and image.
 			SaveHeader header;
 			loadHeader(&stream, &header, filename);
+			u32 pngSize;
+			stream.read(&pngSize);
+			stream.seek(pngSize, Stream::ORIGIN_CURRENT);
 			ret = s_game->serializeGameState(&stream, filename, false);
 			stream.close();
 		}
@@ -221,6 +579,7 @@ namespace TFE_SaveSystem
 
 	bool loadGameHeader(const char* filename, SaveHeader* header)
 	{
+		waitForSave();
 		char filePath[TFE_MAX_PATH];
 		sprintf(filePath, "%s%s", s_gameSavePath, filename);
 
@@ -228,13 +587,42 @@ namespace TFE_SaveSystem
 		FileStream stream;
 		if (stream.open(filePath, Stream::MODE_READ))
 		{
+			memset(header, 0, sizeof(SaveHeader));
 			loadHeader(&stream, header, filename);
 			strcpy(header->fileName, filename);
+
+			if (s_imageBufferSize[1] < SAVE_IMAGE_WIDTH * SAVE_IMAGE_HEIGHT * sizeof(u32))
+			{
+				s_imageBufferSize[1] = SAVE_IMAGE_WIDTH * SAVE_IMAGE_HEIGHT * sizeof(u32);
+				s_imageBuffer[1] = (u32*)realloc(s_imageBuffer[1], s_imageBufferSize[1]);
+			}
+			if (loadHeaderImage(&stream, s_imageBuffer[1]))
+			{
+				buildThumbnail(s_imageBuffer[1], header->thumbnail);
+			}
 			stream.close();
 			ret = true;
 		}
 		return ret;
 	}
+
+	bool loadSaveImage(const char* filename, u32* imageData)
+	{
+		waitForSave();
+		char filePath[TFE_MAX_PATH];
+		sprintf(filePath, "%s%s", s_gameSavePath, filename);
+
+		bool ret = false;
+		FileStream stream;
+		if (stream.open(filePath, Stream::MODE_READ))
+		{
+			SaveHeader header;
+			loadHeader(&stream, &header, filename);
+			ret = loadHeaderImage(&stream, imageData);
+			stream.close();
+		}
+		return ret;
+	}
 		
 	void postLoadRequest(const char* filename)
 	{
@@ -304,13 +692,20 @@ namespace TFE_SaveSystem
 		
 	void setCurrentGame(IGame* game)
 	{
+		waitForSave();
 		s_game = game;
+		TFE_RewindBuffer::setCurrentGame(game);
 		setCurrentGame(game->id);
 	}
 
 	void update()
 	{
+		if (s_saveJobState.load() == SJOB_DONE)
+		{
+			waitForSave();
+		}
 		if (!s_game) { return; }
+		TFE_RewindBuffer::update();
 
 		static s32 lastState = 0;
 		const char* saveFilename = saveRequestFilename();
@@ -318,12 +713,12 @@ namespace TFE_SaveSystem
 		bool canSave = !lastState && s_game->canSave();
 		if (saveFilename && canSave)
 		{
-			saveGame(saveFilename, s_reqSavename);
+			saveGameAsync(saveFilename, s_reqSavename);
 			lastState = 1;
 		}
 		else if (inputMapping_getActionState(IAS_QUICK_SAVE) == STATE_PRESSED && canSave)
 		{
-			saveGame(c_quickSaveName, "Quicksave");
+			saveGameAsync(c_quickSaveName, "Quicksave");
 			lastState = 1;
 		}
 		else if (inputMapping_getActionState(IAS_QUICK_LOAD) == STATE_PRESSED && !lastState)
@@ -13,7 +13,10 @@ namespace TFE_SaveSystem
 		SAVE_MAX_NAME_LEN = 64,
 		SAVE_IMAGE_WIDTH  = 426,
 		SAVE_IMAGE_HEIGHT = 240,
+		SAVE_THUMB_WIDTH  = 64,
+		SAVE_THUMB_HEIGHT = 36,
 	};
+	// Save headers are cached in a per-game save index, so this must remain a flat structure.
 	struct SaveHeader
 	{
 		char fileName[256];
@@ -21,7 +24,11 @@ namespace TFE_SaveSystem
 		char dateTime[256];
 		char levelName[256];
 		char modNames[256];
-		u32  imageData[SAVE_IMAGE_WIDTH * SAVE_IMAGE_HEIGHT];
+		// Used to validate the save index entry.
+		u64  modifiedTime;
+		u64  fileSize;
+		// Small version of the save image, the full image is loaded on demand using loadSaveImage().
+		u32  thumbnail[SAVE_THUMB_WIDTH * SAVE_THUMB_HEIGHT];
 	};
 
 	void init();
@@ -31,9 +38,17 @@ namespace TFE_SaveSystem
 	void setCurrentGame(GameID id);
 	void update();
 	bool saveGame(const char* filename, const char* saveName);
+	// Serialize the game state into memory and hand the thumbnail encoding and file write off to a worker thread.
+	// The game is notified through IGame::saveComplete() once the file has been written.
+	bool saveGameAsync(const char* filename, const char* saveName);
+	bool isSaving();
+	// Wait for the save in flight, if any, to finish.
+	void flushSaves();
 	bool loadGame(const char* filename);
 	// Load only the header for UI.
 	bool loadGameHeader(const char* filename, SaveHeader* header);
+	// Decode the full size (SAVE_IMAGE_WIDTH x SAVE_IMAGE_HEIGHT) save image.
+	bool loadSaveImage(const char* filename, u32* imageData);
 
 	void postLoadRequest(const char* filename);
 	void postSaveRequest(const char* filename, const char* saveName, s32 delay = 0);
@@ -42,5 +57,7 @@ namespace TFE_SaveSystem
 
 	void getSaveFilenameFromIndex(s32 index, char* name);
 
+	// Fill in the headers for all of the saves of the current game.
+	// This uses the save index, so only new or modified saves are read.
 	void populateSaveDirectory(std::vector<SaveHeader>& dir);
 }
\ No newline at end of file
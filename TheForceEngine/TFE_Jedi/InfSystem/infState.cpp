@@ -3,6 +3,7 @@
 #include "infSystem.h"
 #include <TFE_DarkForces/sound.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/levelData.h>
@@ -477,6 +478,17 @@ namespace TFE_Jedi
 		SERIALIZE(InfState_InitVersion, trigger->textId, 0);
 	}
 		
+	void inf_registerRewindState()
+	{
+		REWIND_STATE(s_infSerState);
+		REWIND_STATE(s_infState);
+		REWIND_STATE(s_msgEntity);
+		REWIND_STATE(s_msgTarget);
+		REWIND_STATE(s_msgArg1);
+		REWIND_STATE(s_msgArg2);
+		REWIND_STATE(s_msgEvent);
+	}
+
 	void inf_serialize(Stream* stream)
 	{
 		SERIALIZE_VERSION(InfState_CurVersion);
@@ -14,6 +14,7 @@
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/levelData.h>
+#include <TFE_Jedi/Level/levelCache.h>
 #include <TFE_Jedi/Collision/collision.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_System/parser.h>
@@ -118,7 +119,7 @@ namespace TFE_Jedi
 
 	void inf_createElevatorTask()
 	{
-		s_infSerState.infElevators = allocator_create(sizeof(InfElevator));
+		s_infSerState.infElevators = allocator_createSlab(sizeof(InfElevator), 64);
 		s_infState.infElevTask = createSubTask("elevator", inf_elevatorTaskFunc, inf_elevatorTaskLocal);
 	}
 
@@ -126,7 +127,7 @@ namespace TFE_Jedi
 	{
 		s_infState.teleportTask = createSubTask("teleporter", inf_telelporterTaskFunc, inf_teleporterTaskLocal);
 		task_setNextTick(s_infState.teleportTask, TASK_SLEEP);
-		s_infSerState.infTeleports = allocator_create(sizeof(Teleport));
+		s_infSerState.infTeleports = allocator_createSlab(sizeof(Teleport), 16);
 	}
 
 	void inf_createTriggerTask()
@@ -134,7 +135,7 @@ namespace TFE_Jedi
 		s_infState.infTriggerTask = createSubTask("trigger", inf_triggerTaskFunc, inf_triggerTaskLocal);
 		s_infSerState.activeTriggerCount = 0;
 		// TFE: create a trigger allocator to make tracking easier.
-		s_infSerState.infTriggers = allocator_create(sizeof(InfTrigger));
+		s_infSerState.infTriggers = allocator_createSlab(sizeof(InfTrigger), 64);
 	}
 
 	InfLink* allocateLink(Allocator* infLinks, InfElevator* elev)
@@ -1202,6 +1203,18 @@ namespace TFE_Jedi
 		return seqEnd;
 	}
 
+	// The INF is cached as a table of preprocessed lines.
+	bool inf_compile(const char* source, size_t size, std::vector<char>& output)
+	{
+		TFE_Parser parser;
+		parser.init(source, size);
+		parser.enableBlockComments();
+		parser.addCommentString("//");
+		parser.convertToUpperCase(true);
+		parser.buildLineTable(output);
+		return true;
+	}
+
 	// For now load the INF data directly.
 	// Move back to asset later.
 	JBool inf_load(const char* levelName)
@@ -1210,29 +1223,15 @@ namespace TFE_Jedi
 		strcpy(levelPath, levelName);
 		strcat(levelPath, ".INF");
 
-		FilePath filePath;
-		if (!TFE_Paths::getFilePath(levelPath, &filePath))
+		if (!levelCache_load(levelPath, LCACHE_INF, inf_compile, s_buffer))
 		{
-			TFE_System::logWrite(LOG_ERROR, "level_loadINF", "Cannot find level INF '%s'.", levelPath);
+			TFE_System::logWrite(LOG_ERROR, "level_loadINF", "Cannot load level INF '%s'.", levelPath);
 			return JFALSE;
 		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
-		{
-			TFE_System::logWrite(LOG_ERROR, "level_loadINF", "Cannot open level INF '%s'.", levelPath);
-			return JFALSE;
-		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
 
 		TFE_Parser parser;
 		size_t bufferPos = 0;
-		parser.init(s_buffer.data(), s_buffer.size());
-		parser.enableBlockComments();
-		parser.addCommentString("//");
-		parser.convertToUpperCase(true);
+		parser.initLineTable(s_buffer.data(), s_buffer.size());
 
 		const char* line;
 		line = parser.readLine(bufferPos);
@@ -36,6 +36,7 @@ namespace TFE_Jedi
 	// Serialization & State
 	void inf_clearState();
 	void inf_serialize(Stream* stream);
+	void inf_registerRewindState();
 	
 	// ** Runtime API **
 	// Messages are the way entities and the player interact with the INF system during gameplay.
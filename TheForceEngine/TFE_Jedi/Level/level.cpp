@@ -3,9 +3,12 @@
 
 #include "level.h"
 #include "levelBin.h"
+#include "levelCache.h"
 #include "levelData.h"
+#include "levelStaging.h"
 #include "rwall.h"
 #include "rtexture.h"
+#include "rsectorGrid.h"
 #include <TFE_Game/igame.h>
 #include <TFE_Asset/assetSystem.h>
 #include <TFE_Asset/dfKeywords.h>
@@ -45,11 +48,19 @@ namespace TFE_Jedi
 	static s32 s_dataIndex;
 	static char s_readBuffer[256];
 	static std::vector<char> s_buffer;
+	static std::vector<char> s_objectBuffer;
 
-	JBool level_loadGeometry(const char* levelName);
+	JBool level_readGeometry(const char* levelName, JBool* built);
+	JBool level_buildGeometry(const char* data, size_t size);
+	JBool level_readObjects(const char* levelName);
 	JBool level_loadObjects(const char* levelName, u8 difficulty);
 	JBool level_loadGoals(const char* levelName);
 
+	static f64 level_getElapsedMs(u64 start, u64 end)
+	{
+		return 1000.0 * TFE_System::convertFromTicksToSeconds(end - start);
+	}
+
 	JBool level_load(const char* levelName, u8 difficulty)
 	{
 		if (!levelName) { return JFALSE; }
@@ -64,10 +75,42 @@ namespace TFE_Jedi
 			s_levelState.complete[COMPL_ITEM][i] = JFALSE;
 		}
 
-		if (!level_loadGeometry(levelName)) { return JFALSE; }
+		// TFE: Gather the assets referenced by the level, then read them on worker threads before building the level.
+		const u64 startTime = TFE_System::getCurrentTimeInTicks();
+		levelStaging_begin();
+		level_readObjects(levelName);
+		JBool geometryBuilt = JFALSE;
+		if (!level_readGeometry(levelName, &geometryBuilt))
+		{
+			levelStaging_end();
+			return JFALSE;
+		}
+		const u64 gatherTime = TFE_System::getCurrentTimeInTicks();
+
+		levelStaging_fetch();
+		const u64 fetchTime = TFE_System::getCurrentTimeInTicks();
+
+		if (!geometryBuilt && !level_buildGeometry(s_buffer.data(), s_buffer.size()))
+		{
+			levelStaging_end();
+			return JFALSE;
+		}
+		const u64 geometryTime = TFE_System::getCurrentTimeInTicks();
 		level_loadObjects(levelName, difficulty);
+		const u64 objectTime = TFE_System::getCurrentTimeInTicks();
 		inf_load(levelName);
+		const u64 infTime = TFE_System::getCurrentTimeInTicks();
 		level_loadGoals(levelName);
+		const u64 endTime = TFE_System::getCurrentTimeInTicks();
+
+		const LevelStagingStats* stats = levelStaging_getStats();
+		TFE_System::logWrite(LOG_MSG, "Level Load", "Loaded '%s' in %.2f ms: gather %.2f ms, fetch %.2f ms, geometry %.2f ms, objects %.2f ms, inf %.2f ms, goals %.2f ms.",
+			levelName, level_getElapsedMs(startTime, endTime), level_getElapsedMs(startTime, gatherTime), level_getElapsedMs(gatherTime, fetchTime),
+			level_getElapsedMs(fetchTime, geometryTime), level_getElapsedMs(geometryTime, objectTime), level_getElapsedMs(objectTime, infTime),
+			level_getElapsedMs(infTime, endTime));
+		TFE_System::logWrite(LOG_MSG, "Level Load", "Staged %d assets (%zu KB, %d textures decompressed) on %d threads, %.2f ms of worker time, %d assets not staged.",
+			stats->assetCount, stats->byteCount / 1024, stats->decodedCount, stats->threadCount, 1000.0 * stats->workerTime, stats->missingCount);
+		levelStaging_end();
 
 		return JTRUE;
 	}
@@ -115,11 +158,11 @@ namespace TFE_Jedi
 			sector->dirtyFlags = SDF_ALL;
 
 			// TFE: Try to figure out if a texture is for sky...
-			if ((sector->flags1 & SEC_FLAGS1_EXTERIOR) && (*sector->ceilTex))
+			if ((sector->flags1 & SEC_FLAGS1_EXTERIOR) && sector->ceilTex && (*sector->ceilTex))
 			{
 				(*sector->ceilTex)->flags |= ALWAYS_FULLBRIGHT;
 			}
-			if ((sector->flags1 & SEC_FLAGS1_PIT) && (*sector->floorTex))
+			if ((sector->flags1 & SEC_FLAGS1_PIT) && sector->floorTex && (*sector->floorTex))
 			{
 				(*sector->floorTex)->flags |= ALWAYS_FULLBRIGHT;
 			}
@@ -128,50 +171,35 @@ namespace TFE_Jedi
 		// Setup the control sector.
 		s_levelState.controlSector->id = s_levelState.sectorCount;
 		s_levelState.controlSector->index = s_levelState.controlSector->id;
+
+		// TFE: Spatial lookup for sector_which3D().
+		sectorGrid_build();
 	}
 
-	JBool level_loadGeometry(const char* levelName)
+	// Strings are stored in the compiled geometry string table, returns the string offset.
+	u32 level_addCompiledString(std::vector<char>& strings, const char* str)
 	{
-		s_levelState.secretCount = 0;
-		s_dataIndex = 0;
-		s_levelState.minLayer = INT_MAX;
-		s_levelState.maxLayer = INT_MIN;
-		message_free();
-
-		// Try loading as an LVB
-		if (level_loadGeometryBin(levelName, s_buffer))
-		{
-			return JTRUE;
-		}
-
-		// Otherwise load the LEV
-		char levelPath[TFE_MAX_PATH];
-		strcpy(levelPath, levelName);
-		strcat(levelPath, ".LEV");
-
-		FilePath filePath;
-		if (!TFE_Paths::getFilePath(levelPath, &filePath))
-		{
-			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot find level geometry '%s'.", levelName);
-			return false;
-		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
-		{
-			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot open level geometry '%s'.", levelName);
-			return false;
-		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
+		const u32 offset = u32(strings.size());
+		strings.insert(strings.end(), str, str + strlen(str) + 1);
+		return offset;
+	}
 
+	// Parse the LEV text into the flat CachedGeometry layout.
+	bool level_compileGeometry(const char* source, size_t size, std::vector<char>& output)
+	{
 		TFE_Parser parser;
 		size_t bufferPos = 0;
-		parser.init(s_buffer.data(), s_buffer.size());
+		parser.init(source, size);
 		parser.addCommentString("#");
 		parser.convertToUpperCase(true);
 
+		CachedGeometry geo = {};
+		std::vector<u32> textures;
+		std::vector<CachedSector> sectors;
+		std::vector<vec2_fixed> vertices;
+		std::vector<CachedWall> walls;
+		std::vector<char> strings;
+
 		// Only use the parser "read line" functionality and otherwise read in the same was as the DOS code.
 		const char* line;
 		line = parser.readLine(bufferPos);
@@ -196,13 +224,13 @@ namespace TFE_Jedi
 
 		// This gets read here just to be overwritten later... so just ignore for now.
 		line = parser.readLine(bufferPos);
-		if (sscanf(line, " PALETTE %s", s_levelState.levelPaletteName) != 1)
+		char paletteName[256];
+		if (sscanf(line, " PALETTE %s", paletteName) != 1)
 		{
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read palette name.");
 			return false;
 		}
-
-		level_loadPalette();
+		geo.paletteName = level_addCompiledString(strings, paletteName);
 		
 		// Another value that is ignored.
 		line = parser.readLine(bufferPos);
@@ -222,83 +250,52 @@ namespace TFE_Jedi
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read parallax values.");
 			return false;
 		}
-		s_levelState.parallax0 = floatToFixed16(parallax0);
-		s_levelState.parallax1 = floatToFixed16(parallax1);
+		geo.parallax0 = floatToFixed16(parallax0);
+		geo.parallax1 = floatToFixed16(parallax1);
 
 		// Number of textures used by the level.
 		line = parser.readLine(bufferPos);
-		if (sscanf(line, " TEXTURES %d", &s_levelState.textureCount) != 1)
+		if (sscanf(line, " TEXTURES %d", &geo.textureCount) != 1)
 		{
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read texture count.");
 			return false;
 		}
-		s_levelState.textures = (TextureData**)level_alloc(2 * s_levelState.textureCount * sizeof(TextureData**));
-		memset(s_levelState.textures, 0, 2 * s_levelState.textureCount * sizeof(TextureData**));
-
-		// Load Textures.
-		TextureData** texture = s_levelState.textures;
-		TextureData** texBase = s_levelState.textures + s_levelState.textureCount;
-		for (s32 i = 0; i < s_levelState.textureCount; i++, texture++, texBase++)
+		textures.resize(geo.textureCount);
+		for (s32 i = 0; i < geo.textureCount; i++)
 		{
 			line = parser.readLine(bufferPos);
 			char textureName[256];
-			if (sscanf(line, " TEXTURE: %s ", textureName) != 1)
+			if (!line || sscanf(line, " TEXTURE: %s ", textureName) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read texture name.");
-				*texture = bitmap_load("default.bm", 1);
-				(*texture)->flags |= ENABLE_MIP_MAPS;
+				textures[i] = LCACHE_TEX_DEFAULT;
 			}
 			else if (strcasecmp(textureName, "<NoTexture>") == 0)
 			{
-				*texture = nullptr;
+				textures[i] = LCACHE_NONE;
 			}
 			else
 			{
-				TextureData* tex = bitmap_load(textureName, 1);
-				if (!tex)
-				{
-					TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Could not open '%s', using 'default.bm' instead.", textureName);
-					tex = bitmap_load("default.bm", 1);
-					if (!tex)
-					{
-						TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "'default.bm' is not a valid BM file!");
-						assert(0);
-						return false;
-					}
-				}
-				// TFE - so we know which textures to mip.
-				tex->flags |= ENABLE_MIP_MAPS;
-				*texture = tex;
-				// This version never gets modified, so serialization is simpler.
-				*texBase = tex;
-
-				// Setup an animated texture.
-				if (tex->uvWidth == BM_ANIMATED_TEXTURE && !tex->animSetup)
-				{
-					bitmap_setupAnimatedTexture(texture, i);
-				}
+				textures[i] = level_addCompiledString(strings, textureName);
 			}
 		}
 
-		// Load Sectors.
+		// Sectors.
 		line = parser.readLine(bufferPos);
-		if (sscanf(line, "NUMSECTORS %d", &s_levelState.sectorCount) != 1)
+		if (sscanf(line, "NUMSECTORS %d", &geo.sectorCount) != 1)
 		{
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector count.");
 			return false;
 		}
 
-		s_levelState.sectors = (RSector*)level_alloc(sizeof(RSector) * s_levelState.sectorCount);
-		memset(s_levelState.sectors, 0, sizeof(RSector) * s_levelState.sectorCount);
-		for (u32 i = 0; i < s_levelState.sectorCount; i++)
+		sectors.resize(geo.sectorCount);
+		for (s32 i = 0; i < geo.sectorCount; i++)
 		{
-			RSector* sector = &s_levelState.sectors[i];
-			sector_clear(sector);
-			sector->index = i;
+			CachedSector* sector = &sectors[i];
 
 			// Sector ID and Name
 			line = parser.readLine(bufferPos);
-			if (sscanf(line, " SECTOR %d", &sector->id) != 1)
+			if (!line || sscanf(line, " SECTOR %d", &sector->id) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector id.");
 				return false;
@@ -309,30 +306,16 @@ namespace TFE_Jedi
 			// Sectors missing a name are valid but do not get "addresses" - and thus cannot be
 			// used by the INF system (except in the case of doors and exploding walls, see the flags section below).
 			char name[256];
-			if (sscanf(line, " NAME %s", name) == 1)
+			sector->name = LCACHE_NONE;
+			if (line && sscanf(line, " NAME %s", name) == 1)
 			{
-				// Add the sector "address" for later use by the INF system.
-				message_addAddress(name, 0, 0, sector);
-
-				// Track special elevators.
-				if (!strcasecmp(name, "complete"))
-				{
-					s_levelState.completeSector = sector;
-				}
-				else if (!strcasecmp(name, "boss"))
-				{
-					s_levelState.bossSector = sector;
-				}
-				else if (!strcasecmp(name, "mohc"))
-				{
-					s_levelState.mohcSector = sector;
-				}
+				sector->name = level_addCompiledString(strings, name);
 			}
 
 			// Lighting
 			line = parser.readLine(bufferPos);
 			s32 ambient;
-			if (sscanf(line, " AMBIENT %d", &ambient) != 1)
+			if (!line || sscanf(line, " AMBIENT %d", &ambient) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector ambient.");
 				return false;
@@ -341,26 +324,20 @@ namespace TFE_Jedi
 
 			// Floor Texture & Offset
 			line = parser.readLine(bufferPos);
-			s32 index, tmp;
+			s32 tmp;
 			f32 offsetX, offsetZ;
-			if (sscanf(line, " FLOOR TEXTURE %d %f %f %d", &index, &offsetX, &offsetZ, &tmp) != 4)
+			if (!line || sscanf(line, " FLOOR TEXTURE %d %f %f %d", &sector->floorTex, &offsetX, &offsetZ, &tmp) != 4)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read floor texture.");
 				return false;
 			}
-
-			sector->floorTex = nullptr;
-			if (index != -1)
-			{
-				sector->floorTex = &s_levelState.textures[index];
-			}
 			sector->floorOffset.x = floatToFixed16(offsetX);
 			sector->floorOffset.z = floatToFixed16(offsetZ);
 
 			// Floor Altitude
 			line = parser.readLine(bufferPos);
 			f32 alt;
-			if (sscanf(line, " FLOOR ALTITUDE %f", &alt) != 1)
+			if (!line || sscanf(line, " FLOOR ALTITUDE %f", &alt) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read floor altitude.");
 				return false;
@@ -369,31 +346,26 @@ namespace TFE_Jedi
 
 			// Ceiling Texture & Offset
 			line = parser.readLine(bufferPos);
-			if (sscanf(line, " CEILING TEXTURE %d %f %f %d", &index, &offsetX, &offsetZ, &tmp) != 4)
+			if (!line || sscanf(line, " CEILING TEXTURE %d %f %f %d", &sector->ceilTex, &offsetX, &offsetZ, &tmp) != 4)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read ceiling texture.");
 				return false;
 			}
-			sector->ceilTex = nullptr;
-			if (index != -1)
-			{
-				sector->ceilTex = &s_levelState.textures[index];
-			}
 			sector->ceilOffset.x = floatToFixed16(offsetX);
 			sector->ceilOffset.z = floatToFixed16(offsetZ);
 
 			// Ceiling Altitude
 			line = parser.readLine(bufferPos);
-			if (sscanf(line, " CEILING ALTITUDE %f", &alt) != 1)
+			if (!line || sscanf(line, " CEILING ALTITUDE %f", &alt) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read ceiling altitude.");
 				return false;
 			}
-			sector->ceilingHeight = floatToFixed16(alt);
+			sector->ceilHeight = floatToFixed16(alt);
 
 			// Second Altitude
 			line = parser.readLine(bufferPos);
-			if (sscanf(line, " SECOND ALTITUDE %f", &alt) != 1)
+			if (!line || sscanf(line, " SECOND ALTITUDE %f", &alt) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read second altitude.");
 				return false;
@@ -402,158 +374,371 @@ namespace TFE_Jedi
 
 			// Sector flags
 			line = parser.readLine(bufferPos);
-			if (sscanf(line, " FLAGS %d %d %d", &sector->flags1, &sector->flags2, &sector->flags3) != 3)
+			if (!line || sscanf(line, " FLAGS %d %d %d", &sector->flags1, &sector->flags2, &sector->flags3) != 3)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector flags.");
 				return false;
 			}
-			// Create a door if needed.
-			if (sector->flags1 & SEC_FLAGS1_DOOR)
-			{
-				InfElevator* elev = inf_allocateSpecialElevator(sector, IELEV_SP_DOOR);
-				if (elev) { elev->flags |= INF_EFLAG_DOOR; }
-			}
-			// Create an exploding wall if needed.
-			if (sector->flags1 & SEC_FLAGS1_EXP_WALL)
-			{
-				inf_allocateSpecialElevator(sector, IELEV_SP_EXPLOSIVE_WALL);
-			}
-			// Add secrets.
-			if (sector->flags1 & SEC_FLAGS1_SECRET)
-			{
-				s_levelState.secretCount++;
-			}
 
 			// Layer
 			line = parser.readLine(bufferPos);
-			if (sscanf(line, " LAYER %d", &sector->layer) != 1)
+			if (!line || sscanf(line, " LAYER %d", &sector->layer) != 1)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector layer.");
 				return false;
 			}
-			s_levelState.minLayer = min(s_levelState.minLayer, sector->layer);
-			s_levelState.maxLayer = max(s_levelState.maxLayer, sector->layer);
 
 			// Vertices
 			line = parser.readLine(bufferPos);
-			s32 vertexCount;
-			if (sscanf(line, " VERTICES %d", &vertexCount) != 1)
+			if (!line || sscanf(line, " VERTICES %d", &sector->vertexCount) != 1 || sector->vertexCount < 0)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector vertices.");
 				return false;
 			}
-			const size_t vtxSize = vertexCount * sizeof(vec2_fixed);
-			sector->verticesWS = (vec2_fixed*)level_alloc(vtxSize);
-			sector->verticesVS = (vec2_fixed*)level_alloc(vtxSize);
-			sector->vertexCount = vertexCount;
+			sector->vertexStart = s32(vertices.size());
+			vertices.resize(vertices.size() + sector->vertexCount);
 
-			for (s32 v = 0; v < vertexCount; v++)
+			vec2_fixed* vtx = &vertices[sector->vertexStart];
+			for (s32 v = 0; v < sector->vertexCount; v++)
 			{
 				line = parser.readLine(bufferPos);
 
-				f32 x, z;
-				sscanf(line, " X: %f Z: %f ", &x, &z);
-				sector->verticesWS[v].x = floatToFixed16(x);
-				sector->verticesWS[v].z = floatToFixed16(z);
+				f32 x = 0.0f, z = 0.0f;
+				if (line) { sscanf(line, " X: %f Z: %f ", &x, &z); }
+				vtx[v].x = floatToFixed16(x);
+				vtx[v].z = floatToFixed16(z);
 			}
 
 			// Walls
 			line = parser.readLine(bufferPos);
-			s32 wallCount;
-			if (sscanf(line, " WALLS %d", &wallCount) != 1)
+			if (!line || sscanf(line, " WALLS %d", &sector->wallCount) != 1 || sector->wallCount < 0)
 			{
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector walls.");
 				return false;
 			}
-			sector->walls = (RWall*)level_alloc(wallCount * sizeof(RWall));
-			sector->wallCount = wallCount;
+			sector->wallStart = s32(walls.size());
+			walls.resize(walls.size() + sector->wallCount);
 
-			for (s32 w = 0; w < wallCount; w++)
+			CachedWall* wall = &walls[sector->wallStart];
+			for (s32 w = 0; w < sector->wallCount; w++, wall++)
 			{
-				s32 light, flags3, flags2, flags1, walk, mirror, adjoin;
-				s32 signTex, unused;
-				s32 botTex, topTex, midTex, right, left;
+				s32 light, walk, unused;
 				f32 signOffsetZ, signOffsetX;
 				f32 botOffsetZ, botOffsetX;
 				f32 topOffsetZ, topOffsetX;
 				f32 midOffsetZ, midOffsetX;
 
 				line = parser.readLine(bufferPos);
-				if (sscanf(line, " WALL LEFT: %d RIGHT: %d MID: %d %f %f %d TOP: %d %f %f %d BOT: %d %f %f %d SIGN: %d %f %f ADJOIN: %d MIRROR: %d WALK: %d FLAGS: %d %d %d LIGHT: %d",
-					&left, &right, &midTex, &midOffsetX, &midOffsetZ, &unused, &topTex, &topOffsetX, &topOffsetZ, &unused, &botTex, &botOffsetX, &botOffsetZ, &unused,
-					&signTex, &signOffsetX, &signOffsetZ, &adjoin, &mirror, &walk, &flags1, &flags2, &flags3, &light) != 24)
+				if (!line || sscanf(line, " WALL LEFT: %d RIGHT: %d MID: %d %f %f %d TOP: %d %f %f %d BOT: %d %f %f %d SIGN: %d %f %f ADJOIN: %d MIRROR: %d WALK: %d FLAGS: %d %d %d LIGHT: %d",
+					&wall->left, &wall->right, &wall->midTex, &midOffsetX, &midOffsetZ, &unused, &wall->topTex, &topOffsetX, &topOffsetZ, &unused, &wall->botTex, &botOffsetX, &botOffsetZ, &unused,
+					&wall->signTex, &signOffsetX, &signOffsetZ, &wall->adjoin, &wall->mirror, &walk, &wall->flags1, &wall->flags2, &wall->flags3, &light) != 24)
 				{
 					TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read wall.");
 					return false;
 				}
+				wall->midOffset.x  = floatToFixed16(midOffsetX) * 8;
+				wall->midOffset.z  = floatToFixed16(midOffsetZ) * 8;
+				wall->topOffset.x  = floatToFixed16(topOffsetX) * 8;
+				wall->topOffset.z  = floatToFixed16(topOffsetZ) * 8;
+				wall->botOffset.x  = floatToFixed16(botOffsetX) * 8;
+				wall->botOffset.z  = floatToFixed16(botOffsetZ) * 8;
+				wall->signOffset.x = floatToFixed16(signOffsetX) * 8;
+				wall->signOffset.z = floatToFixed16(signOffsetZ) * 8;
+				wall->light = intToFixed16(light);
+			}
+		}
+		geo.vertexCount = s32(vertices.size());
+		geo.wallCount = s32(walls.size());
+
+		// Pack everything into a single block, all of the arrays are 4 byte aligned.
+		geo.textureOffset = sizeof(CachedGeometry);
+		geo.sectorOffset  = geo.textureOffset + u32(textures.size() * sizeof(u32));
+		geo.vertexOffset  = geo.sectorOffset  + u32(sectors.size() * sizeof(CachedSector));
+		geo.wallOffset    = geo.vertexOffset  + u32(vertices.size() * sizeof(vec2_fixed));
+		geo.stringOffset  = geo.wallOffset    + u32(walls.size() * sizeof(CachedWall));
+		geo.stringSize    = u32(strings.size());
+
+		output.resize(geo.stringOffset + geo.stringSize);
+		char* data = output.data();
+		memcpy(data, &geo, sizeof(CachedGeometry));
+		if (!textures.empty()) { memcpy(data + geo.textureOffset, textures.data(), textures.size() * sizeof(u32)); }
+		if (!sectors.empty())  { memcpy(data + geo.sectorOffset, sectors.data(), sectors.size() * sizeof(CachedSector)); }
+		if (!vertices.empty()) { memcpy(data + geo.vertexOffset, vertices.data(), vertices.size() * sizeof(vec2_fixed)); }
+		if (!walls.empty())    { memcpy(data + geo.wallOffset, walls.data(), walls.size() * sizeof(CachedWall)); }
+		if (!strings.empty())  { memcpy(data + geo.stringOffset, strings.data(), strings.size()); }
+		return true;
+	}
+
+	// Validate the compiled geometry layout before using it.
+	bool level_validateCompiledGeometry(const char* data, size_t size)
+	{
+		if (size < sizeof(CachedGeometry)) { return false; }
+		const CachedGeometry* geo = (const CachedGeometry*)data;
+		if (geo->textureCount < 0 || geo->sectorCount < 0 || geo->vertexCount < 0 || geo->wallCount < 0) { return false; }
+
+		const u64 textureEnd = u64(geo->textureOffset) + u64(geo->textureCount) * sizeof(u32);
+		const u64 sectorEnd  = u64(geo->sectorOffset)  + u64(geo->sectorCount)  * sizeof(CachedSector);
+		const u64 vertexEnd  = u64(geo->vertexOffset)  + u64(geo->vertexCount)  * sizeof(vec2_fixed);
+		const u64 wallEnd    = u64(geo->wallOffset)    + u64(geo->wallCount)    * sizeof(CachedWall);
+		const u64 stringEnd  = u64(geo->stringOffset)  + u64(geo->stringSize);
+		if (textureEnd > size || sectorEnd > size || vertexEnd > size || wallEnd > size || stringEnd > size) { return false; }
+		if (!geo->stringSize || data[geo->stringOffset + geo->stringSize - 1] != 0 || geo->paletteName >= geo->stringSize) { return false; }
+
+		const CachedSector* sector = (const CachedSector*)(data + geo->sectorOffset);
+		for (s32 i = 0; i < geo->sectorCount; i++, sector++)
+		{
+			if (sector->vertexStart < 0 || sector->vertexCount < 0 || sector->vertexStart + sector->vertexCount > geo->vertexCount) { return false; }
+			if (sector->wallStart < 0 || sector->wallCount < 0 || sector->wallStart + sector->wallCount > geo->wallCount) { return false; }
+			if (sector->name != LCACHE_NONE && sector->name >= geo->stringSize) { return false; }
+
+			// Texture and adjoin indices are checked when the level is built, so bad ones can be dropped instead of failing the load.
+			const CachedWall* wall = (const CachedWall*)(data + geo->wallOffset) + sector->wallStart;
+			for (s32 w = 0; w < sector->wallCount; w++, wall++)
+			{
+				if (wall->left < 0 || wall->left >= sector->vertexCount || wall->right < 0 || wall->right >= sector->vertexCount) { return false; }
+			}
+		}
+		return true;
+	}
+
+	// Get a texture from the compiled geometry, an out of range index is treated as no texture.
+	static TextureData** level_getTexture(s32 index, s32 sectorIndex, s32 wallIndex, const char* usage)
+	{
+		if (index < -1 || index >= s_levelState.textureCount)
+		{
+			if (wallIndex >= 0)
+			{
+				TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Sector %d, wall %d has an invalid %s texture index %d, ignoring the texture.", sectorIndex, wallIndex, usage, index);
+			}
+			else
+			{
+				TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Sector %d has an invalid %s texture index %d, ignoring the texture.", sectorIndex, usage, index);
+			}
+			return nullptr;
+		}
+		return (index != -1) ? &s_levelState.textures[index] : nullptr;
+	}
 
+	// Create the level sectors and walls from the compiled geometry.
+	JBool level_buildGeometry(const char* data, size_t size)
+	{
+		if (!level_validateCompiledGeometry(data, size))
+		{
+			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Invalid compiled level geometry.");
+			return JFALSE;
+		}
+		const CachedGeometry* geo = (const CachedGeometry*)data;
+		const u32* textureNames = (const u32*)(data + geo->textureOffset);
+		const CachedSector* srcSectors = (const CachedSector*)(data + geo->sectorOffset);
+		const vec2_fixed* srcVertices = (const vec2_fixed*)(data + geo->vertexOffset);
+		const CachedWall* srcWalls = (const CachedWall*)(data + geo->wallOffset);
+		const char* strings = data + geo->stringOffset;
+
+		strncpy(s_levelState.levelPaletteName, strings + geo->paletteName, sizeof(s_levelState.levelPaletteName) - 1);
+		s_levelState.levelPaletteName[sizeof(s_levelState.levelPaletteName) - 1] = 0;
+		level_loadPalette();
+
+		s_levelState.parallax0 = geo->parallax0;
+		s_levelState.parallax1 = geo->parallax1;
+
+		// Load Textures.
+		s_levelState.textureCount = geo->textureCount;
+		s_levelState.textures = (TextureData**)level_alloc(2 * s_levelState.textureCount * sizeof(TextureData**));
+		memset(s_levelState.textures, 0, 2 * s_levelState.textureCount * sizeof(TextureData**));
+
+		TextureData** texture = s_levelState.textures;
+		TextureData** texBase = s_levelState.textures + s_levelState.textureCount;
+		for (s32 i = 0; i < s_levelState.textureCount; i++, texture++, texBase++)
+		{
+			if (textureNames[i] == LCACHE_TEX_DEFAULT)
+			{
+				*texture = bitmap_load("default.bm", 1);
+				(*texture)->flags |= ENABLE_MIP_MAPS;
+			}
+			else if (textureNames[i] == LCACHE_NONE || textureNames[i] >= geo->stringSize)
+			{
+				*texture = nullptr;
+			}
+			else
+			{
+				const char* textureName = strings + textureNames[i];
+				TextureData* tex = bitmap_load(textureName, 1);
+				if (!tex)
+				{
+					TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Could not open '%s', using 'default.bm' instead.", textureName);
+					tex = bitmap_load("default.bm", 1);
+					if (!tex)
+					{
+						TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "'default.bm' is not a valid BM file!");
+						assert(0);
+						return JFALSE;
+					}
+				}
+				// TFE - so we know which textures to mip.
+				tex->flags |= ENABLE_MIP_MAPS;
+				*texture = tex;
+				// This version never gets modified, so serialization is simpler.
+				*texBase = tex;
+
+				// Setup an animated texture.
+				if (tex->uvWidth == BM_ANIMATED_TEXTURE && !tex->animSetup)
+				{
+					bitmap_setupAnimatedTexture(texture, i);
+				}
+			}
+		}
+
+		// Load Sectors.
+		s_levelState.sectorCount = geo->sectorCount;
+		s_levelState.sectors = (RSector*)level_alloc(sizeof(RSector) * s_levelState.sectorCount);
+		memset(s_levelState.sectors, 0, sizeof(RSector) * s_levelState.sectorCount);
+		for (u32 i = 0; i < s_levelState.sectorCount; i++)
+		{
+			const CachedSector* src = &srcSectors[i];
+			RSector* sector = &s_levelState.sectors[i];
+			sector_clear(sector);
+			sector->index = i;
+			sector->id = src->id;
+
+			if (src->name != LCACHE_NONE)
+			{
+				const char* name = strings + src->name;
+				// Add the sector "address" for later use by the INF system.
+				message_addAddress(name, 0, 0, sector);
+
+				// Track special elevators.
+				if (!strcasecmp(name, "complete"))
+				{
+					s_levelState.completeSector = sector;
+				}
+				else if (!strcasecmp(name, "boss"))
+				{
+					s_levelState.bossSector = sector;
+				}
+				else if (!strcasecmp(name, "mohc"))
+				{
+					s_levelState.mohcSector = sector;
+				}
+			}
+
+			sector->ambient = src->ambient;
+			sector->floorTex = level_getTexture(src->floorTex, i, -1, "floor");
+			sector->floorOffset = src->floorOffset;
+			sector->floorHeight = src->floorHeight;
+			sector->ceilTex = level_getTexture(src->ceilTex, i, -1, "ceiling");
+			sector->ceilOffset = src->ceilOffset;
+			sector->ceilingHeight = src->ceilHeight;
+			sector->secHeight = src->secHeight;
+			sector->flags1 = src->flags1;
+			sector->flags2 = src->flags2;
+			sector->flags3 = src->flags3;
+
+			// Create a door if needed.
+			if (sector->flags1 & SEC_FLAGS1_DOOR)
+			{
+				InfElevator* elev = inf_allocateSpecialElevator(sector, IELEV_SP_DOOR);
+				if (elev) { elev->flags |= INF_EFLAG_DOOR; }
+			}
+			// Create an exploding wall if needed.
+			if (sector->flags1 & SEC_FLAGS1_EXP_WALL)
+			{
+				inf_allocateSpecialElevator(sector, IELEV_SP_EXPLOSIVE_WALL);
+			}
+			// Add secrets.
+			if (sector->flags1 & SEC_FLAGS1_SECRET)
+			{
+				s_levelState.secretCount++;
+			}
+
+			sector->layer = src->layer;
+			s_levelState.minLayer = min(s_levelState.minLayer, sector->layer);
+			s_levelState.maxLayer = max(s_levelState.maxLayer, sector->layer);
+
+			// Vertices
+			const size_t vtxSize = src->vertexCount * sizeof(vec2_fixed);
+			sector->verticesWS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->verticesVS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->vertexCount = src->vertexCount;
+			memcpy(sector->verticesWS, &srcVertices[src->vertexStart], vtxSize);
+
+			// Walls
+			sector->walls = (RWall*)level_alloc(src->wallCount * sizeof(RWall));
+			sector->wallCount = src->wallCount;
+
+			const CachedWall* srcWall = &srcWalls[src->wallStart];
+			for (s32 w = 0; w < src->wallCount; w++, srcWall++)
+			{
 				RWall* wall = &sector->walls[w];
 				wall->id = w;
 				wall->sector = sector;
 				wall->mirrorWall = nullptr;
 				wall->seen = JFALSE;
-				wall->flags1 = flags1;
-				wall->flags2 = flags2;
-				wall->flags3 = flags3;
+				wall->flags1 = srcWall->flags1;
+				wall->flags2 = srcWall->flags2;
+				wall->flags3 = srcWall->flags3;
 
-				vec2_fixed* leftVtxWS = &sector->verticesWS[left];
-				vec2_fixed* rightVtxWS = &sector->verticesWS[right];
+				vec2_fixed* leftVtxWS = &sector->verticesWS[srcWall->left];
+				vec2_fixed* rightVtxWS = &sector->verticesWS[srcWall->right];
 				wall->w0 = leftVtxWS;
 				wall->w1 = rightVtxWS;
-				wall->v0 = &sector->verticesVS[left];
-				wall->v1 = &sector->verticesVS[right];
+				wall->v0 = &sector->verticesVS[srcWall->left];
+				wall->v1 = &sector->verticesVS[srcWall->right];
 				// Store the original position 0 in the wall since it is used by the sector rotation INF.
 				wall->worldPos0.x = leftVtxWS->x;
 				wall->worldPos0.z = leftVtxWS->z;
 
 				wall->nextSector = nullptr;
 				wall->mirror = -1;
-				if (adjoin != -1)
+				if (srcWall->adjoin < -1 || srcWall->adjoin >= geo->sectorCount)
 				{
-					wall->nextSector = &s_levelState.sectors[adjoin];
-					if (mirror == -1)
+					TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Sector %d, wall %d has an invalid adjoin %d, ignoring the adjoin.", i, w, srcWall->adjoin);
+				}
+				else if (srcWall->adjoin != -1)
+				{
+					if (srcWall->mirror == -1)
 					{
 						TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Adjoining wall missing mirror.");
 					}
-					wall->mirror = mirror;
+					// The mirror indexes the walls of the adjoined sector, so drop the adjoin if it is out of range.
+					if (srcWall->mirror < 0 || srcWall->mirror >= srcSectors[srcWall->adjoin].wallCount)
+					{
+						TFE_System::logWrite(LOG_WARNING, "level_loadGeometry", "Sector %d, wall %d has an invalid mirror %d, ignoring the adjoin.", i, w, srcWall->mirror);
+					}
+					else
+					{
+						wall->nextSector = &s_levelState.sectors[srcWall->adjoin];
+						wall->mirror = srcWall->mirror;
+					}
 				}
 
 				wall->infLink = nullptr;
 				wall->collisionFrame = 0;
 				wall->drawFrame = 0;
 				wall->drawFlags = 0;
-				wall->wallLight = intToFixed16(light);
+				wall->wallLight = srcWall->light;
 
-				wall->midTex = nullptr;
-				if (midTex != -1)
+				wall->midTex = level_getTexture(srcWall->midTex, i, w, "mid");
+				if (wall->midTex)
 				{
-					wall->midTex = &s_levelState.textures[midTex];
-					wall->midOffset.x = floatToFixed16(midOffsetX) * 8;
-					wall->midOffset.z = floatToFixed16(midOffsetZ) * 8;
+					wall->midOffset = srcWall->midOffset;
 				}
 
-				wall->topTex = nullptr;
-				if (topTex != -1)
+				wall->topTex = level_getTexture(srcWall->topTex, i, w, "top");
+				if (wall->topTex)
 				{
-					wall->topTex = &s_levelState.textures[topTex];
-					wall->topOffset.x = floatToFixed16(topOffsetX) * 8;
-					wall->topOffset.z = floatToFixed16(topOffsetZ) * 8;
+					wall->topOffset = srcWall->topOffset;
 				}
 
-				wall->botTex = nullptr;
-				if (botTex != -1)
+				wall->botTex = level_getTexture(srcWall->botTex, i, w, "bot");
+				if (wall->botTex)
 				{
-					wall->botTex = &s_levelState.textures[botTex];
-					wall->botOffset.x = floatToFixed16(botOffsetX) * 8;
-					wall->botOffset.z = floatToFixed16(botOffsetZ) * 8;
+					wall->botOffset = srcWall->botOffset;
 				}
 
-				wall->signTex = nullptr;
-				if (signTex != -1)
+				wall->signTex = level_getTexture(srcWall->signTex, i, w, "sign");
+				if (wall->signTex)
 				{
-					wall->signTex = &s_levelState.textures[signTex];
-					wall->signOffset.x = floatToFixed16(signOffsetX) * 8;
-					wall->signOffset.z = floatToFixed16(signOffsetZ) * 8;
+					wall->signOffset = srcWall->signOffset;
 				}
 
 				fixed16_16 dx = rightVtxWS->x - leftVtxWS->x;
@@ -566,10 +751,59 @@ namespace TFE_Jedi
 		}
 
 		level_postProcessGeometry();
-
-		return true;
+		return JTRUE;
 	}
 
+	// Read the compiled level geometry into s_buffer and gather its textures for staging.
+	// LVB levels are built directly, in which case 'built' is set to JTRUE.
+	JBool level_readGeometry(const char* levelName, JBool* built)
+	{
+		s_levelState.secretCount = 0;
+		s_dataIndex = 0;
+		s_levelState.minLayer = INT_MAX;
+		s_levelState.maxLayer = INT_MIN;
+		message_free();
+
+		// Try loading as an LVB
+		*built = JFALSE;
+		if (level_loadGeometryBin(levelName, s_buffer))
+		{
+			*built = JTRUE;
+			return JTRUE;
+		}
+
+		// Otherwise load the LEV, using the compiled version from the level cache when it is up to date.
+		char levelPath[TFE_MAX_PATH];
+		strcpy(levelPath, levelName);
+		strcat(levelPath, ".LEV");
+
+		if (!levelCache_load(levelPath, LCACHE_GEOMETRY, level_compileGeometry, s_buffer))
+		{
+			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot load level geometry '%s'.", levelName);
+			return JFALSE;
+		}
+
+		// Invalid geometry is reported when it is built.
+		const char* data = s_buffer.data();
+		if (level_validateCompiledGeometry(data, s_buffer.size()))
+		{
+			const CachedGeometry* geo = (const CachedGeometry*)data;
+			const u32* textureNames = (const u32*)(data + geo->textureOffset);
+			const char* strings = data + geo->stringOffset;
+			for (s32 i = 0; i < geo->textureCount; i++)
+			{
+				if (textureNames[i] == LCACHE_TEX_DEFAULT)
+				{
+					levelStaging_add(LASSET_TEXTURE, "default.bm");
+				}
+				else if (textureNames[i] != LCACHE_NONE && textureNames[i] < geo->stringSize)
+				{
+					levelStaging_add(LASSET_TEXTURE, strings + textureNames[i]);
+				}
+			}
+		}
+		return JTRUE;
+	}
 	void level_freeAllAssets()
 	{
 		TFE_Sprite_Jedi::freeLevelData();
@@ -701,39 +935,74 @@ namespace TFE_Jedi
 		// TODO
 	}
 
-	JBool level_loadObjects(const char* levelName, u8 difficulty)
+	// The objects are cached as a table of preprocessed lines.
+	bool level_compileObjects(const char* source, size_t size, std::vector<char>& output)
+	{
+		TFE_Parser parser;
+		parser.init(source, size);
+		parser.enableBlockComments();
+		parser.addCommentString("//");
+		parser.addCommentString("#");
+		parser.convertToUpperCase(true);
+		parser.buildLineTable(output);
+		return true;
+	}
+
+	// Read the compiled object file into s_objectBuffer and gather the pods, sprites, frames and sounds for staging.
+	JBool level_readObjects(const char* levelName)
 	{
 		char levelPath[TFE_MAX_PATH];
 		strcpy(levelPath, levelName);
 		strcat(levelPath, ".O");
 
-		s32 curDiff = s32(difficulty) + 1;
+		if (!levelCache_load(levelPath, LCACHE_OBJECTS, level_compileObjects, s_objectBuffer))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Level Load", "Cannot load level objects '%s'.", levelName);
+			s_objectBuffer.clear();
+			return JFALSE;
+		}
 
-		FilePath filePath;
-		if (!TFE_Paths::getFilePath(levelPath, &filePath))
+		TFE_Parser parser;
+		size_t bufferPos = 0;
+		parser.initLineTable(s_objectBuffer.data(), s_objectBuffer.size());
+
+		const char* line;
+		char name[32];
+		while (line = parser.readLine(bufferPos))
 		{
-			TFE_System::logWrite(LOG_ERROR, "Level Load", "Cannot find level objects '%s'.", levelName);
-			return false;
+			if (sscanf(line, " POD: %31s", name) == 1)
+			{
+				levelStaging_add(LASSET_MODEL, name);
+			}
+			else if (sscanf(line, " SPR: %31s", name) == 1)
+			{
+				levelStaging_add(LASSET_WAX, name);
+			}
+			else if (sscanf(line, " FME: %31s", name) == 1)
+			{
+				levelStaging_add(LASSET_FRAME, name);
+			}
+			else if (sscanf(line, " SOUND: %31s", name) == 1)
+			{
+				levelStaging_add(LASSET_SOUND, name);
+			}
 		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
+		return JTRUE;
+	}
+
+	JBool level_loadObjects(const char* levelName, u8 difficulty)
+	{
+		s32 curDiff = s32(difficulty) + 1;
+
+		// The object file is read by level_readObjects(), which reports any errors.
+		if (s_objectBuffer.empty())
 		{
-			TFE_System::logWrite(LOG_ERROR, "Level Load", "Cannot open level objects '%s'.", levelName);
 			return false;
 		}
 
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
-
 		TFE_Parser parser;
 		size_t bufferPos = 0;
-		parser.init(s_buffer.data(), s_buffer.size());
-		parser.enableBlockComments();
-		parser.addCommentString("//");
-		parser.addCommentString("#");
-		parser.convertToUpperCase(true);
+		parser.initLineTable(s_objectBuffer.data(), s_objectBuffer.size());
 
 		// Only use the parser "read line" functionality and otherwise read in the same was as the DOS code.
 		const char* line;
@@ -0,0 +1,148 @@
+#include <cstring>
+
+#include "levelCache.h"
+#include <TFE_Archive/archive.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_System/system.h>
+
+namespace TFE_Jedi
+{
+	enum LevelCacheVersion
+	{
+		LCVER_INIT = 1,
+		LCVER_CUR = LCVER_INIT
+	};
+
+	struct LevelCacheHeader
+	{
+		char sig[4];
+		u32  version;
+		u32  kind;
+		u32  sourceSize;
+		u64  sourceHash;
+		u32  dataSize;
+		u32  pad;
+	};
+
+	static const char c_levelCacheSig[4] = { 'T', 'F', 'L', 'C' };
+	static const char* c_levelCacheExt[LCACHE_COUNT] = { "geo", "obj", "inf" };
+
+	static std::vector<char> s_source;
+	static char s_cacheDir[TFE_MAX_PATH] = { 0 };
+
+	u64 levelCache_hash(const void* data, size_t size)
+	{
+		// FNV-1a
+		const u8* bytes = (const u8*)data;
+		u64 hash = 14695981039346656037ull;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void levelCache_getPath(const FilePath& filePath, const char* fileName, LevelCacheKind kind, char* cachePath)
+	{
+		if (!s_cacheDir[0])
+		{
+			TFE_Paths::appendPath(PATH_PROGRAM_DATA, "Cache/", s_cacheDir);
+			FileUtil::makeDirectory(s_cacheDir);
+			strcat(s_cacheDir, "Levels/");
+			FileUtil::makeDirectory(s_cacheDir);
+		}
+
+		// Files with the same name from different archives or directories get different cache entries.
+		const char* source = filePath.archive ? filePath.archive->getPath() : filePath.path;
+		const u32 sourceHash = u32(levelCache_hash(source, strlen(source)));
+		snprintf(cachePath, TFE_MAX_PATH, "%s%s_%08x.%s", s_cacheDir, fileName, sourceHash, c_levelCacheExt[kind]);
+	}
+
+	bool levelCache_read(const char* cachePath, LevelCacheKind kind, u64 sourceHash, std::vector<char>& output)
+	{
+		FileStream file;
+		if (!file.open(cachePath, Stream::MODE_READ))
+		{
+			return false;
+		}
+		LevelCacheHeader header;
+		const size_t size = file.getSize();
+		if (size < sizeof(LevelCacheHeader) || file.readBuffer(&header, sizeof(LevelCacheHeader)) != sizeof(LevelCacheHeader))
+		{
+			file.close();
+			return false;
+		}
+		if (memcmp(header.sig, c_levelCacheSig, 4) != 0 || header.version != LCVER_CUR || header.kind != kind ||
+			header.sourceSize != u32(s_source.size()) || header.sourceHash != sourceHash || header.dataSize != size - sizeof(LevelCacheHeader))
+		{
+			file.close();
+			return false;
+		}
+
+		// The compiled data is used in place.
+		output.resize(header.dataSize);
+		const bool result = file.readBuffer(output.data(), header.dataSize) == header.dataSize;
+		file.close();
+		return result;
+	}
+
+	void levelCache_write(const char* cachePath, LevelCacheKind kind, u64 sourceHash, const std::vector<char>& data)
+	{
+		FileStream file;
+		if (!file.open(cachePath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "LevelCache", "Cannot write level cache '%s'.", cachePath);
+			return;
+		}
+
+		LevelCacheHeader header = {};
+		memcpy(header.sig, c_levelCacheSig, 4);
+		header.version = LCVER_CUR;
+		header.kind = kind;
+		header.sourceSize = u32(s_source.size());
+		header.sourceHash = sourceHash;
+		header.dataSize = u32(data.size());
+		file.writeBuffer(&header, sizeof(LevelCacheHeader));
+		file.writeBuffer(data.data(), u32(data.size()));
+		file.close();
+	}
+
+	/////////////////////////////////////////////
+	// API
+	/////////////////////////////////////////////
+	bool levelCache_load(const char* fileName, LevelCacheKind kind, LevelCompileFunc compile, std::vector<char>& output)
+	{
+		FilePath filePath;
+		if (!TFE_Paths::getFilePath(fileName, &filePath))
+		{
+			return false;
+		}
+		FileStream file;
+		if (!file.open(&filePath, Stream::MODE_READ))
+		{
+			return false;
+		}
+		const size_t len = file.getSize();
+		s_source.resize(len);
+		file.readBuffer(s_source.data(), u32(len));
+		file.close();
+
+		const u64 sourceHash = levelCache_hash(s_source.data(), s_source.size());
+		char cachePath[TFE_MAX_PATH];
+		levelCache_getPath(filePath, fileName, kind, cachePath);
+		if (levelCache_read(cachePath, kind, sourceHash, output))
+		{
+			return true;
+		}
+
+		if (!compile(s_source.data(), s_source.size(), output))
+		{
+			return false;
+		}
+		levelCache_write(cachePath, kind, sourceHash, output);
+		return true;
+	}
+}
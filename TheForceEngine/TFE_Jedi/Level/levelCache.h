@@ -0,0 +1,100 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Level Cache
+// Compiled versions of the level source files (.LEV, .O, .INF) are
+// cached on disk so the text only needs to be parsed once.
+//
+// Each cache entry is keyed by the source archive (or directory),
+// the file name and a hash of the file contents. The compiled data is
+// a flat block using offsets rather than pointers, so it is loaded
+// with a single read and used in place.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_Jedi/Math/core_math.h>
+#include <TFE_Jedi/Math/fixedPoint.h>
+#include <vector>
+
+namespace TFE_Jedi
+{
+	enum LevelCacheKind
+	{
+		LCACHE_GEOMETRY = 0,	// .LEV compiled into a CachedGeometry block.
+		LCACHE_OBJECTS,			// .O compiled into a parser line table.
+		LCACHE_INF,				// .INF compiled into a parser line table.
+		LCACHE_COUNT
+	};
+
+	enum LevelCacheConstants
+	{
+		LCACHE_NONE = 0xffffffff,		// No string or texture.
+		LCACHE_TEX_DEFAULT = 0xfffffffe,	// The texture line was invalid, use the default texture.
+	};
+
+	// Compiled geometry, all offsets are relative to the start of the block.
+	struct CachedGeometry
+	{
+		fixed16_16 parallax0;
+		fixed16_16 parallax1;
+		s32 textureCount;
+		s32 sectorCount;
+		s32 vertexCount;
+		s32 wallCount;
+
+		u32 paletteName;		// string offset.
+		u32 textureOffset;		// u32[textureCount] string offsets or LCACHE_NONE/LCACHE_TEX_DEFAULT.
+		u32 sectorOffset;		// CachedSector[sectorCount]
+		u32 vertexOffset;		// vec2_fixed[vertexCount]
+		u32 wallOffset;			// CachedWall[wallCount]
+		u32 stringOffset;		// null terminated strings.
+		u32 stringSize;
+	};
+
+	struct CachedSector
+	{
+		s32 id;
+		u32 name;				// string offset or LCACHE_NONE.
+		fixed16_16 ambient;
+		s32 floorTex;
+		vec2_fixed floorOffset;
+		fixed16_16 floorHeight;
+		s32 ceilTex;
+		vec2_fixed ceilOffset;
+		fixed16_16 ceilHeight;
+		fixed16_16 secHeight;
+		u32 flags1;
+		u32 flags2;
+		u32 flags3;
+		s32 layer;
+		s32 vertexStart;
+		s32 vertexCount;
+		s32 wallStart;
+		s32 wallCount;
+	};
+
+	struct CachedWall
+	{
+		s32 left;
+		s32 right;
+		s32 midTex;
+		s32 topTex;
+		s32 botTex;
+		s32 signTex;
+		vec2_fixed midOffset;
+		vec2_fixed topOffset;
+		vec2_fixed botOffset;
+		vec2_fixed signOffset;
+		s32 adjoin;
+		s32 mirror;
+		u32 flags1;
+		u32 flags2;
+		u32 flags3;
+		fixed16_16 light;
+	};
+
+	// Compile the source text into 'output', returns false on failure.
+	typedef bool(*LevelCompileFunc)(const char* source, size_t size, std::vector<char>& output);
+
+	// Load the compiled version of a level file, either from the cache or by compiling the source (and then caching it).
+	// Returns false if the source file cannot be found or compilation fails.
+	bool levelCache_load(const char* fileName, LevelCacheKind kind, LevelCompileFunc compile, std::vector<char>& output);
+}
@@ -5,10 +5,12 @@
 #include "rsector.h"
 #include "rwall.h"
 #include "robjData.h"
+#include "rsectorGrid.h"
 #include <TFE_Game/igame.h>
 #include <TFE_System/system.h>
 #include <TFE_Asset/spriteAsset_Jedi.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 
 // TODO: coupling between Dark Forces and Jedi.
 using namespace TFE_DarkForces;
@@ -54,6 +56,7 @@ namespace TFE_Jedi
 		sector_clear(s_levelState.controlSector);
 
 		objData_clear();
+		sectorGrid_clear();
 	}
 
 	void level_serializeFixupMirrors()
@@ -105,6 +108,23 @@ namespace TFE_Jedi
 		s_secretsPercent = max(0, min(100, s_secretsPercent));
 	}
 		
+	void level_rewindFixup(Stream* stream, bool writeState)
+	{
+		if (writeState) { return; }
+		// The sector data was restored in place, so the renderers need to refresh everything.
+		for (u32 s = 0; s < s_levelState.sectorCount; s++)
+		{
+			s_levelState.sectors[s].dirtyFlags = SDF_ALL;
+		}
+	}
+
+	void level_registerRewindState()
+	{
+		REWIND_STATE(s_levelState);
+		REWIND_STATE(s_levelIntState);
+		TFE_RewindBuffer::addStateFunc(level_rewindFixup);
+	}
+
 	void level_serialize(Stream* stream)
 	{
 		bool debug = serialization_getMode() == SMODE_WRITE;
@@ -215,6 +235,7 @@ namespace TFE_Jedi
 			}
 
 			level_serializeFixupMirrors();
+			sectorGrid_build();
 		}
 
 		// Serialize objects.
@@ -0,0 +1,341 @@
+#include <cstring>
+#include <cctype>
+
+#include "levelStaging.h"
+#include "rtexture.h"
+#include <TFE_Archive/archive.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <SDL_thread.h>
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TFE_Jedi
+{
+	enum
+	{
+		MAX_STAGING_THREADS = 8,
+	};
+
+	struct StagedAsset
+	{
+		LevelAssetType type;
+		std::string name;
+		FilePath filePath;			// Resolved on the main thread.
+		std::string archiveName;	// Name of the file in filePath.archive.
+		s32 worker;					// Worker holding the data, or -1 if the asset could not be staged.
+		size_t offset;
+		size_t size;
+	};
+
+	struct ArchiveCopy
+	{
+		Archive* shared;
+		Archive* copy;		// Null if the archive cannot be read from the workers.
+	};
+
+	struct StagingWorker
+	{
+		std::vector<u8> data;			// Staged assets, referenced by offset since the buffer grows.
+		std::vector<u8> readBuffer;
+		std::vector<ArchiveCopy> archives;
+		s32 decodedCount;
+		u64 ticks;
+	};
+
+	typedef std::unordered_map<std::string, s32> StagedAssetTable;
+
+	static std::vector<StagedAsset> s_stagedAssets;
+	static StagedAssetTable s_stagedTable[LASSET_COUNT];
+	static StagingWorker s_stagingWorkers[MAX_STAGING_THREADS];
+	static SDL_Thread* s_stagingThreads[MAX_STAGING_THREADS] = { 0 };
+	static atomic_u32 s_stagingNext;
+	static bool s_gathering = false;
+	static bool s_fetched = false;
+	static LevelStagingStats s_stagingStats = {};
+
+	// Asset names are not case sensitive.
+	static void staging_getKey(const char* name, std::string& key)
+	{
+		key = name;
+		for (size_t i = 0; i < key.size(); i++)
+		{
+			key[i] = toupper(key[i]);
+		}
+	}
+
+	static void staging_freeWorkers()
+	{
+		for (s32 i = 0; i < MAX_STAGING_THREADS; i++)
+		{
+			StagingWorker* worker = &s_stagingWorkers[i];
+			for (size_t a = 0; a < worker->archives.size(); a++)
+			{
+				Archive::closeCopy(worker->archives[a].copy);
+			}
+			worker->archives.clear();
+			worker->data.clear();
+			worker->data.shrink_to_fit();
+			worker->readBuffer.clear();
+			worker->readBuffer.shrink_to_fit();
+		}
+	}
+
+	void levelStaging_begin()
+	{
+		levelStaging_end();
+		s_gathering = true;
+	}
+
+	void levelStaging_add(LevelAssetType type, const char* name)
+	{
+		if (!s_gathering || !name || !name[0]) { return; }
+
+		std::string key;
+		staging_getKey(name, key);
+		if (s_stagedTable[type].find(key) != s_stagedTable[type].end()) { return; }
+
+		StagedAsset asset = {};
+		if (!TFE_Paths::getFilePath(name, &asset.filePath))
+		{
+			// Leave it to the loader to handle the missing file.
+			return;
+		}
+		if (asset.filePath.archive)
+		{
+			const char* archiveName = asset.filePath.archive->getFileName(asset.filePath.index);
+			if (!archiveName) { return; }
+			asset.archiveName = archiveName;
+		}
+		asset.type = type;
+		asset.name = name;
+		asset.worker = -1;
+
+		s_stagedTable[type][key] = s32(s_stagedAssets.size());
+		s_stagedAssets.push_back(asset);
+	}
+
+	// Get this worker's copy of an archive, the copies are opened on the main thread before the workers start.
+	static Archive* staging_getArchive(StagingWorker* worker, const Archive* shared)
+	{
+		for (size_t i = 0; i < worker->archives.size(); i++)
+		{
+			if (worker->archives[i].shared == shared)
+			{
+				return worker->archives[i].copy;
+			}
+		}
+		return nullptr;
+	}
+
+	// Read the file contents, appending them to 'output'.
+	static bool staging_readFile(StagingWorker* worker, const StagedAsset* asset, std::vector<u8>& output)
+	{
+		const size_t start = output.size();
+		size_t size = 0, bytesRead = 0;
+		if (asset->filePath.archive)
+		{
+			Archive* archive = staging_getArchive(worker, asset->filePath.archive);
+			const u32 index = asset->filePath.index;
+			if (!archive || index >= archive->getFileCount()) { return false; }
+
+			// Make sure the copy has the same directory as the shared archive.
+			const char* fileName = archive->getFileName(index);
+			if (!fileName || strcasecmp(fileName, asset->archiveName.c_str())) { return false; }
+			if (!archive->openFile(index)) { return false; }
+
+			size = archive->getFileLength();
+			output.resize(start + size);
+			bytesRead = size ? archive->readFile(output.data() + start, size) : 0;
+			archive->closeFile();
+		}
+		else
+		{
+			FileStream file;
+			if (!file.open(asset->filePath.path, Stream::MODE_READ)) { return false; }
+
+			size = file.getSize();
+			output.resize(start + size);
+			bytesRead = size ? file.readBuffer(output.data() + start, u32(size)) : 0;
+			file.close();
+		}
+
+		if (bytesRead != size)
+		{
+			output.resize(start);
+			return false;
+		}
+		return true;
+	}
+
+	int stagingWorkerThread(void* userData)
+	{
+		// The profiler slot is released when the thread exits.
+		TFE_THREAD_NAME("Level Staging");
+		StagingWorker* worker = (StagingWorker*)userData;
+		const s32 workerIndex = s32(worker - s_stagingWorkers);
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		while (1)
+		{
+			const u32 job = s_stagingNext.fetch_add(1u);
+			if (job >= s_stagedAssets.size()) { break; }
+
+			StagedAsset* asset = &s_stagedAssets[job];
+			const size_t offset = worker->data.size();
+			if (asset->type == LASSET_TEXTURE)
+			{
+				// Decompress textures here so the main thread only has to copy the image.
+				worker->readBuffer.clear();
+				if (!staging_readFile(worker, asset, worker->readBuffer)) { continue; }
+
+				if (bitmap_decompressFile(worker->readBuffer.data(), worker->readBuffer.size(), worker->data))
+				{
+					worker->decodedCount++;
+				}
+				else
+				{
+					worker->data.insert(worker->data.end(), worker->readBuffer.begin(), worker->readBuffer.end());
+				}
+			}
+			else if (!staging_readFile(worker, asset, worker->data))
+			{
+				continue;
+			}
+
+			asset->offset = offset;
+			asset->size = worker->data.size() - offset;
+			asset->worker = workerIndex;
+		}
+		worker->ticks = TFE_System::getCurrentTimeInTicks() - start;
+		return 0;
+	}
+
+	void levelStaging_fetch()
+	{
+		if (!s_gathering) { return; }
+		s_gathering = false;
+		s_fetched = true;
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		const s32 assetCount = s32(s_stagedAssets.size());
+		if (!assetCount) { return; }
+
+		// Leave a core for the main thread.
+		const s32 threadCount = std::max(1, std::min((s32)MAX_STAGING_THREADS, std::min(SDL_GetCPUCount() - 1, assetCount)));
+
+		// Archives are not thread safe, so each worker reads from its own copy.
+		// Opening the copies only reads the archive directories.
+		std::vector<Archive*> sharedArchives;
+		for (s32 i = 0; i < assetCount; i++)
+		{
+			Archive* shared = s_stagedAssets[i].filePath.archive;
+			if (shared && std::find(sharedArchives.begin(), sharedArchives.end(), shared) == sharedArchives.end())
+			{
+				sharedArchives.push_back(shared);
+			}
+		}
+		for (s32 w = 0; w < threadCount; w++)
+		{
+			StagingWorker* worker = &s_stagingWorkers[w];
+			worker->decodedCount = 0;
+			worker->ticks = 0;
+			for (size_t a = 0; a < sharedArchives.size(); a++)
+			{
+				worker->archives.push_back({ sharedArchives[a], Archive::openCopy(sharedArchives[a]) });
+			}
+		}
+
+		s_stagingNext.store(0u);
+		s32 createdCount = 0;
+		for (s32 i = 0; i < threadCount; i++)
+		{
+			s_stagingThreads[createdCount] = SDL_CreateThread(stagingWorkerThread, "TFE_LevelStaging", &s_stagingWorkers[createdCount]);
+			if (s_stagingThreads[createdCount])
+			{
+				createdCount++;
+			}
+		}
+		if (!createdCount)
+		{
+			// Read on the main thread if no workers can be created.
+			TFE_System::logWrite(LOG_WARNING, "Level Staging", "Cannot create staging threads, reading on the main thread.");
+			stagingWorkerThread(&s_stagingWorkers[0]);
+		}
+		for (s32 i = 0; i < createdCount; i++)
+		{
+			SDL_WaitThread(s_stagingThreads[i], nullptr);
+			s_stagingThreads[i] = nullptr;
+		}
+
+		// The archive copies are no longer needed.
+		u64 workerTicks = 0;
+		s32 decodedCount = 0;
+		for (s32 w = 0; w < threadCount; w++)
+		{
+			StagingWorker* worker = &s_stagingWorkers[w];
+			for (size_t a = 0; a < worker->archives.size(); a++)
+			{
+				Archive::closeCopy(worker->archives[a].copy);
+			}
+			worker->archives.clear();
+			workerTicks += worker->ticks;
+			decodedCount += worker->decodedCount;
+		}
+
+		s_stagingStats.threadCount = std::max(1, createdCount);
+		s_stagingStats.decodedCount = decodedCount;
+		for (s32 i = 0; i < assetCount; i++)
+		{
+			const StagedAsset* asset = &s_stagedAssets[i];
+			if (asset->worker < 0)
+			{
+				s_stagingStats.missingCount++;
+				continue;
+			}
+			s_stagingStats.assetCount++;
+			s_stagingStats.byteCount += asset->size;
+		}
+		s_stagingStats.workerTime = TFE_System::convertFromTicksToSeconds(workerTicks);
+		s_stagingStats.fetchTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+	}
+
+	void levelStaging_end()
+	{
+		s_stagedAssets.clear();
+		for (s32 i = 0; i < LASSET_COUNT; i++)
+		{
+			s_stagedTable[i].clear();
+		}
+		staging_freeWorkers();
+		s_gathering = false;
+		s_fetched = false;
+		s_stagingStats = {};
+	}
+
+	bool levelStaging_get(LevelAssetType type, const char* name, const u8** data, size_t* size)
+	{
+		if (!s_fetched || s_stagedAssets.empty()) { return false; }
+
+		std::string key;
+		staging_getKey(name, key);
+		StagedAssetTable::const_iterator iAsset = s_stagedTable[type].find(key);
+		if (iAsset == s_stagedTable[type].end()) { return false; }
+
+		const StagedAsset* asset = &s_stagedAssets[iAsset->second];
+		if (asset->worker < 0) { return false; }
+
+		*data = s_stagingWorkers[asset->worker].data.data() + asset->offset;
+		*size = asset->size;
+		return true;
+	}
+
+	const LevelStagingStats* levelStaging_getStats()
+	{
+		return &s_stagingStats;
+	}
+}
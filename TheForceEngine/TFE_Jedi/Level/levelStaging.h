@@ -0,0 +1,56 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Level Staging
+// Reads the assets referenced by a level ahead of time on worker
+// threads while the level is loading.
+//
+// The main thread gathers the asset names from the compiled .LEV and
+// .O files, then the workers read the files - using their own archive
+// handles since archives are not thread safe - and decode compressed
+// BM textures into per-thread staging buffers. The asset loaders then
+// take the staged copies instead of reading the files themselves, so
+// building the level (which allocates from the memory regions and
+// fills the asset caches) stays on the main thread.
+//
+// Assets that were not staged are loaded normally.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+namespace TFE_Jedi
+{
+	enum LevelAssetType
+	{
+		LASSET_TEXTURE = 0,	// BM, compressed textures are staged decompressed.
+		LASSET_MODEL,		// 3DO
+		LASSET_WAX,			// WAX
+		LASSET_FRAME,		// FME
+		LASSET_SOUND,		// VOC
+		LASSET_COUNT
+	};
+
+	struct LevelStagingStats
+	{
+		s32 assetCount;		// Assets staged.
+		s32 missingCount;	// Assets that could not be staged and are loaded normally.
+		s32 decodedCount;	// Compressed textures decoded on the workers.
+		s32 threadCount;
+		size_t byteCount;	// Total size of the staged data.
+		f64 fetchTime;		// Wall time of levelStaging_fetch() in seconds.
+		f64 workerTime;		// Time spent in the workers summed over all threads, in seconds.
+	};
+
+	// Start gathering the assets for a level, clearing any previous staging.
+	void levelStaging_begin();
+	// Add an asset to be read, this must be called between levelStaging_begin() and levelStaging_fetch().
+	void levelStaging_add(LevelAssetType type, const char* name);
+	// Read and decode the gathered assets on the worker threads and wait for them to finish.
+	// Does nothing if the assets have already been fetched.
+	void levelStaging_fetch();
+	// Free the staged data.
+	void levelStaging_end();
+
+	// Get the staged contents of an asset file, returns false if the asset was not staged.
+	// The data remains valid until levelStaging_end() is called.
+	bool levelStaging_get(LevelAssetType type, const char* name, const u8** data, size_t* size);
+	const LevelStagingStats* levelStaging_getStats();
+}
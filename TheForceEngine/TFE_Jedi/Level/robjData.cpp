@@ -4,6 +4,7 @@
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_DarkForces/logic.h>
 #include <TFE_DarkForces/generator.h>
 #include <TFE_Memory/chunkedArray.h>
@@ -125,6 +126,11 @@ namespace TFE_Jedi
 		return (SecObject*)TFE_Memory::chunkedArrayGet(s_objData.objectList, id);
 	}
 		
+	void objData_registerRewindState()
+	{
+		REWIND_STATE(s_objData);
+	}
+
 	void objData_serialize(Stream* stream)
 	{
 		SERIALIZE_VERSION(ObjState_CurVersion);
@@ -6,6 +6,7 @@
 #include "robject.h"
 #include "level.h"
 #include "levelData.h"
+#include "rsectorGrid.h"
 #include <TFE_Game/igame.h>
 #include <TFE_System/system.h>
 #include <TFE_DarkForces/player.h>
@@ -211,6 +212,7 @@ namespace TFE_Jedi
 		sector->boundsMax.x = maxX;
 		sector->boundsMin.z = minZ;
 		sector->boundsMax.z = maxZ;
+		sectorGrid_updateBounds(sector);
 	}
 
 	fixed16_16 sector_getMaxObjectHeight(RSector* sector)
@@ -506,19 +508,23 @@ namespace TFE_Jedi
 		}
 	}
 	
+	// TFE: Only the sectors registered in the grid cell containing the point are tested.
+	// Candidates are visited in index order, so the "smallest area" tie-break matches testing every sector.
 	RSector* sector_which3D(fixed16_16 dx, fixed16_16 dy, fixed16_16 dz)
 	{
 		fixed16_16 ix = dx;
 		fixed16_16 iz = dz;
 		fixed16_16 y = dy;
 		
-		RSector* sector = s_levelState.sectors;
+		s32 candidateCount;
+		const s32* candidates = sectorGrid_getCandidates(ix, iz, &candidateCount);
 		RSector* foundSector = nullptr;
 		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		for (s32 i = 0; i < candidateCount; i++)
 		{
+			RSector* sector = &s_levelState.sectors[candidates[i]];
 			if (y >= sector->ceilingHeight && y <= sector->floorHeight)
 			{
 				const fixed16_16 sectorMaxX = sector->boundsMax.x;
@@ -530,7 +536,6 @@ namespace TFE_Jedi
 				const s32 dzInt = floor16(sectorMaxZ - sectorMinZ) + 1;
 				sectorUnitArea = dzInt * dxInt;
 				
-				s32 insideBounds = 0;
 				if (ix >= sectorMinX && ix <= sectorMaxX && iz >= sectorMinZ && iz <= sectorMaxZ)
 				{
 					// pick the containing sector with the smallest area.
@@ -551,13 +556,15 @@ namespace TFE_Jedi
 		fixed16_16 ix = dx;
 		fixed16_16 iz = dz;
 
-		RSector* sector = s_levelState.sectors;
+		s32 candidateCount;
+		const s32* candidates = sectorGrid_getCandidates(ix, iz, &candidateCount);
 		RSector* foundSector = nullptr;
 		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		for (s32 i = 0; i < candidateCount; i++)
 		{
+			RSector* sector = &s_levelState.sectors[candidates[i]];
 			if (sector->layer == layer)
 			{
 				const fixed16_16 sectorMaxX = sector->boundsMax.x;
@@ -569,7 +576,6 @@ namespace TFE_Jedi
 				const s32 dzInt = floor16(sectorMaxZ - sectorMinZ) + 1;
 				sectorUnitArea = dzInt * dxInt;
 
-				s32 insideBounds = 0;
 				if (ix >= sectorMinX && ix <= sectorMaxX && iz >= sectorMinZ && iz <= sectorMaxZ)
 				{
 					// pick the containing sector with the smallest area.
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "rsectorGrid.h"
+#include "rsector.h"
+#include "levelData.h"
+#include <TFE_System/system.h>
+
+namespace TFE_Jedi
+{
+	enum SectorGridConstants
+	{
+		GRID_MIN_CELL_SIZE = 4,		// in world units.
+		GRID_MAX_DIM       = 512,	// maximum cells along each axis.
+	};
+
+	struct CellRect
+	{
+		s32 x0, z0;
+		s32 x1, z1;
+	};
+
+	struct SectorGrid
+	{
+		RSector* sectors;
+		u32 sectorCount;
+
+		// Grid origin and cell size in integer world units.
+		s32 originX;
+		s32 originZ;
+		s32 cellSize;
+		s32 width;
+		s32 height;
+
+		std::vector<std::vector<s32>> cells;
+		// Cells each sector is registered in, this only grows.
+		std::vector<CellRect> sectorRect;
+		// Sectors whose bounds have extended outside of the grid.
+		std::vector<s32> outside;
+	};
+
+	static SectorGrid s_grid = {};
+
+	void sectorGrid_insertSorted(std::vector<s32>& list, s32 index);
+	CellRect sectorGrid_computeRect(const RSector* sector, bool* outsideGrid);
+
+	/////////////////////////////////////////////
+	// API Implementation
+	/////////////////////////////////////////////
+	void sectorGrid_clear()
+	{
+		s_grid.sectors = nullptr;
+		s_grid.sectorCount = 0;
+		s_grid.width = 0;
+		s_grid.height = 0;
+		s_grid.cells.clear();
+		s_grid.sectorRect.clear();
+		s_grid.outside.clear();
+	}
+
+	void sectorGrid_build()
+	{
+		sectorGrid_clear();
+		if (!s_levelState.sectors || !s_levelState.sectorCount) { return; }
+
+		// Compute the level extents in integer units.
+		RSector* sector = s_levelState.sectors;
+		s32 minX = floor16(sector->boundsMin.x), maxX = floor16(sector->boundsMax.x);
+		s32 minZ = floor16(sector->boundsMin.z), maxZ = floor16(sector->boundsMax.z);
+		sector++;
+		for (u32 i = 1; i < s_levelState.sectorCount; i++, sector++)
+		{
+			minX = min(minX, floor16(sector->boundsMin.x));
+			minZ = min(minZ, floor16(sector->boundsMin.z));
+			maxX = max(maxX, floor16(sector->boundsMax.x));
+			maxZ = max(maxZ, floor16(sector->boundsMax.z));
+		}
+
+		// Aim for roughly one cell per sector.
+		const f64 extentX = f64(maxX - minX + 1);
+		const f64 extentZ = f64(maxZ - minZ + 1);
+		s32 cellSize = max((s32)GRID_MIN_CELL_SIZE, (s32)ceil(sqrt(extentX * extentZ / f64(s_levelState.sectorCount))));
+		cellSize = max(cellSize, (s32)ceil(max(extentX, extentZ) / f64(GRID_MAX_DIM)));
+
+		s_grid.sectors = s_levelState.sectors;
+		s_grid.sectorCount = s_levelState.sectorCount;
+		s_grid.originX = minX;
+		s_grid.originZ = minZ;
+		s_grid.cellSize = cellSize;
+		s_grid.width  = (maxX - minX) / cellSize + 1;
+		s_grid.height = (maxZ - minZ) / cellSize + 1;
+		s_grid.cells.resize(s_grid.width * s_grid.height);
+		s_grid.sectorRect.resize(s_grid.sectorCount);
+
+		// Sectors are added in index order, so the cell lists are already sorted.
+		sector = s_levelState.sectors;
+		for (u32 i = 0; i < s_grid.sectorCount; i++, sector++)
+		{
+			bool outsideGrid;
+			const CellRect rect = sectorGrid_computeRect(sector, &outsideGrid);
+			s_grid.sectorRect[i] = rect;
+			for (s32 z = rect.z0; z <= rect.z1; z++)
+			{
+				std::vector<s32>* cell = &s_grid.cells[z * s_grid.width];
+				for (s32 x = rect.x0; x <= rect.x1; x++)
+				{
+					cell[x].push_back(s32(i));
+				}
+			}
+		}
+
+		TFE_System::logWrite(LOG_MSG, "Sector Grid", "Built %d x %d sector grid, cell size %d, for %u sectors.", s_grid.width, s_grid.height, cellSize, s_grid.sectorCount);
+	}
+
+	void sectorGrid_updateBounds(RSector* sector)
+	{
+		if (!s_grid.sectors || sector < s_grid.sectors || sector >= s_grid.sectors + s_grid.sectorCount) { return; }
+
+		const s32 index = s32(sector - s_grid.sectors);
+		bool outsideGrid;
+		const CellRect rect = sectorGrid_computeRect(sector, &outsideGrid);
+		if (outsideGrid)
+		{
+			sectorGrid_insertSorted(s_grid.outside, index);
+		}
+
+		CellRect* prev = &s_grid.sectorRect[index];
+		if (rect.x0 >= prev->x0 && rect.x1 <= prev->x1 && rect.z0 >= prev->z0 && rect.z1 <= prev->z1)
+		{
+			return;
+		}
+
+		// Register the sector in the cells that it did not overlap before.
+		for (s32 z = rect.z0; z <= rect.z1; z++)
+		{
+			std::vector<s32>* cell = &s_grid.cells[z * s_grid.width];
+			for (s32 x = rect.x0; x <= rect.x1; x++)
+			{
+				if (x >= prev->x0 && x <= prev->x1 && z >= prev->z0 && z <= prev->z1) { continue; }
+				sectorGrid_insertSorted(cell[x], index);
+			}
+		}
+		prev->x0 = min(prev->x0, rect.x0);
+		prev->z0 = min(prev->z0, rect.z0);
+		prev->x1 = max(prev->x1, rect.x1);
+		prev->z1 = max(prev->z1, rect.z1);
+	}
+
+	const s32* sectorGrid_getCandidates(fixed16_16 x, fixed16_16 z, s32* count)
+	{
+		// The level may have been replaced without going through the normal load path.
+		if (s_grid.sectors != s_levelState.sectors || s_grid.sectorCount != s_levelState.sectorCount)
+		{
+			sectorGrid_build();
+		}
+
+		const s32 cx = (floor16(x) - s_grid.originX);
+		const s32 cz = (floor16(z) - s_grid.originZ);
+		const std::vector<s32>* list;
+		if (cx < 0 || cz < 0 || cx >= s_grid.width * s_grid.cellSize || cz >= s_grid.height * s_grid.cellSize)
+		{
+			list = &s_grid.outside;
+		}
+		else
+		{
+			list = &s_grid.cells[(cz / s_grid.cellSize) * s_grid.width + (cx / s_grid.cellSize)];
+		}
+
+		*count = s32(list->size());
+		return list->empty() ? nullptr : list->data();
+	}
+
+	/////////////////////////////////////////////
+	// Internal
+	/////////////////////////////////////////////
+	void sectorGrid_insertSorted(std::vector<s32>& list, s32 index)
+	{
+		std::vector<s32>::iterator iter = std::lower_bound(list.begin(), list.end(), index);
+		if (iter == list.end() || *iter != index)
+		{
+			list.insert(iter, index);
+		}
+	}
+
+	// Returns the range of cells overlapped by the sector bounds, clamped to the grid.
+	CellRect sectorGrid_computeRect(const RSector* sector, bool* outsideGrid)
+	{
+		const s32 x0 = floor16(sector->boundsMin.x) - s_grid.originX;
+		const s32 z0 = floor16(sector->boundsMin.z) - s_grid.originZ;
+		const s32 x1 = floor16(sector->boundsMax.x) - s_grid.originX;
+		const s32 z1 = floor16(sector->boundsMax.z) - s_grid.originZ;
+		*outsideGrid = x0 < 0 || z0 < 0 || x1 >= s_grid.width * s_grid.cellSize || z1 >= s_grid.height * s_grid.cellSize;
+
+		CellRect rect;
+		rect.x0 = clamp(x0 / s_grid.cellSize, 0, s_grid.width  - 1);
+		rect.z0 = clamp(z0 / s_grid.cellSize, 0, s_grid.height - 1);
+		rect.x1 = clamp(x1 / s_grid.cellSize, 0, s_grid.width  - 1);
+		rect.z1 = clamp(z1 / s_grid.cellSize, 0, s_grid.height - 1);
+		return rect;
+	}
+}
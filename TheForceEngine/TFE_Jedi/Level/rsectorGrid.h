@@ -0,0 +1,30 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Sector Grid
+// A uniform 2D grid over the sector bounds of the current level, used
+// to limit the sectors tested by sector_which3D() and
+// sector_which3D_Map() to those near the query point.
+//
+// Each sector is registered in every cell overlapped by its bounds.
+// When the bounds change (moving or rotating walls), the sector is
+// added to any new cells it overlaps; it is never removed from cells,
+// so the candidate list is always a superset of the sectors whose
+// current bounds contain the point.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_Jedi/Math/fixedPoint.h>
+
+struct RSector;
+
+namespace TFE_Jedi
+{
+	// Build the grid from the current level sectors.
+	void sectorGrid_build();
+	void sectorGrid_clear();
+	// Called when the bounds of a sector change.
+	void sectorGrid_updateBounds(RSector* sector);
+
+	// Returns the sector indices that may contain the point (x, z), sorted by index.
+	// Returns nullptr with count = 0 if there are no candidates.
+	const s32* sectorGrid_getCandidates(fixed16_16 x, fixed16_16 z, s32* count);
+}
@@ -1,6 +1,7 @@
 #include <cstring>
 
 #include "rtexture.h"
+#include "levelStaging.h"
 #include <TFE_Game/igame.h>
 #include <TFE_System/system.h>
 #include <TFE_Archive/archive.h>
@@ -80,7 +81,7 @@ namespace TFE_Jedi
 	void bitmap_setupAnimationTask()
 	{
 		s_texState.textureAnimTask = createSubTask("texture animation", textureAnimationTaskFunc);
-		s_texState.textureAnimAlloc = allocator_create(sizeof(AnimatedTexture));
+		s_texState.textureAnimAlloc = allocator_createSlab(sizeof(AnimatedTexture), 32);
 		s_texState.animTexIndex = 0;
 	}
 
@@ -212,39 +213,46 @@ namespace TFE_Jedi
 			return s_textureList[pool][iTex->second].texture;
 		}
 
-		FilePath filepath;
-		if (!TFE_Paths::getFilePath(name, &filepath))
+		// TFE: Use the copy read (and decompressed) ahead of time during level load if there is one.
+		const u8* fileData;
+		size_t size;
+		if (!(decompress & 1) || !levelStaging_get(LASSET_TEXTURE, name, &fileData, &size))
 		{
-			return nullptr;
-		}
+			FilePath filepath;
+			if (!TFE_Paths::getFilePath(name, &filepath))
+			{
+				return nullptr;
+			}
 
-		FileStream file;
-		if (!file.open(&filepath, Stream::MODE_READ))
-		{
-			return nullptr;
-		}
+			FileStream file;
+			if (!file.open(&filepath, Stream::MODE_READ))
+			{
+				return nullptr;
+			}
 
-		size_t size = file.getSize();
-		s_buffer.resize(size);
-		file.readBuffer(s_buffer.data(), (u32)size);
-		file.close();
+			size = file.getSize();
+			s_buffer.resize(size);
+			file.readBuffer(s_buffer.data(), (u32)size);
+			file.close();
+			fileData = s_buffer.data();
+		}
 
 		TextureData* texture = (TextureData*)region_alloc(s_texState.memoryRegion, sizeof(TextureData));
-		const u8* data = s_buffer.data();
+		const u8* data = fileData;
 		const u8* end = data + size;
 		const u8* fheader = data;
 		data += 3;
 
 		if (strncmp((char*)fheader, "BM ", 3))
 		{
-			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' is not a valid BM file.", filepath);
+			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' is not a valid BM file.", name);
 			return nullptr;
 		}
 
 		u8 version = readByte(data);
 		if (version != DF_BM_VERSION)
 		{
-			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' has invalid BM version '%u'.", filepath, version);
+			TFE_System::logWrite(LOG_ERROR, "bitmap_load", "File '%s' has invalid BM version '%u'.", name, version);
 			return nullptr;
 		}
 
@@ -349,6 +357,65 @@ namespace TFE_Jedi
 		return texture;
 	}
 
+	bool bitmap_decompressFile(const u8* data, size_t size, std::vector<u8>& output)
+	{
+		// The BM header is 32 bytes, the compressed data size is stored at offset 16.
+		enum { BM_HEADER_SIZE = 32 };
+		if (size < BM_HEADER_SIZE || strncmp((const char*)data, "BM ", 3) || data[3] != DF_BM_VERSION)
+		{
+			return false;
+		}
+		const u8 compressed = data[14];
+		if (compressed != 1 && compressed != 2)
+		{
+			return false;
+		}
+
+		u16 width, height;
+		s32 inSize;
+		memcpy(&width, data + 4, sizeof(u16));
+		memcpy(&height, data + 6, sizeof(u16));
+		memcpy(&inSize, data + 16, sizeof(s32));
+		const size_t columnOffset = BM_HEADER_SIZE + size_t(inSize);
+		if (!width || !height || inSize <= 0 || columnOffset + width * sizeof(u32) > size)
+		{
+			return false;
+		}
+		const u8* inBuffer = data + BM_HEADER_SIZE;
+		const u8* columns = data + columnOffset;
+
+		const size_t start = output.size();
+		const u32 dataSize = u32(width) * u32(height);
+		output.resize(start + BM_HEADER_SIZE + dataSize);
+		u8* header = output.data() + start;
+		memcpy(header, data, 16);
+		header[14] = 0;
+		memcpy(header + 16, &dataSize, sizeof(u32));
+		memset(header + 20, 0, 12);
+
+		u8* dst = header + BM_HEADER_SIZE;
+		for (s32 i = 0; i < width; i++, dst += height)
+		{
+			u32 offset;
+			memcpy(&offset, columns + i * sizeof(u32), sizeof(u32));
+			if (offset >= u32(inSize))
+			{
+				output.resize(start);
+				return false;
+			}
+
+			if (compressed == 1)
+			{
+				decompressColumn_Type1(&inBuffer[offset], dst, height);
+			}
+			else
+			{
+				decompressColumn_Type2(&inBuffer[offset], dst, height);
+			}
+		}
+		return true;
+	}
+
 	TextureData* bitmap_loadFromMemory(const u8* data, size_t size, u32 decompress)
 	{
 		TextureData* texture = (TextureData*)malloc(sizeof(TextureData));
@@ -7,6 +7,7 @@
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_DarkForces/time.h>
+#include <vector>
 
 struct BM_Header
 {
@@ -111,6 +112,10 @@ namespace TFE_Jedi
 	// Used for tools.
 	TextureData* bitmap_loadFromMemory(const u8* data, size_t size, u32 decompress);
 	Allocator* bitmap_getAnimTextureAlloc();
+	// TFE: Convert a compressed BM file into the equivalent uncompressed BM file, appending it to 'output'.
+	// This does not touch any texture state so it is safe to call from worker threads.
+	// Returns false, leaving 'output' unchanged, if the data is not a compressed single frame BM.
+	bool bitmap_decompressFile(const u8* data, size_t size, std::vector<u8>& output);
 
 	// Serialization.
 	void bitmap_serializeLevelTextures(Stream* stream);
@@ -1,6 +1,7 @@
 #include "allocator.h"
 #include <TFE_System/system.h>
 #include <TFE_Memory/memoryRegion.h>
+#include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Game/igame.h>
 #include <assert.h>
 
@@ -8,6 +9,13 @@ struct AllocHeader
 {
 	AllocHeader* prev;
 	AllocHeader* next;
+	// TFE: position in the list, valid while the index table is valid.
+	s32 index;
+};
+
+struct AllocSlab
+{
+	AllocSlab* next;
 };
 
 struct Allocator
@@ -24,6 +32,20 @@ struct Allocator
 	// TFE
 	AllocHeader* iterSave;
 	AllocHeader* iterPrevSave;
+
+	// TFE: Index table, maps positions to items so random access doesn't have to walk the list.
+	// It is updated in place when items are added to the end and rebuilt lazily otherwise.
+	AllocHeader** indexTable;
+	s32 indexCapacity;
+	s32 count;
+	JBool indexValid;
+
+	// TFE: Slab storage (optional), items are carved out of larger blocks and reused through a free list.
+	AllocSlab* slabs;
+	u8* slabCur;
+	u8* slabEnd;
+	AllocHeader* freeList;
+	s32 itemsPerSlab;
 };
 
 namespace TFE_Jedi
@@ -34,6 +56,15 @@ namespace TFE_Jedi
 	static const size_t c_invalidPtr = (~size_t(0)) - sizeof(AllocHeader) + 1;
 	#define ALLOC_INVALID_PTR ((AllocHeader*)c_invalidPtr)
 	#define MAX_ALLOC_SIZE (8*1024*1024)  // 8MB
+	#define MIN_INDEX_CAPACITY 16
+
+	// Slab item headers are aligned so the items are aligned the same way as region allocations.
+	static const s32 c_slabAlign = 8;
+	static const s32 c_slabHeaderSize = (sizeof(AllocSlab) + c_slabAlign - 1) & ~(c_slabAlign - 1);
+
+	void allocator_rebuildIndex(Allocator* alloc);
+	AllocHeader* allocator_headerFromIndex(Allocator* alloc, s32 index);
+	s32 allocator_indexFromHeader(Allocator* alloc, AllocHeader* header);
 
 	// Create and free an allocator.
 	Allocator* allocator_create(s32 allocSize, MemoryRegion* region)
@@ -62,19 +93,63 @@ namespace TFE_Jedi
 		res->iter = ALLOC_INVALID_PTR;
 		res->size = allocSize + sizeof(AllocHeader);
 		res->refCount = 0;
+		res->iterSave = ALLOC_INVALID_PTR;
+		res->iterPrevSave = ALLOC_INVALID_PTR;
+
+		res->indexTable = nullptr;
+		res->indexCapacity = 0;
+		res->count = 0;
+		res->indexValid = JTRUE;
+
+		res->slabs = nullptr;
+		res->slabCur = nullptr;
+		res->slabEnd = nullptr;
+		res->freeList = nullptr;
+		res->itemsPerSlab = 0;
 
 		return res;
 	}
 
+	Allocator* allocator_createSlab(s32 allocSize, s32 itemsPerSlab, MemoryRegion* region)
+	{
+		Allocator* res = allocator_create(allocSize, region);
+		if (!res) { return nullptr; }
+
+		// Items on the free list store the link after the header, so leave room for it and keep the items aligned.
+		s32 size = max(res->size, s32(sizeof(AllocHeader) + sizeof(AllocHeader*)));
+		res->size = (size + c_slabAlign - 1) & ~(c_slabAlign - 1);
+		res->itemsPerSlab = max(1, itemsPerSlab);
+		return res;
+	}
+
 	void allocator_free(Allocator* alloc)
 	{
 		if (!alloc) { return; }
 
-		void* item = allocator_getHead(alloc);
-		while (item)
+		if (alloc->itemsPerSlab)
+		{
+			// The items live in the slabs, so there is no need to free them one at a time.
+			AllocSlab* slab = alloc->slabs;
+			while (slab)
+			{
+				AllocSlab* next = slab->next;
+				TFE_Memory::region_free(alloc->region, slab);
+				slab = next;
+			}
+			alloc->slabs = nullptr;
+		}
+		else
+		{
+			void* item = allocator_getHead(alloc);
+			while (item)
+			{
+				allocator_deleteItem(alloc, item);
+				item = allocator_getNext(alloc);
+			}
+		}
+		if (alloc->indexTable)
 		{
-			allocator_deleteItem(alloc, item);
-			item = allocator_getNext(alloc);
+			TFE_Memory::region_free(alloc->region, alloc->indexTable);
 		}
 
 		alloc->self = (Allocator*)ALLOC_INVALID_PTR;
@@ -86,12 +161,55 @@ namespace TFE_Jedi
 		return alloc->self == alloc;
 	}
 
+	AllocHeader* allocator_allocHeader(Allocator* alloc)
+	{
+		if (!alloc->itemsPerSlab)
+		{
+			return (AllocHeader*)TFE_Memory::region_alloc(alloc->region, alloc->size);
+		}
+
+		// Reuse a freed item if possible.
+		AllocHeader* header = alloc->freeList;
+		if (header)
+		{
+			alloc->freeList = *(AllocHeader**)((u8*)header + sizeof(AllocHeader));
+			return header;
+		}
+
+		if (alloc->slabCur + alloc->size > alloc->slabEnd)
+		{
+			const size_t slabSize = c_slabHeaderSize + size_t(alloc->size) * alloc->itemsPerSlab;
+			AllocSlab* slab = (AllocSlab*)TFE_Memory::region_alloc(alloc->region, slabSize);
+			if (!slab) { return nullptr; }
+
+			slab->next = alloc->slabs;
+			alloc->slabs = slab;
+			alloc->slabCur = (u8*)slab + c_slabHeaderSize;
+			alloc->slabEnd = (u8*)slab + slabSize;
+		}
+		header = (AllocHeader*)alloc->slabCur;
+		alloc->slabCur += alloc->size;
+		return header;
+	}
+
+	void allocator_freeHeader(Allocator* alloc, AllocHeader* header)
+	{
+		if (!alloc->itemsPerSlab)
+		{
+			TFE_Memory::region_free(alloc->region, header);
+			return;
+		}
+		// The prev/next pointers are left intact, like region_free() would, in case a saved iterator still references the item.
+		*(AllocHeader**)((u8*)header + sizeof(AllocHeader)) = alloc->freeList;
+		alloc->freeList = header;
+	}
+
 	// Allocate and free individual items.
 	void* allocator_newItem(Allocator* alloc)
 	{
 		if (!alloc) { return nullptr; }
 
-		AllocHeader* header = (AllocHeader*)TFE_Memory::region_alloc(alloc->region, alloc->size);
+		AllocHeader* header = allocator_allocHeader(alloc);
 		if (!header)
 		{
 			TFE_System::logWrite(LOG_ERROR, "Allocator", "allocator_newItem - cannot allocate header of size %d", alloc->size);
@@ -101,6 +219,7 @@ namespace TFE_Jedi
 
 		header->next = ALLOC_INVALID_PTR;
 		header->prev = alloc->tail;
+		header->index = alloc->count;
 
 		if (alloc->tail != ALLOC_INVALID_PTR)
 		{
@@ -113,6 +232,20 @@ namespace TFE_Jedi
 			alloc->head = header;
 		}
 
+		// Items are always added to the end, so the index table can be extended in place.
+		if (alloc->indexValid)
+		{
+			if (alloc->count < alloc->indexCapacity)
+			{
+				alloc->indexTable[alloc->count] = header;
+			}
+			else
+			{
+				alloc->indexValid = JFALSE;
+			}
+		}
+		alloc->count++;
+
 		return ((u8*)header + sizeof(AllocHeader));
 	}
 
@@ -141,124 +274,114 @@ namespace TFE_Jedi
 			alloc->iterPrev = header->next;
 		}
 
-		TFE_Memory::region_free(alloc->region, header);
+		// Removing the last item leaves the rest of the index table intact.
+		alloc->count--;
+		if (next != ALLOC_INVALID_PTR)
+		{
+			alloc->indexValid = JFALSE;
+		}
+
+		allocator_freeHeader(alloc, header);
 	}
 
-	// Random access.
-	s32 allocator_getCount(Allocator* alloc)
+	void allocator_rebuildIndex(Allocator* alloc)
 	{
-		if (!alloc) { return 0; }
+		if (alloc->count > alloc->indexCapacity)
+		{
+			// Grow geometrically so that adding items one at a time only rarely requires a rebuild.
+			s32 capacity = max(MIN_INDEX_CAPACITY, alloc->indexCapacity * 2);
+			while (capacity < alloc->count) { capacity *= 2; }
 
-		s32 count = 0;
+			if (alloc->indexTable)
+			{
+				TFE_Memory::region_free(alloc->region, alloc->indexTable);
+			}
+			alloc->indexTable = (AllocHeader**)TFE_Memory::region_alloc(alloc->region, sizeof(AllocHeader*) * capacity);
+			alloc->indexCapacity = alloc->indexTable ? capacity : 0;
+			if (!alloc->indexTable)
+			{
+				TFE_System::logWrite(LOG_ERROR, "Allocator", "allocator_rebuildIndex - cannot allocate an index table of size %d", capacity);
+				assert(0);
+				return;
+			}
+		}
+
+		s32 index = 0;
 		AllocHeader* header = alloc->head;
 		while (header != ALLOC_INVALID_PTR)
 		{
-			count++;
+			header->index = index;
+			alloc->indexTable[index] = header;
+			index++;
 			header = header->next;
 		}
-		return count;
+		alloc->indexValid = JTRUE;
+	}
+
+	// Returns the header at 'index' or ALLOC_INVALID_PTR if the index is out of range.
+	AllocHeader* allocator_headerFromIndex(Allocator* alloc, s32 index)
+	{
+		if (index < 0 || index >= alloc->count) { return ALLOC_INVALID_PTR; }
+		if (!alloc->indexValid) { allocator_rebuildIndex(alloc); }
+		return alloc->indexValid ? alloc->indexTable[index] : ALLOC_INVALID_PTR;
+	}
+
+	// Returns the position of 'header' in the list or -1 if it is not part of the list.
+	s32 allocator_indexFromHeader(Allocator* alloc, AllocHeader* header)
+	{
+		if (header == ALLOC_INVALID_PTR || !alloc->count) { return -1; }
+		if (!alloc->indexValid) { allocator_rebuildIndex(alloc); }
+		if (!alloc->indexValid) { return -1; }
+
+		const s32 index = header->index;
+		return (index >= 0 && index < alloc->count && alloc->indexTable[index] == header) ? index : -1;
+	}
+
+	// Random access.
+	s32 allocator_getCount(Allocator* alloc)
+	{
+		if (!alloc) { return 0; }
+		return alloc->count;
 	}
 		
 	s32 allocator_getCurPos(Allocator* alloc)
 	{
 		if (!alloc) { return -1; }
-
-		s32 index = 0;
-		AllocHeader* iter = alloc->iter;
-		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
-		{
-			if (header == iter)
-			{
-				return index;
-			}
-			index++;
-			header = header->next;
-		}
-		return -1;
+		return allocator_indexFromHeader(alloc, alloc->iter);
 	}
 
 	void allocator_setPos(Allocator* alloc, s32 pos)
 	{
-		s32 index = 0;
-		AllocHeader* header = alloc->head;
-		alloc->iter = ALLOC_INVALID_PTR;
-		while (header != ALLOC_INVALID_PTR)
-		{
-			if (index == pos)
-			{
-				alloc->iter = header;
-				break;
-			}
-			index++;
-			header = header->next;
-		}
+		alloc->iter = allocator_headerFromIndex(alloc, pos);
 	}
 		
 	s32 allocator_getPrevPos(Allocator* alloc)
 	{
 		if (!alloc) { return -1; }
-
-		s32 index = 0;
-		AllocHeader* iterPrev = alloc->iterPrev;
-		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
-		{
-			if (header == iterPrev)
-			{
-				return index;
-			}
-			index++;
-			header = header->next;
-		}
-		return -1;
+		return allocator_indexFromHeader(alloc, alloc->iterPrev);
 	}
 
 	void allocator_setPrevPos(Allocator* alloc, s32 pos)
 	{
-		s32 index = 0;
-		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
+		AllocHeader* header = allocator_headerFromIndex(alloc, pos);
+		if (header != ALLOC_INVALID_PTR)
 		{
-			if (index == pos)
-			{
-				alloc->iterPrev = header;
-				break;
-			}
-			index++;
-			header = header->next;
+			alloc->iterPrev = header;
 		}
 	}
 
 	s32 allocator_getIndex(Allocator* alloc, void* item)
 	{
 		if (!item) { return -1; }
-
-		AllocHeader* header = alloc->head;
-		s32 index = 0;
-		while (header != ALLOC_INVALID_PTR)
-		{
-			if ((u8*)item == (u8*)header + sizeof(AllocHeader))
-			{
-				return index;
-			}
-			index++;
-			header = header->next;
-		}
-		return -1;
+		return allocator_indexFromHeader(alloc, (AllocHeader*)((u8*)item - sizeof(AllocHeader)));
 	}
 
 	void* allocator_getByIndex(Allocator* alloc, s32 index)
 	{
 		if (!alloc) { return nullptr; }
 
-		AllocHeader* header = alloc->head;
-		while (index > 0 && header != ALLOC_INVALID_PTR)
-		{
-			index--;
-			header = header->next;
-		}
-
+		// Negative indices return the head, as in the original code.
+		AllocHeader* header = allocator_headerFromIndex(alloc, max(0, index));
 		alloc->iterPrev = header;
 		alloc->iter = header;
 		return (u8*)header + sizeof(AllocHeader);
@@ -1,6 +1,12 @@
 #pragma once
 //////////////////////////////////////////////////////////////////////
 // Allocator API as found in the Jedi Engine
+//
+// TFE: Random access (getIndex, getByIndex, getCount, ...) goes through
+// a lazily rebuilt index table instead of walking the list.
+// Allocators created with allocator_createSlab() allocate items from
+// larger blocks ("slabs") and reuse freed items, which keeps items close
+// together in memory for allocators with many items.
 //////////////////////////////////////////////////////////////////////
 #include <TFE_System/types.h>
 #include <TFE_Memory/memoryRegion.h>
@@ -11,6 +17,7 @@ namespace TFE_Jedi
 {
 	// Create and free an allocator.
 	Allocator* allocator_create(s32 allocSize, MemoryRegion* region = nullptr);
+	Allocator* allocator_createSlab(s32 allocSize, s32 itemsPerSlab, MemoryRegion* region = nullptr);
 	void allocator_free(Allocator* alloc);
 	bool allocator_validate(Allocator* alloc);
 
@@ -11,6 +11,7 @@
 #include "../redgePair.h"
 #include "rsectorFixed.h"
 #include "../rcommon.h"
+#include "../rtraversal.h"
 
 namespace TFE_Jedi
 {
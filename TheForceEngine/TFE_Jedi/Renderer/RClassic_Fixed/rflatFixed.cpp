@@ -9,6 +9,8 @@
 #include "../rsectorRender.h"
 #include "../redgePair.h"
 #include "../rcommon.h"
+#include "../rtraversal.h"
+#include "../texelKernels.h"
 #include <assert.h>
 
 namespace TFE_Jedi
@@ -75,10 +77,29 @@ namespace RClassic_Fixed
 		}
 	}
 				
+	// Draw the current scanline with the SIMD kernels, see texelKernels.h
+	static void drawScanline_Kernel(u32 mode)
+	{
+		TexelSpan span;
+		span.u0 = u32(s_scanlineU0);
+		span.v0 = u32(s_scanlineV0);
+		span.dUdX = u32(s_scanline_dUdX);
+		span.dVdX = u32(s_scanline_dVdX);
+		span.fracBits = FRAC_BITS_16;
+		span.dataEnd = s_ftexDataEnd;
+		span.width = s_scanlineWidth;
+		span.image = s_ftexImage;
+		span.light = s_scanlineLight;
+		span.out = s_scanlineOut;
+		s_texelKernels->span[mode](&span);
+	}
+
 	// This produces functionally identical results to the original but splits apart the U/V and dUdx/dVdx into seperate variables
 	// to account for C vs ASM differences.
 	void drawScanline()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_LIT); return; }
+
 		fixed16_16 U = s_scanlineU0;
 		fixed16_16 V = s_scanlineV0;
 		const fixed16_16 dUdX = s_scanline_dUdX;
@@ -104,6 +125,8 @@ namespace RClassic_Fixed
 
 	void drawScanline_Fullbright()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_FULLBRIGHT); return; }
+
 		fixed16_16 V = s_scanlineV0;
 		fixed16_16 U = s_scanlineU0;
 		fixed16_16 dVdX = s_scanline_dVdX;
@@ -129,6 +152,8 @@ namespace RClassic_Fixed
 
 	void drawScanline_Trans()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_LIT | TKM_TRANS); return; }
+
 		fixed16_16 V = s_scanlineV0;
 		fixed16_16 U = s_scanlineU0;
 		fixed16_16 dVdX = s_scanline_dVdX;
@@ -156,6 +181,8 @@ namespace RClassic_Fixed
 
 	void drawScanline_Fullbright_Trans()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_TRANS); return; }
+
 		fixed16_16 V = s_scanlineV0;
 		fixed16_16 U = s_scanlineU0;
 		fixed16_16 dVdX = s_scanline_dVdX;
@@ -178,6 +205,26 @@ namespace RClassic_Fixed
 			if (c) { s_scanlineOut[i] = c; }
 		}
 	}
+
+	void flat_drawTestScanline(u32 mode, fixed16_16 u, fixed16_16 v, fixed16_16 dUdX, fixed16_16 dVdX, s32 width, u8* image, s32 dataEnd, const u8* light, u8* out)
+	{
+		s_scanlineU0 = u;
+		s_scanlineV0 = v;
+		s_scanline_dUdX = dUdX;
+		s_scanline_dVdX = dVdX;
+		s_scanlineWidth = width;
+		s_ftexImage = image;
+		s_ftexDataEnd = dataEnd;
+		s_scanlineLight = light;
+		s_scanlineOut = out;
+		switch (mode)
+		{
+			case TKM_FULLBRIGHT:      { drawScanline_Fullbright(); } break;
+			case TKM_LIT:             { drawScanline(); } break;
+			case TKM_TRANS:           { drawScanline_Fullbright_Trans(); } break;
+			case TKM_LIT | TKM_TRANS: { drawScanline_Trans(); } break;
+		}
+	}
 			   
 	bool flat_setTexture(TextureData* tex)
 	{
@@ -22,5 +22,9 @@ namespace TFE_Jedi
 		// Set Parameters for 3D object rendering.
 		void flat_preparePolygon(fixed16_16 heightOffset, fixed16_16 offsetX, fixed16_16 offsetZ, TextureData* texture);
 		void flat_drawPolygonScanline(s32 x0, s32 x1, s32 y, bool trans);
+
+		// Draw a single scanline with the scanline functions used by the flats, the texel is ((U & 63) << 6) + (V & 63).
+		// 'mode' is a TexelKernelMode, used to verify the texel kernels against the scalar loops.
+		void flat_drawTestScanline(u32 mode, fixed16_16 u, fixed16_16 v, fixed16_16 dUdX, fixed16_16 dVdX, s32 width, u8* image, s32 dataEnd, const u8* light, u8* out);
 	}
 }
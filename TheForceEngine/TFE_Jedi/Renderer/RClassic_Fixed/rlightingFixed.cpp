@@ -3,6 +3,7 @@
 #include "rlightingFixed.h"
 #include "rclassicFixed.h"
 #include "../rcommon.h"
+#include "../rtraversal.h"
 #include "../rlimits.h"
 
 namespace TFE_Jedi
@@ -11,6 +11,7 @@
 #include "robj3dFixed_PolygonDraw.h"
 #include "../rclassicFixedSharedState.h"
 #include "../../rcommon.h"
+#include "../../rtraversal.h"
 
 namespace TFE_Jedi
 {
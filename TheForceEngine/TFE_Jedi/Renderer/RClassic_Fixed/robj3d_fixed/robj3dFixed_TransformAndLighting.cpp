@@ -5,6 +5,7 @@
 #include "../rclassicFixedSharedState.h"
 #include "../rlightingFixed.h"
 #include "../../rcommon.h"
+#include "../../rtraversal.h"
 
 namespace TFE_Jedi
 {
@@ -16,6 +16,7 @@
 #include "rclassicFixedSharedState.h"
 #include "robj3d_fixed/robj3dFixed.h"
 #include "../rcommon.h"
+#include "../rtraversal.h"
 
 using namespace TFE_Jedi::RClassic_Fixed;
 
@@ -12,7 +12,9 @@
 #include "redgePairFixed.h"
 #include "rclassicFixedSharedState.h"
 #include "../rcommon.h"
+#include "../rtraversal.h"
 #include "../jediRenderer.h"
+#include "../texelKernels.h"
 
 namespace TFE_Jedi
 {
@@ -2076,8 +2078,26 @@ namespace RClassic_Fixed
 		return z;
 	}
 
+	// Draw the current column with the SIMD kernels, see texelKernels.h
+	static void drawColumn_Kernel(u32 mode)
+	{
+		TexelColumn column;
+		column.v0 = u32(s_vCoordFixed);
+		column.dVdY = u32(s_vCoordStep);
+		column.fracBits = FRAC_BITS_16;
+		column.heightMask = s_texHeightMask;
+		column.count = s_yPixelCount;
+		column.stride = s_width;
+		column.image = s_texImage;
+		column.light = s_columnLight;
+		column.out = s_columnOut;
+		s_texelKernels->column[mode](&column);
+	}
+
 	void drawColumn_Fullbright()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_16, s_texHeightMask)) { drawColumn_Kernel(TKM_FULLBRIGHT); return; }
+
 		fixed16_16 vCoordFixed = s_vCoordFixed;
 		u8* tex = s_texImage;
 
@@ -2096,6 +2116,8 @@ namespace RClassic_Fixed
 
 	void drawColumn_Lit()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_16, s_texHeightMask)) { drawColumn_Kernel(TKM_LIT); return; }
+
 		fixed16_16 vCoordFixed = s_vCoordFixed;
 		u8* tex = s_texImage;
 
@@ -2114,6 +2136,8 @@ namespace RClassic_Fixed
 
 	void drawColumn_Fullbright_Trans()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_16, s_texHeightMask)) { drawColumn_Kernel(TKM_TRANS); return; }
+
 		fixed16_16 vCoordFixed = s_vCoordFixed;
 		u8* tex = s_texImage;
 
@@ -2132,6 +2156,8 @@ namespace RClassic_Fixed
 
 	void drawColumn_Lit_Trans()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_16, s_texHeightMask)) { drawColumn_Kernel(TKM_LIT | TKM_TRANS); return; }
+
 		fixed16_16 vCoordFixed = s_vCoordFixed;
 		u8* tex = s_texImage;
 
@@ -2148,6 +2174,24 @@ namespace RClassic_Fixed
 		}
 	}
 
+	void wall_drawTestColumn(u32 mode, fixed16_16 v, fixed16_16 dVdY, s32 heightMask, s32 count, u8* image, const u8* light, u8* out)
+	{
+		s_vCoordFixed = v;
+		s_vCoordStep = dVdY;
+		s_texHeightMask = heightMask;
+		s_yPixelCount = count;
+		s_texImage = image;
+		s_columnLight = light;
+		s_columnOut = out;
+		switch (mode)
+		{
+			case TKM_FULLBRIGHT:      { drawColumn_Fullbright(); } break;
+			case TKM_LIT:             { drawColumn_Lit(); } break;
+			case TKM_TRANS:           { drawColumn_Fullbright_Trans(); } break;
+			case TKM_LIT | TKM_TRANS: { drawColumn_Lit_Trans(); } break;
+		}
+	}
+
 	void wall_addAdjoinSegment(s32 length, s32 x0, fixed16_16 top_dydx, fixed16_16 y1, fixed16_16 bot_dydx, fixed16_16 y0, RWallSegmentFixed* wallSegment)
 	{
 		if (s_adjoinSegCount < MAX_ADJOIN_SEG)
@@ -36,6 +36,10 @@ namespace TFE_Jedi
 
 		void wall_addAdjoinSegment(s32 length, s32 x0, fixed16_16 top_dydx, fixed16_16 y1, fixed16_16 bot_dydx, fixed16_16 y0, RWallSegmentFixed* wallSegment);
 
+		// Draw a single column with the column functions used by the walls, rows are s_width apart.
+		// 'mode' is a TexelKernelMode, used to verify the texel kernels against the scalar loops.
+		void wall_drawTestColumn(u32 mode, fixed16_16 v, fixed16_16 dVdY, s32 heightMask, s32 count, u8* image, const u8* light, u8* out);
+
 		// Sprite code for now because so much is shared.
 		void sprite_drawFrame(u8* basePtr, WaxFrame* frame, SecObject* obj);
 	}
@@ -11,6 +11,7 @@
 #include "rflatFloat.h"
 #include "../redgePair.h"
 #include "rsectorFloat.h"
+#include "rcolumnBandFloat.h"
 #include "../rcommon.h"
 
 namespace TFE_Jedi
@@ -197,11 +198,17 @@ namespace RClassic_Float
 
 	void resetState()
 	{
-		s_rcfltState.depth1d_all = nullptr;
+		s_rcfltThread.depth1d_all = nullptr;
 		s_rcfltState.skyTable = nullptr;
 
-		free(s_rcfltState.adjoinEdgeList);
-		s_rcfltState.adjoinEdgeList = nullptr;
+		free(s_rcfltThread.adjoinEdgeList);
+		free(s_rcfltThread.flatEdgeList);
+		free(s_rcfltThread.wallSegListDst);
+		s_rcfltThread.adjoinEdgeList = nullptr;
+		s_rcfltThread.flatEdgeList = nullptr;
+		s_rcfltThread.wallSegListDst = nullptr;
+
+		band_destroy();
 	}
 
 	void buildProjectionTables(s32 xc, s32 yc, s32 w, s32 h)
@@ -213,20 +220,27 @@ namespace RClassic_Float
 		setupProjectionParameters(f32(halfWidth), xc, yc);
 		setWidthFraction(1.0f);
 
-		EdgePairFloat* flatEdge = &s_rcfltState.flatEdgeList[s_flatCount];
-		s_rcfltState.flatEdge = flatEdge;
+		// Per-thread lists, column band threads allocate their own copies.
+		if (!s_rcfltThread.flatEdgeList)
+		{
+			s_rcfltThread.flatEdgeList = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * MAX_SEG_EXT);
+			s_rcfltThread.wallSegListDst = (RWallSegmentFloat*)malloc(sizeof(RWallSegmentFloat) * MAX_SEG_EXT);
+		}
+
+		EdgePairFloat* flatEdge = &s_rcfltThread.flatEdgeList[s_flatCount];
+		s_rcfltThread.flatEdge = flatEdge;
 		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState.windowMaxY, 0, s_rcfltState.windowMinY);
 		
 		s_columnTop = (s32*)game_realloc(s_columnTop, s_width * sizeof(s32));
 		s_columnBot = (s32*)game_realloc(s_columnBot, s_width * sizeof(s32));
-		s_rcfltState.depth1d_all = (f32*)game_realloc(s_rcfltState.depth1d_all, s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		s_rcfltThread.depth1d_all = (f32*)game_realloc(s_rcfltThread.depth1d_all, s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1));
 		s_windowTop_all = (s32*)game_realloc(s_windowTop_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
 		s_windowBot_all = (s32*)game_realloc(s_windowBot_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
 
 		// This table is giant with higher limits, so for now allocate directly from the heap (13 MB)
-		if (!s_rcfltState.adjoinEdgeList)
+		if (!s_rcfltThread.adjoinEdgeList)
 		{
-			s_rcfltState.adjoinEdgeList = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * MAX_ADJOIN_SEG_EXT * MAX_ADJOIN_DEPTH_EXT);
+			s_rcfltThread.adjoinEdgeList = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * MAX_ADJOIN_SEG_EXT * MAX_ADJOIN_DEPTH_EXT);
 		}
 
 		memset(s_windowTop_all, s_minScreenY, s_width);
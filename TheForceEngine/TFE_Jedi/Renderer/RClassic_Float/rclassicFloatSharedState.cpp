@@ -3,4 +3,53 @@
 namespace TFE_Jedi
 {
 	RClassicFloatState s_rcfltState = { 0 };
+	thread_local RClassicFloatThreadState s_rcfltThread = { 0 };
+
+	namespace RClassic_Float
+	{
+		// Window
+		thread_local s32 s_windowMinX_Pixels;
+		thread_local s32 s_windowMaxX_Pixels;
+		thread_local s32 s_windowMinY_Pixels;
+		thread_local s32 s_windowMaxY_Pixels;
+		thread_local s32 s_windowMaxCeil;
+		thread_local s32 s_windowMinFloor;
+
+		// Render
+		thread_local RSector* s_prevSector = nullptr;
+		thread_local s32 s_sectorIndex;
+		thread_local s32 s_maxAdjoinIndex;
+		thread_local s32 s_adjoinIndex;
+		thread_local s32 s_maxAdjoinDepth;
+		thread_local s32 s_windowX0;
+		thread_local s32 s_windowX1;
+
+		// Column Heights
+		thread_local s32* s_columnTop = nullptr;
+		thread_local s32* s_columnBot = nullptr;
+		thread_local s32* s_windowTop_all = nullptr;
+		thread_local s32* s_windowBot_all = nullptr;
+		thread_local s32* s_windowTop = nullptr;
+		thread_local s32* s_windowBot = nullptr;
+		thread_local s32* s_windowTopPrev = nullptr;
+		thread_local s32* s_windowBotPrev = nullptr;
+
+		thread_local s32* s_objWindowTop = nullptr;
+		thread_local s32* s_objWindowBot = nullptr;
+
+		// WallSegments
+		thread_local s32 s_curWallSeg;
+		thread_local s32 s_adjoinSegCount;
+		thread_local s32 s_adjoinDepth;
+
+		// Flats
+		thread_local s32 s_flatCount;
+		thread_local s32 s_wallMaxCeilY;
+		thread_local s32 s_wallMinFloorY;
+
+		// Lighting
+		thread_local s32 s_sectorAmbient;
+		thread_local s32 s_scaledAmbient;
+		thread_local s32 s_sectorAmbientFraction;
+	}  // RClassic_Float
 }  // TFE_Jedi
\ No newline at end of file
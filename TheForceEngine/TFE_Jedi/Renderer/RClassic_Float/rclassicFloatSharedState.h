@@ -10,6 +10,8 @@
 #include <TFE_Jedi/Renderer/rlimits.h>
 #include <TFE_Jedi/Renderer/rwallSegment.h>
 
+struct RSector;
+
 namespace TFE_Jedi
 {
 	struct RClassicFloatState
@@ -26,8 +28,6 @@ namespace TFE_Jedi
 		f32  focalLength;
 		f32  focalLenAspect;
 		f32  eyeHeight;
-		f32* depth1d_all;
-		f32* depth1d;
 
 		// Camera
 		vec3_float cameraPos;
@@ -48,19 +48,98 @@ namespace TFE_Jedi
 		f32  nearPlaneHalfLen;
 
 		// Window
-		f32 windowMinZ;
 		f32 windowMinY;
 		f32 windowMaxY;
 
+		// Processed walls, shared by all threads.
+		RWallSegmentFloat wallSegListSrc[MAX_SEG_EXT];
+	};
+
+	// State owned by the thread walking the sectors.
+	// When column bands are enabled, every band thread runs the full traversal with its own copy
+	// but only writes pixels in the [bandX0, bandX1] column range.
+	struct RClassicFloatThreadState
+	{
+		// Column band
+		s32 bandX0;
+		s32 bandX1;
+		JBool mainThread;		// Only the main thread writes results read by the game (such as the drawn object list).
+
+		// Projection
+		f32* depth1d_all;
+		f32* depth1d;
+
+		// Window
+		f32 windowMinZ;
+
 		// Flats
 		EdgePairFloat* flatEdge;
-		EdgePairFloat  flatEdgeList[MAX_SEG_EXT];
+		EdgePairFloat* flatEdgeList;
 		EdgePairFloat* adjoinEdge;
 		EdgePairFloat* adjoinEdgeList;
 
-		RWallSegmentFloat   wallSegListDst[MAX_SEG_EXT];
-		RWallSegmentFloat   wallSegListSrc[MAX_SEG_EXT];
+		RWallSegmentFloat*  wallSegListDst;
 		RWallSegmentFloat** adjoinSegment;
+
+		// Traversal markers, indexed by the cached wall and sector indices.
+		s32* wallDrawFrame;
+		s32* sectorDrawFrame;
 	};
+
 	extern RClassicFloatState s_rcfltState;
+	extern thread_local RClassicFloatThreadState s_rcfltThread;
+
+	inline bool columnInBand(s32 x)
+	{
+		return x >= s_rcfltThread.bandX0 && x <= s_rcfltThread.bandX1;
+	}
+
+	namespace RClassic_Float
+	{
+		// Sector traversal state, the thread_local versions of the variables in rtraversal.h.
+		// Window
+		extern thread_local s32 s_windowMinX_Pixels;
+		extern thread_local s32 s_windowMaxX_Pixels;
+		extern thread_local s32 s_windowMinY_Pixels;
+		extern thread_local s32 s_windowMaxY_Pixels;
+		extern thread_local s32 s_windowMaxCeil;
+		extern thread_local s32 s_windowMinFloor;
+
+		// Render
+		extern thread_local RSector* s_prevSector;
+		extern thread_local s32 s_sectorIndex;
+		extern thread_local s32 s_maxAdjoinIndex;
+		extern thread_local s32 s_adjoinIndex;
+		extern thread_local s32 s_maxAdjoinDepth;
+		extern thread_local s32 s_windowX0;
+		extern thread_local s32 s_windowX1;
+
+		// Column Heights
+		extern thread_local s32* s_columnTop;
+		extern thread_local s32* s_columnBot;
+		extern thread_local s32* s_windowTop_all;
+		extern thread_local s32* s_windowBot_all;
+		extern thread_local s32* s_windowTop;
+		extern thread_local s32* s_windowBot;
+		extern thread_local s32* s_windowTopPrev;
+		extern thread_local s32* s_windowBotPrev;
+
+		extern thread_local s32* s_objWindowTop;
+		extern thread_local s32* s_objWindowBot;
+
+		// WallSegments
+		extern thread_local s32 s_curWallSeg;
+		extern thread_local s32 s_adjoinSegCount;
+		extern thread_local s32 s_adjoinDepth;
+
+		// Flats
+		extern thread_local s32 s_flatCount;
+		extern thread_local s32 s_wallMaxCeilY;
+		extern thread_local s32 s_wallMinFloorY;
+
+		// Lighting
+		extern thread_local s32 s_sectorAmbient;
+		extern thread_local s32 s_scaledAmbient;
+		extern thread_local s32 s_sectorAmbientFraction;
+	}  // RClassic_Float
 }  // TFE_Jedi
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include <cstring>
+#include <vector>
+#include <SDL_thread.h>
+#include <SDL_mutex.h>
+
+#include <TFE_System/system.h>
+#include <TFE_Jedi/Level/rsector.h>
+#include "rcolumnBandFloat.h"
+#include "rsectorFloat.h"
+#include "rclassicFloatSharedState.h"
+#include "../rcommon.h"
+
+namespace TFE_Jedi
+{
+
+namespace RClassic_Float
+{
+	struct BandMarkers
+	{
+		s32* wallDrawFrame;
+		s32* sectorDrawFrame;
+		u32  wallCapacity;
+		u32  sectorCapacity;
+		u32  generation;
+	};
+
+	struct BandWorker
+	{
+		SDL_Thread* thread;
+		SDL_sem* start;
+		s32 band;
+
+		// Buffers owned by the worker, these mirror the main thread buffers setup in buildProjectionTables().
+		s32  width;
+		s32* columnTop;
+		s32* columnBot;
+		s32* windowTop_all;
+		s32* windowBot_all;
+		f32* depth1d_all;
+		EdgePairFloat* flatEdgeList;
+		EdgePairFloat* adjoinEdgeList;
+		RWallSegmentFloat* wallSegListDst;
+		BandMarkers markers;
+
+		// Each worker has its own sector renderer for the traversal stack, which shares the cached sector data.
+		TFE_Sectors_Float* sectors;
+	};
+
+	static s32 s_threadCount = 1;
+	static s32 s_workerCount = 0;
+	static BandWorker s_workers[MAX_BAND_THREADS - 1] = { 0 };
+	static BandMarkers s_mainMarkers = { 0 };
+	static SDL_sem* s_workDone = nullptr;
+	static SDL_mutex* s_sharedLock = nullptr;
+	static JBool s_bandsActive = JFALSE;
+	static JBool s_shutdown = JFALSE;
+	static u32 s_markerGeneration = 0;
+
+	// Per-frame values set by the main thread before the workers are started.
+	static TFE_Sectors_Float* s_frameSectors = nullptr;
+	static RSector* s_frameSector = nullptr;
+	static s32 s_frameWindowX0;
+	static s32 s_frameWindowX1;
+	static s32 s_bandX[MAX_BAND_THREADS + 1];
+	// Sectors rendered by the main thread while the bands are active.
+	static std::vector<RSector*> s_renderedSectors;
+
+	int  band_workerThread(void* userData);
+	void band_startWorkers(s32 count);
+	void band_stopWorkers();
+	void band_allocateBuffers(BandWorker* worker);
+	void band_freeBuffers(BandWorker* worker);
+	void band_allocateMarkers(BandMarkers* markers, u32 wallCount, u32 sectorCount);
+	void band_freeMarkers(BandMarkers* markers);
+
+	void band_setThreadCount(s32 count)
+	{
+		s_threadCount = clamp(count, 1, MAX_BAND_THREADS);
+	}
+
+	s32 band_getThreadCount()
+	{
+		return s_threadCount;
+	}
+
+	void band_destroy()
+	{
+		band_stopWorkers();
+		band_freeMarkers(&s_mainMarkers);
+		s_rcfltThread.wallDrawFrame = nullptr;
+		s_rcfltThread.sectorDrawFrame = nullptr;
+
+		if (s_sharedLock)
+		{
+			SDL_DestroyMutex(s_sharedLock);
+			s_sharedLock = nullptr;
+		}
+		if (s_workDone)
+		{
+			SDL_DestroySemaphore(s_workDone);
+			s_workDone = nullptr;
+		}
+	}
+
+	void band_resetMarkers()
+	{
+		s_markerGeneration++;
+	}
+
+	void band_prepareMainThread(u32 wallCount, u32 sectorCount)
+	{
+		band_allocateMarkers(&s_mainMarkers, wallCount, sectorCount);
+
+		s_rcfltThread.bandX0 = s_minScreenX_Pixels;
+		s_rcfltThread.bandX1 = s_maxScreenX_Pixels;
+		s_rcfltThread.mainThread = JTRUE;
+		s_rcfltThread.wallDrawFrame = s_mainMarkers.wallDrawFrame;
+		s_rcfltThread.sectorDrawFrame = s_mainMarkers.sectorDrawFrame;
+	}
+
+	void band_drawSectors(TFE_Sectors_Float* sectors, RSector* sector)
+	{
+		const s32 bandCount = min(s_threadCount, s_maxScreenX_Pixels - s_minScreenX_Pixels + 1);
+		if (bandCount <= 1)
+		{
+			sectors->draw(sector);
+			return;
+		}
+		if (s_workerCount != bandCount - 1)
+		{
+			band_stopWorkers();
+			band_startWorkers(bandCount - 1);
+			// Fallback to single threaded rendering if the threads cannot be created.
+			if (s_workerCount != bandCount - 1)
+			{
+				band_stopWorkers();
+				s_threadCount = 1;
+				sectors->draw(sector);
+				return;
+			}
+		}
+
+		// Split the screen into evenly sized bands.
+		const s32 width = s_maxScreenX_Pixels - s_minScreenX_Pixels + 1;
+		for (s32 i = 0; i <= bandCount; i++)
+		{
+			s_bandX[i] = s_minScreenX_Pixels + width * i / bandCount;
+		}
+
+		s_frameSectors  = sectors;
+		s_frameSector   = sector;
+		s_frameWindowX0 = s_windowX0;
+		s_frameWindowX1 = s_windowX1;
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			band_allocateBuffers(&s_workers[i]);
+			band_allocateMarkers(&s_workers[i].markers, sectors->m_cachedWallCount, sectors->m_cachedSectorCount);
+		}
+
+		// Kick off the workers and then draw the first band on this thread.
+		s_bandsActive = JTRUE;
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			SDL_SemPost(s_workers[i].start);
+		}
+
+		s_rcfltThread.bandX0 = s_bandX[0];
+		s_rcfltThread.bandX1 = s_bandX[1] - 1;
+		sectors->draw(sector);
+
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			SDL_SemWait(s_workDone);
+		}
+		s_bandsActive = JFALSE;
+
+		const size_t renderedCount = s_renderedSectors.size();
+		for (size_t i = 0; i < renderedCount; i++)
+		{
+			s_renderedSectors[i]->flags1 |= SEC_FLAGS1_RENDERED;
+		}
+		s_renderedSectors.clear();
+
+		s_rcfltThread.bandX0 = s_minScreenX_Pixels;
+		s_rcfltThread.bandX1 = s_maxScreenX_Pixels;
+	}
+
+	void band_lockShared()
+	{
+		if (s_bandsActive) { SDL_LockMutex(s_sharedLock); }
+	}
+
+	void band_unlockShared()
+	{
+		if (s_bandsActive) { SDL_UnlockMutex(s_sharedLock); }
+	}
+
+	void band_setSectorRendered(RSector* sector)
+	{
+		if (s_bandsActive)
+		{
+			s_renderedSectors.push_back(sector);
+		}
+		else
+		{
+			sector->flags1 |= SEC_FLAGS1_RENDERED;
+		}
+	}
+
+	void band_resetTraversal()
+	{
+		memset(s_rcfltThread.depth1d_all, 0, s_width * sizeof(f32));
+		s_rcfltThread.windowMinZ = 0.0f;
+
+		s_windowMinX_Pixels = s_minScreenX_Pixels;
+		s_windowMaxX_Pixels = s_maxScreenX_Pixels;
+		s_windowMinY_Pixels = 1;
+		s_windowMaxY_Pixels = s_height - 1;
+		s_windowMaxCeil  = s_minScreenY;
+		s_windowMinFloor = s_maxScreenY;
+		s_flatCount  = 0;
+		s_curWallSeg = 0;
+
+		s_prevSector = nullptr;
+		s_sectorIndex = 0;
+		s_maxAdjoinIndex = 0;
+		s_adjoinSegCount = 1;
+		s_adjoinIndex = 0;
+
+		s_adjoinDepth = 1;
+		s_maxAdjoinDepth = 1;
+
+		for (s32 i = 0; i < s_width; i++)
+		{
+			s_columnTop[i] = s_minScreenY;
+			s_columnBot[i] = s_maxScreenY;
+			s_windowTop_all[i] = s_minScreenY;
+			s_windowBot_all[i] = s_maxScreenY;
+		}
+	}
+
+	/////////////////////////////////////////////
+	// Internal
+	/////////////////////////////////////////////
+	void band_drawWorker(BandWorker* worker)
+	{
+		// Bind the worker buffers to this thread.
+		s_rcfltThread.bandX0 = s_bandX[worker->band];
+		s_rcfltThread.bandX1 = s_bandX[worker->band + 1] - 1;
+		s_rcfltThread.mainThread = JFALSE;
+		s_rcfltThread.depth1d_all = worker->depth1d_all;
+		s_rcfltThread.flatEdgeList = worker->flatEdgeList;
+		s_rcfltThread.adjoinEdgeList = worker->adjoinEdgeList;
+		s_rcfltThread.wallSegListDst = worker->wallSegListDst;
+		s_rcfltThread.wallDrawFrame = worker->markers.wallDrawFrame;
+		s_rcfltThread.sectorDrawFrame = worker->markers.sectorDrawFrame;
+		s_columnTop = worker->columnTop;
+		s_columnBot = worker->columnBot;
+		s_windowTop_all = worker->windowTop_all;
+		s_windowBot_all = worker->windowBot_all;
+
+		// Start from the same state as the main thread.
+		band_resetTraversal();
+		s_windowX0 = s_frameWindowX0;
+		s_windowX1 = s_frameWindowX1;
+
+		worker->sectors->shareCachedData(s_frameSectors);
+		worker->sectors->prepareThread();
+		worker->sectors->draw(s_frameSector);
+	}
+
+	int band_workerThread(void* userData)
+	{
+		BandWorker* worker = (BandWorker*)userData;
+		while (1)
+		{
+			SDL_SemWait(worker->start);
+			if (s_shutdown) { break; }
+
+			band_drawWorker(worker);
+			SDL_SemPost(s_workDone);
+		}
+		return 0;
+	}
+
+	void band_startWorkers(s32 count)
+	{
+		if (!s_sharedLock) { s_sharedLock = SDL_CreateMutex(); }
+		if (!s_workDone) { s_workDone = SDL_CreateSemaphore(0); }
+		if (!s_sharedLock || !s_workDone)
+		{
+			TFE_System::logWrite(LOG_ERROR, "Classic_Float", "Cannot create the column band synchronization objects.");
+			return;
+		}
+
+		s_shutdown = JFALSE;
+		for (s32 i = 0; i < count; i++)
+		{
+			BandWorker* worker = &s_workers[i];
+			memset(worker, 0, sizeof(BandWorker));
+			worker->band = i + 1;
+			worker->sectors = new TFE_Sectors_Float();
+			worker->start = SDL_CreateSemaphore(0);
+			if (worker->start)
+			{
+				worker->thread = SDL_CreateThread(band_workerThread, "ColumnBand", worker);
+			}
+			if (!worker->thread)
+			{
+				TFE_System::logWrite(LOG_ERROR, "Classic_Float", "Cannot create column band thread %d.", i + 1);
+				if (worker->start) { SDL_DestroySemaphore(worker->start); }
+				delete worker->sectors;
+				memset(worker, 0, sizeof(BandWorker));
+				break;
+			}
+			s_workerCount++;
+		}
+	}
+
+	void band_stopWorkers()
+	{
+		s_shutdown = JTRUE;
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			SDL_SemPost(s_workers[i].start);
+		}
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			BandWorker* worker = &s_workers[i];
+			SDL_WaitThread(worker->thread, nullptr);
+			SDL_DestroySemaphore(worker->start);
+
+			band_freeBuffers(worker);
+			band_freeMarkers(&worker->markers);
+			// The worker renderer only borrows the cached data, so it is not destroyed here.
+			delete worker->sectors;
+			memset(worker, 0, sizeof(BandWorker));
+		}
+		s_workerCount = 0;
+		s_shutdown = JFALSE;
+	}
+
+	void band_allocateBuffers(BandWorker* worker)
+	{
+		if (!worker->flatEdgeList)
+		{
+			worker->flatEdgeList   = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * MAX_SEG_EXT);
+			worker->wallSegListDst = (RWallSegmentFloat*)malloc(sizeof(RWallSegmentFloat) * MAX_SEG_EXT);
+			worker->adjoinEdgeList = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * MAX_ADJOIN_SEG_EXT * MAX_ADJOIN_DEPTH_EXT);
+		}
+		if (worker->width == s_width) { return; }
+
+		worker->width = s_width;
+		worker->columnTop = (s32*)realloc(worker->columnTop, s_width * sizeof(s32));
+		worker->columnBot = (s32*)realloc(worker->columnBot, s_width * sizeof(s32));
+		worker->depth1d_all = (f32*)realloc(worker->depth1d_all, s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		worker->windowTop_all = (s32*)realloc(worker->windowTop_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		worker->windowBot_all = (s32*)realloc(worker->windowBot_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+	}
+
+	void band_freeBuffers(BandWorker* worker)
+	{
+		free(worker->flatEdgeList);
+		free(worker->wallSegListDst);
+		free(worker->adjoinEdgeList);
+		free(worker->columnTop);
+		free(worker->columnBot);
+		free(worker->depth1d_all);
+		free(worker->windowTop_all);
+		free(worker->windowBot_all);
+	}
+
+	// Markers hold frame numbers, so newly allocated entries are cleared to avoid matching the current frame.
+	void band_allocateMarkers(BandMarkers* markers, u32 wallCount, u32 sectorCount)
+	{
+		if (markers->generation != s_markerGeneration)
+		{
+			if (markers->wallDrawFrame)   { memset(markers->wallDrawFrame, 0, markers->wallCapacity * sizeof(s32)); }
+			if (markers->sectorDrawFrame) { memset(markers->sectorDrawFrame, 0, markers->sectorCapacity * sizeof(s32)); }
+			markers->generation = s_markerGeneration;
+		}
+		if (wallCount > markers->wallCapacity)
+		{
+			markers->wallDrawFrame = (s32*)realloc(markers->wallDrawFrame, wallCount * sizeof(s32));
+			memset(markers->wallDrawFrame + markers->wallCapacity, 0, (wallCount - markers->wallCapacity) * sizeof(s32));
+			markers->wallCapacity = wallCount;
+		}
+		if (sectorCount > markers->sectorCapacity)
+		{
+			markers->sectorDrawFrame = (s32*)realloc(markers->sectorDrawFrame, sectorCount * sizeof(s32));
+			memset(markers->sectorDrawFrame + markers->sectorCapacity, 0, (sectorCount - markers->sectorCapacity) * sizeof(s32));
+			markers->sectorCapacity = sectorCount;
+		}
+	}
+
+	void band_freeMarkers(BandMarkers* markers)
+	{
+		free(markers->wallDrawFrame);
+		free(markers->sectorDrawFrame);
+		memset(markers, 0, sizeof(BandMarkers));
+	}
+}  // RClassic_Float
+
+}  // TFE_Jedi
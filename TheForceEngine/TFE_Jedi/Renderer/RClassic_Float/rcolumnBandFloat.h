@@ -0,0 +1,45 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Column Bands
+// Splits the Classic_Float view into vertical column bands, each
+// drawn on its own thread. Every band thread runs the full sector
+// traversal - so clipping, depth and window bookkeeping match the
+// single threaded renderer exactly - but only writes pixels inside of
+// its band. This keeps the output pixel identical regardless of the
+// thread count.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+struct RSector;
+
+namespace TFE_Jedi
+{
+	class TFE_Sectors_Float;
+
+	namespace RClassic_Float
+	{
+		#define MAX_BAND_THREADS 16
+
+		// Set the number of threads used to draw the view, 1 = single threaded.
+		void band_setThreadCount(s32 count);
+		s32  band_getThreadCount();
+		// Stop the worker threads and free their buffers.
+		void band_destroy();
+
+		// Clear the traversal markers, called when the cached sector data is rebuilt.
+		void band_resetMarkers();
+		// Setup the main thread band and traversal markers, called once per frame before drawing.
+		void band_prepareMainThread(u32 wallCount, u32 sectorCount);
+		// Reset the calling thread's traversal state for a new frame.
+		void band_resetTraversal();
+		// Draw the view from 'sector', splitting the pixel work between the band threads.
+		void band_drawSectors(TFE_Sectors_Float* sectors, RSector* sector);
+
+		// Guard the per-frame sector setup that is shared between band threads.
+		void band_lockShared();
+		void band_unlockShared();
+		// Flag a sector as rendered, called from the main thread only.
+		// While the band threads are drawing the flags are set after they finish since the other threads read the sector flags.
+		void band_setSectorRendered(RSector* sector);
+	}  // RClassic_Float
+}  // TFE_Jedi
@@ -7,10 +7,10 @@
 #include "rclassicFloat.h"
 #include "rclassicFloatSharedState.h"
 #include "fixedPoint20.h"
-#include "../rscanline.h"
 #include "../rsectorRender.h"
 #include "../redgePair.h"
 #include "../rcommon.h"
+#include "../texelKernels.h"
 #include <assert.h>
 
 namespace TFE_Jedi
@@ -18,23 +18,26 @@ namespace TFE_Jedi
 
 namespace RClassic_Float
 {
-	static s32 s_scanlineX0;
-
-	static fixed44_20 s_scanlineU0;
-	static fixed44_20 s_scanlineV0;
-	static fixed44_20 s_scanline_dUdX;
-	static fixed44_20 s_scanline_dVdX;
-
-	static s32 s_scanlineWidth;
-	static const u8* s_scanlineLight;
-	static u8* s_scanlineOut;
-
-	static u8* s_ftexImage;
-	static s32 s_ftexDataEnd;
-	static s32 s_ftexHeight;
-	static s32 s_ftexWidthMask;
-	static s32 s_ftexHeightMask;
-	static s32 s_ftexHeightLog2;
+	static thread_local s32 s_scanlineX0;
+
+	static thread_local fixed44_20 s_scanlineU0;
+	static thread_local fixed44_20 s_scanlineV0;
+	static thread_local fixed44_20 s_scanline_dUdX;
+	static thread_local fixed44_20 s_scanline_dVdX;
+
+	static thread_local s32 s_scanlineWidth;
+	static thread_local const u8* s_scanlineLight;
+	static thread_local u8* s_scanlineOut;
+
+	static thread_local u8* s_ftexImage;
+	static thread_local s32 s_ftexDataEnd;
+	static thread_local s32 s_ftexHeight;
+	static thread_local s32 s_ftexWidthMask;
+	static thread_local s32 s_ftexHeightMask;
+	static thread_local s32 s_ftexHeightLog2;
+
+	// Scanline building and clipping, using the thread_local traversal state.
+	#include "../rscanlineFunc.h"
 		
 	void flat_addEdges(s32 length, s32 x0, f32 dyFloor_dx, f32 yFloor, f32 dyCeil_dx, f32 yCeil)
 	{
@@ -53,15 +56,15 @@ namespace RClassic_Float
 				yFloor1 += dyFloor_dx * lengthFlt;
 			}
 
-			edgePair_setup(length, x0, dyFloor_dx, yFloor1, yFloor, dyCeil_dx, yCeil, yCeil1, s_rcfltState.flatEdge);
+			edgePair_setup(length, x0, dyFloor_dx, yFloor1, yFloor, dyCeil_dx, yCeil, yCeil1, s_rcfltThread.flatEdge);
 
-			if (s_rcfltState.flatEdge->yPixel_C1 - 1 > s_wallMaxCeilY)
+			if (s_rcfltThread.flatEdge->yPixel_C1 - 1 > s_wallMaxCeilY)
 			{
-				s_wallMaxCeilY = s_rcfltState.flatEdge->yPixel_C1 - 1;
+				s_wallMaxCeilY = s_rcfltThread.flatEdge->yPixel_C1 - 1;
 			}
-			if (s_rcfltState.flatEdge->yPixel_F1 + 1 < s_wallMinFloorY)
+			if (s_rcfltThread.flatEdge->yPixel_F1 + 1 < s_wallMinFloorY)
 			{
-				s_wallMinFloorY = s_rcfltState.flatEdge->yPixel_F1 + 1;
+				s_wallMinFloorY = s_rcfltThread.flatEdge->yPixel_F1 + 1;
 			}
 			if (s_wallMaxCeilY < s_windowMinY_Pixels)
 			{
@@ -72,15 +75,34 @@ namespace RClassic_Float
 				s_wallMinFloorY = s_windowMaxY_Pixels;
 			}
 
-			s_rcfltState.flatEdge++;
+			s_rcfltThread.flatEdge++;
 			s_flatCount++;
 		}
 	}
 				
+	// Draw the current scanline with the SIMD kernels, see texelKernels.h
+	static void drawScanline_Kernel(u32 mode)
+	{
+		TexelSpan span;
+		span.u0 = u32(s_scanlineU0);
+		span.v0 = u32(s_scanlineV0);
+		span.dUdX = u32(s_scanline_dUdX);
+		span.dVdX = u32(s_scanline_dVdX);
+		span.fracBits = FRAC_BITS_20;
+		span.dataEnd = s_ftexDataEnd;
+		span.width = s_scanlineWidth;
+		span.image = s_ftexImage;
+		span.light = s_scanlineLight;
+		span.out = s_scanlineOut;
+		s_texelKernels->span[mode](&span);
+	}
+
 	// This produces functionally identical results to the original but splits apart the U/V and dUdx/dVdx into seperate variables
 	// to account for C vs ASM differences.
 	void drawScanline()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_LIT); return; }
+
 		const fixed44_20 dVdX = s_scanline_dVdX;
 		const fixed44_20 dUdX = s_scanline_dUdX;
 		fixed44_20 V = s_scanlineV0;
@@ -97,6 +119,8 @@ namespace RClassic_Float
 
 	void drawScanline_Fullbright()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_FULLBRIGHT); return; }
+
 		const fixed44_20 dVdX = s_scanline_dVdX;
 		const fixed44_20 dUdX = s_scanline_dUdX;
 		fixed44_20 V = s_scanlineV0;
@@ -113,6 +137,8 @@ namespace RClassic_Float
 
 	void drawScanline_Trans()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_LIT | TKM_TRANS); return; }
+
 		const fixed44_20 dVdX = s_scanline_dVdX;
 		const fixed44_20 dUdX = s_scanline_dUdX;
 		fixed44_20 V = s_scanlineV0;
@@ -131,6 +157,8 @@ namespace RClassic_Float
 
 	void drawScanline_Fullbright_Trans()
 	{
+		if (s_texelKernels) { drawScanline_Kernel(TKM_TRANS); return; }
+
 		const fixed44_20 dVdX = s_scanline_dVdX;
 		const fixed44_20 dUdX = s_scanline_dUdX;
 		fixed44_20 V = s_scanlineV0;
@@ -146,6 +174,26 @@ namespace RClassic_Float
 			if (baseColor) { s_scanlineOut[i] = baseColor; }
 		}
 	}
+
+	void flat_drawTestScanline(u32 mode, fixed44_20 u, fixed44_20 v, fixed44_20 dUdX, fixed44_20 dVdX, s32 width, u8* image, s32 dataEnd, const u8* light, u8* out)
+	{
+		s_scanlineU0 = u;
+		s_scanlineV0 = v;
+		s_scanline_dUdX = dUdX;
+		s_scanline_dVdX = dVdX;
+		s_scanlineWidth = width;
+		s_ftexImage = image;
+		s_ftexDataEnd = dataEnd;
+		s_scanlineLight = light;
+		s_scanlineOut = out;
+		switch (mode)
+		{
+			case TKM_FULLBRIGHT:      { drawScanline_Fullbright(); } break;
+			case TKM_LIT:             { drawScanline(); } break;
+			case TKM_TRANS:           { drawScanline_Fullbright_Trans(); } break;
+			case TKM_LIT | TKM_TRANS: { drawScanline_Trans(); } break;
+		}
+	}
 			   
 	bool flat_setTexture(TextureData* tex)
 	{
@@ -161,6 +209,26 @@ namespace RClassic_Float
 		return true;
 	}
 	
+	// Clip the current scanline to the column band of this thread.
+	// Scanlines are drawn from right to left starting at (U0, V0), so skipped pixels on the right
+	// advance the starting coordinates to keep the texture mapping identical to the unclipped scanline.
+	bool flat_clipScanlineToBand()
+	{
+		const s32 x0 = s_scanlineX0;
+		const s32 x1 = s_scanlineX0 + s_scanlineWidth - 1;
+		const s32 clipX0 = max(x0, s_rcfltThread.bandX0);
+		const s32 clipX1 = min(x1, s_rcfltThread.bandX1);
+		if (clipX0 > clipX1) { return false; }
+
+		const s32 skipRight = x1 - clipX1;
+		s_scanlineU0 += s_scanline_dUdX * skipRight;
+		s_scanlineV0 += s_scanline_dVdX * skipRight;
+		s_scanlineOut += clipX0 - x0;
+		s_scanlineX0 = clipX0;
+		s_scanlineWidth = clipX1 - clipX0 + 1;
+		return true;
+	}
+
 	void flat_drawCeiling(SectorCached* sectorCached, EdgePairFloat* edges, s32 count)
 	{
 		f32 textureOffsetU = s_rcfltState.cameraPos.x - sectorCached->ceilOffset.x;
@@ -212,6 +280,10 @@ namespace RClassic_Float
 					s_scanline_dUdX = -floatToFixed20(negCosRelCeil * worldTexelScaleAspect);
 					s_scanlineLight =  computeLighting(z, 0);
 					
+					if (!flat_clipScanlineToBand())
+					{
+						continue;
+					}
 					if (s_scanlineLight)
 					{
 						drawScanline();
@@ -279,6 +351,10 @@ namespace RClassic_Float
 					s_scanline_dUdX = -floatToFixed20(negCosRelFloor * worldTexelScaleAspect);
 					s_scanlineLight = computeLighting(z, 0);
 
+					if (!flat_clipScanlineToBand())
+					{
+						continue;
+					}
 					if (s_scanlineLight)
 					{
 						drawScanline();
@@ -304,15 +380,15 @@ namespace RClassic_Float
 		drawScanline_Fullbright_Trans
 	};
 
-	static f32 s_poly_offsetX;
-	static f32 s_poly_offsetZ;
+	static thread_local f32 s_poly_offsetX;
+	static thread_local f32 s_poly_offsetZ;
 
-	static f32 s_poly_scaledHOffset;
-	static f32 s_poly_sinYawHOffset;
-	static f32 s_poly_cosYawHOffset;
+	static thread_local f32 s_poly_scaledHOffset;
+	static thread_local f32 s_poly_sinYawHOffset;
+	static thread_local f32 s_poly_cosYawHOffset;
 
-	static f32 s_poly_cosYawScaledHOffset;
-	static f32 s_poly_sinYawScaledHOffset;
+	static thread_local f32 s_poly_cosYawScaledHOffset;
+	static thread_local f32 s_poly_sinYawScaledHOffset;
 		
 	void flat_preparePolygon(f32 heightOffset, f32 offsetX, f32 offsetZ, TextureData* texture)
 	{
@@ -360,6 +436,8 @@ namespace RClassic_Float
 		s_scanline_dUdX =  floatToFixed20(s_poly_cosYawHOffset*worldTexelScaleAspect);
 
 		s_scanlineLight = computeLighting(z, 0);
+		if (!flat_clipScanlineToBand()) { return; }
+
 		const s32 index = (!s_scanlineLight) + trans*2;
 		c_scanlineDrawFunc[index]();
 	}
@@ -24,5 +24,9 @@ namespace TFE_Jedi
 		// Set Parameters for 3D object rendering.
 		void flat_preparePolygon(f32 heightOffset, f32 offsetX, f32 offsetZ, TextureData* texture);
 		void flat_drawPolygonScanline(s32 x0, s32 x1, s32 y, bool trans);
+
+		// Draw a single scanline with the scanline functions used by the flats, the coordinates are 44.20 fixed point.
+		// 'mode' is a TexelKernelMode, used to verify the texel kernels against the scalar loops.
+		void flat_drawTestScanline(u32 mode, s64 u, s64 v, s64 dUdX, s64 dVdX, s32 width, u8* image, s32 dataEnd, const u8* light, u8* out);
 	}
 }
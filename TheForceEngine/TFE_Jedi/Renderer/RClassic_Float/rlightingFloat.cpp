@@ -2,6 +2,7 @@
 #include <TFE_Jedi/Math/core_math.h>
 #include "rlightingFloat.h"
 #include "rclassicFloat.h"
+#include "rclassicFloatSharedState.h"
 #include "../rcommon.h"
 #include "../rlimits.h"
 
@@ -73,7 +73,7 @@ namespace RClassic_Float
 			robj3d_drawPolygon(polygon, polyVertexCount, obj, model);
 		}
 
-		if (drawn && s_drawnObjCount < MAX_DRAWN_OBJ_STORE)
+		if (drawn && s_rcfltThread.mainThread && s_drawnObjCount < MAX_DRAWN_OBJ_STORE)
 		{
 			s_drawnObj[s_drawnObjCount++] = obj;
 		}
@@ -102,7 +102,7 @@ namespace RClassic_Float
 				continue;
 			}
 			// Check the 1d depth buffer and Y positon and skip if occluded.
-			if (z >= s_rcfltState.depth1d[pixel_x] || pixel_y > s_windowMaxY_Pixels || pixel_y < s_windowMinY_Pixels || pixel_y < s_windowTop[pixel_x] || pixel_y > s_windowBot[pixel_x])
+			if (z >= s_rcfltThread.depth1d[pixel_x] || pixel_y > s_windowMaxY_Pixels || pixel_y < s_windowMinY_Pixels || pixel_y < s_windowTop[pixel_x] || pixel_y > s_windowBot[pixel_x])
 			{
 				continue;
 			}
@@ -111,6 +111,7 @@ namespace RClassic_Float
 			{
 				const s32 x = clamp(pixel_x - halfSize + (i % size), s_minScreenX_Pixels, s_maxScreenX_Pixels);
 				const s32 y = clamp(pixel_y - halfSize + (i / size), s_windowMinY_Pixels, s_windowMaxY_Pixels);
+				if (!columnInBand(x)) { continue; }
 				s_display[y*s_width + x] = color;
 			}
 		}
@@ -132,7 +133,7 @@ namespace RClassic_Float
 	{
 		JmPolygon* p0 = *((JmPolygon**)r0);
 		JmPolygon* p1 = *((JmPolygon**)r1);
-		return signZero(p1->zAvef - p0->zAvef);
+		return signZero(s_polygonZAve[p1->index] - s_polygonZAve[p0->index]);
 	}
 
 }}  // TFE_Jedi
\ No newline at end of file
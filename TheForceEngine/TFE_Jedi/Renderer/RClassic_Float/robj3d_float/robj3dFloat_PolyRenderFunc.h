@@ -350,7 +350,7 @@ void robj3d_drawFlatColorPolygon(vec3_float* projVertices, s32 vertexCount, u8 c
 	for (s32 foundEdge = 0; !foundEdge && s_columnX >= s_minScreenX_Pixels && s_columnX <= s_maxScreenX_Pixels; s_columnX++)
 	{
 		const f32 edgeMinZ = min(s_edgeBot_Z0, s_edgeTop_Z0);
-		const f32 z = s_rcfltState.depth1d[s_columnX];
+		const f32 z = s_rcfltThread.depth1d[s_columnX];
 
 		// Is ave edge Z occluded by walls? Is column outside of the vertical area?
 		if (edgeMinZ < z && s_edgeTopY0_Pixel <= s_windowMaxY_Pixels && s_edgeBotY0_Pixel >= s_windowMinY_Pixels)
@@ -376,7 +376,7 @@ void robj3d_drawFlatColorPolygon(vec3_float* projVertices, s32 vertexCount, u8 c
 			}
 
 			s_columnHeight = y0_Bot - y0_Top + 1;
-			if (s_columnHeight > 0)
+			if (s_columnHeight > 0 && columnInBand(s_columnX))
 			{
 				const f32 height = f32(s_edgeBotY0_Pixel - s_edgeTopY0_Pixel + 1);
 				s_pcolumnOut = &s_display[y0_Top*s_width + s_columnX];
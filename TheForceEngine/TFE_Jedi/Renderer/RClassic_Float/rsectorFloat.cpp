@@ -18,6 +18,7 @@
 #include "redgePairFloat.h"
 #include "rclassicFloatSharedState.h"
 #include "robj3d_float/robj3dFloat.h"
+#include "rcolumnBandFloat.h"
 #include "../rcommon.h"
 
 using namespace TFE_Jedi::RClassic_Float;
@@ -27,7 +28,7 @@ namespace TFE_Jedi
 {
 	namespace
 	{
-		static TFE_Sectors_Float* s_ctx = nullptr;
+		static thread_local TFE_Sectors_Float* s_ctx = nullptr;
 
 		s32 wallSortX(const void* r0, const void* r1)
 		{
@@ -175,17 +176,30 @@ namespace TFE_Jedi
 	{
 		m_cachedSectors = nullptr;
 		m_cachedSectorCount = 0;
+		m_cachedWallCount = 0;
 	}
 
 	void TFE_Sectors_Float::prepare()
 	{
 		allocateCachedData();
+		band_prepareMainThread(m_cachedWallCount, m_cachedSectorCount);
+		prepareThread();
 
-		EdgePairFloat* flatEdge = &s_rcfltState.flatEdgeList[s_flatCount];
-		s_rcfltState.flatEdge = flatEdge;
+		light_transformDirLights();
+	}
+
+	void TFE_Sectors_Float::prepareThread()
+	{
+		EdgePairFloat* flatEdge = &s_rcfltThread.flatEdgeList[s_flatCount];
+		s_rcfltThread.flatEdge = flatEdge;
 		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState.windowMaxY, 0, s_rcfltState.windowMinY);
+	}
 
-		light_transformDirLights();
+	void TFE_Sectors_Float::shareCachedData(const TFE_Sectors_Float* src)
+	{
+		m_cachedSectors = src->m_cachedSectors;
+		m_cachedSectorCount = src->m_cachedSectorCount;
+		m_cachedWallCount = src->m_cachedWallCount;
 	}
 
 	void transformPointByCameraFixedToFloat(vec3_fixed* worldPoint, vec3_float* viewPoint)
@@ -215,10 +229,7 @@ namespace TFE_Jedi
 		s32* winTopNext = &s_windowTop_all[s_adjoinDepth * s_width];
 		s32* winBotNext = &s_windowBot_all[s_adjoinDepth * s_width];
 
-		s_rcfltState.depth1d = &s_rcfltState.depth1d_all[(s_adjoinDepth - 1) * s_width];
-
-		s32 startWall = s_curSector->startWall;
-		s32 drawWallCount = s_curSector->drawWallCnt;
+		s_rcfltThread.depth1d = &s_rcfltThread.depth1d_all[(s_adjoinDepth - 1) * s_width];
 
 		if (s_flatLighting)
 		{
@@ -236,14 +247,18 @@ namespace TFE_Jedi
 		f32* depthPrev = nullptr;
 		if (s_adjoinDepth > 1)
 		{
-			depthPrev = &s_rcfltState.depth1d_all[(s_adjoinDepth - 2) * s_width];
-			memcpy(&s_rcfltState.depth1d[s_minScreenX_Pixels], &depthPrev[s_minScreenX_Pixels], s_width * 4);
+			depthPrev = &s_rcfltThread.depth1d_all[(s_adjoinDepth - 2) * s_width];
+			memcpy(&s_rcfltThread.depth1d[s_minScreenX_Pixels], &depthPrev[s_minScreenX_Pixels], s_width * 4);
 		}
 
 		s_wallMaxCeilY  = s_windowMinY_Pixels;
 		s_wallMinFloorY = s_windowMaxY_Pixels;
 		SectorCached* cachedSector = &m_cachedSectors[s_curSector->index];
 
+		// The first column band thread to reach the sector in a frame updates the shared cached data and processed walls.
+		band_lockShared();
+		s32 startWall = s_curSector->startWall;
+		s32 drawWallCount = s_curSector->drawWallCnt;
 		if (s_drawFrame != s_curSector->prevDrawFrame)
 		{
 			TFE_ZONE_BEGIN(secUpdateCache, "Update Sector Cache");
@@ -298,8 +313,9 @@ namespace TFE_Jedi
 				s_curSector->prevDrawFrame = s_drawFrame;
 			TFE_ZONE_END(wallProcess);
 		}
+		band_unlockShared();
 
-		RWallSegmentFloat* wallSegment = &s_rcfltState.wallSegListDst[s_curWallSeg];
+		RWallSegmentFloat* wallSegment = &s_rcfltThread.wallSegListDst[s_curWallSeg];
 		s32 drawSegCnt = wall_mergeSort(wallSegment, s_maxSegCount - s_curWallSeg, startWall, drawWallCount);
 		s_curWallSeg += drawSegCnt;
 
@@ -308,15 +324,15 @@ namespace TFE_Jedi
 		TFE_ZONE_END(wallQSort);
 
 		s32 flatCount = s_flatCount;
-		EdgePairFloat* flatEdge = &s_rcfltState.flatEdgeList[s_flatCount];
-		s_rcfltState.flatEdge = flatEdge;
+		EdgePairFloat* flatEdge = &s_rcfltThread.flatEdgeList[s_flatCount];
+		s_rcfltThread.flatEdge = flatEdge;
 
 		s32 adjoinStart = s_adjoinSegCount;
-		EdgePairFloat* adjoinEdges = &s_rcfltState.adjoinEdgeList[adjoinStart];
+		EdgePairFloat* adjoinEdges = &s_rcfltThread.adjoinEdgeList[adjoinStart];
 		RWallSegmentFloat* adjoinList[MAX_ADJOIN_DEPTH_EXT];
 
-		s_rcfltState.adjoinEdge = adjoinEdges;
-		s_rcfltState.adjoinSegment = adjoinList;
+		s_rcfltThread.adjoinEdge = adjoinEdges;
+		s_rcfltThread.adjoinSegment = adjoinList;
 
 		// Draw each wall segment in the sector.
 		TFE_ZONE_BEGIN(secDrawWalls, "Draw Walls");
@@ -457,7 +473,7 @@ namespace TFE_Jedi
 						s_maxAdjoinDepth = s_adjoinDepth;
 					}
 
-					srcWall->drawFrame = s_drawFrame;
+					s_rcfltThread.wallDrawFrame[curAdjoinSeg->srcWall->index] = s_drawFrame;
 					s_windowTop = winTopNext;
 					s_windowBot = winBotNext;
 					if (prevAdjoinSeg != 0)
@@ -475,7 +491,7 @@ namespace TFE_Jedi
 						}
 					}
 
-					s_rcfltState.windowMinZ = min(curAdjoinSeg->z0, curAdjoinSeg->z1);
+					s_rcfltThread.windowMinZ = min(curAdjoinSeg->z0, curAdjoinSeg->z1);
 					draw(nextSector);
 					
 					if (s_adjoinDepth)
@@ -484,7 +500,7 @@ namespace TFE_Jedi
 						s_adjoinDepth--;
 						restoreValues(index);
 					}
-					srcWall->drawFrame = 0;
+					s_rcfltThread.wallDrawFrame[curAdjoinSeg->srcWall->index] = 0;
 					if (srcWall->flags1 & WF1_ADJ_MID_TEX)
 					{
 						TFE_ZONE("Draw Transparent Walls");
@@ -494,9 +510,9 @@ namespace TFE_Jedi
 			}
 		}
 
-		if (!(s_curSector->flags1 & SEC_FLAGS1_SUBSECTOR) && depthPrev && s_drawFrame != s_prevSector->prevDrawFrame2)
+		if (!(s_curSector->flags1 & SEC_FLAGS1_SUBSECTOR) && depthPrev && s_drawFrame != s_rcfltThread.sectorDrawFrame[s_prevSector->index])
 		{
-			memcpy(&depthPrev[s_windowMinX_Pixels], &s_rcfltState.depth1d[s_windowMinX_Pixels], (s_windowMaxX_Pixels - s_windowMinX_Pixels + 1) * sizeof(f32));
+			memcpy(&depthPrev[s_windowMinX_Pixels], &s_rcfltThread.depth1d[s_windowMinX_Pixels], (s_windowMaxX_Pixels - s_windowMinX_Pixels + 1) * sizeof(f32));
 		}
 
 		// Objects
@@ -557,8 +573,11 @@ namespace TFE_Jedi
 		}
 		TFE_ZONE_END(secDrawObjects);
 
-		s_curSector->flags1 |= SEC_FLAGS1_RENDERED;
-		s_curSector->prevDrawFrame2 = s_drawFrame;
+		if (s_rcfltThread.mainThread)
+		{
+			band_setSectorRendered(s_curSector);
+		}
+		s_rcfltThread.sectorDrawFrame[s_curSector->index] = s_drawFrame;
 	}
 		
 	void TFE_Sectors_Float::adjoin_setupAdjoinWindow(s32* winBot, s32* winBotNext, s32* winTop, s32* winTopNext, EdgePairFloat* adjoinEdges, s32 adjoinCount)
@@ -640,7 +659,7 @@ namespace TFE_Jedi
 		SectorSaveValues* dst = &s_sectorStack[index];
 		dst->curSector = s_curSector;
 		dst->prevSector = s_prevSector;
-		dst->depth1d = s_rcfltState.depth1d;
+		dst->depth1d = s_rcfltThread.depth1d;
 		dst->windowX0 = s_windowX0;
 		dst->windowX1 = s_windowX1;
 		dst->windowMinY = s_windowMinY_Pixels;
@@ -665,7 +684,7 @@ namespace TFE_Jedi
 		const SectorSaveValues* src = &s_sectorStack[index];
 		s_curSector = src->curSector;
 		s_prevSector = src->prevSector;
-		s_rcfltState.depth1d = (f32*)src->depth1d;
+		s_rcfltThread.depth1d = (f32*)src->depth1d;
 		s_windowX0 = src->windowX0;
 		s_windowX1 = src->windowX1;
 		s_windowMinY_Pixels = src->windowMinY;
@@ -690,6 +709,7 @@ namespace TFE_Jedi
 		level_free(m_cachedSectors);
 		m_cachedSectors = nullptr;
 		m_cachedSectorCount = 0;
+		m_cachedWallCount = 0;
 	}
 		
 	void TFE_Sectors_Float::updateCachedWalls(SectorCached* cached, u32 flags)
@@ -712,6 +732,7 @@ namespace TFE_Jedi
 			{
 				wcached->wall = srcWall;
 				wcached->sector = cached;
+				wcached->index = cached->wallOffset + w;
 				wcached->v0 = &cached->verticesVS[PTR_OFFSET(srcWall->v0, srcSector->verticesVS) / sizeof(vec2_fixed)];
 				wcached->v1 = &cached->verticesVS[PTR_OFFSET(srcWall->v1, srcSector->verticesVS) / sizeof(vec2_fixed)];
 			}
@@ -792,11 +813,15 @@ namespace TFE_Jedi
 			m_cachedSectors = (SectorCached*)level_alloc(sizeof(SectorCached) * m_cachedSectorCount);
 			memset(m_cachedSectors, 0, sizeof(SectorCached) * m_cachedSectorCount);
 
+			m_cachedWallCount = 0;
 			for (u32 i = 0; i < m_cachedSectorCount; i++)
 			{
 				m_cachedSectors[i].sector = &s_levelState.sectors[i];
+				m_cachedSectors[i].wallOffset = m_cachedWallCount;
+				m_cachedWallCount += s_levelState.sectors[i].wallCount;
 				updateCachedSector(&m_cachedSectors[i], SDF_ALL);
 			}
+			band_resetMarkers();
 		}
 	}
 
@@ -19,6 +19,7 @@ namespace TFE_Jedi
 	{
 		RSector* sector;		// base sector.
 		WallCached* cachedWalls;
+		s32 wallOffset;			// index of the first wall when walls are numbered across all sectors.
 		s32 objectCapacity;
 		// Floating point version of view space vertices.
 		vec2_float* verticesVS;
@@ -35,7 +36,7 @@ namespace TFE_Jedi
 	class TFE_Sectors_Float : public TFE_Sectors
 	{
 	public:
-		TFE_Sectors_Float() : m_cachedSectors(nullptr), m_cachedSectorCount(0) {}
+		TFE_Sectors_Float() : m_cachedSectors(nullptr), m_cachedSectorCount(0), m_cachedWallCount(0) {}
 
 		// Sub-Renderer specific
 		void destroy() override;
@@ -44,6 +45,10 @@ namespace TFE_Jedi
 		void draw(RSector* sector) override;
 		void subrendererChanged() override;
 
+		// Per-thread setup, called by prepare() and by column band threads that share the cached data of another renderer.
+		void prepareThread();
+		void shareCachedData(const TFE_Sectors_Float* src);
+
 	private:
 		void saveValues(s32 index);
 		void restoreValues(s32 index);
@@ -58,5 +63,6 @@ namespace TFE_Jedi
 	public:
 		SectorCached* m_cachedSectors = nullptr;
 		u32 m_cachedSectorCount = 0;
+		u32 m_cachedWallCount = 0;
 	};
 }  // TFE_Jedi
@@ -14,6 +14,7 @@
 #include "rclassicFloatSharedState.h"
 #include "../rcommon.h"
 #include "../jediRenderer.h"
+#include "../texelKernels.h"
 
 namespace TFE_Jedi
 {
@@ -28,15 +29,26 @@ namespace RClassic_Float
 		BACK = 0,
 	};
 
-	static f32 s_segmentCross;
-	static s32 s_texHeightMask;
-	static s32 s_yPixelCount;
-	static fixed44_20 s_vCoordStep;
-	static fixed44_20 s_vCoordFixed;
-	static const u8* s_columnLight;
-	static u8* s_texImage;
-	static u8* s_columnOut;
-	static u8  s_workBuffer[WAX_DECOMPRESS_SIZE];
+	static thread_local f32 s_segmentCross;
+	static thread_local s32 s_texHeightMask;
+	static thread_local s32 s_yPixelCount;
+	static thread_local fixed44_20 s_vCoordStep;
+	static thread_local fixed44_20 s_vCoordFixed;
+	static thread_local const u8* s_columnLight;
+	static thread_local u8* s_texImage;
+	static thread_local u8* s_columnOut;
+	static thread_local u8  s_workBuffer[WAX_DECOMPRESS_SIZE];
+
+	// Every column band thread draws the same walls, so only the main thread writes the results back to the level data.
+	static inline void wall_setHidden(RWall* wall)
+	{
+		if (s_rcfltThread.mainThread) { wall->visible = 0; }
+	}
+
+	static inline void wall_setSeen(RWall* wall)
+	{
+		if (s_rcfltThread.mainThread) { wall->seen = JTRUE; }
+	}
 
 	s32 segmentCrossesLine(f32 ax0, f32 ay0, f32 ax1, f32 ay1, f32 bx0, f32 by0, f32 bx1, f32 by1);
 	f32 solveForZ_Numerator(RWallSegmentFloat* wallSegment);
@@ -444,8 +456,8 @@ namespace RClassic_Float
 		while (1)
 		{
 			WallCached* srcWall = srcSeg->srcWall;
-			JBool processed = (s_drawFrame == srcWall->wall->drawFrame) ? JTRUE : JFALSE;
-			JBool insideWindow = ((srcSeg->z0 >= s_rcfltState.windowMinZ || srcSeg->z1 >= s_rcfltState.windowMinZ) && srcSeg->wallX0 <= s_windowMaxX_Pixels && srcSeg->wallX1 >= s_windowMinX_Pixels) ? JTRUE : JFALSE;
+			JBool processed = (s_drawFrame == s_rcfltThread.wallDrawFrame[srcWall->index]) ? JTRUE : JFALSE;
+			JBool insideWindow = ((srcSeg->z0 >= s_rcfltThread.windowMinZ || srcSeg->z1 >= s_rcfltThread.windowMinZ) && srcSeg->wallX0 <= s_windowMaxX_Pixels && srcSeg->wallX1 >= s_windowMinX_Pixels) ? JTRUE : JFALSE;
 			if (!processed && insideWindow)
 			{
 				// Copy the source segment into "newSeg" so it can be modified.
@@ -780,11 +792,11 @@ namespace RClassic_Float
 
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, numerator);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 
-			srcWall->visible = 0;
+			wall_setHidden(srcWall);
 			return;
 		}
 
@@ -826,13 +838,13 @@ namespace RClassic_Float
 
 			f32 dxView = 0;
 			f32 z = solveForZ(wallSegment, x, numerator, &dxView);
-			s_rcfltState.depth1d[x] = z;
+			s_rcfltThread.depth1d[x] = z;
 
 			f32 uScale  = wallSegment->uScale;
 			f32 uCoord0 = wallSegment->uCoord0 + cachedWall->midOffset.x;
 			f32 uCoord = uCoord0 + ((wallSegment->orient == WORIENT_DZ_DX) ? dxView*uScale : (z - z0)*uScale);
 
-			if (s_yPixelCount > 0)
+			if (s_yPixelCount > 0 && columnInBand(x))
 			{
 				// texture wrapping, assumes texWidth is a power of 2.
 				s32 texelU = floorFloat(uCoord) & (texWidth - 1);
@@ -905,7 +917,7 @@ namespace RClassic_Float
 			y0F += dYdXbot;
 		}
 
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawTransparent(RWallSegmentFloat* wallSegment, EdgePairFloat* edge)
@@ -959,16 +971,18 @@ namespace RClassic_Float
 				s_vCoordFixed = floatToFixed20((yF0 - f32(yF_pixel) + 0.5f)*vCoordStep + cachedWall->midOffset.z);
 
 				s_columnOut = &s_display[yC_pixel*s_width + x];
-				s_rcfltState.depth1d[x] = z;
-				s_columnLight = computeLighting(z, floor16(srcWall->wallLight));
-
-				if (s_columnLight)
-				{
-					drawColumn_Lit_Trans();
-				}
-				else
+				s_rcfltThread.depth1d[x] = z;
+				if (columnInBand(x))
 				{
-					drawColumn_Fullbright_Trans();
+					s_columnLight = computeLighting(z, floor16(srcWall->wallLight));
+					if (s_columnLight)
+					{
+						drawColumn_Lit_Trans();
+					}
+					else
+					{
+						drawColumn_Fullbright_Trans();
+					}
 				}
 			}
 
@@ -1013,12 +1027,12 @@ namespace RClassic_Float
 			const f32 numerator = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, numerator);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 
-			srcWall->visible = 0;
-			srcWall->seen = JTRUE;
+			wall_setHidden(srcWall);
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1045,11 +1059,11 @@ namespace RClassic_Float
 			const f32 numerator = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, numerator);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->visible = 0;
-			srcWall->seen = JTRUE;
+			wall_setHidden(srcWall);
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1091,13 +1105,13 @@ namespace RClassic_Float
 				s_columnTop[x] = y0_pixel - 1;
 				s_columnBot[x] = y1_pixel + 1;
 
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, numerator);
 				y0 += dydxCeil;
 				y1 += dydxFloor;
 			}
 		}
 
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawBottom(RWallSegmentFloat* wallSegment)
@@ -1131,7 +1145,7 @@ namespace RClassic_Float
 		s32 cy1 = roundFloat(cProj1);
 		if (cy0 > s_windowMaxY_Pixels && cy1 >= s_windowMaxY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setHidden(srcWall);
 			s32 x = wallSegment->wallX0;
 			s32 length = wallSegment->wallX1 - x + 1;
 
@@ -1140,10 +1154,10 @@ namespace RClassic_Float
 			f32 num = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1156,7 +1170,7 @@ namespace RClassic_Float
 		if (fy0 < s_windowMinY_Pixels && fy1 < s_windowMinY_Pixels)
 		{
 			// Wall is above the top of the screen.
-			srcWall->visible = 0;
+			wall_setHidden(srcWall);
 			s32 x = wallSegment->wallX0;
 			s32 length = wallSegment->wallX1 - x + 1;
 
@@ -1165,10 +1179,10 @@ namespace RClassic_Float
 			f32 num = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1220,9 +1234,9 @@ namespace RClassic_Float
 				s32 yC_pixel = min(roundFloat(yC), s_windowBot[x]);
 				s_columnTop[x] = yC_pixel - 1;
 				s_columnBot[x] = bot;
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1272,8 +1286,8 @@ namespace RClassic_Float
 					f32 dz = z - z0;
 					uCoord = u0 + (dz*wallSegment->uScale) + cachedWall->botOffset.x;
 				}
-				s_rcfltState.depth1d[x] = z;
-				if (s_yPixelCount > 0)
+				s_rcfltThread.depth1d[x] = z;
+				if (s_yPixelCount > 0 && columnInBand(x))
 				{
 					s32 widthMask = tex->width - 1;
 					s32 texelU = floorFloat(uCoord) & widthMask;
@@ -1333,7 +1347,7 @@ namespace RClassic_Float
 				yC += ceil_dYdX;
 			}
 		}
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawTop(RWallSegmentFloat* wallSegment)
@@ -1365,15 +1379,15 @@ namespace RClassic_Float
 
 		if (yC0_pixel > s_windowMaxY_Pixels && yC1_pixel > s_windowMaxY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setHidden(srcWall);
 			for (s32 i = 0; i < lengthInPixels; i++) { s_columnTop[x0 + i] = s_windowMaxY_Pixels; }
 			flat_addEdges(lengthInPixels, x0, 0, f32(s_windowMaxY_Pixels + 1), 0, f32(s_windowMaxY_Pixels + 1));
 			for (s32 i = 0, x = x0; i < lengthInPixels; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1393,15 +1407,15 @@ namespace RClassic_Float
 		s32 yF1_pixel = roundFloat(yF1);
 		if (yF0_pixel < s_windowMinY_Pixels && yF1_pixel < s_windowMinY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setHidden(srcWall);
 			for (s32 i = 0; i < lengthInPixels; i++) { s_columnBot[x0 + i] = s_windowMinY_Pixels; }
 			flat_addEdges(lengthInPixels, x0, 0, f32(s_windowMinY_Pixels - 1), 0, f32(s_windowMinY_Pixels - 1));
 			for (s32 i = 0, x = x0; i < lengthInPixels; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1447,10 +1461,10 @@ namespace RClassic_Float
 				}
 
 				s_columnBot[x] = yF0_pixel + 1;
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 				yF0 += floor_dYdX;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1490,8 +1504,8 @@ namespace RClassic_Float
 			f32 uCoord0 = wallSegment->uCoord0 + cachedWall->topOffset.x;
 			f32 uCoord = uCoord0 + ((wallSegment->orient == WORIENT_DZ_DX) ? dxView*uScale : (z - z0)*uScale);
 
-			s_rcfltState.depth1d[x] = z;
-			if (s_yPixelCount > 0)
+			s_rcfltThread.depth1d[x] = z;
+			if (s_yPixelCount > 0 && columnInBand(x))
 			{
 				s32 widthMask = texture->width - 1;
 				s32 texelU = floorFloat(uCoord) & widthMask;
@@ -1552,7 +1566,7 @@ namespace RClassic_Float
 			yF0 += floor_dYdX;
 		}
 		
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawTopAndBottom(RWallSegmentFloat* wallSegment)
@@ -1580,17 +1594,17 @@ namespace RClassic_Float
 
 		if (c0_pixel > s_windowMaxY_Pixels && c1_pixel > s_windowMaxY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setHidden(srcWall);
 			for (s32 i = 0; i < length; i++) { s_columnTop[x0 + i] = s_windowMaxY_Pixels; }
 
 			flat_addEdges(length, x0, 0, f32(s_windowMaxY_Pixels + 1), 0, f32(s_windowMaxY_Pixels + 1));
 			f32 num = solveForZ_Numerator(wallSegment);
 			for (s32 i = 0, x = x0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1602,7 +1616,7 @@ namespace RClassic_Float
 		s32 f1_pixel = roundFloat(fProj1);
 		if (f0_pixel < s_windowMinY_Pixels && f1_pixel < s_windowMinY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setHidden(srcWall);
 			for (s32 i = 0; i < length; i++) { s_columnBot[x0 + i] = s_windowMinY_Pixels; }
 
 			flat_addEdges(length, x0, 0, f32(s_windowMinY_Pixels - 1), 0, f32(s_windowMinY_Pixels - 1));
@@ -1610,10 +1624,10 @@ namespace RClassic_Float
 
 			for (s32 i = 0, x = x0; i < length; i++, x++)
 			{
-				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
+				s_rcfltThread.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1677,8 +1691,8 @@ namespace RClassic_Float
 					f32 dz = z - z0;
 					u = u0 + (dz*wallSegment->uScale) + cachedWall->topOffset.x;
 				}
-				s_rcfltState.depth1d[x] = z;
-				if (s_yPixelCount > 0)
+				s_rcfltThread.depth1d[x] = z;
+				if (s_yPixelCount > 0 && columnInBand(x))
 				{
 					s32 widthMask = topTex->width - 1;
 					s32 texelU = floorFloat(u) & widthMask;
@@ -1781,8 +1795,8 @@ namespace RClassic_Float
 						f32 dz = z - z0;
 						uCoord = u0 + (dz*wallSegment->uScale) + cachedWall->botOffset.x;
 					}
-					s_rcfltState.depth1d[x] = z;
-					if (s_yPixelCount > 0)
+					s_rcfltThread.depth1d[x] = z;
+					if (s_yPixelCount > 0 && columnInBand(x))
 					{
 						s32 widthMask = botTex->width - 1;
 						s32 texelU = floorFloat(uCoord) & widthMask;
@@ -1853,12 +1867,12 @@ namespace RClassic_Float
 		s32 next_c1_pixel = roundFloat(next_cProj1);
 		if ((next_f0_pixel <= s_windowMinY_Pixels && next_f1_pixel <= s_windowMinY_Pixels) || (next_c0_pixel >= s_windowMaxY_Pixels && next_c1_pixel >= s_windowMaxY_Pixels) || (nextSector->floorHeight <= nextSector->ceilingHeight))
 		{
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
 		wall_addAdjoinSegment(length, x0, next_floor_dYdX, next_fProj0 - 1.0f, next_ceil_dYdX, next_cProj0 + 1.0f, wallSegment);
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	// Parts of the code inside 's_height == SKY_BASE_HEIGHT' are based on the original DOS exe.
@@ -1890,7 +1904,8 @@ namespace RClassic_Float
 		s_texHeightMask = texture->height - 1;
 		const s32 texWidthMask = texture->width - 1;
 
-		for (s32 x = s_windowMinX_Pixels; x <= s_windowMaxX_Pixels; x++)
+		const s32 xMax = min(s_windowMaxX_Pixels, s_rcfltThread.bandX1);
+		for (s32 x = max(s_windowMinX_Pixels, s_rcfltThread.bandX0); x <= xMax; x++)
 		{
 			const s32 y0 = s_windowTop[x];
 			const s32 y1 = min(s_columnTop[x], s_windowBot[x]);
@@ -1938,7 +1953,8 @@ namespace RClassic_Float
 		s_vCoordStep = floatToFixed20(vCoordStep);
 
 		s_texHeightMask = texture->height - 1;
-		for (s32 x = s_windowMinX_Pixels; x <= s_windowMaxX_Pixels; x++)
+		const s32 xMax = min(s_windowMaxX_Pixels, s_rcfltThread.bandX1);
+		for (s32 x = max(s_windowMinX_Pixels, s_rcfltThread.bandX0); x <= xMax; x++)
 		{
 			const s32 y0 = s_windowTop[x];
 			const s32 y1 = min(s_screenYMidFlt - 1, s_windowBot[x]);
@@ -1994,7 +2010,8 @@ namespace RClassic_Float
 		s_texHeightMask = texture->height - 1;
 		const s32 texWidthMask = texture->width - 1;
 
-		for (s32 x = s_windowMinX_Pixels; x <= s_windowMaxX_Pixels; x++)
+		const s32 xMax = min(s_windowMaxX_Pixels, s_rcfltThread.bandX1);
+		for (s32 x = max(s_windowMinX_Pixels, s_rcfltThread.bandX0); x <= xMax; x++)
 		{
 			const s32 y0 = max(s_columnBot[x], s_windowTop[x]);
 			const s32 y1 = s_windowBot[x];
@@ -2042,7 +2059,8 @@ namespace RClassic_Float
 		s_vCoordStep = floatToFixed20(vCoordStep);
 
 		s_texHeightMask = texture->height - 1;
-		for (s32 x = s_windowMinX_Pixels; x <= s_windowMaxX_Pixels; x++)
+		const s32 xMax = min(s_windowMaxX_Pixels, s_rcfltThread.bandX1);
+		for (s32 x = max(s_windowMinX_Pixels, s_rcfltThread.bandX0); x <= xMax; x++)
 		{
 			const s32 y0 = max(s_screenYMidFlt, s_windowTop[x]);
 			const s32 y1 = s_windowBot[x];
@@ -2140,8 +2158,26 @@ namespace RClassic_Float
 		return z;
 	}
 
+	// Draw the current column with the SIMD kernels, see texelKernels.h
+	static void drawColumn_Kernel(u32 mode)
+	{
+		TexelColumn column;
+		column.v0 = u32(s_vCoordFixed);
+		column.dVdY = u32(s_vCoordStep);
+		column.fracBits = FRAC_BITS_20;
+		column.heightMask = s_texHeightMask;
+		column.count = s_yPixelCount;
+		column.stride = s_width;
+		column.image = s_texImage;
+		column.light = s_columnLight;
+		column.out = s_columnOut;
+		s_texelKernels->column[mode](&column);
+	}
+
 	void drawColumn_Fullbright()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_20, s_texHeightMask)) { drawColumn_Kernel(TKM_FULLBRIGHT); return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2156,6 +2192,8 @@ namespace RClassic_Float
 
 	void drawColumn_Lit()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_20, s_texHeightMask)) { drawColumn_Kernel(TKM_LIT); return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2170,6 +2208,8 @@ namespace RClassic_Float
 
 	void drawColumn_Fullbright_Trans()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_20, s_texHeightMask)) { drawColumn_Kernel(TKM_TRANS); return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2185,6 +2225,8 @@ namespace RClassic_Float
 
 	void drawColumn_Lit_Trans()
 	{
+		if (s_texelKernels && texelKernels_columnFits(FRAC_BITS_20, s_texHeightMask)) { drawColumn_Kernel(TKM_LIT | TKM_TRANS); return; }
+
 		fixed44_20 vCoordFixed = s_vCoordFixed;
 		const u8* tex = s_texImage;
 		const s32 end = s_yPixelCount - 1;
@@ -2198,6 +2240,24 @@ namespace RClassic_Float
 		}
 	}
 
+	void wall_drawTestColumn(u32 mode, fixed44_20 v, fixed44_20 dVdY, s32 heightMask, s32 count, u8* image, const u8* light, u8* out)
+	{
+		s_vCoordFixed = v;
+		s_vCoordStep = dVdY;
+		s_texHeightMask = heightMask;
+		s_yPixelCount = count;
+		s_texImage = image;
+		s_columnLight = light;
+		s_columnOut = out;
+		switch (mode)
+		{
+			case TKM_FULLBRIGHT:      { drawColumn_Fullbright(); } break;
+			case TKM_LIT:             { drawColumn_Lit(); } break;
+			case TKM_TRANS:           { drawColumn_Fullbright_Trans(); } break;
+			case TKM_LIT | TKM_TRANS: { drawColumn_Lit_Trans(); } break;
+		}
+	}
+
 	void wall_addAdjoinSegment(s32 length, s32 x0, f32 top_dydx, f32 y1, f32 bot_dydx, f32 y0, RWallSegmentFloat* wallSegment)
 	{
 		if (s_adjoinSegCount < s_maxAdjoinSegCount)
@@ -2213,13 +2273,13 @@ namespace RClassic_Float
 			{
 				y1End += (top_dydx * lengthFlt);
 			}
-			edgePair_setup(length, x0, top_dydx, y1End, y1, bot_dydx, y0, y0End, s_rcfltState.adjoinEdge);
+			edgePair_setup(length, x0, top_dydx, y1End, y1, bot_dydx, y0, y0End, s_rcfltThread.adjoinEdge);
 
-			s_rcfltState.adjoinEdge++;
+			s_rcfltThread.adjoinEdge++;
 			s_adjoinSegCount++;
 
-			*s_rcfltState.adjoinSegment = wallSegment;
-			s_rcfltState.adjoinSegment++;
+			*s_rcfltThread.adjoinSegment = wallSegment;
+			s_rcfltThread.adjoinSegment++;
 		}
 	}
 
@@ -2332,7 +2392,7 @@ namespace RClassic_Float
 		const u32* columnOffset = (u32*)(basePtr + cell->columnOffset);
 		for (s32 x = x0_pixel; x <= x1_pixel; x++, uCoord += uCoordStep)
 		{
-			if (z < s_rcfltState.depth1d[x])
+			if (z < s_rcfltThread.depth1d[x])
 			{
 				s32 y0 = y0_pixel;
 				s32 y1 = y1_pixel;
@@ -2349,7 +2409,9 @@ namespace RClassic_Float
 				}
 
 				s_yPixelCount = y1 - y0 + 1;
-				if (s_yPixelCount > 0)
+				// The drawn state is tracked for every column so it matches across column bands.
+				if (s_yPixelCount > 1) { drawn = JTRUE; }
+				if (s_yPixelCount > 0 && columnInBand(x))
 				{
 					const f32 vOffset = f32(y1_pixel - y1);
 					s_vCoordFixed = floatToFixed20(vOffset*vCoordStep);
@@ -2377,12 +2439,11 @@ namespace RClassic_Float
 					s_columnOut = &s_display[y0 * s_width + x];
 					// Draw the column.
 					spriteColumnFunc();
-					if (s_yPixelCount > 1) { drawn = JTRUE; }
 				}
 			}
 		}
 
-		if (drawn && s_drawnObjCount < MAX_DRAWN_OBJ_STORE)
+		if (drawn && s_rcfltThread.mainThread && s_drawnObjCount < MAX_DRAWN_OBJ_STORE)
 		{
 			s_drawnObj[s_drawnObjCount++] = obj;
 		}
@@ -23,6 +23,7 @@ namespace TFE_Jedi
 	{
 		RWall* wall;	// base wall.
 		SectorCached* sector;
+		s32 index;		// wall index across all sectors.
 		// Vertices (viewspace) - points to cached vertices.
 		vec2_float* v0;
 		vec2_float* v1;
@@ -64,6 +65,10 @@ namespace TFE_Jedi
 
 		void wall_addAdjoinSegment(s32 length, s32 x0, f32 top_dydx, f32 y1, f32 bot_dydx, f32 y0, RWallSegmentFloat* wallSegment);
 
+		// Draw a single column with the column functions used by the walls, rows are s_width apart and 'v' and 'dVdY' are 44.20 fixed point.
+		// 'mode' is a TexelKernelMode, used to verify the texel kernels against the scalar loops.
+		void wall_drawTestColumn(u32 mode, s64 v, s64 dVdY, s32 heightMask, s32 count, u8* image, const u8* light, u8* out);
+
 		// Sprite code for now because so much is shared.
 		void sprite_drawFrame(u8* basePtr, WaxFrame* frame, SecObject* obj, vec3_float* cachedPosVS);
 	}
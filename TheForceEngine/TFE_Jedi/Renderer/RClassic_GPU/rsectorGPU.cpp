@@ -26,6 +26,7 @@
 #include <TFE_Asset/imageAsset.h>
 
 #include <TFE_FrontEndUI/console.h>
+#include <vector>
 
 #include "rclassicGPU.h"
 #include "rsectorGPU.h"
@@ -38,6 +39,7 @@
 #include "sectorDisplayList.h"
 #include "spriteDisplayList.h"
 #include "../rcommon.h"
+#include "../rtraversal.h"
 
 // TODO: FIx
 #include "../RClassic_Float/rclassicFloatSharedState.h"
@@ -99,6 +101,65 @@ namespace TFE_Jedi
 		s32 skyParam1Id;
 	};
 
+	// The sector traversal is recorded as a list of events, which are replayed on later frames while the
+	// camera and the geometry of the recorded sectors are unchanged. Segments are projected relative to the
+	// exact camera position, so any camera movement invalidates the record. Recording adds copies on top of
+	// the traversal, so it only starts once the view has been still for TRAVERSAL_RECORD_DELAY frames and a
+	// moving camera costs the same as without the cache.
+	enum TraversalEventType
+	{
+		TEV_SEGMENTS = 0,	// Wall segments added to the s-buffer and display list.
+		TEV_SECTOR,			// A sector is visited, its objects are added.
+		TEV_PORTAL_PUSH,	// A portal is added and its frustum pushed.
+		TEV_PORTAL_POP,
+	};
+	struct TraversalEvent
+	{
+		TraversalEventType type;
+		RSector* sector;
+		RSector* prevSector;
+		s32 prevPortalId;
+		bool forceTreatAsSolid;
+		// TEV_SEGMENTS
+		s32 segStart, segCount;
+		s32 clipStart, clipCount;
+		// TEV_SECTOR
+		s32 rangeCount;
+		Vec2f range[2];
+		Vec2f rangeSrc[2];
+		// TEV_PORTAL_PUSH
+		s32 planeStart;
+		u32 planeCount;
+		Vec3f corner0, corner1;
+		s32 parentPortalId;
+		bool portalAdded;
+	};
+	enum
+	{
+		TRAVERSAL_RECORD_DELAY = 4,
+	};
+	struct TraversalRecord
+	{
+		bool valid;
+		bool recording;
+		s32 staticFrames;	// Frames the view has been unchanged, up to TRAVERSAL_RECORD_DELAY.
+		// The view of the previous frame.
+		RSector* rootSector;
+		Vec3f cameraPos;
+		Mat3  cameraMtx;
+		Mat4  cameraProj;
+		s32   maxPortals;
+		s32   maxWallSeg;
+
+		std::vector<TraversalEvent> events;
+		std::vector<Segment> segments;
+		std::vector<SegmentClipped> clipped;
+		std::vector<s32> clippedSeg;			// Index of the segment of each clipped segment, relative to the event.
+		std::vector<Vec4f> planes;
+		std::vector<RSector*> sectors;			// Sectors that were checked for updates.
+		std::vector<RSector*> rendered;			// Sectors marked as rendered for the automap.
+	};
+
 	static GPUSourceData s_gpuSourceData = { 0 };
 
 	TextureGpu* s_trueColorMapping = nullptr;
@@ -124,6 +185,11 @@ namespace TFE_Jedi
 	static s32 s_rangeCount;
 
 	static Portal* s_portalList = nullptr;
+	static TraversalRecord s_traversal = {};
+	static s32 s_traversalRecordId = 0;
+	static s32 s_sectorsTraversed = 0;
+	static s32 s_segmentsInserted = 0;
+	static s32 s_traversalCacheHits = 0;
 	static Vec2f  s_range[2];
 	static Vec2f  s_rangeSrc[2];
 	static Segment s_wallSegments[2048];
@@ -262,6 +328,7 @@ namespace TFE_Jedi
 	void TFE_Sectors_GPU::reset()
 	{
 		m_levelInit = false;
+		s_traversal.valid = false;
 		s_flushCache = JFALSE;
 	}
 
@@ -805,6 +872,9 @@ namespace TFE_Jedi
 		if (!m_gpuInit)
 		{
 			TFE_COUNTER(s_wallSegGenerated, "Wall Segments");
+			TFE_COUNTER(s_sectorsTraversed, "Sectors Traversed");
+			TFE_COUNTER(s_segmentsInserted, "Segments Inserted");
+			TFE_COUNTER(s_traversalCacheHits, "Traversal Cache Hits");
 			
 			m_gpuInit = true;
 			s_gpuFrame = 1;
@@ -846,6 +916,7 @@ namespace TFE_Jedi
 		if (!m_levelInit)
 		{
 			m_levelInit = true;
+			s_traversal.valid = false;
 
 			// Let's just cache the current data.
 			s_cachedSectors = (GPUCachedSector*)level_alloc(sizeof(GPUCachedSector) * s_levelState.sectorCount);
@@ -985,6 +1056,7 @@ namespace TFE_Jedi
 		{
 			if (s_flushCache)
 			{
+				s_traversal.valid = false;
 				for (u32 i = 0; i < s_levelState.sectorCount; i++)
 				{
 					RSector* sector = &s_levelState.sectors[i];
@@ -1066,10 +1138,16 @@ namespace TFE_Jedi
 
 	void updateCachedSector(RSector* srcSector, u32& uploadFlags)
 	{
+		GPUCachedSector* cached = &s_cachedSectors[srcSector->index];
+		if (s_traversal.recording && cached->traversalRecord != s_traversalRecordId)
+		{
+			cached->traversalRecord = s_traversalRecordId;
+			s_traversal.sectors.push_back(srcSector);
+		}
+
 		u32 flags = srcSector->dirtyFlags;
 		if (!flags) { return; }  // Nothing to do.
 
-		GPUCachedSector* cached = &s_cachedSectors[srcSector->index];
 		if (flags & (SDF_HEIGHTS | SDF_FLAT_OFFSETS | SDF_AMBIENT))
 		{
 			cached->floorHeight   = fixed16ToFloat(srcSector->floorHeight);
@@ -1135,6 +1213,27 @@ namespace TFE_Jedi
 		return count;
 	}
 
+	// Record the current s-buffer contents, so they can be restored when the traversal is replayed.
+	void traversal_recordSegments(RSector* curSector, u32 segCount, Segment* wallSegments, bool forceTreatAsSolid)
+	{
+		TraversalEvent ev = {};
+		ev.type = TEV_SEGMENTS;
+		ev.sector = curSector;
+		ev.forceTreatAsSolid = forceTreatAsSolid;
+		ev.segStart = s32(s_traversal.segments.size());
+		ev.segCount = s32(segCount);
+		ev.clipStart = s32(s_traversal.clipped.size());
+		s_traversal.segments.insert(s_traversal.segments.end(), wallSegments, wallSegments + segCount);
+
+		for (SegmentClipped* segment = sbuffer_get(); segment; segment = segment->next)
+		{
+			s_traversal.clipped.push_back(*segment);
+			s_traversal.clippedSeg.push_back(s32(segment->seg - wallSegments));
+		}
+		ev.clipCount = s32(s_traversal.clipped.size()) - ev.clipStart;
+		s_traversal.events.push_back(ev);
+	}
+
 	void buildSegmentBuffer(bool initSector, RSector* curSector, u32 segCount, Segment* wallSegments, bool forceTreatAsSolid)
 	{
 		// Next insert solid segments into the segment buffer one at a time.
@@ -1144,6 +1243,11 @@ namespace TFE_Jedi
 			sbuffer_insertSegment(&wallSegments[i]);
 		}
 		sbuffer_mergeSegments();
+		s_segmentsInserted += s32(segCount);
+		if (s_traversal.recording)
+		{
+			traversal_recordSegments(curSector, segCount, wallSegments, forceTreatAsSolid);
+		}
 
 		// Build the display list.
 		SegmentClipped* segment = sbuffer_get();
@@ -1667,6 +1771,11 @@ namespace TFE_Jedi
 		
 		// Mark sector as being rendered for the automap.
 		curSector->flags1 |= SEC_FLAGS1_RENDERED;
+		s_sectorsTraversed++;
+		if (s_traversal.recording)
+		{
+			s_traversal.rendered.push_back(curSector);
+		}
 
 		// Build the world-space wall segments.
 		u32 segCount = 0;
@@ -1686,6 +1795,19 @@ namespace TFE_Jedi
 			return;
 		}
 
+		if (s_traversal.recording)
+		{
+			TraversalEvent ev = {};
+			ev.type = TEV_SECTOR;
+			ev.sector = curSector;
+			ev.prevSector = prevSector;
+			ev.prevPortalId = prevPortalId;
+			ev.rangeCount = s_rangeCount;
+			memcpy(ev.range, s_range, sizeof(Vec2f) * 2);
+			memcpy(ev.rangeSrc, s_rangeSrc, sizeof(Vec2f) * 2);
+			s_traversal.events.push_back(ev);
+		}
+
 		// Determine which objects are visible and add them.
 		addSectorObjects(curSector, prevSector, s_displayCurrentPortalId, prevPortalId);
 
@@ -1704,7 +1826,21 @@ namespace TFE_Jedi
 			// Add a portal to the display list.
 			Vec3f corner0 = { portal->v0.x, portal->y0, portal->v0.z };
 			Vec3f corner1 = { portal->v1.x, portal->y1, portal->v1.z };
-			if (sdisplayList_addPortal(corner0, corner1, parentPortalId))
+			const bool portalAdded = sdisplayList_addPortal(corner0, corner1, parentPortalId);
+			if (s_traversal.recording)
+			{
+				TraversalEvent ev = {};
+				ev.type = TEV_PORTAL_PUSH;
+				ev.planeStart = s32(s_traversal.planes.size());
+				ev.planeCount = portal->frustum.planeCount;
+				ev.corner0 = corner0;
+				ev.corner1 = corner1;
+				ev.parentPortalId = parentPortalId;
+				ev.portalAdded = portalAdded;
+				s_traversal.planes.insert(s_traversal.planes.end(), portal->frustum.planes, portal->frustum.planes + portal->frustum.planeCount);
+				s_traversal.events.push_back(ev);
+			}
+			if (portalAdded)
 			{
 				portal->wall->drawFrame = s_gpuFrame;
 				traverseSector(portal->next, curSector, portal->wall, parentPortalId, level, uploadFlags, portal->v0, portal->v1);
@@ -1713,6 +1849,151 @@ namespace TFE_Jedi
 
 			frustum_pop();
 			level--;
+			if (s_traversal.recording)
+			{
+				TraversalEvent ev = {};
+				ev.type = TEV_PORTAL_POP;
+				s_traversal.events.push_back(ev);
+			}
+		}
+	}
+
+	// The geometry of a recorded sector changed, so the traversal must be rebuilt.
+	static const u32 c_traversalDirtyFlags = SDF_VERTICES | SDF_HEIGHTS | SDF_WALL_SHAPE | SDF_INIT_SETUP;
+
+	// Compare the view with the previous frame, any change drops the record and restarts the delay.
+	void traversal_updateView(RSector* sector)
+	{
+		const bool sameView = s_traversal.rootSector == sector &&
+			s_traversal.maxPortals == s_maxPortals && s_traversal.maxWallSeg == s_maxWallSeg &&
+			memcmp(&s_traversal.cameraPos, &s_cameraPos, sizeof(Vec3f)) == 0 &&
+			memcmp(&s_traversal.cameraMtx, &s_cameraMtx, sizeof(Mat3)) == 0 &&
+			memcmp(&s_traversal.cameraProj, &s_cameraProj, sizeof(Mat4)) == 0;
+		if (sameView)
+		{
+			s_traversal.staticFrames = min(s_traversal.staticFrames + 1, (s32)TRAVERSAL_RECORD_DELAY);
+			return;
+		}
+
+		s_traversal.valid = false;
+		s_traversal.staticFrames = 0;
+		s_traversal.rootSector = sector;
+		s_traversal.cameraPos  = s_cameraPos;
+		s_traversal.cameraMtx  = s_cameraMtx;
+		s_traversal.cameraProj = s_cameraProj;
+		s_traversal.maxPortals = s_maxPortals;
+		s_traversal.maxWallSeg = s_maxWallSeg;
+	}
+
+	bool traversal_canReplay()
+	{
+		if (!s_traversal.valid) { return false; }
+
+		const size_t count = s_traversal.sectors.size();
+		RSector** recSector = s_traversal.sectors.data();
+		for (size_t s = 0; s < count; s++)
+		{
+			if (recSector[s]->dirtyFlags & c_traversalDirtyFlags)
+			{
+				// Geometry that keeps changing, such as a moving elevator in view, is not recorded every frame.
+				s_traversal.valid = false;
+				s_traversal.staticFrames = 0;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void traversal_beginRecord()
+	{
+		s_traversalRecordId++;
+		s_traversal.recording = true;
+		s_traversal.events.clear();
+		s_traversal.segments.clear();
+		s_traversal.clipped.clear();
+		s_traversal.clippedSeg.clear();
+		s_traversal.planes.clear();
+		s_traversal.sectors.clear();
+		s_traversal.rendered.clear();
+	}
+
+	void traversal_endRecord()
+	{
+		s_traversal.recording = false;
+		s_traversal.valid = true;
+	}
+
+	// Replay the recorded traversal, this produces the same display lists as traverseSector() without
+	// rebuilding the wall segments, s-buffers and portal frustums.
+	void traversal_replay(u32& uploadFlags)
+	{
+		// Sector heights, offsets and lighting may still change without affecting the traversal.
+		const size_t sectorCount = s_traversal.sectors.size();
+		for (size_t s = 0; s < sectorCount; s++)
+		{
+			updateCachedSector(s_traversal.sectors[s], uploadFlags);
+		}
+
+		const size_t renderedCount = s_traversal.rendered.size();
+		for (size_t s = 0; s < renderedCount; s++)
+		{
+			s_traversal.rendered[s]->flags1 |= SEC_FLAGS1_RENDERED;
+		}
+
+		static Frustum s_replayFrustum;
+		const size_t eventCount = s_traversal.events.size();
+		for (size_t e = 0; e < eventCount; e++)
+		{
+			const TraversalEvent* ev = &s_traversal.events[e];
+			switch (ev->type)
+			{
+				case TEV_SEGMENTS:
+				{
+					memcpy(s_wallSegments, &s_traversal.segments[ev->segStart], sizeof(Segment) * ev->segCount);
+					SegmentClipped* clipped = &s_traversal.clipped[ev->clipStart];
+					const s32* clippedSeg = &s_traversal.clippedSeg[ev->clipStart];
+					for (s32 i = 0; i < ev->clipCount; i++)
+					{
+						clipped[i].seg = &s_wallSegments[clippedSeg[i]];
+					}
+					sbuffer_set(ev->clipCount, clipped);
+
+					GPUCachedSector* cached = &s_cachedSectors[ev->sector->index];
+					cached->builtFrame = s_gpuFrame;
+					SegmentClipped* segment = sbuffer_get();
+					while (segment && s_wallSegGenerated < s_maxWallSeg)
+					{
+						debug_addQuad(segment->v0, segment->v1, segment->seg->y0, segment->seg->y1,
+							segment->seg->portalY0, segment->seg->portalY1, segment->seg->portal);
+
+						sdisplayList_addSegment(ev->sector, cached, segment, ev->forceTreatAsSolid);
+						s_wallSegGenerated++;
+						segment = segment->next;
+					}
+				} break;
+				case TEV_SECTOR:
+				{
+					s_rangeCount = ev->rangeCount;
+					memcpy(s_range, ev->range, sizeof(Vec2f) * 2);
+					memcpy(s_rangeSrc, ev->rangeSrc, sizeof(Vec2f) * 2);
+					addSectorObjects(ev->sector, ev->prevSector, s_displayCurrentPortalId, ev->prevPortalId);
+					s_traversalCacheHits++;
+				} break;
+				case TEV_PORTAL_PUSH:
+				{
+					s_replayFrustum.planeCount = ev->planeCount;
+					memcpy(s_replayFrustum.planes, &s_traversal.planes[ev->planeStart], sizeof(Vec4f) * ev->planeCount);
+					frustum_push(s_replayFrustum);
+					s_portalsTraversed++;
+
+					const bool portalAdded = sdisplayList_addPortal(ev->corner0, ev->corner1, ev->parentPortalId);
+					assert(portalAdded == ev->portalAdded);
+				} break;
+				case TEV_PORTAL_POP:
+				{
+					frustum_pop();
+				} break;
+			}
 		}
 	}
 						
@@ -1730,6 +2011,9 @@ namespace TFE_Jedi
 		s_portalsTraversed = 0;
 		s_portalListCount = 0;
 		s_wallSegGenerated = 0;
+		s_sectorsTraversed = 0;
+		s_segmentsInserted = 0;
+		s_traversalCacheHits = 0;
 		Vec2f startView[] = { {0,0}, {0,0} };
 
 		// Compute an XZ direction for sprite culling.
@@ -1751,8 +2035,27 @@ namespace TFE_Jedi
 		model_drawListClear();
 		objectPortalPlanes_clear();
 
-		updateCachedSector(sector, uploadFlags);
-		traverseSector(sector, nullptr, nullptr, 0, level, uploadFlags, startView[0], startView[1]);
+		// Reuse the traversal from a previous frame if the view and the sector geometry haven't changed.
+		{
+			TFE_ZONE("Sector Traversal");
+			traversal_updateView(sector);
+			const bool replay = traversal_canReplay();
+			const bool record = !replay && s_traversal.staticFrames >= TRAVERSAL_RECORD_DELAY;
+			if (record)
+			{
+				traversal_beginRecord();
+			}
+			updateCachedSector(sector, uploadFlags);
+			if (replay)
+			{
+				traversal_replay(uploadFlags);
+			}
+			else
+			{
+				traverseSector(sector, nullptr, nullptr, 0, level, uploadFlags, startView[0], startView[1]);
+				if (record) { traversal_endRecord(); }
+			}
+		}
 		frustum_pop();
 
 		// Fixup the transparencies if using bilinear filtering.
@@ -321,6 +321,30 @@ namespace TFE_Jedi
 		return s_segClippedHead;
 	}
 
+	void sbuffer_set(s32 count, const SegmentClipped* segs)
+	{
+		sbuffer_clear();
+		for (s32 i = 0; i < count; i++)
+		{
+			SegmentClipped* entry = sbuffer_getClippedSeg(segs[i].seg);
+			if (!entry) { break; }
+			entry->x0 = segs[i].x0;
+			entry->x1 = segs[i].x1;
+			entry->v0 = segs[i].v0;
+			entry->v1 = segs[i].v1;
+
+			if (s_segClippedTail)
+			{
+				insertSegmentAfter(s_segClippedTail, entry);
+			}
+			else
+			{
+				s_segClippedHead = entry;
+				s_segClippedTail = entry;
+			}
+		}
+	}
+
 	SegmentClipped* sbuffer_getClippedSeg(Segment* seg, SegmentClipped* dstSegs, s32 maxOutputSegs, s32& dstSegCount)
 	{
 		if (dstSegCount >= maxOutputSegs)
@@ -46,6 +46,8 @@ namespace TFE_Jedi
 	void sbuffer_mergeSegments();
 	void sbuffer_insertSegment(Segment* seg);
 	SegmentClipped* sbuffer_get();
+	// Replace the buffer contents with 'count' segments that are already sorted and clipped.
+	void sbuffer_set(s32 count, const SegmentClipped* segs);
 
 	// Clips a segment to the buffer but does *not* update the s-buffer itself.
 	// The result will be zero or more output segments.
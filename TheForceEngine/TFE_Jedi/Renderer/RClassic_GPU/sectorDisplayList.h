@@ -43,6 +43,7 @@ namespace TFE_Jedi
 		u64 builtFrame;
 
 		s32 wallStart;
+		s32 traversalRecord;	// Last traversal record that included the sector.
 	};
 
 	void sdisplayList_init(s32* posIndex, s32* dataIndex, s32 planesIndex);
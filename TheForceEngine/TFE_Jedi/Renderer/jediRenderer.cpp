@@ -3,8 +3,10 @@
 #include <TFE_Jedi/Level/robject.h>
 #include <TFE_Jedi/Level/level.h>
 #include "rcommon.h"
+#include "rtraversal.h"
 #include "rsectorRender.h"
 #include "screenDraw.h"
+#include "texelKernels.h"
 #include "RClassic_Fixed/rclassicFixedSharedState.h"
 #include "RClassic_Fixed/rclassicFixed.h"
 #include "RClassic_Fixed/rsectorFixed.h"
@@ -12,6 +14,7 @@
 #include "RClassic_Float/rclassicFloat.h"
 #include "RClassic_Float/rsectorFloat.h"
 #include "RClassic_Float/rclassicFloatSharedState.h"
+#include "RClassic_Float/rcolumnBandFloat.h"
 
 #include "RClassic_GPU/rclassicGPU.h"
 #include "RClassic_GPU/rsectorGPU.h"
@@ -35,6 +38,8 @@ namespace TFE_Jedi
 	static Vec3f s_lumMask = { 0 };
 	static Vec3f s_palFx = { 0 };
 	static u32 s_sourcePalette[256];
+	static s32 s_floatThreadCount = 1;
+	static s32 s_bandTestThreadCount = 0;	// Column band thread count compared against single threaded drawing on the next frame, 0 = no test.
 	bool s_showWireframe = false;
 	TFE_Sectors* s_sectorRenderer = nullptr;
 	RendererType s_rendererType = RENDERER_SOFTWARE;
@@ -43,8 +48,14 @@ namespace TFE_Jedi
 	// Forward Declarations
 	/////////////////////////////////////////////
 	void clear1dDepth();
+	void copyFloatTraversalCounters();
 	void console_setSubRenderer(const std::vector<std::string>& args);
 	void console_getSubRenderer(const std::vector<std::string>& args);
+	void console_setTexelKernels(const std::vector<std::string>& args);
+	void console_getTexelKernels(const std::vector<std::string>& args);
+	void console_testTexelKernels(const std::vector<std::string>& args);
+	void console_testFloatBands(const std::vector<std::string>& args);
+	void testFloatBands(u8* display, RSector* sector, const u8* colormap, const u8* lightSourceRamp);
 
 	/////////////////////////////////////////////
 	// Implementation
@@ -116,10 +127,15 @@ namespace TFE_Jedi
 		CVAR_INT(s_maxDepthCount, "d_maxDepthCount", CVFLAG_DO_NOT_SERIALIZE, "Maximum adjoin depth count.");
 		CVAR_INT(s_sectorAmbient, "d_sectorAmbient", CVFLAG_DO_NOT_SERIALIZE, "Current Sector Ambient.");
 		CVAR_BOOL(s_showWireframe, "d_enableWireframe", CVFLAG_DO_NOT_SERIALIZE, "Enable wireframe rendering.");
+		CVAR_INT(s_floatThreadCount, "r_floatThreadCount", CVFLAG_NONE, "Number of threads used to draw the view with the Classic_Float sub-renderer (1 - 16).");
 
 		// Remove temporarily until they do something useful again.
 		CCMD("rsetSubRenderer", console_setSubRenderer, 1, "Set the sub-renderer - valid values are: Classic_Fixed, Classic_Float, Classic_GPU.");
 		CCMD("rgetSubRenderer", console_getSubRenderer, 0, "Get the current sub-renderer.");
+		CCMD("rsetTexelKernels", console_setTexelKernels, 1, "Set the column and scanline kernels used by the software sub-renderers - valid values are: scalar, sse2, avx2, neon, auto.");
+		CCMD("rgetTexelKernels", console_getTexelKernels, 0, "Get the column and scanline kernels used by the software sub-renderers.");
+		CCMD("rtestTexelKernels", console_testTexelKernels, 0, "Verify that each supported kernel set matches the scalar loops and time it, default N = 10000 cases - rtestTexelKernels [N]");
+		CCMD("rtestFloatBands", console_testFloatBands, 0, "Draw the next Classic_Float frame with 1 and N column band threads and compare the output, default N = 4 - rtestFloatBands [N]");
 
 		// Setup performance counters.
 		TFE_COUNTER(s_maxAdjoinDepth, "Maximum Adjoin Depth");
@@ -131,6 +147,7 @@ namespace TFE_Jedi
 
 		s_sectorRenderer = renderer_getSectorRenderer(TSR_CLASSIC_FIXED);
 		renderer_setLimits();
+		texelKernels_init();
 	}
 
 	void renderer_destroy()
@@ -234,6 +251,57 @@ namespace TFE_Jedi
 		TFE_Console::addToHistory(c_subRenderers[s_subRenderer]);
 	}
 
+	void console_setTexelKernels(const std::vector<std::string>& args)
+	{
+		if (args.size() < 2) { return; }
+		TexelKernelLevel level = strcasecmp(args[1].c_str(), "auto") == 0 ? texelKernels_getBestLevel() : texelKernels_getLevelFromName(args[1].c_str());
+		if (level == TKL_COUNT)
+		{
+			TFE_Console::addToHistory("Invalid kernels - valid values are: scalar, sse2, avx2, neon, auto.");
+			return;
+		}
+		if (!texelKernels_setLevel(level))
+		{
+			char res[256];
+			sprintf(res, "Kernels '%s' are not supported on this CPU.", texelKernels_getLevelName(level));
+			TFE_Console::addToHistory(res);
+			return;
+		}
+		TFE_Console::addToHistory(texelKernels_getLevelName(level));
+	}
+
+	void console_getTexelKernels(const std::vector<std::string>& args)
+	{
+		TFE_Console::addToHistory(texelKernels_getLevelName(texelKernels_getLevel()));
+	}
+
+	void console_testTexelKernels(const std::vector<std::string>& args)
+	{
+		const s32 caseCount = args.size() >= 2 ? max(1, s32(TFE_Console::getFloatArg(args[1]))) : 10000;
+		char res[256];
+		for (s32 i = 0; i < TKL_COUNT; i++)
+		{
+			const TexelKernelLevel level = TexelKernelLevel(i);
+			if (!texelKernels_isSupported(level)) { continue; }
+
+			const s32 differences = texelKernels_verify(level, caseCount, 0x1234u);
+			const f64 time = texelKernels_benchmark(level, 100);
+			sprintf(res, "  %-6s %s (%d pixels differ), 100 frames of 320x200 walls and flats in %0.3f ms", texelKernels_getLevelName(level),
+				differences == 0 ? "bit-exact" : "MISMATCH", differences, time * 1000.0);
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	void console_testFloatBands(const std::vector<std::string>& args)
+	{
+		if (s_subRenderer != TSR_CLASSIC_FLOAT)
+		{
+			TFE_Console::addToHistory("rtestFloatBands - the Classic_Float sub-renderer must be active.");
+			return;
+		}
+		s_bandTestThreadCount = args.size() >= 2 ? clamp(s32(TFE_Console::getFloatArg(args[1])), 2, MAX_BAND_THREADS) : 4;
+	}
+
 	static s32 s_fov = -1;
 	static bool s_clearCachedTextures = false;
 
@@ -485,6 +553,12 @@ namespace TFE_Jedi
 
 	void drawWorld(u8* display, RSector* sector, const u8* colormap, const u8* lightSourceRamp)
 	{
+		if (s_bandTestThreadCount && s_subRenderer == TSR_CLASSIC_FLOAT)
+		{
+			testFloatBands(display, sector, colormap, lightSourceRamp);
+			return;
+		}
+
 		// Clear the top pixel row.
 		if (s_subRenderer != TSR_CLASSIC_GPU)
 		{
@@ -509,39 +583,48 @@ namespace TFE_Jedi
 		s_display = display;
 		s_colorMap = colormap;
 		s_lightSourceRamp = lightSourceRamp;
-		if (s_subRenderer != TSR_CLASSIC_GPU)
-		{
-			clear1dDepth();
-		}
-
-		s_windowMinX_Pixels = s_minScreenX_Pixels;
-		s_windowMaxX_Pixels = s_maxScreenX_Pixels;
-		s_windowMinY_Pixels = 1;
-		s_windowMaxY_Pixels = s_height - 1;
-		s_windowMaxCeil  = s_minScreenY;
-		s_windowMinFloor = s_maxScreenY;
-		s_flatCount  = 0;
-		s_nextWall   = 0;
-		s_curWallSeg = 0;
+		s_nextWall = 0;
 		s_drawnObjCount = 0;
 
-		s_prevSector = nullptr;
-		s_sectorIndex = 0;
-		s_maxAdjoinIndex = 0;
-		s_adjoinSegCount = 1;
-		s_adjoinIndex = 0;
-
-		s_adjoinDepth = 1;
-		s_maxAdjoinDepth = 1;
-
-		if (s_subRenderer != TSR_CLASSIC_GPU)
+		if (s_subRenderer == TSR_CLASSIC_FLOAT)
+		{
+			// Classic_Float has its own thread_local traversal state, see rclassicFloatSharedState.h
+			RClassic_Float::band_resetTraversal();
+		}
+		else
 		{
-			for (s32 i = 0; i < s_width; i++)
+			if (s_subRenderer != TSR_CLASSIC_GPU)
 			{
-				s_columnTop[i] = s_minScreenY;
-				s_columnBot[i] = s_maxScreenY;
-				s_windowTop_all[i] = s_minScreenY;
-				s_windowBot_all[i] = s_maxScreenY;
+				clear1dDepth();
+			}
+
+			s_windowMinX_Pixels = s_minScreenX_Pixels;
+			s_windowMaxX_Pixels = s_maxScreenX_Pixels;
+			s_windowMinY_Pixels = 1;
+			s_windowMaxY_Pixels = s_height - 1;
+			s_windowMaxCeil  = s_minScreenY;
+			s_windowMinFloor = s_maxScreenY;
+			s_flatCount  = 0;
+			s_curWallSeg = 0;
+
+			s_prevSector = nullptr;
+			s_sectorIndex = 0;
+			s_maxAdjoinIndex = 0;
+			s_adjoinSegCount = 1;
+			s_adjoinIndex = 0;
+
+			s_adjoinDepth = 1;
+			s_maxAdjoinDepth = 1;
+
+			if (s_subRenderer != TSR_CLASSIC_GPU)
+			{
+				for (s32 i = 0; i < s_width; i++)
+				{
+					s_columnTop[i] = s_minScreenY;
+					s_columnBot[i] = s_maxScreenY;
+					s_windowTop_all[i] = s_minScreenY;
+					s_windowBot_all[i] = s_maxScreenY;
+				}
 			}
 		}
 				
@@ -549,7 +632,16 @@ namespace TFE_Jedi
 		{
 			TFE_ZONE("Sector Draw");
 			s_sectorRenderer->prepare();
-			s_sectorRenderer->draw(sector);
+			if (s_subRenderer == TSR_CLASSIC_FLOAT)
+			{
+				RClassic_Float::band_setThreadCount(s_floatThreadCount);
+				RClassic_Float::band_drawSectors((TFE_Sectors_Float*)s_sectorRenderer, sector);
+				copyFloatTraversalCounters();
+			}
+			else
+			{
+				s_sectorRenderer->draw(sector);
+			}
 		}
 	}
 
@@ -563,10 +655,51 @@ namespace TFE_Jedi
 			memset(s_rcfState.depth1d_all, 0, s_width * sizeof(s32));
 			s_rcfState.windowMinZ = 0;
 		}
-		else if (s_subRenderer == TSR_CLASSIC_FLOAT)
+	}
+
+	// Draw the view single threaded and then with the requested column band thread count and compare the results,
+	// which must be pixel identical. The threaded frame is left in the display.
+	void testFloatBands(u8* display, RSector* sector, const u8* colormap, const u8* lightSourceRamp)
+	{
+		const s32 threadCount = s_bandTestThreadCount;
+		const s32 prevThreadCount = s_floatThreadCount;
+		s_bandTestThreadCount = 0;
+
+		const size_t size = size_t(s_width) * size_t(s_height);
+		std::vector<u8> reference(size);
+
+		s_floatThreadCount = 1;
+		memset(display, 0, size);
+		drawWorld(display, sector, colormap, lightSourceRamp);
+		memcpy(reference.data(), display, size);
+
+		s_floatThreadCount = threadCount;
+		memset(display, 0, size);
+		drawWorld(display, sector, colormap, lightSourceRamp);
+		const s32 usedThreadCount = RClassic_Float::band_getThreadCount();
+		s_floatThreadCount = prevThreadCount;
+
+		s32 differences = 0;
+		for (size_t i = 0; i < size; i++)
 		{
-			memset(s_rcfltState.depth1d_all, 0, s_width * sizeof(f32));
-			s_rcfltState.windowMinZ = 0.0f;
+			if (reference[i] != display[i]) { differences++; }
 		}
+
+		char res[256];
+		sprintf(res, "rtestFloatBands - %d threads: %s (%d pixels differ)", usedThreadCount, differences == 0 ? "pixel identical" : "MISMATCH", differences);
+		TFE_Console::addToHistory(res);
+	}
+
+	// The performance counters and d_sectorAmbient point at the shared traversal globals,
+	// so copy the main thread Classic_Float values after drawing.
+	void copyFloatTraversalCounters()
+	{
+		s_maxAdjoinDepth = RClassic_Float::s_maxAdjoinDepth;
+		s_maxAdjoinIndex = RClassic_Float::s_maxAdjoinIndex;
+		s_sectorIndex    = RClassic_Float::s_sectorIndex;
+		s_flatCount      = RClassic_Float::s_flatCount;
+		s_curWallSeg     = RClassic_Float::s_curWallSeg;
+		s_adjoinSegCount = RClassic_Float::s_adjoinSegCount;
+		s_sectorAmbient  = RClassic_Float::s_sectorAmbient;
 	}
 }
@@ -1,4 +1,5 @@
 #include "rcommon.h"
+#include "rtraversal.h"
 #include "redgePair.h"
 
 struct SecObject;
@@ -2,6 +2,7 @@
 #include "redgePair.h"
 #include <TFE_Jedi/Level/robject.h>
 #include "rcommon.h"
+#include "rtraversal.h"
 
 namespace TFE_Jedi
 {
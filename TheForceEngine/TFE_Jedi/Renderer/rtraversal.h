@@ -0,0 +1,62 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Sector Traversal
+// Window, column and adjoin state used while walking the sectors
+// with the Classic_Fixed and Classic_GPU sub-renderers.
+//
+// Classic_Float declares thread_local copies of the same variables
+// in RClassic_Float (rclassicFloatSharedState.h) so each column band
+// thread can walk the sectors on its own, so the Float sources must
+// not include this header.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+struct RSector;
+
+namespace TFE_Jedi
+{
+	// Window
+	extern s32 s_windowMinX_Pixels;
+	extern s32 s_windowMaxX_Pixels;
+	extern s32 s_windowMinY_Pixels;
+	extern s32 s_windowMaxY_Pixels;
+	extern s32 s_windowMaxCeil;
+	extern s32 s_windowMinFloor;
+
+	// Render
+	extern RSector* s_prevSector;
+	extern s32 s_sectorIndex;
+	extern s32 s_maxAdjoinIndex;
+	extern s32 s_adjoinIndex;
+	extern s32 s_maxAdjoinDepth;
+	extern s32 s_windowX0;
+	extern s32 s_windowX1;
+
+	// Column Heights
+	extern s32* s_columnTop;
+	extern s32* s_columnBot;
+	extern s32* s_windowTop_all;
+	extern s32* s_windowBot_all;
+	extern s32* s_windowTop;
+	extern s32* s_windowBot;
+	extern s32* s_windowTopPrev;
+	extern s32* s_windowBotPrev;
+
+	extern s32* s_objWindowTop;
+	extern s32* s_objWindowBot;
+
+	// WallSegments
+	extern s32 s_curWallSeg;
+	extern s32 s_adjoinSegCount;
+	extern s32 s_adjoinDepth;
+
+	// Flats
+	extern s32 s_flatCount;
+	extern s32 s_wallMaxCeilY;
+	extern s32 s_wallMinFloorY;
+
+	// Lighting
+	extern s32 s_sectorAmbient;
+	extern s32 s_scaledAmbient;
+	extern s32 s_sectorAmbientFraction;
+}
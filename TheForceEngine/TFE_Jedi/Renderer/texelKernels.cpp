@@ -0,0 +1,586 @@
+#include "texelKernels.h"
+#include "rcommon.h"
+#include "RClassic_Fixed/rwallFixed.h"
+#include "RClassic_Fixed/rflatFixed.h"
+#include "RClassic_Float/rwallFloat.h"
+#include "RClassic_Float/rflatFloat.h"
+#include <TFE_System/system.h>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define TEXEL_KERNELS_X86 1
+	#include <emmintrin.h>
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define TARGET_AVX2
+	#else
+		#define TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define TEXEL_KERNELS_NEON 1
+	#include <arm_neon.h>
+#endif
+
+namespace TFE_Jedi
+{
+	const TexelKernels* s_texelKernels = nullptr;
+	static TexelKernelLevel s_texelKernelLevel = TKL_SCALAR;
+
+	static const char* c_texelKernelLevelNames[TKL_COUNT] =
+	{
+		"scalar",	// TKL_SCALAR
+		"sse2",		// TKL_SSE2
+		"avx2",		// TKL_AVX2
+		"neon",		// TKL_NEON
+	};
+
+	//////////////////////////////////////////////////////////////////////
+	// Shared pixel output.
+	//////////////////////////////////////////////////////////////////////
+	template<u32 mode>
+	static inline void writeTexel(u8* out, const u8* image, const u8* light, s32 texel)
+	{
+		const u8 c = image[texel];
+		if (!(mode & TKM_TRANS) || c)
+		{
+			*out = (mode & TKM_LIT) ? light[c] : c;
+		}
+	}
+
+	// idx[k] is the texel for out[N - 1 - k], since scanlines are drawn from right to left.
+	template<u32 mode, s32 N>
+	static inline void writeSpanBlock(u8* out, const s32* idx, const u8* image, const u8* light)
+	{
+		if (mode & TKM_TRANS)
+		{
+			for (s32 k = 0; k < N; k++)
+			{
+				writeTexel<mode>(&out[N - 1 - k], image, light, idx[k]);
+			}
+		}
+		else
+		{
+			u8 pixels[N];
+			for (s32 k = 0; k < N; k++)
+			{
+				const u8 c = image[idx[k]];
+				pixels[N - 1 - k] = (mode & TKM_LIT) ? light[c] : c;
+			}
+			memcpy(out, pixels, N);
+		}
+	}
+
+	// idx[k] is the texel for the row k rows above 'out'.
+	template<u32 mode, s32 N>
+	static inline void writeColumnBlock(u8* out, s32 stride, const s32* idx, const u8* image, const u8* light)
+	{
+		for (s32 k = 0; k < N; k++, out -= stride)
+		{
+			writeTexel<mode>(out, image, light, idx[k]);
+		}
+	}
+
+	template<u32 mode>
+	static inline void spanTail(const TexelSpan* span, s32 i, u32 u, u32 v)
+	{
+		for (; i >= 0; i--, u += span->dUdX, v += span->dVdX)
+		{
+			const s32 texel = ((((u >> span->fracBits) & 63) << 6) + ((v >> span->fracBits) & 63)) & span->dataEnd;
+			writeTexel<mode>(&span->out[i], span->image, span->light, texel);
+		}
+	}
+
+	template<u32 mode>
+	static inline void columnTail(const TexelColumn* column, s32 i, u32 v)
+	{
+		for (; i >= 0; i--, v += column->dVdY)
+		{
+			const s32 texel = (v >> column->fracBits) & column->heightMask;
+			writeTexel<mode>(&column->out[i * column->stride], column->image, column->light, texel);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// Scalar
+	//////////////////////////////////////////////////////////////////////
+	template<u32 mode>
+	static void span_scalar(const TexelSpan* span)
+	{
+		spanTail<mode>(span, span->width - 1, span->u0, span->v0);
+	}
+
+	template<u32 mode>
+	static void column_scalar(const TexelColumn* column)
+	{
+		columnTail<mode>(column, column->count - 1, column->v0);
+	}
+
+	static const TexelKernels c_kernelsScalar =
+	{
+		TKL_SCALAR,
+		{ span_scalar<0>, span_scalar<1>, span_scalar<2>, span_scalar<3> },
+		{ column_scalar<0>, column_scalar<1>, column_scalar<2>, column_scalar<3> },
+	};
+
+#ifdef TEXEL_KERNELS_X86
+	//////////////////////////////////////////////////////////////////////
+	// SSE2, 4 pixels per iteration.
+	//////////////////////////////////////////////////////////////////////
+	template<u32 mode>
+	static void span_sse2(const TexelSpan* span)
+	{
+		const u32 dU = span->dUdX, dV = span->dVdX;
+		__m128i u = _mm_setr_epi32(s32(span->u0), s32(span->u0 + dU), s32(span->u0 + 2*dU), s32(span->u0 + 3*dU));
+		__m128i v = _mm_setr_epi32(s32(span->v0), s32(span->v0 + dV), s32(span->v0 + 2*dV), s32(span->v0 + 3*dV));
+		const __m128i stepU   = _mm_set1_epi32(s32(4 * dU));
+		const __m128i stepV   = _mm_set1_epi32(s32(4 * dV));
+		const __m128i frac    = _mm_cvtsi32_si128(span->fracBits);
+		const __m128i mask63  = _mm_set1_epi32(63);
+		const __m128i dataEnd = _mm_set1_epi32(span->dataEnd);
+
+		alignas(16) s32 idx[4];
+		s32 i = span->width - 1;
+		for (; i >= 3; i -= 4)
+		{
+			const __m128i tu = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(u, frac), mask63), 6);
+			const __m128i tv = _mm_and_si128(_mm_srl_epi32(v, frac), mask63);
+			_mm_store_si128((__m128i*)idx, _mm_and_si128(_mm_add_epi32(tu, tv), dataEnd));
+			writeSpanBlock<mode, 4>(&span->out[i - 3], idx, span->image, span->light);
+
+			u = _mm_add_epi32(u, stepU);
+			v = _mm_add_epi32(v, stepV);
+		}
+		spanTail<mode>(span, i, u32(_mm_cvtsi128_si32(u)), u32(_mm_cvtsi128_si32(v)));
+	}
+
+	template<u32 mode>
+	static void column_sse2(const TexelColumn* column)
+	{
+		const u32 dV = column->dVdY;
+		__m128i v = _mm_setr_epi32(s32(column->v0), s32(column->v0 + dV), s32(column->v0 + 2*dV), s32(column->v0 + 3*dV));
+		const __m128i stepV = _mm_set1_epi32(s32(4 * dV));
+		const __m128i frac  = _mm_cvtsi32_si128(column->fracBits);
+		const __m128i mask  = _mm_set1_epi32(column->heightMask);
+
+		alignas(16) s32 idx[4];
+		s32 i = column->count - 1;
+		for (; i >= 3; i -= 4)
+		{
+			_mm_store_si128((__m128i*)idx, _mm_and_si128(_mm_srl_epi32(v, frac), mask));
+			writeColumnBlock<mode, 4>(&column->out[i * column->stride], column->stride, idx, column->image, column->light);
+			v = _mm_add_epi32(v, stepV);
+		}
+		columnTail<mode>(column, i, u32(_mm_cvtsi128_si32(v)));
+	}
+
+	static const TexelKernels c_kernelsSse2 =
+	{
+		TKL_SSE2,
+		{ span_sse2<0>, span_sse2<1>, span_sse2<2>, span_sse2<3> },
+		{ column_sse2<0>, column_sse2<1>, column_sse2<2>, column_sse2<3> },
+	};
+
+	//////////////////////////////////////////////////////////////////////
+	// AVX2, 8 pixels per iteration.
+	//////////////////////////////////////////////////////////////////////
+	template<u32 mode>
+	TARGET_AVX2 static void span_avx2(const TexelSpan* span)
+	{
+		const u32 dU = span->dUdX, dV = span->dVdX;
+		const __m256i lane    = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		__m256i u = _mm256_add_epi32(_mm256_set1_epi32(s32(span->u0)), _mm256_mullo_epi32(lane, _mm256_set1_epi32(s32(dU))));
+		__m256i v = _mm256_add_epi32(_mm256_set1_epi32(s32(span->v0)), _mm256_mullo_epi32(lane, _mm256_set1_epi32(s32(dV))));
+		const __m256i stepU   = _mm256_set1_epi32(s32(8 * dU));
+		const __m256i stepV   = _mm256_set1_epi32(s32(8 * dV));
+		const __m128i frac    = _mm_cvtsi32_si128(span->fracBits);
+		const __m256i mask63  = _mm256_set1_epi32(63);
+		const __m256i dataEnd = _mm256_set1_epi32(span->dataEnd);
+
+		alignas(32) s32 idx[8];
+		s32 i = span->width - 1;
+		for (; i >= 7; i -= 8)
+		{
+			const __m256i tu = _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(u, frac), mask63), 6);
+			const __m256i tv = _mm256_and_si256(_mm256_srl_epi32(v, frac), mask63);
+			_mm256_store_si256((__m256i*)idx, _mm256_and_si256(_mm256_add_epi32(tu, tv), dataEnd));
+			writeSpanBlock<mode, 8>(&span->out[i - 7], idx, span->image, span->light);
+
+			u = _mm256_add_epi32(u, stepU);
+			v = _mm256_add_epi32(v, stepV);
+		}
+		spanTail<mode>(span, i, u32(_mm256_extract_epi32(u, 0)), u32(_mm256_extract_epi32(v, 0)));
+	}
+
+	template<u32 mode>
+	TARGET_AVX2 static void column_avx2(const TexelColumn* column)
+	{
+		const u32 dV = column->dVdY;
+		const __m256i lane  = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		__m256i v = _mm256_add_epi32(_mm256_set1_epi32(s32(column->v0)), _mm256_mullo_epi32(lane, _mm256_set1_epi32(s32(dV))));
+		const __m256i stepV = _mm256_set1_epi32(s32(8 * dV));
+		const __m128i frac  = _mm_cvtsi32_si128(column->fracBits);
+		const __m256i mask  = _mm256_set1_epi32(column->heightMask);
+
+		alignas(32) s32 idx[8];
+		s32 i = column->count - 1;
+		for (; i >= 7; i -= 8)
+		{
+			_mm256_store_si256((__m256i*)idx, _mm256_and_si256(_mm256_srl_epi32(v, frac), mask));
+			writeColumnBlock<mode, 8>(&column->out[i * column->stride], column->stride, idx, column->image, column->light);
+			v = _mm256_add_epi32(v, stepV);
+		}
+		columnTail<mode>(column, i, u32(_mm256_extract_epi32(v, 0)));
+	}
+
+	static const TexelKernels c_kernelsAvx2 =
+	{
+		TKL_AVX2,
+		{ span_avx2<0>, span_avx2<1>, span_avx2<2>, span_avx2<3> },
+		{ column_avx2<0>, column_avx2<1>, column_avx2<2>, column_avx2<3> },
+	};
+
+	static bool cpuHasSse2()
+	{
+	#if defined(_M_X64) || defined(__x86_64__)
+		return true;
+	#elif defined(_MSC_VER)
+		s32 info[4];
+		__cpuid(info, 1);
+		return (info[3] & FLAG_BIT(26)) != 0;
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("sse2") != 0;
+	#endif
+	}
+
+	static bool cpuHasAvx2()
+	{
+	#ifdef _MSC_VER
+		s32 info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) { return false; }
+
+		// The OS must also save the YMM registers.
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & FLAG_BIT(27)) != 0;
+		const bool avx = (info[2] & FLAG_BIT(28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) { return false; }
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & FLAG_BIT(5)) != 0;
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+	#endif
+	}
+#endif  // TEXEL_KERNELS_X86
+
+#ifdef TEXEL_KERNELS_NEON
+	//////////////////////////////////////////////////////////////////////
+	// NEON, 4 pixels per iteration.
+	//////////////////////////////////////////////////////////////////////
+	template<u32 mode>
+	static void span_neon(const TexelSpan* span)
+	{
+		const u32 dU = span->dUdX, dV = span->dVdX;
+		const u32 u0[4] = { span->u0, span->u0 + dU, span->u0 + 2*dU, span->u0 + 3*dU };
+		const u32 v0[4] = { span->v0, span->v0 + dV, span->v0 + 2*dV, span->v0 + 3*dV };
+		uint32x4_t u = vld1q_u32(u0);
+		uint32x4_t v = vld1q_u32(v0);
+		const uint32x4_t stepU   = vdupq_n_u32(4 * dU);
+		const uint32x4_t stepV   = vdupq_n_u32(4 * dV);
+		const int32x4_t  frac    = vdupq_n_s32(-span->fracBits);
+		const uint32x4_t mask63  = vdupq_n_u32(63);
+		const uint32x4_t dataEnd = vdupq_n_u32(u32(span->dataEnd));
+
+		s32 idx[4];
+		s32 i = span->width - 1;
+		for (; i >= 3; i -= 4)
+		{
+			const uint32x4_t tu = vshlq_n_u32(vandq_u32(vshlq_u32(u, frac), mask63), 6);
+			const uint32x4_t tv = vandq_u32(vshlq_u32(v, frac), mask63);
+			vst1q_u32((u32*)idx, vandq_u32(vaddq_u32(tu, tv), dataEnd));
+			writeSpanBlock<mode, 4>(&span->out[i - 3], idx, span->image, span->light);
+
+			u = vaddq_u32(u, stepU);
+			v = vaddq_u32(v, stepV);
+		}
+		spanTail<mode>(span, i, vgetq_lane_u32(u, 0), vgetq_lane_u32(v, 0));
+	}
+
+	template<u32 mode>
+	static void column_neon(const TexelColumn* column)
+	{
+		const u32 dV = column->dVdY;
+		const u32 v0[4] = { column->v0, column->v0 + dV, column->v0 + 2*dV, column->v0 + 3*dV };
+		uint32x4_t v = vld1q_u32(v0);
+		const uint32x4_t stepV = vdupq_n_u32(4 * dV);
+		const int32x4_t  frac  = vdupq_n_s32(-column->fracBits);
+		const uint32x4_t mask  = vdupq_n_u32(u32(column->heightMask));
+
+		s32 idx[4];
+		s32 i = column->count - 1;
+		for (; i >= 3; i -= 4)
+		{
+			vst1q_u32((u32*)idx, vandq_u32(vshlq_u32(v, frac), mask));
+			writeColumnBlock<mode, 4>(&column->out[i * column->stride], column->stride, idx, column->image, column->light);
+			v = vaddq_u32(v, stepV);
+		}
+		columnTail<mode>(column, i, vgetq_lane_u32(v, 0));
+	}
+
+	static const TexelKernels c_kernelsNeon =
+	{
+		TKL_NEON,
+		{ span_neon<0>, span_neon<1>, span_neon<2>, span_neon<3> },
+		{ column_neon<0>, column_neon<1>, column_neon<2>, column_neon<3> },
+	};
+#endif  // TEXEL_KERNELS_NEON
+
+	static const TexelKernels* getKernels(TexelKernelLevel level)
+	{
+		switch (level)
+		{
+			case TKL_SCALAR:
+				return &c_kernelsScalar;
+		#ifdef TEXEL_KERNELS_X86
+			case TKL_SSE2:
+				return cpuHasSse2() ? &c_kernelsSse2 : nullptr;
+			case TKL_AVX2:
+				return cpuHasAvx2() ? &c_kernelsAvx2 : nullptr;
+		#endif
+		#ifdef TEXEL_KERNELS_NEON
+			case TKL_NEON:
+				return &c_kernelsNeon;
+		#endif
+			default:
+				break;
+		}
+		return nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// API
+	//////////////////////////////////////////////////////////////////////
+	void texelKernels_init()
+	{
+		const TexelKernelLevel level = texelKernels_getBestLevel();
+		texelKernels_setLevel(level);
+		TFE_System::logWrite(LOG_MSG, "Renderer", "Texel kernels: %s", texelKernels_getLevelName(level));
+	}
+
+	bool texelKernels_isSupported(TexelKernelLevel level)
+	{
+		return getKernels(level) != nullptr;
+	}
+
+	bool texelKernels_setLevel(TexelKernelLevel level)
+	{
+		const TexelKernels* kernels = getKernels(level);
+		if (!kernels) { return false; }
+
+		s_texelKernelLevel = level;
+		// The scalar level uses the original loops in the renderers.
+		s_texelKernels = (level == TKL_SCALAR) ? nullptr : kernels;
+		return true;
+	}
+
+	TexelKernelLevel texelKernels_getLevel()
+	{
+		return s_texelKernelLevel;
+	}
+
+	TexelKernelLevel texelKernels_getBestLevel()
+	{
+		// The NEON kernels have not been verified on ARM hardware yet, so they are only used when selected with rsetTexelKernels.
+		const TexelKernelLevel order[] = { TKL_AVX2, TKL_SSE2 };
+		for (s32 i = 0; i < s32(TFE_ARRAYSIZE(order)); i++)
+		{
+			if (texelKernels_isSupported(order[i])) { return order[i]; }
+		}
+		return TKL_SCALAR;
+	}
+
+	const char* texelKernels_getLevelName(TexelKernelLevel level)
+	{
+		return (level >= TKL_SCALAR && level < TKL_COUNT) ? c_texelKernelLevelNames[level] : "invalid";
+	}
+
+	TexelKernelLevel texelKernels_getLevelFromName(const char* name)
+	{
+		for (s32 i = 0; i < TKL_COUNT; i++)
+		{
+			if (strcasecmp(name, c_texelKernelLevelNames[i]) == 0) { return TexelKernelLevel(i); }
+		}
+		return TKL_COUNT;
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// Verification and benchmark.
+	// The verification draws through the column and scanline functions of
+	// both sub-renderers, once with their scalar loops and once with the
+	// kernels: Classic_Float steps 44.20 coordinates, Classic_Fixed 16.16.
+	//////////////////////////////////////////////////////////////////////
+	static u32 s_testSeed;
+
+	static u32 testRandom()
+	{
+		s_testSeed = s_testSeed * 1664525u + 1013904223u;
+		return s_testSeed >> 8;
+	}
+
+	static s64 testRandom64(s32 bits)
+	{
+		const u64 value = (u64(testRandom()) << 24) ^ u64(testRandom());
+		return s64(value & ((1ull << bits) - 1)) - (s64(1) << (bits - 1));
+	}
+
+	static s32 countDifferences(const u8* a, const u8* b, size_t size)
+	{
+		s32 count = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			count += (a[i] != b[i]) ? 1 : 0;
+		}
+		return count;
+	}
+
+	s32 texelKernels_verify(TexelKernelLevel level, s32 caseCount, u32 seed)
+	{
+		const TexelKernels* kernels = getKernels(level);
+		if (!kernels) { return -1; }
+		s_testSeed = seed;
+
+		// The renderer state is restored afterward, the columns use s_width as the stride.
+		const TexelKernels* prevKernels = s_texelKernels;
+		const s32 prevWidth = s_width;
+
+		std::vector<u8> image, expected, result;
+		u8 light[256];
+		s32 differences = 0;
+		for (s32 t = 0; t < caseCount; t++)
+		{
+			const u32 mode = testRandom() % TKM_COUNT;
+			// Classic_Float (44.20) on even cases, Classic_Fixed (16.16) on odd.
+			const bool float20 = (t & 1) == 0;
+
+			// Textures are not always 64x64 and transparent textures have plenty of 0 texels.
+			const s32 width  = 1 << (testRandom() % 8);
+			const s32 height = 1 << (testRandom() % (float20 ? 13 : 15));
+			image.resize(size_t(width) * size_t(height));
+			for (size_t i = 0; i < image.size(); i++)
+			{
+				image[i] = (testRandom() & 3) ? u8(testRandom()) : 0;
+			}
+			for (s32 i = 0; i < 256; i++) { light[i] = u8(testRandom()); }
+
+			// Scanline
+			{
+				const s32 spanWidth = testRandom() % 1024;
+				const s32 dataEnd = s32(image.size()) - 1;
+				expected.resize(spanWidth + 1);
+				for (size_t i = 0; i < expected.size(); i++) { expected[i] = u8(testRandom()); }
+				result = expected;
+
+				if (float20)
+				{
+					const s64 u = testRandom64(44), v = testRandom64(44);
+					const s64 dUdX = testRandom64(24), dVdX = testRandom64(24);
+					s_texelKernels = nullptr;
+					RClassic_Float::flat_drawTestScanline(mode, u, v, dUdX, dVdX, spanWidth, image.data(), dataEnd, light, expected.data());
+					s_texelKernels = kernels;
+					RClassic_Float::flat_drawTestScanline(mode, u, v, dUdX, dVdX, spanWidth, image.data(), dataEnd, light, result.data());
+				}
+				else
+				{
+					const fixed16_16 u = fixed16_16(testRandom() << 8), v = fixed16_16(testRandom() << 8);
+					const fixed16_16 dUdX = fixed16_16(testRandom64(21)), dVdX = fixed16_16(testRandom64(21));
+					s_texelKernels = nullptr;
+					RClassic_Fixed::flat_drawTestScanline(mode, u, v, dUdX, dVdX, spanWidth, image.data(), dataEnd, light, expected.data());
+					s_texelKernels = kernels;
+					RClassic_Fixed::flat_drawTestScanline(mode, u, v, dUdX, dVdX, spanWidth, image.data(), dataEnd, light, result.data());
+				}
+				differences += countDifferences(expected.data(), result.data(), expected.size());
+			}
+
+			// Column
+			{
+				const s32 count = testRandom() % 1024;
+				s_width = 1 + testRandom() % 64;
+				expected.resize(size_t(count) * size_t(s_width) + 1);
+				for (size_t i = 0; i < expected.size(); i++) { expected[i] = u8(testRandom()); }
+				result = expected;
+
+				if (float20)
+				{
+					const s64 v = testRandom64(44), dVdY = testRandom64(26);
+					s_texelKernels = nullptr;
+					RClassic_Float::wall_drawTestColumn(mode, v, dVdY, height - 1, count, image.data(), light, expected.data());
+					s_texelKernels = kernels;
+					RClassic_Float::wall_drawTestColumn(mode, v, dVdY, height - 1, count, image.data(), light, result.data());
+				}
+				else
+				{
+					const fixed16_16 v = fixed16_16(testRandom() << 8), dVdY = fixed16_16(testRandom64(22));
+					s_texelKernels = nullptr;
+					RClassic_Fixed::wall_drawTestColumn(mode, v, dVdY, height - 1, count, image.data(), light, expected.data());
+					s_texelKernels = kernels;
+					RClassic_Fixed::wall_drawTestColumn(mode, v, dVdY, height - 1, count, image.data(), light, result.data());
+				}
+				differences += countDifferences(expected.data(), result.data(), expected.size());
+			}
+		}
+
+		s_texelKernels = prevKernels;
+		s_width = prevWidth;
+		return differences;
+	}
+
+	f64 texelKernels_benchmark(TexelKernelLevel level, s32 iterations)
+	{
+		const TexelKernels* kernels = getKernels(level);
+		if (!kernels) { return 0.0; }
+
+		// A 320x200 view of 64x64 textures: every row as a lit scanline and every column as a lit wall column.
+		const s32 viewWidth = 320, viewHeight = 200;
+		std::vector<u8> image(64 * 64), view(viewWidth * viewHeight);
+		u8 light[256];
+		s_testSeed = 1;
+		for (size_t i = 0; i < image.size(); i++) { image[i] = u8(testRandom()); }
+		for (s32 i = 0; i < 256; i++) { light[i] = u8(testRandom()); }
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (s32 it = 0; it < iterations; it++)
+		{
+			for (s32 y = 0; y < viewHeight; y++)
+			{
+				TexelSpan span = {};
+				span.u0 = u32(it) << 20; span.v0 = u32(y) << 18;
+				span.dUdX = 0x3000 + y * 0x100; span.dVdX = 0x1000;
+				span.fracBits = 16;
+				span.dataEnd = 64 * 64 - 1;
+				span.width = viewWidth;
+				span.image = image.data();
+				span.light = light;
+				span.out = &view[y * viewWidth];
+				kernels->span[TKM_LIT](&span);
+			}
+			for (s32 x = 0; x < viewWidth; x++)
+			{
+				TexelColumn column = {};
+				column.v0 = u32(x) << 16; column.dVdY = 0x8000 + x * 0x40;
+				column.fracBits = 16;
+				column.heightMask = 63;
+				column.count = viewHeight;
+				column.stride = viewWidth;
+				column.image = &image[(x & 63) * 64];
+				column.light = light;
+				column.out = &view[x];
+				kernels->column[TKM_LIT](&column);
+			}
+		}
+		return TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Texel Kernels
+// SIMD versions of the column and scanline inner loops shared by the
+// Classic_Fixed and Classic_Float sub-renderers.
+//
+// The kernels step several texture coordinates per iteration and
+// produce the same pixels as the scalar loops in rwall*/rflat*.
+// Only the low 32 bits of the fixed point coordinates are used, which
+// is exact as long as the masked texel bits fit in 32 bits, see
+// texelKernels_columnFits().
+// Texel and colormap lookups are unrolled rather than gathered since
+// gathers read 4 bytes per lookup and would read past the end of the
+// images and colormaps.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+
+namespace TFE_Jedi
+{
+	enum TexelKernelLevel
+	{
+		TKL_SCALAR = 0,
+		TKL_SSE2,
+		TKL_AVX2,
+		TKL_NEON,
+		TKL_COUNT
+	};
+
+	enum TexelKernelMode
+	{
+		TKM_FULLBRIGHT = 0,
+		TKM_LIT        = FLAG_BIT(0),
+		TKM_TRANS      = FLAG_BIT(1),
+		TKM_COUNT      = 4
+	};
+
+	// Scanline: out[width - 1] uses (u0, v0) and each pixel to the left is one step further.
+	// texel = ((((u >> fracBits) & 63) << 6) + ((v >> fracBits) & 63)) & dataEnd
+	struct TexelSpan
+	{
+		u32 u0, v0;
+		u32 dUdX, dVdX;
+		s32 fracBits;
+		s32 dataEnd;
+		s32 width;
+		const u8* image;
+		const u8* light;
+		u8* out;
+	};
+
+	// Column: row 'count - 1' (out[(count - 1) * stride]) uses v0 and each row above is one step further.
+	// texel = (v >> fracBits) & heightMask
+	struct TexelColumn
+	{
+		u32 v0, dVdY;
+		s32 fracBits;
+		s32 heightMask;
+		s32 count;
+		s32 stride;
+		const u8* image;
+		const u8* light;
+		u8* out;
+	};
+
+	typedef void(*TexelSpanKernel)(const TexelSpan* span);
+	typedef void(*TexelColumnKernel)(const TexelColumn* column);
+
+	struct TexelKernels
+	{
+		TexelKernelLevel level;
+		TexelSpanKernel   span[TKM_COUNT];
+		TexelColumnKernel column[TKM_COUNT];
+	};
+
+	// The kernels in use, or null if the renderers should use their own scalar loops.
+	extern const TexelKernels* s_texelKernels;
+
+	// Select the best level supported by the CPU, NEON is not selected by default.
+	void texelKernels_init();
+	bool texelKernels_isSupported(TexelKernelLevel level);
+	bool texelKernels_setLevel(TexelKernelLevel level);
+	TexelKernelLevel texelKernels_getLevel();
+	TexelKernelLevel texelKernels_getBestLevel();
+	const char* texelKernels_getLevelName(TexelKernelLevel level);
+	// Returns TKL_COUNT if the name is not valid.
+	TexelKernelLevel texelKernels_getLevelFromName(const char* name);
+
+	// The texel bits selected by 'mask' after shifting by 'fracBits' must be within the low 32 bits of the coordinate.
+	inline bool texelKernels_columnFits(s32 fracBits, s32 mask)
+	{
+		return (u32(mask) >> (32 - fracBits)) == 0;
+	}
+
+	// Draw random columns and scanlines with the kernels of 'level' and with the scalar loops of both
+	// sub-renderers, returns the number of pixels that differ.
+	s32 texelKernels_verify(TexelKernelLevel level, s32 caseCount, u32 seed);
+	// Draw a fixed set of columns and scanlines 'iterations' times, returns the time in seconds.
+	f64 texelKernels_benchmark(TexelKernelLevel level, s32 iterations);
+}
@@ -3,6 +3,10 @@
 #include "virtualFramebuffer.h"
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Settings/settings.h>
+#include <TFE_Asset/videoWriter.h>
+#include <TFE_System/system.h>
+#include <algorithm>
+#include <cmath>
 
 namespace TFE_Jedi
 {
@@ -28,7 +32,15 @@ namespace TFE_Jedi
 	static FramebufferMode s_mode = VFB_TEXTURE;
 	static FramebufferMode s_nextMode = VFB_TEXTURE;
 
+	static bool s_recording = false;
+	static f64  s_recordStartTime = 0.0;
+	static f64  s_recordFramerate = 0.0;
+	static s64  s_recordFrame = -1;
+	static u32  s_recordWidth = 0;
+	static u32  s_recordHeight = 0;
+
 	void vfb_createVirtualDisplay(u32 width, u32 height);
+	void vfb_recordFrame();
 		
 	////////////////////////////////////////////////////////////////////////
 	// Setup
@@ -193,6 +205,10 @@ namespace TFE_Jedi
 	void vfb_swap()
 	{
 		TFE_RenderBackend::updateVirtualDisplay(s_curFrameBuffer, s_width * s_height);
+		if (s_recording)
+		{
+			vfb_recordFrame();
+		}
 	}
 
 	////////////////////////////
@@ -235,6 +251,68 @@ namespace TFE_Jedi
 		return s_width;
 	}
 
+	////////////////////////////
+	// Recording
+	////////////////////////////
+	JBool vfb_startRecording(const char* path, s32 format, f32 framerate)
+	{
+		if (s_recording || s_mode != VFB_TEXTURE || !s_curFrameBuffer) { return JFALSE; }
+		// Below 1 fps every frame would map to frame 0.
+		u32 frameRate = 1;
+		if (framerate >= 1.0f)
+		{
+			frameRate = u32(framerate);
+		}
+		else
+		{
+			TFE_System::logWrite(LOG_WARNING, "VirtualFramebuffer", "Invalid recording framerate %f, using 1 fps.", framerate);
+		}
+		if (!TFE_VideoWriter::begin(path, VideoFormat(format), s_width, s_height, frameRate))
+		{
+			return JFALSE;
+		}
+		s_recording = true;
+		s_recordStartTime = TFE_System::getTime();
+		s_recordFramerate = f64(frameRate);
+		s_recordFrame = -1;
+		s_recordWidth = s_width;
+		s_recordHeight = s_height;
+		return JTRUE;
+	}
+
+	void vfb_stopRecording()
+	{
+		if (!s_recording) { return; }
+		s_recording = false;
+
+		const s64 frame = s64(floor((TFE_System::getTime() - s_recordStartTime) * s_recordFramerate));
+		TFE_VideoWriter::end(u64(std::max(frame, s_recordFrame + 1)));
+	}
+
+	JBool vfb_isRecording()
+	{
+		return s_recording ? JTRUE : JFALSE;
+	}
+
+	// Add the first frame presented in each recording frame, later frames in the same interval are skipped.
+	void vfb_recordFrame()
+	{
+		if (s_mode != VFB_TEXTURE) { return; }
+		if (s_width != s_recordWidth || s_height != s_recordHeight)
+		{
+			TFE_System::logWrite(LOG_WARNING, "VirtualFramebuffer", "The resolution changed, recording stopped.");
+			vfb_stopRecording();
+			return;
+		}
+
+		const s64 frame = s64(floor((TFE_System::getTime() - s_recordStartTime) * s_recordFramerate));
+		if (frame > s_recordFrame)
+		{
+			TFE_VideoWriter::addFrame(s_curFrameBuffer, s_width, s_palette, u64(frame));
+			s_recordFrame = frame;
+		}
+	}
+
 	////////////////////////////
 	// Internal
 	////////////////////////////
@@ -77,4 +77,13 @@ namespace TFE_Jedi
 	void vfb_getResolution(u32* width, u32* height);
 	// Returns the stride for rendering stride
 	u32 vfb_getStride();
+
+	////////////////////////////
+	// Recording
+	////////////////////////////
+	// Record the frames presented by vfb_swap() directly from the 8-bit framebuffer, 'format' is a VideoFormat.
+	// Returns JFALSE if the frames are not rendered on the CPU (i.e. the GPU renderer is in use).
+	JBool vfb_startRecording(const char* path, s32 format, f32 framerate);
+	void vfb_stopRecording();
+	JBool vfb_isRecording();
 }  // namespace TFE_Jedi
\ No newline at end of file
@@ -2,7 +2,10 @@
 
 #include "serialization.h"
 #include <TFE_Jedi/Level/levelData.h>
+#include <TFE_Asset/modelAsset_jedi.h>
+#include <TFE_Asset/spriteAsset_Jedi.h>
 #include <TFE_System/system.h>
+#include <unordered_map>
 
 using namespace TFE_DarkForces;
 using namespace TFE_Memory;
@@ -14,8 +17,67 @@ namespace TFE_Jedi
 	#define ID_GET_INDEX(id) ((id) & 0xffffff)
 	#define ID_GET_POOL(id) AssetPool((id) >> 24)
 
+	// Maps asset pointers to asset IDs while writing, see serialization_buildPointerMaps().
+	typedef std::unordered_map<const void*, s32> PointerIdMap;
+
 	u32 s_sVersion = 0;
 	SerializationMode s_sMode = SMODE_UNKNOWN;
+
+	static bool s_pointerMapsBuilt = false;
+	static PointerIdMap s_textureIds;
+	static PointerIdMap s_modelIds;
+	static PointerIdMap s_waxIds;
+	static PointerIdMap s_frameIds;
+
+	template <typename T>
+	void serialization_addPointers(PointerIdMap& map, const T* const* list, s32 count, AssetPool pool)
+	{
+		for (s32 i = 0; i < count; i++)
+		{
+			// Keep the first ID if an asset is listed more than once, matching the linear lookups.
+			map.insert({ list[i], GEN_ID(i, pool) });
+		}
+	}
+
+	// Returns the ID of 'ptr' or -1 if it is not in the map.
+	s32 serialization_findPointerId(const PointerIdMap& map, const void* ptr)
+	{
+		PointerIdMap::const_iterator iId = map.find(ptr);
+		return iId != map.end() ? iId->second : -1;
+	}
+
+	void serialization_buildPointerMaps()
+	{
+		serialization_clearPointerMaps();
+		for (s32 p = 0; p < POOL_COUNT; p++)
+		{
+			const AssetPool pool = AssetPool(p);
+
+			s32 textureCount = 0;
+			TextureData** textures = bitmap_getTextures(&textureCount, pool);
+			serialization_addPointers(s_textureIds, textures, textureCount, pool);
+
+			const std::vector<JediModel*>& models = TFE_Model_Jedi::getModelList(pool);
+			serialization_addPointers(s_modelIds, models.data(), s32(models.size()), pool);
+
+			const std::vector<JediWax*>& waxList = TFE_Sprite_Jedi::getWaxList(pool);
+			serialization_addPointers(s_waxIds, waxList.data(), s32(waxList.size()), pool);
+
+			const std::vector<JediFrame*>& frameList = TFE_Sprite_Jedi::getFrameList(pool);
+			serialization_addPointers(s_frameIds, frameList.data(), s32(frameList.size()), pool);
+		}
+		s_pointerMapsBuilt = true;
+	}
+
+	void serialization_clearPointerMaps()
+	{
+		// Swap with empty maps so the memory is released between saves.
+		PointerIdMap().swap(s_textureIds);
+		PointerIdMap().swap(s_modelIds);
+		PointerIdMap().swap(s_waxIds);
+		PointerIdMap().swap(s_frameIds);
+		s_pointerMapsBuilt = false;
+	}
 		
 	void serialization_serializeDfSound(Stream* stream, u32 version, SoundSourceId* id)
 	{
@@ -83,7 +145,11 @@ namespace TFE_Jedi
 		{
 			s32 index;
 			AssetPool pool;
-			if (bitmap_getTextureIndex(texture, &index, &pool))
+			if (s_pointerMapsBuilt)
+			{
+				id = serialization_findPointerId(s_textureIds, texture);
+			}
+			else if (bitmap_getTextureIndex(texture, &index, &pool))
 			{
 				id = GEN_ID(index, pool);
 			}
@@ -102,7 +168,11 @@ namespace TFE_Jedi
 		{
 			s32 index;
 			AssetPool pool;
-			if (TFE_Model_Jedi::getModelIndex(model, &index, &pool))
+			if (s_pointerMapsBuilt)
+			{
+				id = serialization_findPointerId(s_modelIds, model);
+			}
+			else if (TFE_Model_Jedi::getModelIndex(model, &index, &pool))
 			{
 				id = GEN_ID(index, pool);
 			}
@@ -121,7 +191,11 @@ namespace TFE_Jedi
 		{
 			s32 index;
 			AssetPool pool;
-			if (TFE_Sprite_Jedi::getWaxIndex(wax, &index, &pool))
+			if (s_pointerMapsBuilt)
+			{
+				id = serialization_findPointerId(s_waxIds, wax);
+			}
+			else if (TFE_Sprite_Jedi::getWaxIndex(wax, &index, &pool))
 			{
 				id = GEN_ID(index, pool);
 			}
@@ -140,7 +214,11 @@ namespace TFE_Jedi
 		{
 			s32 index;
 			AssetPool pool;
-			if (TFE_Sprite_Jedi::getFrameIndex(frame, &index, &pool))
+			if (s_pointerMapsBuilt)
+			{
+				id = serialization_findPointerId(s_frameIds, frame);
+			}
+			else if (TFE_Sprite_Jedi::getFrameIndex(frame, &index, &pool))
 			{
 				id = GEN_ID(index, pool);
 			}
@@ -68,6 +68,12 @@ namespace TFE_Jedi
 	inline void serialization_setMode(SerializationMode mode) { s_sMode = mode; }
 	inline SerializationMode serialization_getMode() { return s_sMode; }
 		
+	// Build maps from asset pointers (textures, models, waxes, frames) to IDs so that writing pointers
+	// doesn't have to search the asset lists. Build them before writing a save and clear them afterwards,
+	// the maps are invalid once assets are loaded or freed.
+	void serialization_buildPointerMaps();
+	void serialization_clearPointerMaps();
+
 	void serialization_serializeDfSound(Stream* stream, u32 version, SoundSourceId* id);
 	void serialization_serializeSectorPtr(Stream* stream, u32 version, RSector*& sector);
 	void serialization_serializeAnimatedTexturePtr(Stream* stream, u32 version, AnimatedTexture*& animTex);
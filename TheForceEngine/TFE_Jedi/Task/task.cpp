@@ -5,12 +5,16 @@
 #include <TFE_DarkForces/time.h>
 #include <TFE_System/system.h>
 #include <TFE_Game/igame.h>
+#include <TFE_Game/rewindBuffer.h>
 #include <TFE_System/profiler.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Jedi/Serialization/serialization.h>
 #include <stdarg.h>
+#include <algorithm>
 #include <tuple>
 #include <vector>
+#include <queue>
+#include <set>
 
 using namespace TFE_DarkForces;
 using namespace TFE_Memory;
@@ -63,6 +67,27 @@ struct Task
 
 	// Timing.
 	Tick nextTick;
+
+	// TFE: Scheduling.
+	u64 order;		// Position in the execution order, see task_insertOrder().
+	u32 schedId;	// Changes whenever nextTick changes, used to discard stale sleep entries.
+	JBool ready;	// JTRUE if the task is in the ready list.
+};
+
+// Orders tasks by their position in the execution order.
+struct TaskOrder
+{
+	bool operator()(const Task* a, const Task* b) const { return a->order < b->order; }
+};
+
+// A sleeping task waiting for its wake tick.
+struct TaskSleepEntry
+{
+	Tick tick;
+	u32 schedId;
+	Task* task;
+
+	bool operator>(const TaskSleepEntry& other) const { return tick > other.tick; }
 };
 
 namespace TFE_Jedi
@@ -94,7 +119,31 @@ namespace TFE_Jedi
 	static bool s_enableTimeLimiter = true;
 	static Task* s_taskPauseTask = nullptr;
 
+	// TFE: Scheduling
+	// Rather than walking every task each frame, tasks are kept in execution order and only the tasks that are
+	// awake (nextTick <= s_curTick) or framebreak tasks are stored in the ready list. Sleeping tasks with a wake
+	// tick are stored in a min-heap and moved to the ready list once s_curTick reaches their wake tick.
+	// The ready list is a vector sorted by Task::order that keeps its capacity, so yielding does not allocate.
+	static std::set<Task*, TaskOrder> s_taskOrder;
+	static std::vector<Task*> s_readyTasks;
+	static std::priority_queue<TaskSleepEntry, std::vector<TaskSleepEntry>, std::greater<TaskSleepEntry>> s_sleepingTasks;
+	static u32  s_schedId = 0;
+	static Tick s_wakeTick = 0;
+	static s32  s_frameVisitedTaskCount = 0;
+
+	const u64 c_taskOrderSpacing = 1ull << 32;
+
 	void selectNextTask();
+	void task_clearSchedule();
+	void task_insertOrder(Task* task, Task* before);
+	void task_removeFromSchedule(Task* task);
+	void task_setTick(Task* task, Tick tick);
+	void task_wakeSleepingTasks();
+	void task_addReady(Task* task);
+	void task_removeReady(Task* task);
+	Task* task_findNextReady(Task* task);
+	Task* task_findNextInRing(Task* task);
+	void console_verifyTaskOrder(const std::vector<std::string>& args);
 
 	void createRootTask()
 	{
@@ -110,8 +159,10 @@ namespace TFE_Jedi
 		s_curTask = &s_rootTask;
 		s_taskCount = 0;
 		s_frameActiveTaskCount = 0;
+		task_clearSchedule();
 
 		CVAR_BOOL(s_enableTimeLimiter, "d_enableTaskTimeLimiter", CVFLAG_DO_NOT_SERIALIZE, "Enable the task time limiter.");
+		CCMD("taskVerifyOrder", console_verifyTaskOrder, 0, "Verify that the scheduled task order matches walking the task ring for every task.");
 	}
 
 	Task* createSubTask(const char* name, TaskFunc func, TaskFunc localRunFunc)
@@ -126,6 +177,8 @@ namespace TFE_Jedi
 
 		s_taskCount++;
 		strcpy(newTask->name, name);
+		// Subtasks run before the existing subtasks of the current task.
+		task_insertOrder(newTask, s_curTask);
 
 		// Insert newTask at the head of the subtask list in the current "mainline" task.
 		newTask->next = s_curTask->subtaskNext;
@@ -144,7 +197,7 @@ namespace TFE_Jedi
 		newTask->userData = nullptr;
 		newTask->framebreak = JFALSE;
 		
-		newTask->nextTick = 0;
+		task_setTick(newTask, 0);
 
 		newTask->context = { 0 };
 		newTask->context.callstack[0] = func;
@@ -166,6 +219,7 @@ namespace TFE_Jedi
 		s_taskCount++;
 		// Insert the task after 's_taskIter'
 		strcpy(newTask->name, name);
+		task_insertOrder(newTask, s_taskIter->next);
 		newTask->next = s_taskIter->next;
 		// This was missing?
 		if (s_taskIter->next)
@@ -185,7 +239,7 @@ namespace TFE_Jedi
 		newTask->context.callstack[0] = func;
 		newTask->localRunFunc = localRunFunc;
 		newTask->context.level = TASK_INIT_LEVEL;
-		newTask->nextTick = s_curTick;
+		task_setTick(newTask, s_curTick);
 
 		return newTask;
 	}
@@ -195,6 +249,10 @@ namespace TFE_Jedi
 		SERIALIZE(SaveVersionInit, task->context.ip[0], 0);
 		SERIALIZE(SaveVersionInit, task->context.stackSize[0], 0);
 		SERIALIZE(SaveVersionInit, task->nextTick, 0);
+		if (serialization_getMode() == SMODE_READ)
+		{
+			task_setTick(task, task->nextTick);
+		}
 		if (serialization_getMode() == SMODE_READ && !task->context.stackMem)
 		{
 			task->context.stackMem = (u8*)allocFromChunkedArray(s_stackBlocks);
@@ -214,6 +272,78 @@ namespace TFE_Jedi
 		}
 	}
 
+	// The tasks and their stacks live in the game region, so only the root task and the schedule need to be saved.
+	void task_serializeRewindSchedule(Stream* stream, bool writeState)
+	{
+		u32 orderCount, readyCount, sleepCount;
+		if (writeState)
+		{
+			orderCount = u32(s_taskOrder.size());
+			stream->write(&orderCount);
+			for (std::set<Task*, TaskOrder>::iterator iter = s_taskOrder.begin(); iter != s_taskOrder.end(); ++iter)
+			{
+				Task* task = *iter;
+				stream->writeBuffer(&task, sizeof(Task*));
+			}
+
+			readyCount = u32(s_readyTasks.size());
+			stream->write(&readyCount);
+			stream->writeBuffer(s_readyTasks.data(), sizeof(Task*), readyCount);
+
+			std::priority_queue<TaskSleepEntry, std::vector<TaskSleepEntry>, std::greater<TaskSleepEntry>> sleepingTasks = s_sleepingTasks;
+			sleepCount = u32(sleepingTasks.size());
+			stream->write(&sleepCount);
+			for (; !sleepingTasks.empty(); sleepingTasks.pop())
+			{
+				stream->writeBuffer(&sleepingTasks.top(), sizeof(TaskSleepEntry));
+			}
+		}
+		else
+		{
+			// The order is taken from the restored tasks.
+			s_taskOrder.clear();
+			stream->read(&orderCount);
+			for (u32 i = 0; i < orderCount; i++)
+			{
+				Task* task;
+				stream->readBuffer(&task, sizeof(Task*));
+				s_taskOrder.insert(s_taskOrder.end(), task);
+			}
+
+			stream->read(&readyCount);
+			s_readyTasks.resize(readyCount);
+			stream->readBuffer(s_readyTasks.data(), sizeof(Task*), readyCount);
+
+			s_sleepingTasks = {};
+			stream->read(&sleepCount);
+			for (u32 i = 0; i < sleepCount; i++)
+			{
+				TaskSleepEntry entry;
+				stream->readBuffer(&entry, sizeof(TaskSleepEntry));
+				s_sleepingTasks.push(entry);
+			}
+		}
+	}
+
+	void task_registerRewindState()
+	{
+		REWIND_STATE(s_tasks);
+		REWIND_STATE(s_stackBlocks);
+		REWIND_STATE(s_taskCount);
+		REWIND_STATE(s_rootTask);
+		REWIND_STATE(s_taskIter);
+		REWIND_STATE(s_curTask);
+		REWIND_STATE(s_currentMsg);
+		REWIND_STATE(s_curContext);
+		REWIND_STATE(s_frameActiveTaskCount);
+		REWIND_STATE(s_taskSystemPaused);
+		REWIND_STATE(s_taskPauseTask);
+		REWIND_STATE(s_schedId);
+		REWIND_STATE(s_wakeTick);
+		REWIND_STATE(s_frameVisitedTaskCount);
+		TFE_RewindBuffer::addStateFunc(task_serializeRewindSchedule);
+	}
+
 	Task* task_getCurrent()
 	{
 		return s_curTask;
@@ -254,6 +384,8 @@ namespace TFE_Jedi
 			parent->subtaskNext = task->next;
 		}
 		
+		task_removeFromSchedule(task);
+
 		// Free any memory allocated for the local context.
 		freeToChunkedArray(s_stackBlocks, task->context.stackMem);
 		// Finally free the task itself from the chunked array.
@@ -272,6 +404,7 @@ namespace TFE_Jedi
 		s_curTask = &s_rootTask;
 		s_taskCount = 0;
 		s_frameActiveTaskCount = 0;
+		task_clearSchedule();
 
 		s_taskSystemPaused = JFALSE;
 		s_taskPauseTask = nullptr;
@@ -281,6 +414,7 @@ namespace TFE_Jedi
 	{
 		chunkedArrayClear(s_tasks);
 		chunkedArrayClear(s_stackBlocks);
+		task_clearSchedule();
 
 		s_curTask    = nullptr;
 		s_curContext = nullptr;
@@ -304,16 +438,17 @@ namespace TFE_Jedi
 		s_frameActiveTaskCount = 0;
 		s_taskSystemPaused = JFALSE;
 		s_taskPauseTask = nullptr;
+		task_clearSchedule();
 	}
 
 	void task_makeActive(Task* task)
 	{
-		task->nextTick = 0;
+		task_setTick(task, 0);
 	}
 
 	void task_setNextTick(Task* task, Tick tick)
 	{
-		task->nextTick = tick;
+		task_setTick(task, tick);
 	}
 
 	void task_setUserData(Task* task, void* data)
@@ -394,51 +529,37 @@ namespace TFE_Jedi
 
 	void selectNextTask()
 	{
-		// Find the next task to run.
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Execution:
+		//  * Go to the next task
+		//  * Check to see if there are sub-tasks
+		//  * If so, the assign current to the sub-task.
+		//  * Execute the task.
+		//  * Once we are on the last sub-task, then go back to the parent.
+		//  * Once the parent executes, then we move on to parent->next and start all over.
+		// TFE: The order above is stored in Task::order, so the next task is the first ready task after the current
+		// task in that order, wrapping around at the end (which always has the root task).
+		task_wakeSleepingTasks();
+
 		Task* task = s_curTask;
-		while (1)
-		{
-			//////////////////////////////////////////////////////////////////////////////////////////
-			// Execution:
-			//  * Go to the next task
-			//  * Check to see if there are sub-tasks
-			//  * If so, the assign current to the sub-task.
-			//  * Execute the task.
-			//  * Once we are on the last sub-task, then go back to the parent.
-			//  * Once the parent executes, then we move on to parent->next and start all over.
-			if (task->next)
+		while (task && !s_readyTasks.empty())
+		{
+			std::vector<Task*>::iterator iter = std::upper_bound(s_readyTasks.begin(), s_readyTasks.end(), task, TaskOrder());
+			if (iter == s_readyTasks.end())
 			{
-				// Move the to the next task.
-				task = task->next;
-				// If the task has sub-tasks, loop until we find the last one.
-				// This is usually only one deep.
-				while (task->subtaskNext)
-				{
-					task = task->subtaskNext;
-				}
-				// Then execute the task.
-				if (task->nextTick <= s_curTick || task->framebreak)
-				{
-					s_currentMsg = MSG_RUN_TASK;
-					s_curTask = task;
-					return;
-				}
+				iter = s_readyTasks.begin();
 			}
-			else if (task->subtaskParent)
+			task = *iter;
+			s_frameVisitedTaskCount++;
+
+			if (task->nextTick <= s_curTick || task->framebreak)
 			{
-				// Otherwise, try to execute the parent.
-				task = task->subtaskParent;
-				if (task->nextTick <= s_curTick || task->framebreak)
-				{
-					s_currentMsg = MSG_RUN_TASK;
-					s_curTask = task;
-					return;
-				}
-			}
-			else
-			{
-				break;
+				s_currentMsg = MSG_RUN_TASK;
+				s_curTask = task;
+				return;
 			}
+			// The tick went backwards since the task was woken, so put it back to sleep.
+			task_setTick(task, task->nextTick);
 		}
 
 		// If no selection is possible, assign the first task.
@@ -507,7 +628,7 @@ namespace TFE_Jedi
 		}
 
 		// Update the current tick based on the delay.
-		s_curTask->nextTick = (delay < TASK_SLEEP) ? s_curTick + delay : delay;
+		task_setTick(s_curTask, (delay < TASK_SLEEP) ? s_curTick + delay : delay);
 		
 		// Find the next task to run.
 		selectNextTask();
@@ -559,6 +680,7 @@ namespace TFE_Jedi
 		s_prevTime = time;
 		s_currentMsg = MSG_RUN_TASK;
 		s_frameActiveTaskCount = 0;
+		s_frameVisitedTaskCount = 0;
 
 		// Return if the task system is paused.
 		if (s_taskSystemPaused)
@@ -628,6 +750,7 @@ namespace TFE_Jedi
 
 		TFE_COUNTER(s_taskCount, "Task Count");
 		TFE_COUNTER(s_frameActiveTaskCount, "Active Tasks");
+		TFE_COUNTER(s_frameVisitedTaskCount, "Visited Tasks");
 	}
 
 	s32 task_getCount()
@@ -704,4 +827,198 @@ namespace TFE_Jedi
 		}
 		return startCallLevel != startContext->callLevel;
 	}
-}
\ No newline at end of file
+
+	/////////////////////////////////////////////
+	// Scheduling
+	/////////////////////////////////////////////
+	void task_clearSchedule()
+	{
+		s_taskOrder.clear();
+		s_readyTasks.clear();
+		s_readyTasks.reserve(TASK_CHUNK_SIZE);
+		s_sleepingTasks = {};
+		s_wakeTick = s_curTick;
+
+		// The root task is always last in the execution order.
+		s_rootTask.order = ~0ull;
+		s_rootTask.ready = JFALSE;
+		s_taskOrder.insert(&s_rootTask);
+	}
+
+	// Insert 'task' into the execution order just before 'before' and any of its subtasks.
+	void task_insertOrder(Task* task, Task* before)
+	{
+		// Subtasks run before their parent, so find the first task that runs in the 'before' subtree.
+		while (before->subtaskNext)
+		{
+			before = before->subtaskNext;
+		}
+
+		std::set<Task*, TaskOrder>::iterator iter = s_taskOrder.find(before);
+		assert(iter != s_taskOrder.end());
+		u64 prevOrder = (iter == s_taskOrder.begin()) ? 0 : (*std::prev(iter))->order;
+		if (before->order - prevOrder < 2)
+		{
+			// Out of space, so spread out the existing tasks (the relative order is unchanged).
+			u64 order = c_taskOrderSpacing;
+			for (iter = s_taskOrder.begin(); iter != s_taskOrder.end(); ++iter)
+			{
+				if (*iter != &s_rootTask)
+				{
+					(*iter)->order = order;
+					order += c_taskOrderSpacing;
+				}
+			}
+			iter = s_taskOrder.find(before);
+			prevOrder = (iter == s_taskOrder.begin()) ? 0 : (*std::prev(iter))->order;
+		}
+
+		task->order = prevOrder + (before->order - prevOrder) / 2;
+		task->schedId = 0;
+		task->ready = JFALSE;
+		task->framebreak = JFALSE;
+		s_taskOrder.insert(task);
+	}
+
+	void task_removeFromSchedule(Task* task)
+	{
+		task_removeReady(task);
+		s_taskOrder.erase(task);
+		// Invalidate any sleep entries.
+		task->schedId = ++s_schedId;
+	}
+
+	// All changes to Task::nextTick go through here to keep the ready set and sleeping tasks up to date.
+	void task_setTick(Task* task, Tick tick)
+	{
+		task->nextTick = tick;
+		task->schedId = ++s_schedId;
+
+		if (tick <= s_curTick || task->framebreak)
+		{
+			task_addReady(task);
+		}
+		else
+		{
+			task_removeReady(task);
+		}
+
+		if (tick > s_curTick && tick != TASK_SLEEP)
+		{
+			s_sleepingTasks.push({ tick, task->schedId, task });
+		}
+	}
+
+	void task_wakeSleepingTasks()
+	{
+		if (s_wakeTick == s_curTick) { return; }
+		s_wakeTick = s_curTick;
+
+		while (!s_sleepingTasks.empty() && s_sleepingTasks.top().tick <= s_curTick)
+		{
+			const TaskSleepEntry entry = s_sleepingTasks.top();
+			s_sleepingTasks.pop();
+			// Skip entries if the task has been rescheduled or freed since.
+			if (entry.schedId == entry.task->schedId)
+			{
+				task_addReady(entry.task);
+			}
+		}
+	}
+
+	void task_addReady(Task* task)
+	{
+		if (task->ready) { return; }
+		task->ready = JTRUE;
+		s_readyTasks.insert(std::lower_bound(s_readyTasks.begin(), s_readyTasks.end(), task, TaskOrder()), task);
+	}
+
+	void task_removeReady(Task* task)
+	{
+		if (!task->ready) { return; }
+		task->ready = JFALSE;
+		std::vector<Task*>::iterator iter = std::lower_bound(s_readyTasks.begin(), s_readyTasks.end(), task, TaskOrder());
+		assert(iter != s_readyTasks.end() && *iter == task);
+		s_readyTasks.erase(iter);
+	}
+
+	// Returns the task that selectNextTask() picks after 'task', without changing the schedule.
+	Task* task_findNextReady(Task* task)
+	{
+		std::vector<Task*>::iterator iter = std::upper_bound(s_readyTasks.begin(), s_readyTasks.end(), task, TaskOrder());
+		for (size_t i = 0; i < s_readyTasks.size(); i++, ++iter)
+		{
+			if (iter == s_readyTasks.end())
+			{
+				iter = s_readyTasks.begin();
+			}
+			if ((*iter)->nextTick <= s_curTick || (*iter)->framebreak)
+			{
+				return *iter;
+			}
+		}
+		return nullptr;
+	}
+
+	// Returns the next task by walking the task ring the way the original code did.
+	Task* task_findNextInRing(Task* task)
+	{
+		// Every task is visited at most twice (once going down to the subtasks and once coming back up), so stop if nothing can run.
+		for (s32 i = 0; i <= 2 * (s_taskCount + 1); i++)
+		{
+			if (task->next)
+			{
+				task = task->next;
+				while (task->subtaskNext)
+				{
+					task = task->subtaskNext;
+				}
+			}
+			else if (task->subtaskParent)
+			{
+				task = task->subtaskParent;
+			}
+			else
+			{
+				return nullptr;
+			}
+
+			if (task->nextTick <= s_curTick || task->framebreak)
+			{
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	// Check that the next task selected from every task matches the original task ring walk.
+	void console_verifyTaskOrder(const std::vector<std::string>& args)
+	{
+		if (!s_taskCount)
+		{
+			TFE_Console::addToHistory("taskVerifyOrder - there are no tasks.");
+			return;
+		}
+		task_wakeSleepingTasks();
+
+		s32 mismatchCount = 0;
+		std::set<Task*, TaskOrder>::iterator iter = s_taskOrder.begin();
+		for (; iter != s_taskOrder.end(); ++iter)
+		{
+			Task* task = *iter;
+			Task* expected = task_findNextInRing(task);
+			Task* scheduled = task_findNextReady(task);
+			if (expected != scheduled)
+			{
+				char res[256];
+				sprintf(res, "  after '%s': expected '%s', scheduled '%s'", task->name, expected ? expected->name : "none", scheduled ? scheduled->name : "none");
+				TFE_Console::addToHistory(res);
+				mismatchCount++;
+			}
+		}
+
+		char res[256];
+		sprintf(res, "taskVerifyOrder - %d tasks, %s (%d mismatches).", s32(s_taskOrder.size()), mismatchCount ? "FAILED" : "order matches", mismatchCount);
+		TFE_Console::addToHistory(res);
+	}
+}
@@ -42,6 +42,8 @@ namespace TFE_Jedi
 	// needs to be provided and the state be properly serialized by the client. The callback should properly handle
 	// both saving and loading. See vueLogic_serializeTaskLocalMemory() in TFE_DarkForces/vueLogic.cpp for an example.
 	void task_serializeState(Stream* stream, Task* task, void* userData = nullptr, LocalMemorySerCallback localMemCallback = nullptr);
+	// Register the task system state outside of the game region with the rewind buffer.
+	void task_registerRewindState();
 
 	Task* task_getCurrent();
 
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <algorithm>
+#include <unordered_map>
 
 // #define _VERIFY_MEMORY
 
@@ -26,22 +27,38 @@ enum
 	MIN_SPLIT_SIZE = 32,
 	BLOCK_ARR_STEP = 16,
 	ALIGNMENT = 8,
-	ALLOC_BIN_COUNT = 6,
-	ALLOC_BIN_LAST = 5,
+	ALLOC_BIN_COUNT = REGION_BIN_COUNT,
+	ALLOC_BIN_LAST = REGION_BIN_COUNT - 1,
 	// No more then 256 blocks, and no more than 16MB per block for a total of 4GB.
 	MAX_BLOCK_COUNT = 256,
 	MAX_BLOCK_SIZE  = 16 * 1024 * 1024,
 	RELATIVE_NON_NULL_BIT = 1u,
 	SHARED_HEADER_SIZE = 8,	// 8 bytes are shared between RegionAllocHeader{} and AllocHeaderFree{}
+	// Slabs
+	SLAB_CLASS_COUNT = REGION_SLAB_CLASS_COUNT,
+	SLAB_SIZE = 4096,		// Size of each slab, allocated from the region.
+	SLAB_MAX_ALLOC = 64,	// Larger allocations do not use slabs.
+	// Trace
+	TRACE_MAX_OPS = 4 * 1024 * 1024,
 };
 
+// The tag is stored in the 4 bytes right before each allocation, which tells region_free() how to find the owner.
+static const u32 c_allocTag    = 0x434f4c41;	// 'ALOC' - general allocation, preceded by RegionAllocHeader{}.
+static const u32 c_slotTag     = 0x544f4c53;	// 'SLOT' - allocated slab slot, preceded by SlabSlotHeader{}.
+static const u32 c_slotFreeTag = 0x45455246;	// 'FREE' - free slab slot.
+
+// Slab size classes, by the largest allocation size.
+static const u32 c_slabClassSize[SLAB_CLASS_COUNT] = { 8, 16, 24, 32, 48, 64 };
+
 struct RegionAllocHeader
 {
 	u32 size;
 	u8  free;
 	u8  bin;
-	u8  pad8[2];
-	u32 pad4[2];	// pad to 16 bytes.
+	u8  blockIndex;	// Index of the block that holds the allocation.
+	u8  slab;		// 1 if the allocation holds a slab.
+	u32 pad;		// pad to 16 bytes.
+	u32 tag;		// c_allocTag when allocated.
 };
 
 // free structure is larger than header, because it fits within the
@@ -51,7 +68,8 @@ struct AllocHeaderFree
 	u32 size;
 	u8  free;
 	u8  bin;
-	u8  pad8[2];
+	u8  blockIndex;
+	u8  slab;
 	AllocHeaderFree* binNext;
 	AllocHeaderFree* binPrev;
 #if (defined(_WIN32) && !defined(_WIN64)) || (__SIZEOF_POINTER__ == 4)
@@ -76,6 +94,50 @@ struct MemoryBlock
 	AllocHeaderFree* freeListBins[ALLOC_BIN_COUNT];
 };
 
+// A slab holds fixed size slots for one size class. Slots are referenced by their offset from the slab
+// so that the slab survives being serialized.
+struct RegionSlab
+{
+	u16 sizeClass;
+	u16 slotSize;		// Slot size, including the SlabSlotHeader{}.
+	u16 slotCount;
+	u16 usedCount;
+	u32 freeHead;		// Offset of the first free slot, 0 if there are none.
+	u32 bumpOffset;		// Offset of the first slot that has never been used.
+	// Slabs with free slots, rebuilt when the region is restored.
+	RegionSlab* next;
+	RegionSlab* prev;
+};
+
+struct SlabSlotHeader
+{
+	u32 slabOffset;		// Offset of the slot from the slab.
+	u32 tag;			// c_slotTag or c_slotFreeTag.
+};
+
+enum RegionTraceOp : u8
+{
+	TRACE_ALLOC = 0,
+	TRACE_REALLOC,
+	TRACE_FREE,
+	TRACE_CLEAR,
+};
+
+struct RegionTraceEntry
+{
+	u8  op;
+	u32 id;
+	u32 size;
+};
+
+struct RegionTrace
+{
+	bool recording;
+	u32  nextId;
+	std::vector<RegionTraceEntry> entries;
+	std::unordered_map<void*, u32> ids;
+};
+
 struct MemoryRegion
 {
 	char name[32];
@@ -85,10 +147,20 @@ struct MemoryRegion
 	size_t blockCount;
 	size_t blockSize;
 	size_t maxBlocks;
+
+	// Runtime state, not serialized.
+	bool useSlabs;
+	RegionSlab* slabs[SLAB_CLASS_COUNT];	// Slabs with free slots.
+	size_t memUsed;
+	size_t peakUsed;
+	u32 generation;		// Changes when the region is cleared or restored, see region_getState().
+	RegionTrace* trace;
 };
 
 static_assert(sizeof(RegionAllocHeader) == 16, "RegionAllocHeader is the wrong size.");
 static_assert(sizeof(AllocHeaderFree) == 24, "AllocHeaderFree is the wrong size.");
+static_assert(sizeof(SlabSlotHeader) == 8, "SlabSlotHeader is the wrong size.");
+static_assert(MAX_BLOCK_COUNT <= 256, "The block index must fit in RegionAllocHeader::blockIndex.");
 
 namespace TFE_Memory
 {
@@ -103,13 +175,19 @@ namespace TFE_Memory
 	bool allocateNewBlock(MemoryRegion* region);
 	void removeHeaderFromFreelist(MemoryBlock* block, RegionAllocHeader* header);
 	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header);
+	void slab_link(MemoryRegion* region, RegionSlab* slab);
+	void resetBlock(MemoryRegion* region, MemoryBlock* block);
+	bool isTracing(MemoryRegion* region);
+	void trace_clear(MemoryRegion* region);
 
 	void verifyMemory(MemoryRegion* region)
 	{
+		size_t used = 0;
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
 			MemoryBlock* block = region->memBlocks[i];
 			assert(block->sizeFree <= region->blockSize);
+			used += region->blockSize - block->sizeFree;
 			u8* mem = (u8*)block + sizeof(MemoryBlock);
 			RegionAllocHeader* prev = nullptr;
 			for (u32 a = 0; a < block->count; a++)
@@ -117,6 +195,12 @@ namespace TFE_Memory
 				RegionAllocHeader* header = (RegionAllocHeader*)mem;
 				assert(header->free == 0 || header->free == 1);
 				assert(header->size <= region->blockSize);
+				assert(header->free || (header->tag == c_allocTag && header->blockIndex == i));
+				if (!header->free && header->slab)
+				{
+					RegionSlab* slab = (RegionSlab*)(header + 1);
+					assert(slab->usedCount <= slab->slotCount);
+				}
 				mem += header->size;
 				prev = header;
 			}
@@ -135,6 +219,7 @@ namespace TFE_Memory
 				}
 			}
 		}
+		assert(used == region->memUsed);
 	}
 
 	MemoryRegion* region_create(const char* name, size_t blockSize, size_t maxSize)
@@ -160,6 +245,12 @@ namespace TFE_Memory
 		region->blockCount = 0;
 		region->blockSize = blockSize;
 		region->maxBlocks = maxSize ? (maxSize + blockSize - 1) / blockSize : 0;
+		region->useSlabs = true;
+		memset(region->slabs, 0, sizeof(RegionSlab*) * SLAB_CLASS_COUNT);
+		region->memUsed = 0;
+		region->peakUsed = 0;
+		region->generation = 0;
+		region->trace = nullptr;
 		if (!allocateNewBlock(region))
 		{
 			free(region);
@@ -176,16 +267,17 @@ namespace TFE_Memory
 		assert(region);
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
-			MemoryBlock* block = region->memBlocks[i];
-			block->sizeFree = u32(region->blockSize);
-			block->count = 1;
+			resetBlock(region, region->memBlocks[i]);
+		}
+		memset(region->slabs, 0, sizeof(RegionSlab*) * SLAB_CLASS_COUNT);
+		region->memUsed = 0;
+		region->peakUsed = 0;
+		region->generation++;
+		VERIFY_MEMORY();
 
-			RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
-			header->size = block->sizeFree;
-			header->free = 0;
-			memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
-			insertBlockIntoFreelist(block, header);
-			VERIFY_MEMORY();
+		if (isTracing(region))
+		{
+			trace_clear(region);
 		}
 	}
 
@@ -197,11 +289,13 @@ namespace TFE_Memory
 			free(region->memBlocks[i]);
 		}
 		free(region->memBlocks);
+		delete region->trace;
 		free(region);
 	}
 		
-	void* allocFromHeader(MemoryBlock* block, RegionAllocHeader* header, u32 size)
+	void* allocFromHeader(MemoryRegion* region, s32 blockIndex, RegionAllocHeader* header, u32 size)
 	{
+		MemoryBlock* block = region->memBlocks[blockIndex];
 		assert(header->free == 1);
 		if (header->size - size >= MIN_SPLIT_SIZE)
 		{
@@ -228,39 +322,39 @@ namespace TFE_Memory
 			removeHeaderFromFreelist(block, header);
 		}
 		block->sizeFree -= header->size;
+		header->blockIndex = u8(blockIndex);
+		header->slab = 0;
+		header->tag = c_allocTag;
+
+		region->memUsed += header->size;
+		region->peakUsed = std::max(region->peakUsed, region->memUsed);
 		return (u8*)header + sizeof(RegionAllocHeader);
 	}
 
-	void* region_alloc(MemoryRegion* region, size_t size)
+	void* allocGeneral(MemoryRegion* region, size_t size)
 	{
-		assert(region);
-		if (size == 0) { return nullptr; }
-
-		size = alloc_align(size + sizeof(RegionAllocHeader));
-		assert(size >= 24);	// at least 24 bytes is required to hold the free header.
-		if (size > region->blockSize) { return nullptr; }
+		const size_t allocSize = alloc_align(size + sizeof(RegionAllocHeader));
+		assert(allocSize >= 24);	// at least 24 bytes is required to hold the free header.
+		if (allocSize > region->blockSize) { return nullptr; }
 		
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
 			MemoryBlock* block = region->memBlocks[i];
-			if (block->sizeFree < size)
+			if (block->sizeFree < allocSize)
 			{
 				continue;
 			}
 
 			// Try to allocate from the closest matching bin.
-			s32 bin = getBinFromSize((u32)size);
+			s32 bin = getBinFromSize((u32)allocSize);
 			for (s32 b = bin; b < ALLOC_BIN_COUNT; b++)
 			{
 				AllocHeaderFree* header = block->freeListBins[b];
 				while (header)
 				{
-					if (header->size >= size)
+					if (header->size >= allocSize)
 					{
-						VERIFY_MEMORY();
-						void* mem = allocFromHeader(block, (RegionAllocHeader*)header, (u32)size);
-						VERIFY_MEMORY();
-						return mem;
+						return allocFromHeader(region, i, (RegionAllocHeader*)header, (u32)allocSize);
 					}
 					header = header->binNext;
 				}
@@ -271,141 +365,375 @@ namespace TFE_Memory
 		{
 			if (allocateNewBlock(region))
 			{
-				VERIFY_MEMORY();
-				void* mem = region_alloc(region, size);
-				VERIFY_MEMORY();
-				return mem;
+				return allocGeneral(region, size);
 			}
 		}
 		
 		// We are all out of memory...
-		TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Failed to allocate %u bytes in region '%s'.", size, region->name);
+		TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Failed to allocate %u bytes in region '%s'.", allocSize, region->name);
 		return nullptr;
 	}
 
-	void* region_realloc(MemoryRegion* region, void* ptr, size_t size)
+	void freeGeneral(MemoryRegion* region, void* ptr)
 	{
-		assert(region);
-		if (!ptr) { return region_alloc(region, size); }
+		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
+		assert(!header->free);
+		if (header->free)
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to double free pointer %x in region '%s'.", ptr, region->name);
+			return;
+		}
+		assert(header->tag == c_allocTag && header->blockIndex < region->blockCount);
+		if (header->tag != c_allocTag || header->blockIndex >= region->blockCount)
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to free pointer %x which was not allocated in region '%s'.", ptr, region->name);
+			return;
+		}
+
+		MemoryBlock* block = region->memBlocks[header->blockIndex];
+		RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
+		if ((u8*)nextHeader >= (u8*)block + sizeof(MemoryBlock) + region->blockSize)
+		{
+			nextHeader = nullptr;
+		}
+
+		region->memUsed -= header->size;
+		freeSlot(header, nextHeader, block);
+	}
+
+	//////////////////////////////////////////////////
+	// Slabs
+	//////////////////////////////////////////////////
+	// Size class for allocations of 1 to 64 bytes, indexed by (size - 1) >> 3.
+	static const u8 c_slabSizeClass[SLAB_MAX_ALLOC / ALIGNMENT] = { 0, 1, 2, 3, 4, 4, 5, 5 };
+
+	void slab_link(MemoryRegion* region, RegionSlab* slab)
+	{
+		RegionSlab*& head = region->slabs[slab->sizeClass];
+		slab->prev = nullptr;
+		slab->next = head;
+		if (head) { head->prev = slab; }
+		head = slab;
+	}
+
+	void slab_unlink(MemoryRegion* region, RegionSlab* slab)
+	{
+		if (slab->prev) { slab->prev->next = slab->next; }
+		else { region->slabs[slab->sizeClass] = slab->next; }
+		if (slab->next) { slab->next->prev = slab->prev; }
+		slab->next = nullptr;
+		slab->prev = nullptr;
+	}
+
+	RegionSlab* slab_create(MemoryRegion* region, s32 sizeClass)
+	{
+		RegionSlab* slab = (RegionSlab*)allocGeneral(region, SLAB_SIZE);
+		if (!slab) { return nullptr; }
+		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)slab - sizeof(RegionAllocHeader));
+		header->slab = 1;
+
+		const u32 firstSlot = u32(alloc_align(sizeof(RegionSlab)));
+		slab->sizeClass  = u16(sizeClass);
+		slab->slotSize   = u16(c_slabClassSize[sizeClass] + sizeof(SlabSlotHeader));
+		slab->slotCount  = u16((SLAB_SIZE - firstSlot) / slab->slotSize);
+		slab->usedCount  = 0;
+		slab->freeHead   = 0;
+		slab->bumpOffset = firstSlot;
+		slab_link(region, slab);
+		return slab;
+	}
+
+	void* slab_alloc(MemoryRegion* region, s32 sizeClass)
+	{
+		RegionSlab* slab = region->slabs[sizeClass];
+		if (!slab)
+		{
+			slab = slab_create(region, sizeClass);
+			if (!slab) { return nullptr; }
+		}
+		assert(slab->usedCount < slab->slotCount);
+
+		u32 offset;
+		SlabSlotHeader* slot;
+		if (slab->freeHead)
+		{
+			offset = slab->freeHead;
+			slot = (SlabSlotHeader*)((u8*)slab + offset);
+			assert(slot->tag == c_slotFreeTag);
+			slab->freeHead = *(u32*)(slot + 1);
+		}
+		else
+		{
+			offset = slab->bumpOffset;
+			slot = (SlabSlotHeader*)((u8*)slab + offset);
+			slab->bumpOffset += slab->slotSize;
+		}
+		slot->slabOffset = offset;
+		slot->tag = c_slotTag;
+
+		slab->usedCount++;
+		if (slab->usedCount == slab->slotCount)
+		{
+			slab_unlink(region, slab);
+		}
+		return slot + 1;
+	}
+
+	RegionSlab* slab_getFromSlot(void* ptr)
+	{
+		SlabSlotHeader* slot = (SlabSlotHeader*)ptr - 1;
+		return (RegionSlab*)((u8*)slot - slot->slabOffset);
+	}
+
+	void slab_free(MemoryRegion* region, void* ptr)
+	{
+		SlabSlotHeader* slot = (SlabSlotHeader*)ptr - 1;
+		RegionSlab* slab = slab_getFromSlot(ptr);
+		assert(slot->tag == c_slotTag && slab->usedCount > 0);
+
+		const bool wasFull = slab->usedCount == slab->slotCount;
+		slot->tag = c_slotFreeTag;
+		*(u32*)ptr = slab->freeHead;
+		slab->freeHead = slot->slabOffset;
+		slab->usedCount--;
+
+		if (wasFull)
+		{
+			slab_link(region, slab);
+		}
+		else if (slab->usedCount == 0 && (slab->prev || slab->next))
+		{
+			// Release empty slabs, but keep the last one to avoid thrashing.
+			slab_unlink(region, slab);
+			freeGeneral(region, slab);
+		}
+	}
+
+	//////////////////////////////////////////////////
+	// Tracing
+	//////////////////////////////////////////////////
+	void trace_addEntry(MemoryRegion* region, u8 op, u32 id, size_t size)
+	{
+		RegionTrace* trace = region->trace;
+		trace->entries.push_back({ op, id, u32(size) });
+		if (trace->entries.size() >= TRACE_MAX_OPS)
+		{
+			TFE_System::logWrite(LOG_WARNING, "MemoryRegion", "The allocation trace for region '%s' is full, recording stopped.", region->name);
+			trace->recording = false;
+		}
+	}
+
+	void trace_alloc(MemoryRegion* region, void* ptr, size_t size)
+	{
+		if (!ptr) { return; }
+		const u32 id = region->trace->nextId++;
+		region->trace->ids[ptr] = id;
+		trace_addEntry(region, TRACE_ALLOC, id, size);
+	}
+
+	void trace_realloc(MemoryRegion* region, void* prevPtr, void* ptr, size_t size)
+	{
+		if (!ptr) { return; }
+		RegionTrace* trace = region->trace;
+		std::unordered_map<void*, u32>::iterator iPrev = prevPtr ? trace->ids.find(prevPtr) : trace->ids.end();
+		if (iPrev == trace->ids.end())
+		{
+			// The original allocation was made before recording started.
+			trace_alloc(region, ptr, size);
+			return;
+		}
+
+		const u32 id = iPrev->second;
+		trace->ids.erase(iPrev);
+		trace->ids[ptr] = id;
+		trace_addEntry(region, TRACE_REALLOC, id, size);
+	}
+
+	void trace_free(MemoryRegion* region, void* ptr)
+	{
+		RegionTrace* trace = region->trace;
+		std::unordered_map<void*, u32>::iterator iPtr = trace->ids.find(ptr);
+		if (iPtr == trace->ids.end()) { return; }
+
+		const u32 id = iPtr->second;
+		trace->ids.erase(iPtr);
+		trace_addEntry(region, TRACE_FREE, id, 0);
+	}
+
+	void trace_clear(MemoryRegion* region)
+	{
+		region->trace->ids.clear();
+		trace_addEntry(region, TRACE_CLEAR, 0, 0);
+	}
+
+	bool isTracing(MemoryRegion* region)
+	{
+		return region->trace && region->trace->recording;
+	}
+
+	//////////////////////////////////////////////////
+	// Allocation
+	//////////////////////////////////////////////////
+	void* allocInternal(MemoryRegion* region, size_t size)
+	{
+		if (region->useSlabs && size <= SLAB_MAX_ALLOC)
+		{
+			return slab_alloc(region, c_slabSizeClass[(size - 1) >> 3]);
+		}
+		return allocGeneral(region, size);
+	}
+
+	void freeInternal(MemoryRegion* region, void* ptr)
+	{
+		const u32 tag = ((u32*)ptr)[-1];
+		if (tag == c_slotTag)
+		{
+			slab_free(region, ptr);
+		}
+		else if (tag == c_slotFreeTag)
+		{
+			assert(0);
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to double free pointer %x in region '%s'.", ptr, region->name);
+		}
+		else
+		{
+			freeGeneral(region, ptr);
+		}
+	}
+
+	void* reallocInternal(MemoryRegion* region, void* ptr, size_t size)
+	{
+		if (!ptr) { return allocInternal(region, size); }
 		if (size == 0) { return nullptr; }
 
+		// Slab slots cannot grow, so move the allocation if it no longer fits.
+		if (((u32*)ptr)[-1] == c_slotTag)
+		{
+			RegionSlab* slab = slab_getFromSlot(ptr);
+			const u32 capacity = slab->slotSize - sizeof(SlabSlotHeader);
+			if (size <= capacity)
+			{
+				return ptr;
+			}
+
+			void* newMem = allocInternal(region, size);
+			if (!newMem) { return nullptr; }
+			memcpy(newMem, ptr, capacity);
+			slab_free(region, ptr);
+			return newMem;
+		}
+
 		size = alloc_align(size + sizeof(RegionAllocHeader));
 		if (size > region->blockSize) { return nullptr; }
 
-		// If the current block is already large enough, skip looping over the memory blocks.
+		// If the current block is already large enough, there is nothing to do.
 		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
+		assert(header->free == 0 && header->tag == c_allocTag);
 		if (header->size >= size)
 		{
 			return ptr;
 		}
 
-		// First try to reallocate in the same region.
-		u32 prevSize = 0;
-		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
+		// First try to reallocate in the same block.
+		MemoryBlock* block = region->memBlocks[header->blockIndex];
+		RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
+		if ((u8*)nextHeader >= (u8*)block + sizeof(MemoryBlock) + region->blockSize)
 		{
-			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
-			{
-				RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
-				RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
-				assert(header->free == 0);
-
-				if ((u8*)nextHeader >= (u8*)block + region->blockSize)
-				{
-					nextHeader = nullptr;
-				}
-				// If it is big enough, just stick to the same memory.
-				if (header->size >= size)
-				{
-					return ptr;
-				}
-				// If the next block is free, merge the two blocks and then allocate from that.
-				if (nextHeader && nextHeader->free && header->size + nextHeader->size >= size)
-				{
-					VERIFY_MEMORY();
-					// Remove the nextHeader from the freelist.
-					assert(nextHeader->free == 1);
-					removeHeaderFromFreelist(block, nextHeader);
-
-					// Merge blocks.
-					block->sizeFree += header->size;
-					header->size += nextHeader->size;
-					block->count--;
+			nextHeader = nullptr;
+		}
+		// If the next block is free, merge the two blocks and then allocate from that.
+		if (nextHeader && nextHeader->free && header->size + nextHeader->size >= size)
+		{
+			// Remove the nextHeader from the freelist.
+			assert(nextHeader->free == 1);
+			removeHeaderFromFreelist(block, nextHeader);
+
+			// Merge blocks.
+			const u32 prevSize = header->size;
+			block->sizeFree += header->size;
+			header->size += nextHeader->size;
+			block->count--;
 									
-					// Allocate from the new header.
-					if (header->size - size >= MIN_SPLIT_SIZE)
-					{
-						// Split.
-						size_t split0 = size;
-						size_t split1 = header->size - split0;
-						RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + split0);
-
-						// Reset the header.
-						header->free = 0;
-						header->size = u32(split0);
-
-						// Create a new free block.
-						next->size = u32(split1);
-						next->free = 0;
-						block->count++;
-
-						// Add the new block to the free list.
-						insertBlockIntoFreelist(block, next);
-					}
-					block->sizeFree -= header->size;
-					VERIFY_MEMORY();
-					return (u8*)header + sizeof(RegionAllocHeader);
-				}
-				// Otherwise break, we have to free and reallocate.
-				prevSize = header->size;
-				break;
+			// Allocate from the new header.
+			if (header->size - size >= MIN_SPLIT_SIZE)
+			{
+				// Split.
+				size_t split0 = size;
+				size_t split1 = header->size - split0;
+				RegionAllocHeader* next = (RegionAllocHeader*)((u8*)header + split0);
+
+				// Reset the header.
+				header->free = 0;
+				header->size = u32(split0);
+
+				// Create a new free block.
+				next->size = u32(split1);
+				next->free = 0;
+				block->count++;
+
+				// Add the new block to the free list.
+				insertBlockIntoFreelist(block, next);
 			}
+			block->sizeFree -= header->size;
+
+			region->memUsed += header->size - prevSize;
+			region->peakUsed = std::max(region->peakUsed, region->memUsed);
+			return (u8*)header + sizeof(RegionAllocHeader);
 		}
 
-		// Allocate a new block of memory.
-		void* newMem = region_alloc(region, size);
+		// Otherwise allocate a new block of memory.
+		const u32 prevSize = header->size;
+		void* newMem = allocInternal(region, size - sizeof(RegionAllocHeader));
 		if (!newMem) { return nullptr; }
 		// Copy over the contents from the previous block.
-		if (prevSize > sizeof(RegionAllocHeader))
-		{
-			memcpy(newMem, ptr, std::min((u32)size, prevSize) - sizeof(RegionAllocHeader));
-		}
+		memcpy(newMem, ptr, std::min((u32)size, prevSize) - sizeof(RegionAllocHeader));
 		// Free the previous block
-		region_free(region, ptr);
+		freeGeneral(region, ptr);
 		// Then return the new block.
+		return newMem;
+	}
+
+	void* region_alloc(MemoryRegion* region, size_t size)
+	{
+		assert(region);
+		if (size == 0) { return nullptr; }
+
+		VERIFY_MEMORY();
+		void* mem = allocInternal(region, size);
+		VERIFY_MEMORY();
+
+		if (isTracing(region))
+		{
+			trace_alloc(region, mem, size);
+		}
+		return mem;
+	}
+
+	void* region_realloc(MemoryRegion* region, void* ptr, size_t size)
+	{
+		assert(region);
 		VERIFY_MEMORY();
+		void* newMem = reallocInternal(region, ptr, size);
+		VERIFY_MEMORY();
+
+		if (isTracing(region))
+		{
+			trace_realloc(region, ptr, newMem, size);
+		}
 		return newMem;
 	}
 		
 	void region_free(MemoryRegion* region, void* ptr)
 	{
 		if (!ptr || !region) { return; }
-
-		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
+		if (isTracing(region))
 		{
-			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
-			{
-				RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
-				RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
-				if ((u8*)nextHeader >= (u8*)block + region->blockSize)
-				{
-					nextHeader = nullptr;
-				}
-
-				assert(!header->free);
-				if (header->free)
-				{
-					TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Attempted to double free pointer %x in region '%s'.", ptr, region->name);
-					return;
-				}
-
-				VERIFY_MEMORY();
-				freeSlot(header, nextHeader, block);
-				VERIFY_MEMORY();
-				return;
-			}
+			trace_free(region, ptr);
 		}
+
+		VERIFY_MEMORY();
+		freeInternal(region, ptr);
+		VERIFY_MEMORY();
 	}
 		
 	size_t region_getMemoryUsed(MemoryRegion* region)
@@ -428,6 +756,174 @@ namespace TFE_Memory
 	{
 		return region->blockCount * region->blockSize;
 	}
+
+	void region_getStats(MemoryRegion* region, MemoryRegionStats* stats)
+	{
+		memset(stats, 0, sizeof(MemoryRegionStats));
+		stats->capacity = region_getMemoryCapacity(region);
+		stats->used = region->memUsed;
+		stats->peakUsed = region->peakUsed;
+		for (s32 c = 0; c < SLAB_CLASS_COUNT; c++)
+		{
+			stats->slabSlotSize[c] = c_slabClassSize[c];
+		}
+
+		for (s32 i = 0; i < region->blockCount; i++)
+		{
+			MemoryBlock* block = region->memBlocks[i];
+			u8* mem = (u8*)block + sizeof(MemoryBlock);
+			for (u32 a = 0; a < block->count; a++)
+			{
+				RegionAllocHeader* header = (RegionAllocHeader*)mem;
+				if (header->free)
+				{
+					stats->binFreeCount[header->bin]++;
+					stats->binFreeBytes[header->bin] += header->size;
+					stats->freeBytes += header->size;
+					stats->largestFree = std::max(stats->largestFree, size_t(header->size));
+				}
+				else if (header->slab)
+				{
+					RegionSlab* slab = (RegionSlab*)(header + 1);
+					stats->slabCount[slab->sizeClass]++;
+					stats->slabSlotsUsed[slab->sizeClass] += slab->usedCount;
+					stats->slabSlotsFree[slab->sizeClass] += slab->slotCount - slab->usedCount;
+				}
+				else
+				{
+					stats->allocCount++;
+				}
+				mem += header->size;
+			}
+		}
+		stats->fragmentation = stats->freeBytes ? 1.0f - f32(f64(stats->largestFree) / f64(stats->freeBytes)) : 0.0f;
+	}
+
+	void region_beginTrace(MemoryRegion* region)
+	{
+		if (!region->trace)
+		{
+			region->trace = new RegionTrace();
+		}
+		region->trace->entries.clear();
+		region->trace->ids.clear();
+		region->trace->nextId = 0;
+		region->trace->recording = true;
+	}
+
+	void region_endTrace(MemoryRegion* region)
+	{
+		if (region->trace)
+		{
+			region->trace->recording = false;
+		}
+	}
+
+	size_t region_getTraceLength(MemoryRegion* region)
+	{
+		return region->trace ? region->trace->entries.size() : 0;
+	}
+
+	// Replay a trace using malloc if 'region' is null, returns the time taken and updates the peak memory used.
+	f64 replayTrace(const RegionTrace* trace, MemoryRegion* region, std::vector<void*>& ptrs, size_t* peak)
+	{
+		ptrs.assign(std::max(trace->nextId, 1u), nullptr);
+		const size_t count = trace->entries.size();
+		const RegionTraceEntry* entry = trace->entries.data();
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (size_t i = 0; i < count; i++, entry++)
+		{
+			void*& ptr = ptrs[entry->id];
+			switch (entry->op)
+			{
+				case TRACE_ALLOC:
+				{
+					ptr = region ? region_alloc(region, entry->size) : malloc(entry->size);
+				} break;
+				case TRACE_REALLOC:
+				{
+					ptr = region ? region_realloc(region, ptr, entry->size) : realloc(ptr, entry->size);
+				} break;
+				case TRACE_FREE:
+				{
+					if (region) { region_free(region, ptr); }
+					else { free(ptr); }
+					ptr = nullptr;
+				} break;
+				case TRACE_CLEAR:
+				{
+					// Without a region, every live allocation has to be freed individually.
+					if (region)
+					{
+						*peak = std::max(*peak, region->peakUsed);
+						region_clear(region);
+					}
+					else
+					{
+						for (size_t p = 0; p < ptrs.size(); p++)
+						{
+							free(ptrs[p]);
+							ptrs[p] = nullptr;
+						}
+					}
+				} break;
+			}
+		}
+		const u64 delta = TFE_System::getCurrentTimeInTicks() - start;
+
+		// Cleanup, this is not timed.
+		if (region)
+		{
+			*peak = std::max(*peak, region->peakUsed);
+			region_clear(region);
+		}
+		else
+		{
+			for (size_t p = 0; p < ptrs.size(); p++)
+			{
+				free(ptrs[p]);
+			}
+		}
+		return TFE_System::convertFromTicksToSeconds(delta);
+	}
+
+	bool region_benchmarkTrace(MemoryRegion* region, s32 runCount, MemoryRegionBenchmark* result)
+	{
+		if (!region || !region->trace || region->trace->entries.empty() || runCount < 1)
+		{
+			return false;
+		}
+		const RegionTrace* trace = region->trace;
+		MemoryRegion* generalRegion = region_create("Benchmark", region->blockSize);
+		MemoryRegion* slabRegion = region_create("BenchmarkSlab", region->blockSize);
+		if (!generalRegion || !slabRegion)
+		{
+			if (generalRegion) { region_destroy(generalRegion); }
+			if (slabRegion) { region_destroy(slabRegion); }
+			return false;
+		}
+		generalRegion->useSlabs = false;
+
+		memset(result, 0, sizeof(MemoryRegionBenchmark));
+		result->opCount = trace->entries.size();
+		result->runCount = runCount;
+
+		std::vector<void*> ptrs;
+		size_t mallocPeak = 0;
+		for (s32 i = 0; i < runCount; i++)
+		{
+			result->mallocTime += replayTrace(trace, nullptr, ptrs, &mallocPeak);
+			result->regionTime += replayTrace(trace, generalRegion, ptrs, &result->regionPeak);
+			result->slabTime   += replayTrace(trace, slabRegion, ptrs, &result->slabPeak);
+		}
+		region_destroy(generalRegion);
+		region_destroy(slabRegion);
+
+		TFE_System::logWrite(LOG_MSG, "MemoryRegion", "Benchmark '%s' - %zu operations, %d runs. Malloc: %f, Region: %f (peak %zu), Region with slabs: %f (peak %zu)",
+			region->name, result->opCount, runCount, result->mallocTime, result->regionTime, result->regionPeak, result->slabTime, result->slabPeak);
+		return true;
+	}
 		
 	RelativePointer region_getRelativePointer(MemoryRegion* region, void* ptr)
 	{
@@ -437,7 +933,7 @@ namespace TFE_Memory
 		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
 		{
 			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
+			if (ptr >= block && (u8*)ptr <= (u8*)block + sizeof(MemoryBlock) + region->blockSize)
 			{
 				rp = RelativePointer((u8*)ptr - (u8*)block - sizeof(MemoryBlock));
 				rp |= (i << c_relativeBlockShift);
@@ -472,6 +968,70 @@ namespace TFE_Memory
 		return (u8*)block + (ptr & c_relativeOffsetMask) + sizeof(MemoryBlock);
 	}
 
+	void region_getState(MemoryRegion* region, MemoryRegionState* state)
+	{
+		state->generation = region->generation;
+		state->blockCount = region->blockCount;
+		state->memUsed = region->memUsed;
+		state->peakUsed = region->peakUsed;
+		memcpy(state->slabs, region->slabs, sizeof(RegionSlab*) * SLAB_CLASS_COUNT);
+	}
+
+	bool region_restoreState(MemoryRegion* region, const MemoryRegionState* state)
+	{
+		if (state->generation != region->generation || state->blockCount > region->blockCount)
+		{
+			return false;
+		}
+		// Blocks allocated after the state was captured are not used by it.
+		for (size_t b = state->blockCount; b < region->blockCount; b++)
+		{
+			resetBlock(region, region->memBlocks[b]);
+		}
+		region->memUsed = state->memUsed;
+		region->peakUsed = state->peakUsed;
+		memcpy(region->slabs, state->slabs, sizeof(RegionSlab*) * SLAB_CLASS_COUNT);
+		if (isTracing(region))
+		{
+			trace_clear(region);
+		}
+		VERIFY_MEMORY();
+		return true;
+	}
+
+	u8* region_getBlockMemory(MemoryRegion* region, size_t blockIndex, size_t* size)
+	{
+		assert(blockIndex < region->blockCount);
+		*size = sizeof(MemoryBlock) + region->blockSize;
+		return (u8*)region->memBlocks[blockIndex];
+	}
+
+	void region_getUsedPages(MemoryRegion* region, size_t blockIndex, u32 pageSize, std::vector<u8>& pageUsed)
+	{
+		assert(blockIndex < region->blockCount && pageSize);
+		const size_t memSize = sizeof(MemoryBlock) + region->blockSize;
+		pageUsed.assign((memSize + pageSize - 1) / pageSize, 0);
+
+		// The block header, the allocation headers and the allocations.
+		// Only the header of a free range is used, the rest of the range can hold anything.
+		MemoryBlock* block = region->memBlocks[blockIndex];
+		size_t offset = sizeof(MemoryBlock);
+		size_t usedStart = 0, usedEnd = sizeof(MemoryBlock);
+		for (u32 a = 0; a < block->count; a++)
+		{
+			const RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + offset);
+			const size_t end = offset + (header->free ? sizeof(AllocHeaderFree) : header->size);
+			if (offset > usedEnd)
+			{
+				for (size_t p = usedStart / pageSize; p <= (usedEnd - 1) / pageSize; p++) { pageUsed[p] = 1; }
+				usedStart = offset;
+			}
+			usedEnd = end;
+			offset += header->size;
+		}
+		for (size_t p = usedStart / pageSize; p <= (usedEnd - 1) / pageSize; p++) { pageUsed[p] = 1; }
+	}
+
 	bool region_serializeToDisk(MemoryRegion* region, FileStream* file)
 	{
 		if (!region || !file || !file->isOpen())
@@ -531,13 +1091,27 @@ namespace TFE_Memory
 		if (!region)
 		{
 			region = (MemoryRegion*)malloc(sizeof(MemoryRegion));
-			region->blockArrCapacity = 0;
+			if (region)
+			{
+				region->blockArrCapacity = 0;
+				region->useSlabs = true;
+				region->generation = 0;
+				region->trace = nullptr;
+			}
 		}
 		if (!region)
 		{
 			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Failed to allocate region.");
 			return nullptr;
 		}
+		// The slab lists and usage are rebuilt from the restored blocks.
+		memset(region->slabs, 0, sizeof(RegionSlab*) * SLAB_CLASS_COUNT);
+		region->memUsed = 0;
+		region->generation++;
+		if (isTracing(region))
+		{
+			trace_clear(region);
+		}
 
 		size_t blockAllocStart = 0;
 		file->readBuffer(region->name, 32);
@@ -641,11 +1215,21 @@ namespace TFE_Memory
 				else
 				{
 					file->readBuffer((u8*)header + SHARED_HEADER_SIZE, header->size - SHARED_HEADER_SIZE);
+					header->blockIndex = u8(b);
+					header->tag = c_allocTag;
+					region->memUsed += header->size;
+
+					RegionSlab* slab = (RegionSlab*)(header + 1);
+					if (header->slab && slab->usedCount < slab->slotCount)
+					{
+						slab_link(region, slab);
+					}
 				}
 
 				memPtr += header->size;
 			}
 		}
+		region->peakUsed = region->memUsed;
 
 		return region;
 	}
@@ -722,6 +1306,19 @@ namespace TFE_Memory
 		}
 	}
 
+	// Make the whole block a single free range.
+	void resetBlock(MemoryRegion* region, MemoryBlock* block)
+	{
+		block->sizeFree = u32(region->blockSize);
+		block->count = 1;
+
+		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
+		header->size = block->sizeFree;
+		header->free = 0;
+		memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
+		insertBlockIntoFreelist(block, header);
+	}
+
 	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header)
 	{
 		AllocHeaderFree* freeNext = (AllocHeaderFree*)header;
@@ -729,8 +1326,8 @@ namespace TFE_Memory
 		s32 bin = getBinFromSize(header->size);
 		freeNext->free = 1;
 		freeNext->bin = bin;
-		freeNext->pad8[0] = 0;
-		freeNext->pad8[1] = 0;
+		freeNext->blockIndex = 0;
+		freeNext->slab = 0;
 		if (!block->freeListBins[bin])
 		{
 			block->freeListBins[bin] = freeNext;
@@ -782,16 +1379,7 @@ namespace TFE_Memory
 		region->blockCount++;
 		TFE_System::logWrite(LOG_MSG, "MemoryRegion", "Allocated new memory block in region '%s' - new size is %u blocks, total size is '%u'", region->name, region->blockCount, region->blockSize * region->blockCount);
 
-		MemoryBlock* block = region->memBlocks[blockIndex];
-		block->sizeFree = u32(region->blockSize);
-		block->count = 1;
-
-		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
-		header->size = block->sizeFree;
-		header->free = 0;
-		memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
-		insertBlockIntoFreelist(block, header);
-
+		resetBlock(region, region->memBlocks[blockIndex]);
 		return true;
 	}
 
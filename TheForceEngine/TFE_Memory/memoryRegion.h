@@ -2,6 +2,10 @@
 //////////////////////////////////////////////////////////////////////
 // General purpose memory allocator which acts as a region of
 // memory which can be quickly cleared.
+//
+// Small allocations are served from fixed size slots in slabs, which
+// are themselves allocated from the region. Every allocation records
+// its owner, so freeing memory does not need to search the blocks.
 //////////////////////////////////////////////////////////////////////
 #include <TFE_System/types.h>
 #include <TFE_FileSystem/filestream.h>
@@ -9,10 +13,59 @@
 #include <string>
 
 struct MemoryRegion;
+struct RegionSlab;
 typedef u32 RelativePointer;
 
 #define NULL_RELATIVE_POINTER 0
 
+enum MemoryRegionConstants
+{
+	REGION_BIN_COUNT = 6,			// Free-list bins in each block.
+	REGION_SLAB_CLASS_COUNT = 6,	// Slab size classes.
+};
+
+struct MemoryRegionStats
+{
+	size_t capacity;
+	size_t used;				// Bytes allocated from the blocks, including headers and slabs.
+	size_t peakUsed;			// Highest 'used' since the region was created or cleared.
+	size_t freeBytes;
+	size_t largestFree;			// The largest free range in any block.
+	f32    fragmentation;		// 1 - largestFree / freeBytes, 0 means all free memory is in one range.
+	u32    allocCount;			// Live allocations outside of the slabs.
+
+	// Free ranges per bin.
+	u32    binFreeCount[REGION_BIN_COUNT];
+	size_t binFreeBytes[REGION_BIN_COUNT];
+
+	// Slabs per size class.
+	u32    slabSlotSize[REGION_SLAB_CLASS_COUNT];	// Largest allocation that fits in the class.
+	u32    slabCount[REGION_SLAB_CLASS_COUNT];
+	u32    slabSlotsUsed[REGION_SLAB_CLASS_COUNT];
+	u32    slabSlotsFree[REGION_SLAB_CLASS_COUNT];
+};
+
+// The allocator state held outside of the blocks, see region_getState().
+struct MemoryRegionState
+{
+	u32    generation;
+	size_t blockCount;
+	size_t memUsed;
+	size_t peakUsed;
+	RegionSlab* slabs[REGION_SLAB_CLASS_COUNT];
+};
+
+struct MemoryRegionBenchmark
+{
+	size_t opCount;			// Operations in the trace.
+	s32    runCount;
+	f64    mallocTime;		// Total time to replay the trace using malloc/realloc/free.
+	f64    regionTime;		// Total time to replay the trace in a region without slabs.
+	f64    slabTime;		// Total time to replay the trace in a region with slabs.
+	size_t regionPeak;		// Peak memory used by the region without slabs.
+	size_t slabPeak;		// Peak memory used by the region with slabs.
+};
+
 namespace TFE_Memory
 {
 	MemoryRegion* region_create(const char* name, size_t blockSize, size_t maxSize = 0u);
@@ -26,6 +79,7 @@ namespace TFE_Memory
 	size_t region_getMemoryUsed(MemoryRegion* region);
 	size_t region_getMemoryCapacity(MemoryRegion* region);
 	void region_getBlockInfo(MemoryRegion* region, size_t* blockCount, size_t* blockSize);
+	void region_getStats(MemoryRegion* region, MemoryRegionStats* stats);
 
 	RelativePointer region_getRelativePointer(MemoryRegion* region, void* ptr);
 	void* region_getRealPointer(MemoryRegion* region, RelativePointer ptr);
@@ -36,5 +90,24 @@ namespace TFE_Memory
 	// otherwise it will attempt to reuse the existing region.
 	MemoryRegion* region_restoreFromDisk(MemoryRegion* region, FileStream* file);
 
+	// In-place snapshots: the block memory is copied as-is and later written back to the same blocks,
+	// so pointers into the region stay valid. Together with the block memory, the state restores the region
+	// exactly. The state cannot be restored once the region has been cleared or restored from disk.
+	void region_getState(MemoryRegion* region, MemoryRegionState* state);
+	bool region_restoreState(MemoryRegion* region, const MemoryRegionState* state);
+	// Raw memory of a block, including the block header.
+	u8*  region_getBlockMemory(MemoryRegion* region, size_t blockIndex, size_t* size);
+	// Mark the pages of the block memory that hold allocator state or allocations.
+	// The contents of the other pages do not matter to the region.
+	void region_getUsedPages(MemoryRegion* region, size_t blockIndex, u32 pageSize, std::vector<u8>& pageUsed);
+
+	// Record the alloc, realloc, free and clear calls made on the region until region_endTrace() is called.
+	void region_beginTrace(MemoryRegion* region);
+	void region_endTrace(MemoryRegion* region);
+	size_t region_getTraceLength(MemoryRegion* region);
+	// Replay the recorded trace 'runCount' times with malloc, and in new regions with and without slabs.
+	// Returns false if the region has no trace.
+	bool region_benchmarkTrace(MemoryRegion* region, s32 runCount, MemoryRegionBenchmark* result);
+
 	void region_test();
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include <TFE_RenderBackend/indexBuffer.h>
+
+IndexBuffer::~IndexBuffer()
+{
+	destroy();
+}
+
+bool IndexBuffer::create(u32 count, u32 stride, bool dynamic, void* initData)
+{
+	m_stride = stride;
+	m_count = count;
+	m_size = count * stride;
+	m_dynamic = dynamic;
+	return true;
+}
+
+void IndexBuffer::destroy()
+{
+	m_count = 0;
+	m_size = 0;
+}
+
+void IndexBuffer::update(const void* buffer, size_t size)
+{
+}
+
+u32 IndexBuffer::bind() const
+{
+	return m_stride;
+}
+
+void IndexBuffer::unbind() const
+{
+}
@@ -0,0 +1,542 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Null render backend.
+// A CPU only implementation of the render backend that does not require OpenGL or a display.
+// The 8-bit virtual display is resolved to RGBA in memory, using the current palette, during swap().
+// GPU resources are created but hold no data and GPU draw calls are ignored, so only the software
+// renderers produce output.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <TFE_RenderBackend/renderBackend.h>
+#include <TFE_RenderBackend/dynamicTexture.h>
+#include <TFE_RenderBackend/textureGpu.h>
+#include <TFE_Settings/settings.h>
+#include <TFE_Ui/ui.h>
+#include <TFE_Asset/imageAsset.h>
+#include <TFE_System/profiler.h>
+#include <SDL.h>
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace TFE_RenderBackend
+{
+	static const f32 c_tallScreenThreshold = 1.32f;	// 4:3 + epsilon.
+
+	static char s_screenshotPath[TFE_MAX_PATH];
+	static bool s_screenshotQueued = false;
+
+	static WindowState m_windowState;
+	static SDL_Window* m_window = nullptr;
+	static bool s_vsync = false;
+
+	static u32 s_paletteCpu[256];
+	static TextureGpu* s_paletteTexture = nullptr;
+
+	static u32 s_virtualWidth, s_virtualHeight;
+	static u32 s_virtualWidthUi;
+	static u32 s_virtualWidth3d;
+	static bool s_widescreen = false;
+	static bool s_asyncFrameBuffer = false;
+	static bool s_gpuColorConvert = false;
+	static DisplayMode s_displayMode;
+	static u32 s_clearColor = 0xff000000;
+
+	// The last virtual display update, either 8-bit or 32-bit.
+	static std::vector<u8> s_virtualBuffer;
+	static bool s_virtualBufferIndexed = true;
+	// The resolved virtual display and the final "screen".
+	static std::vector<u32> s_virtualRgba;
+	static std::vector<u32> s_screen;
+
+	static std::vector<SDL_Rect> s_displayBounds;
+
+	void resolveVirtualDisplay();
+	void drawVirtualDisplay();
+	void clearScreen();
+	u32  packColor(const f32* color);
+
+	bool init(const WindowState& state)
+	{
+		m_windowState = state;
+		s_vsync = (state.flags & WINFLAG_VSYNC) != 0;
+
+		// A hidden window is still created for input and the system UI.
+		m_window = SDL_CreateWindow(state.name, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, state.width, state.height, SDL_WINDOW_HIDDEN);
+		if (!m_window)
+		{
+			TFE_System::logWrite(LOG_ERROR, "RenderBackend", "Cannot create window: %s", SDL_GetError());
+			return false;
+		}
+		TFE_System::logWrite(LOG_MSG, "RenderBackend", "Using the null render backend, output is %u x %u.", state.width, state.height);
+		TFE_Ui::init(m_window, nullptr, 100);
+
+		s_paletteTexture = new TextureGpu();
+		s_paletteTexture->create(256, 1);
+		memset(s_paletteCpu, 0, sizeof(u32) * 256);
+
+		s_screen.resize(m_windowState.width * m_windowState.height);
+		clearScreen();
+		return true;
+	}
+
+	void destroy()
+	{
+		TFE_Ui::shutdown();
+
+		delete s_paletteTexture;
+		s_paletteTexture = nullptr;
+		SDL_DestroyWindow(m_window);
+		m_window = nullptr;
+
+		s_virtualBuffer.clear();
+		s_virtualRgba.clear();
+		s_screen.clear();
+	}
+
+	bool getVsyncEnabled()
+	{
+		return s_vsync;
+	}
+
+	void enableVsync(bool enable)
+	{
+		s_vsync = enable;
+	}
+
+	void setClearColor(const f32* color)
+	{
+		s_clearColor = packColor(color);
+	}
+
+	void swap(bool blitVirtualDisplay)
+	{
+		if (blitVirtualDisplay) { drawVirtualDisplay(); }
+		else { clearScreen(); }
+
+		TFE_ZONE_BEGIN(systemUi, "System UI");
+		TFE_Ui::render();
+		TFE_ZONE_END(systemUi);
+
+		if (s_screenshotQueued)
+		{
+			s_screenshotQueued = false;
+			TFE_Image::writeImage(s_screenshotPath, m_windowState.width, m_windowState.height, s_screen.data());
+		}
+	}
+
+	void captureScreenToMemory(u32* mem)
+	{
+		memcpy(mem, s_screen.data(), s_screen.size() * sizeof(u32));
+	}
+
+	void queueScreenshot(const char* screenshotPath)
+	{
+		strcpy(s_screenshotPath, screenshotPath);
+		s_screenshotQueued = true;
+	}
+
+	void startGifRecording(const char* path)
+	{
+		TFE_System::logWrite(LOG_WARNING, "RenderBackend", "GIF recording is not supported by the null render backend.");
+	}
+
+	void stopGifRecording()
+	{
+	}
+
+	void updateSettings()
+	{
+	}
+
+	void resize(s32 width, s32 height)
+	{
+		TFE_Settings_Window* windowSettings = TFE_Settings::getWindowSettings();
+
+		m_windowState.width = width;
+		m_windowState.height = height;
+
+		windowSettings->width = width;
+		windowSettings->height = height;
+		if (!(m_windowState.flags & WINFLAG_FULLSCREEN))
+		{
+			m_windowState.baseWindowWidth = width;
+			m_windowState.baseWindowHeight = height;
+
+			windowSettings->baseWidth = width;
+			windowSettings->baseHeight = height;
+		}
+		s_screen.resize(width * height);
+		clearScreen();
+	}
+
+	void enumerateDisplays()
+	{
+		// Get the displays and their bounds.
+		s32 displayCount = SDL_GetNumVideoDisplays();
+		s_displayBounds.resize(std::max(displayCount, 0));
+		for (s32 i = 0; i < displayCount; i++)
+		{
+			SDL_GetDisplayBounds(i, &s_displayBounds[i]);
+		}
+	}
+
+	s32 getDisplayCount()
+	{
+		enumerateDisplays();
+		return (s32)s_displayBounds.size();
+	}
+
+	s32 getDisplayIndex(s32 x, s32 y)
+	{
+		enumerateDisplays();
+
+		s32 displayIndex = -1;
+		for (size_t i = 0; i < s_displayBounds.size(); i++)
+		{
+			if (x >= s_displayBounds[i].x && x < s_displayBounds[i].x + s_displayBounds[i].w &&
+				y >= s_displayBounds[i].y && y < s_displayBounds[i].y + s_displayBounds[i].h)
+			{
+				displayIndex = s32(i);
+				break;
+			}
+		}
+		return displayIndex;
+	}
+
+	bool getDisplayMonitorInfo(s32 displayIndex, MonitorInfo* monitorInfo)
+	{
+		enumerateDisplays();
+		if (displayIndex < 0 || displayIndex >= (s32)s_displayBounds.size())
+		{
+			return false;
+		}
+
+		monitorInfo->x = s_displayBounds[displayIndex].x;
+		monitorInfo->y = s_displayBounds[displayIndex].y;
+		monitorInfo->w = s_displayBounds[displayIndex].w;
+		monitorInfo->h = s_displayBounds[displayIndex].h;
+		return true;
+	}
+
+	f32 getDisplayRefreshRate()
+	{
+		return m_windowState.refreshRate;
+	}
+
+	void getCurrentMonitorInfo(MonitorInfo* monitorInfo)
+	{
+		if (!getDisplayMonitorInfo(0, monitorInfo))
+		{
+			*monitorInfo = { 0, 0, (s32)m_windowState.width, (s32)m_windowState.height };
+		}
+	}
+
+	void enableFullscreen(bool enable)
+	{
+		TFE_Settings::getWindowSettings()->fullscreen = enable;
+		if (enable) { m_windowState.flags |= WINFLAG_FULLSCREEN; }
+		else { m_windowState.flags &= ~WINFLAG_FULLSCREEN; }
+	}
+
+	void clearWindow()
+	{
+		clearScreen();
+	}
+
+	void getDisplayInfo(DisplayInfo* displayInfo)
+	{
+		assert(displayInfo);
+
+		displayInfo->width = m_windowState.width;
+		displayInfo->height = m_windowState.height;
+		displayInfo->refreshRate = (m_windowState.flags & WINFLAG_VSYNC) != 0 ? m_windowState.refreshRate : 0.0f;
+	}
+
+	bool createVirtualDisplay(const VirtualDisplayInfo& vdispInfo)
+	{
+		s_virtualWidth = vdispInfo.width;
+		s_virtualHeight = vdispInfo.height;
+		s_virtualWidthUi = vdispInfo.widthUi;
+		s_virtualWidth3d = vdispInfo.width3d;
+		s_displayMode = vdispInfo.mode;
+		s_widescreen = (vdispInfo.flags & VDISP_WIDESCREEN) != 0;
+		s_asyncFrameBuffer = (vdispInfo.flags & VDISP_ASYNC_FRAMEBUFFER) != 0;
+		s_gpuColorConvert = (vdispInfo.flags & VDISP_GPU_COLOR_CONVERT) != 0;
+
+		s_virtualBuffer.assign(s_virtualWidth * s_virtualHeight, 0);
+		s_virtualBufferIndexed = true;
+		s_virtualRgba.resize(s_virtualWidth * s_virtualHeight);
+		return true;
+	}
+
+	u32 getVirtualDisplayWidth2D()
+	{
+		return s_virtualWidthUi;
+	}
+
+	u32 getVirtualDisplayWidth3D()
+	{
+		return s_virtualWidth3d;
+	}
+
+	u32 getVirtualDisplayHeight()
+	{
+		return s_virtualHeight;
+	}
+
+	u32 getVirtualDisplayOffset2D()
+	{
+		if (s_virtualWidth <= s_virtualWidthUi) { return 0; }
+		return (s_virtualWidth - s_virtualWidthUi) >> 1;
+	}
+
+	u32 getVirtualDisplayOffset3D()
+	{
+		if (s_virtualWidth <= s_virtualWidth3d) { return 0; }
+		return (s_virtualWidth - s_virtualWidth3d) >> 1;
+	}
+
+	void* getVirtualDisplayGpuPtr()
+	{
+		return nullptr;
+	}
+
+	bool getWidescreen()
+	{
+		return s_widescreen;
+	}
+
+	bool getFrameBufferAsync()
+	{
+		return s_asyncFrameBuffer;
+	}
+
+	bool getGPUColorConvert()
+	{
+		return s_gpuColorConvert;
+	}
+
+	void updateVirtualDisplay(const void* buffer, size_t size)
+	{
+		TFE_ZONE("Update Virtual Display");
+		// The buffer is either 8-bit (resolved using the palette) or already 32-bit color.
+		s_virtualBufferIndexed = size < size_t(s_virtualWidth * s_virtualHeight * 4);
+		s_virtualBuffer.resize(size);
+		memcpy(s_virtualBuffer.data(), buffer, size);
+	}
+
+	void bindVirtualDisplay()
+	{
+	}
+
+	void clearVirtualDisplay(f32* color, bool clearColor)
+	{
+	}
+
+	void copyToVirtualDisplay(RenderTargetHandle src)
+	{
+	}
+
+	void copyBackbufferToRenderTarget(RenderTargetHandle dst)
+	{
+	}
+
+	void setPalette(const u32* palette)
+	{
+		memcpy(s_paletteCpu, palette, 256 * sizeof(u32));
+	}
+
+	const u32* getPalette()
+	{
+		return s_paletteCpu;
+	}
+
+	const TextureGpu* getPaletteTexture()
+	{
+		return s_paletteTexture;
+	}
+
+	void setColorCorrection(bool enabled, const ColorCorrection* color/* = nullptr*/, bool bloomChanged/* = false*/)
+	{
+		// Color correction is a GPU post effect.
+	}
+
+	void bloomPostEnable(bool enable)
+	{
+	}
+
+	// Render targets only exist to satisfy the interface, they are backed by empty textures.
+	RenderTargetHandle createRenderTarget(u32 width, u32 height, bool hasDepthBuffer)
+	{
+		TextureGpu* texture = new TextureGpu();
+		texture->create(width, height);
+		return RenderTargetHandle(texture);
+	}
+
+	void freeRenderTarget(RenderTargetHandle handle)
+	{
+		delete (TextureGpu*)handle;
+	}
+
+	void bindRenderTarget(RenderTargetHandle handle)
+	{
+	}
+
+	void clearRenderTarget(RenderTargetHandle handle, const f32* clearColor, f32 clearDepth)
+	{
+	}
+
+	void clearRenderTargetDepth(RenderTargetHandle handle, f32 clearDepth)
+	{
+	}
+
+	void copyRenderTarget(RenderTargetHandle dst, RenderTargetHandle src)
+	{
+	}
+
+	void unbindRenderTarget()
+	{
+	}
+
+	void setViewport(s32 x, s32 y, s32 w, s32 h)
+	{
+	}
+
+	void setScissorRect(bool enable, s32 x, s32 y, s32 w, s32 h)
+	{
+	}
+
+	const TextureGpu* getRenderTargetTexture(RenderTargetHandle rtHandle)
+	{
+		return (const TextureGpu*)rtHandle;
+	}
+
+	void getRenderTargetDim(RenderTargetHandle rtHandle, u32* width, u32* height)
+	{
+		const TextureGpu* texture = (const TextureGpu*)rtHandle;
+		*width = texture->getWidth();
+		*height = texture->getHeight();
+	}
+
+	TextureGpu* createTexture(u32 width, u32 height, TexFormat format)
+	{
+		TextureGpu* texture = new TextureGpu();
+		texture->create(width, height, format);
+		return texture;
+	}
+
+	TextureGpu* createTextureArray(u32 width, u32 height, u32 layers, u32 channels, u32 mipCount)
+	{
+		TextureGpu* texture = new TextureGpu();
+		texture->createArray(width, height, layers, channels, mipCount);
+		return texture;
+	}
+
+	TextureGpu* createTexture(u32 width, u32 height, const u32* data, MagFilter magFilter)
+	{
+		TextureGpu* texture = new TextureGpu();
+		texture->createWithData(width, height, data, magFilter);
+		return texture;
+	}
+
+	void freeTexture(TextureGpu* texture)
+	{
+		delete texture;
+	}
+
+	void getTextureDim(TextureGpu* texture, u32* width, u32* height)
+	{
+		*width = texture->getWidth();
+		*height = texture->getHeight();
+	}
+
+	void* getGpuPtr(const TextureGpu* texture)
+	{
+		return nullptr;
+	}
+
+	void drawIndexedTriangles(u32 triCount, u32 indexStride, u32 indexStart)
+	{
+	}
+
+	void drawLines(u32 lineCount)
+	{
+	}
+
+	/////////////////////////////////////////////
+	// Internal
+	/////////////////////////////////////////////
+	u32 packColor(const f32* color)
+	{
+		const u32 r = u32(std::min(std::max(color[0], 0.0f), 1.0f) * 255.0f);
+		const u32 g = u32(std::min(std::max(color[1], 0.0f), 1.0f) * 255.0f);
+		const u32 b = u32(std::min(std::max(color[2], 0.0f), 1.0f) * 255.0f);
+		const u32 a = u32(std::min(std::max(color[3], 0.0f), 1.0f) * 255.0f);
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	void clearScreen()
+	{
+		std::fill(s_screen.begin(), s_screen.end(), s_clearColor);
+	}
+
+	void resolveVirtualDisplay()
+	{
+		const u32 pixelCount = s_virtualWidth * s_virtualHeight;
+		if (s_virtualBufferIndexed)
+		{
+			const u8* src = s_virtualBuffer.data();
+			const u32 count = std::min(pixelCount, (u32)s_virtualBuffer.size());
+			for (u32 i = 0; i < count; i++)
+			{
+				s_virtualRgba[i] = s_paletteCpu[src[i]] | 0xff000000;
+			}
+		}
+		else
+		{
+			memcpy(s_virtualRgba.data(), s_virtualBuffer.data(), pixelCount * sizeof(u32));
+		}
+	}
+
+	// Scale the virtual display to the screen, matching the aspect correction of the OpenGL backend.
+	void drawVirtualDisplay()
+	{
+		TFE_ZONE("Draw Virtual Display");
+		if (!s_virtualWidth || !s_virtualHeight) { return; }
+		resolveVirtualDisplay();
+
+		s32 x = 0, y = 0;
+		s32 w = m_windowState.width;
+		s32 h = m_windowState.height;
+		const f32 aspect = f32(w) / f32(h);
+		if (s_displayMode == DMODE_ASPECT_CORRECT && aspect > c_tallScreenThreshold && !s_widescreen)
+		{
+			// pillarbox
+			w = 4 * m_windowState.height / 3;
+			x = std::max(0, ((s32)m_windowState.width - w) / 2);
+		}
+		else if (s_displayMode == DMODE_ASPECT_CORRECT && (!s_widescreen || aspect <= c_tallScreenThreshold))
+		{
+			// letterbox
+			h = 3 * m_windowState.width / 4;
+			y = std::max(0, ((s32)m_windowState.height - h) / 2);
+		}
+		if (s_displayMode != DMODE_STRETCH)
+		{
+			clearScreen();
+		}
+
+		const s32 x1 = std::min(x + w, (s32)m_windowState.width);
+		const s32 y1 = std::min(y + h, (s32)m_windowState.height);
+		for (s32 sy = y; sy < y1; sy++)
+		{
+			const u32 vy = u32(sy - y) * s_virtualHeight / u32(h);
+			const u32* srcRow = &s_virtualRgba[vy * s_virtualWidth];
+			u32* dstRow = &s_screen[sy * m_windowState.width];
+			for (s32 sx = x; sx < x1; sx++)
+			{
+				dstRow[sx] = srcRow[u32(sx - x) * s_virtualWidth / u32(w)];
+			}
+		}
+	}
+}  // namespace
@@ -0,0 +1,40 @@
+#include <TFE_RenderBackend/renderState.h>
+
+namespace TFE_RenderState
+{
+	void clear()
+	{
+	}
+
+	void setStateEnable(bool enable, u32 stateFlags)
+	{
+	}
+
+	void setBlendMode(StateBlendFactor srcFactor, StateBlendFactor dstFactor, StateBlendFunc func)
+	{
+	}
+
+	void setDepthFunction(ComparisonFunction func)
+	{
+	}
+
+	void setStencilFunction(ComparisonFunction func, s32 ref, u32 mask)
+	{
+	}
+
+	void setStencilOp(StencilOp stencilFail, StencilOp depthFail, StencilOp depthStencilPass)
+	{
+	}
+
+	void setColorMask(u32 colorMask)
+	{
+	}
+
+	void setDepthBias(f32 factor, f32 bias)
+	{
+	}
+
+	void enableClipPlanes(s32 count)
+	{
+	}
+};
@@ -0,0 +1,41 @@
+#include <TFE_RenderBackend/shaderBuffer.h>
+
+ShaderBuffer::~ShaderBuffer()
+{
+	destroy();
+}
+
+bool ShaderBuffer::create(u32 count, const ShaderBufferDef& bufferDef, bool dynamic, void* initData)
+{
+	m_bufferDef = bufferDef;
+	m_stride = bufferDef.channelCount * bufferDef.channelSize;
+	m_count = count;
+	m_size = count * m_stride;
+	m_dynamic = dynamic;
+	m_gpuHandle[0] = 0;
+	m_gpuHandle[1] = 0;
+	m_initialized = true;
+	return true;
+}
+
+void ShaderBuffer::destroy()
+{
+	m_initialized = false;
+}
+
+void ShaderBuffer::update(const void* buffer, size_t size)
+{
+}
+
+void ShaderBuffer::bind(s32 bindPoint) const
+{
+}
+
+void ShaderBuffer::unbind(s32 bindPoint) const
+{
+}
+
+s32 ShaderBuffer::getMaxSize()
+{
+	return 128 * 1024 * 1024;
+}
@@ -0,0 +1,62 @@
+#include <TFE_RenderBackend/textureGpu.h>
+#include <cstring>
+
+// Null backend: textures only track their dimensions, no data is stored.
+static const u32 c_channelCount[] = { 4, 1, 4, 1 };
+static const u32 c_bytesPerChannel[] = { 1, 1, 2, 2 };
+
+TextureGpu::~TextureGpu()
+{
+}
+
+bool TextureGpu::create(u32 width, u32 height, TexFormat format, bool hasMipmaps, MagFilter magFilter)
+{
+	m_width = width;
+	m_height = height;
+	m_channels = c_channelCount[format];
+	m_bytesPerChannel = c_bytesPerChannel[format];
+	m_layers = 1;
+	return true;
+}
+
+bool TextureGpu::createArray(u32 width, u32 height, u32 layers, u32 channels, u32 mipCount)
+{
+	m_width = width;
+	m_height = height;
+	m_channels = channels;
+	m_bytesPerChannel = 1;
+	m_layers = layers;
+	m_mipCount = mipCount;
+	return true;
+}
+
+bool TextureGpu::createWithData(u32 width, u32 height, const void* buffer, MagFilter magFilter)
+{
+	return create(width, height, TEX_RGBA8, false, magFilter);
+}
+
+bool TextureGpu::update(const void* buffer, size_t size, s32 layer, s32 mipLevel)
+{
+	return true;
+}
+
+void TextureGpu::setFilter(MagFilter magFilter, MinFilter minFilter, bool isArray) const
+{
+}
+
+void TextureGpu::bind(u32 slot/* = 0*/) const
+{
+}
+
+void TextureGpu::clear(u32 slot/* = 0*/)
+{
+}
+
+void TextureGpu::clearSlots(u32 count, u32 start/* = 0*/)
+{
+}
+
+void TextureGpu::readCpu(u8* image)
+{
+	memset(image, 0, m_width * m_height * m_channels * m_bytesPerChannel);
+}
@@ -0,0 +1,34 @@
+#include <TFE_RenderBackend/vertexBuffer.h>
+
+VertexBuffer::~VertexBuffer()
+{
+	destroy();
+}
+
+bool VertexBuffer::create(u32 count, u32 stride, u32 attrCount, const AttributeMapping* attrMapping, bool dynamic, void* initData)
+{
+	m_stride = stride;
+	m_count = count;
+	m_size = count * stride;
+	m_attrCount = attrCount;
+	m_dynamic = dynamic;
+	return true;
+}
+
+void VertexBuffer::destroy()
+{
+	m_count = 0;
+	m_size = 0;
+}
+
+void VertexBuffer::update(const void* buffer, size_t size)
+{
+}
+
+void VertexBuffer::bind() const
+{
+}
+
+void VertexBuffer::unbind() const
+{
+}
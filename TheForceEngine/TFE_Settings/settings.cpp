@@ -405,6 +405,7 @@ namespace TFE_Settings
 		writeKeyValue_Bool(settings, "gameExitsToMenu",   s_systemSettings.gameQuitExitsToMenu);
 		writeKeyValue_Bool(settings, "returnToModLoader", s_systemSettings.returnToModLoader);
 		writeKeyValue_Float(settings, "gifRecordingFramerate", s_systemSettings.gifRecordingFramerate);
+		writeKeyValue_Int(settings, "recordingFormat", s_systemSettings.recordingFormat);
 	}
 
 	void writeA11ySettings(FileStream& settings)
@@ -864,6 +865,10 @@ namespace TFE_Settings
 		{
 			s_systemSettings.gifRecordingFramerate = parseFloat(value);
 		}
+		else if (strcasecmp("recordingFormat", key) == 0)
+		{
+			s_systemSettings.recordingFormat = std::min(std::max(parseInt(value), 0), 1);
+		}
 	}
 	
 	void parseA11ySettings(const char* key, const char* value)
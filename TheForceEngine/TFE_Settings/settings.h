@@ -212,6 +212,7 @@ struct TFE_Settings_System
 	bool gameQuitExitsToMenu = true;	// Quitting from the game returns to the main menu instead.
 	bool returnToModLoader = true;		// Return to the Mod Loader if running a mod.
 	f32 gifRecordingFramerate = 18;		// Used with GIF recording (Alt-F2)
+	s32 recordingFormat = 0;			// VideoFormat used when recording the software renderer framebuffer (Alt-F2): 0 = GIF, 1 = Y4M.
 };
 
 struct TFE_Settings_A11y
@@ -6,7 +6,8 @@
 
 namespace
 {
-	static char s_line[4096];
+	// Thread local so parsers can be used on worker threads (such as the mod scanner).
+	static thread_local char s_line[4096];
 	bool isWhitespace(const char c)
 	{
 		if (c > 32 && c < 127)
@@ -26,13 +27,33 @@ namespace
 	}
 }
 
-TFE_Parser::TFE_Parser() : m_buffer(nullptr), m_bufferLen(0u), m_enableBlockComments(false), m_blockComment(false), m_enableColonSeperator(false), m_convertToUppercase(false) {}
+TFE_Parser::TFE_Parser() : m_buffer(nullptr), m_bufferLen(0u), m_enableBlockComments(false), m_blockComment(false), m_enableColonSeperator(false), m_convertToUppercase(false), m_lineTable(false) {}
 TFE_Parser::~TFE_Parser() {}
 
 void TFE_Parser::init(const char* buffer, size_t len)
 {
 	m_buffer = buffer;
 	m_bufferLen = len;
+	m_lineTable = false;
+}
+
+void TFE_Parser::initLineTable(const char* table, size_t len)
+{
+	m_buffer = table;
+	m_bufferLen = len;
+	m_lineTable = true;
+}
+
+void TFE_Parser::buildLineTable(std::vector<char>& table)
+{
+	table.clear();
+
+	size_t bufferPos = 0;
+	const char* line;
+	while ((line = readLine(bufferPos)) != nullptr)
+	{
+		table.insert(table.end(), line, line + strlen(line) + 1);
+	}
 }
 
 // Enable block comments of the form /*...*/
@@ -77,6 +98,18 @@ bool TFE_Parser::isComment(const char* buffer)
 const char* TFE_Parser::readLine(size_t& bufferPos, bool skipLeadingWhitespace, bool commentOnlyAtBeginning)
 {
 	if (bufferPos >= m_bufferLen || m_bufferLen < 1) { return nullptr; }
+	if (m_lineTable)
+	{
+		const char* line = m_buffer + bufferPos;
+		bufferPos += strlen(line) + 1;
+		if (skipLeadingWhitespace)
+		{
+			const char* content = line;
+			while (*content && isWhitespace(*content)) { content++; }
+			if (*content) { line = content; }
+		}
+		return line;
+	}
 
 	// Keep reading lines until either one has real content or we reach the end of the buffer.
 	bool lineHasContent = false;
@@ -17,6 +17,11 @@ public:
 	~TFE_Parser();
 
 	void init(const char* buffer, size_t len);
+	// Initialize from a line table built by buildLineTable(), readLine() then returns the stored lines directly.
+	// Note the table holds the lines as returned by readLine() with the default options.
+	void initLineTable(const char* table, size_t len);
+	// Read all of the lines from the buffer into a table of null terminated strings.
+	void buildLineTable(std::vector<char>& table);
 
 	// Enable block comments of the form /*...*/
 	void enableBlockComments();
@@ -44,6 +49,7 @@ private:
 	bool m_blockComment;
 	bool m_enableColonSeperator;
 	bool m_convertToUppercase;
+	bool m_lineTable;
 
 private:
 	bool isComment(const char* buffer);
@@ -1,36 +1,78 @@
 #include <cstring>
 
 #include "profiler.h"
+#include <TFE_FileSystem/filestream.h>
+#include <SDL_thread.h>
 #include <assert.h>
 #include <algorithm>
 #include <vector>
 #include <string>
 #include <map>
 
-// TODO: Support call "paths" - with seperate time per path.
-
 namespace TFE_Profiler
 {
 	#define ZONE_BUFFER_COUNT 2
 	#define MAX_ZONE_STACK 256
-	
+	#define MAX_ZONE_SITES 1024
+	#define MAX_PROFILE_THREADS 32
+	#define THREAD_EVENT_COUNT (1 << 17)	// Must be a power of 2.
+	#define FRAME_SITE 0
+
+	enum EventType
+	{
+		EVENT_BEGIN = 0,
+		EVENT_END,
+	};
+
+	// A zone site, one per TFE_ZONE() in the code.
+	struct ZoneSite
+	{
+		const char* name;
+		const char* func;
+		u32 lineNumber;
+	};
+
+	struct Event
+	{
+		u64 time;
+		u32 site;
+		u32 type;
+	};
+
+	// Each thread writes to its own ring of events, so recording never needs to lock.
+	// Slots are released when their thread exits and reused by later threads, keeping the event buffer.
+	// A slot released during a trace capture is not reused until the capture is written.
+	struct ThreadEvents
+	{
+		Event* events;
+		std::atomic<u64> writeCount;
+		std::atomic<u64> releaseTime;
+		atomic_u32 inUse;
+		SDL_threadID threadId;
+		char name[64];
+	};
+
+	// Releases the thread slot when the thread exits.
+	struct ThreadSlotGuard
+	{
+		ThreadEvents* thread = nullptr;
+		~ThreadSlotGuard();
+	};
+
+	// Zones aggregated by call path, built from the main thread events each frame.
 	struct Zone
 	{
-		u32  id;
-		u32  level = 0;
-		u32  parent = NULL_ZONE;
-		u64  path;
+		u32  site;
+		u32  level;
+		u32  parent;
 		u64  frame;
-		char name[64];
-		char func[64];
-		u32  lineNumber;
 
 		f64  timeInZone[ZONE_BUFFER_COUNT];
 		f64  timeInZoneAve;
 		f64  fractOfParentAve;
 
-		u32  child = NULL_ZONE;
-		u32  sibling = NULL_ZONE;
+		u32  child;
+		u32  sibling;
 	};
 
 	struct Counter
@@ -42,123 +84,159 @@ namespace TFE_Profiler
 		char name[64];
 	};
 
-	typedef std::map<std::string, u32> ZoneMap;
+	typedef std::map<std::string, u32> CounterMap;
 	typedef std::vector<Zone> ZoneList;
 	typedef std::vector<u32> SortedZoneList;
 	typedef std::vector<Counter> CounterList;
 
-	static ZoneMap  s_zoneMap;
+	static ZoneSite s_sites[MAX_ZONE_SITES] = { { "Frame", "", 0 } };
+	static atomic_u32 s_siteCount(1);
+	static std::atomic_flag s_siteLock = ATOMIC_FLAG_INIT;
+
+	static ThreadEvents s_threads[MAX_PROFILE_THREADS];
+	// The number of slots that have been used, slots below this count may be free for reuse.
+	static atomic_u32 s_threadCount(0);
+	static thread_local ThreadEvents* s_threadEvents = nullptr;
+	static thread_local ThreadSlotGuard s_threadSlotGuard;
+
 	static ZoneList s_zoneList;
 	static SortedZoneList s_sortedZoneList;
 	static SortedZoneList s_roots;
 
-	static ZoneMap  s_counterMap;
+	static CounterMap  s_counterMap;
 	static CounterList s_counterList;
 
 	static u64 s_frameBegin;
 	static f64 s_frameTime;
 	static u32 s_readBuffer = 0;
 	static u32 s_writeBuffer = 1;
-	static u32 s_level;
-	static u32 s_maxLevel;
-	static u32 s_zoneStack[MAX_ZONE_STACK];
 	static u64 s_currentFrame = 1;
-	static u64 s_currentPath;
-
-	void addZoneChild(u32 parentId, u32 zoneId)
+	// Only the thread that runs the frame is aggregated for the profiler view, other threads (such as audio) are only captured.
+	static ThreadEvents* s_frameThread = nullptr;
+	static u64 s_frameEventStart = 0;
+
+	// Trace capture.
+	static u32 s_captureFrames = 0;
+	// Read by registerThread() on any thread: the capture is active from beginCapture() until the trace is written,
+	// and s_captureBegin is 0 until the first captured frame begins.
+	static atomic_u32 s_captureActive(0);
+	static std::atomic<u64> s_captureBegin(0);
+	static char s_capturePath[TFE_MAX_PATH];
+
+	ThreadEvents* registerThread();
+	void aggregateFrameEvents(u64 start, u64 end);
+	void writeTrace(u64 beginTime, u64 endTime);
+
+	u32 registerZone(const char* name, const char* func, u32 lineNumber)
 	{
-		Zone& parent = s_zoneList[parentId];
-		Zone& zone = s_zoneList[zoneId];
-		// This has already been added.
-		if (zone.sibling != NULL_ZONE)
-		{
-			return;
-		}
+		while (s_siteLock.test_and_set(std::memory_order_acquire));
 
-		if (parent.child == zoneId)
+		u32 site = s_siteCount.load(std::memory_order_relaxed);
+		if (site < MAX_ZONE_SITES)
 		{
-			return;
-		}
-		else if (parent.child == NULL_ZONE)
-		{
-			parent.child = zoneId;
+			s_sites[site] = { name, func, lineNumber };
+			s_siteCount.store(site + 1, std::memory_order_release);
 		}
 		else
 		{
-			Zone* child = &s_zoneList[parent.child];
-			while (1)
-			{
-				if (child->sibling == zoneId)
-				{
-					return;
-				}
-				else if (child->sibling == NULL_ZONE)
-				{
-					child->sibling = zoneId;
-					break;
-				}
-				child = &s_zoneList[child->sibling];
-			};
+			// Too many sites, overflow zones are dropped.
+			site = NULL_ZONE;
 		}
+
+		s_siteLock.clear(std::memory_order_release);
+		return site;
 	}
 
-	u32 beginZone(const char* name, const char* func, u32 lineNumber)
+	inline void recordEvent(u32 site, u32 type)
 	{
-		ZoneMap::iterator iZone = s_zoneMap.find(name);
-		u32 id = 0;
+		if (site == NULL_ZONE) { return; }
 
-		if (iZone == s_zoneMap.end())
-		{
-			id = (u32)s_zoneList.size();
-
-			Zone zone;
-			zone.id = id;
-			zone.path = s_currentPath;
-			zone.timeInZone[s_readBuffer]  = 0;
-			zone.timeInZone[s_writeBuffer] = 0;
-			zone.timeInZoneAve = 0.0;
-			zone.fractOfParentAve = 0.0;
-			zone.frame = 0;
-			
-			s_zoneList.push_back(zone);
-			s_zoneMap[name] = id;
-		}
-		else
-		{
-			id = iZone->second;
-		}
+		ThreadEvents* thread = s_threadEvents ? s_threadEvents : registerThread();
+		if (!thread) { return; }
+
+		const u64 index = thread->writeCount.load(std::memory_order_relaxed);
+		Event* ev = &thread->events[index & (THREAD_EVENT_COUNT - 1)];
+		ev->time = TFE_System::getCurrentTimeInTicks();
+		ev->site = site;
+		ev->type = type;
+		thread->writeCount.store(index + 1, std::memory_order_release);
+	}
+
+	void beginZone(u32 site)
+	{
+		recordEvent(site, EVENT_BEGIN);
+	}
+
+	void endZone(u32 site)
+	{
+		recordEvent(site, EVENT_END);
+	}
 
-		Zone& zone = s_zoneList[id];
-		strcpy(zone.name, name);
-		strcpy(zone.func, func);
-		zone.lineNumber = lineNumber;
-		zone.level = s_level;
+	// Reusing a slot resets its ring, which must not drop events that the current capture still has to write.
+	bool canReuseSlot(const ThreadEvents* thread)
+	{
+		if (!thread->events || !s_captureActive.load()) { return true; }
+		const u64 captureBegin = s_captureBegin.load();
+		return captureBegin && thread->releaseTime.load() < captureBegin;
+	}
 
-		zone.parent = s_level > 0 ? s_zoneStack[s_level - 1] : NULL_ZONE;
-		if (zone.parent == NULL_ZONE)
+	ThreadEvents* registerThread()
+	{
+		// Take the first free slot, reusing the slots of threads that have exited.
+		u32 index = 0;
+		for (; index < MAX_PROFILE_THREADS; index++)
 		{
-			s_roots.push_back(id);
+			u32 expected = 0u;
+			if (!s_threads[index].inUse.compare_exchange_strong(expected, 1u, std::memory_order_acquire)) { continue; }
+			if (canReuseSlot(&s_threads[index])) { break; }
+			s_threads[index].inUse.store(0u, std::memory_order_release);
 		}
-		else
+		if (index >= MAX_PROFILE_THREADS) { return nullptr; }
+
+		ThreadEvents* thread = &s_threads[index];
+		if (!thread->events)
 		{
-			addZoneChild(zone.parent, zone.id);
+			thread->events = (Event*)malloc(sizeof(Event) * THREAD_EVENT_COUNT);
+			if (!thread->events)
+			{
+				thread->inUse.store(0u, std::memory_order_release);
+				return nullptr;
+			}
 		}
+		thread->writeCount.store(0);
+		thread->threadId = SDL_ThreadID();
+		sprintf(thread->name, "Thread %u", index);
 
-		s_zoneStack[s_level] = id;
-		s_level++;
+		u32 count = s_threadCount.load();
+		while (count < index + 1 && !s_threadCount.compare_exchange_weak(count, index + 1));
 
-		return id;
+		s_threadEvents = thread;
+		s_threadSlotGuard.thread = thread;
+		return thread;
 	}
 
-	void endZone(u32 id, u64 dt)
+	ThreadSlotGuard::~ThreadSlotGuard()
 	{
-		s_zoneList[id].timeInZone[s_writeBuffer] += TFE_System::convertFromTicksToSeconds(dt);
-		s_level--;
+		if (!thread) { return; }
+		// The event buffer is kept, the events may still be read by a trace and the next thread using the slot reuses it.
+		s_threadEvents = nullptr;
+		thread->releaseTime.store(TFE_System::getCurrentTimeInTicks());
+		thread->inUse.store(0u, std::memory_order_release);
+		thread = nullptr;
+	}
+
+	void setThreadName(const char* name)
+	{
+		ThreadEvents* thread = s_threadEvents ? s_threadEvents : registerThread();
+		if (thread && strcmp(thread->name, name) != 0)
+		{
+			strncpy(thread->name, name, 63);
+		}
 	}
 
 	void addCounter(const char* name, s32* counter)
 	{
-		ZoneMap::iterator iCounter = s_counterMap.find(name);
+		CounterMap::iterator iCounter = s_counterMap.find(name);
 		if (iCounter == s_counterMap.end())
 		{
 			const u32 id = (u32)s_counterList.size();
@@ -174,16 +252,36 @@ namespace TFE_Profiler
 		}
 	}
 
+	bool beginCapture(u32 frameCount, const char* path)
+	{
+		if (s_captureFrames || !frameCount) { return false; }
+		// Note that long captures may be truncated if they overflow the thread event rings.
+		s_captureFrames = frameCount;
+		s_captureBegin.store(0);
+		s_captureActive.store(1u);
+		strncpy(s_capturePath, path, TFE_MAX_PATH - 1);
+		s_capturePath[TFE_MAX_PATH - 1] = 0;
+		return true;
+	}
+
+	bool isCapturing()
+	{
+		return s_captureFrames != 0;
+	}
+
 	void frameBegin()
 	{
+		if (!s_frameThread)
+		{
+			setThreadName("Main");
+			s_frameThread = s_threadEvents;
+		}
 		std::swap(s_readBuffer, s_writeBuffer);
 		// Validate buffer indices.
 		assert(s_readBuffer < ZONE_BUFFER_COUNT && s_writeBuffer < ZONE_BUFFER_COUNT && s_readBuffer != s_writeBuffer);
 		s_readBuffer  %= ZONE_BUFFER_COUNT;
 		s_writeBuffer %= ZONE_BUFFER_COUNT;
 
-		s_level = 0;
-		s_maxLevel = 0;
 		s_roots.clear();
 
 		// Swap buffers, s_readBuffer is safe to read in the middle of the next frame.
@@ -202,36 +300,111 @@ namespace TFE_Profiler
 		}
 
 		s_frameBegin = TFE_System::getCurrentTimeInTicks();
+		if (s_captureFrames && !s_captureBegin.load())
+		{
+			s_captureBegin.store(s_frameBegin);
+		}
+		s_frameEventStart = s_frameThread ? s_frameThread->writeCount.load(std::memory_order_relaxed) : 0;
+		beginZone(FRAME_SITE);
 	}
 
 	void traverseZoneTree(u32 id)
 	{
-		if (id == NULL_ZONE) { return; }
-		Zone* zone = &s_zoneList[id];
-		// Make sure zones are only inserted once for now.
-		if (zone->frame != s_currentFrame)
+		while (id != NULL_ZONE)
 		{
-			s_sortedZoneList.push_back(id);
+			Zone* zone = &s_zoneList[id];
+			if (zone->frame == s_currentFrame)
+			{
+				s_sortedZoneList.push_back(id);
+				traverseZoneTree(zone->child);
+			}
+			id = zone->sibling;
 		}
-		zone->frame = s_currentFrame;
-		
-		while (zone->child != NULL_ZONE)
+	}
+
+	u32 findOrAddZone(u32 parent, u32 site, u32 level)
+	{
+		// Zones with the same parent and site share the same call path.
+		u32 lastChild = NULL_ZONE;
+		if (parent == NULL_ZONE)
 		{
-			traverseZoneTree(zone->child);
-			zone = &s_zoneList[zone->child];
+			for (size_t r = 0; r < s_roots.size(); r++)
+			{
+				if (s_zoneList[s_roots[r]].site == site) { return s_roots[r]; }
+			}
+			// Roots are not linked, search the root level zones from previous frames.
+			for (size_t i = 0; i < s_zoneList.size(); i++)
+			{
+				if (s_zoneList[i].parent == NULL_ZONE && s_zoneList[i].site == site)
+				{
+					s_roots.push_back(u32(i));
+					return u32(i);
+				}
+			}
 		}
+		else
+		{
+			for (u32 id = s_zoneList[parent].child; id != NULL_ZONE; id = s_zoneList[id].sibling)
+			{
+				if (s_zoneList[id].site == site) { return id; }
+				lastChild = id;
+			}
+		}
+
+		Zone zone = {};
+		zone.site = site;
+		zone.level = level;
+		zone.parent = parent;
+		zone.child = NULL_ZONE;
+		zone.sibling = NULL_ZONE;
+		const u32 id = u32(s_zoneList.size());
+		s_zoneList.push_back(zone);
+
+		if (parent == NULL_ZONE) { s_roots.push_back(id); }
+		else if (lastChild == NULL_ZONE) { s_zoneList[parent].child = id; }
+		else { s_zoneList[lastChild].sibling = id; }
+		return id;
+	}
+
+	void aggregateFrameEvents(u64 start, u64 end)
+	{
+		// The frame overflowed the ring buffer, so the zones cannot be matched up.
+		if (end - start > THREAD_EVENT_COUNT) { return; }
 
-		zone = &s_zoneList[id];
-		while (zone->sibling != NULL_ZONE)
+		u32 zoneStack[MAX_ZONE_STACK];
+		u64 timeStack[MAX_ZONE_STACK];
+		u32 level = 0;
+		for (u64 e = start; e < end; e++)
 		{
-			traverseZoneTree(zone->sibling);
-			zone = &s_zoneList[zone->sibling];
+			const Event* ev = &s_frameThread->events[e & (THREAD_EVENT_COUNT - 1)];
+			if (ev->site == FRAME_SITE) { continue; }
+
+			if (ev->type == EVENT_BEGIN)
+			{
+				if (level >= MAX_ZONE_STACK) { break; }
+				const u32 id = findOrAddZone(level ? zoneStack[level - 1] : NULL_ZONE, ev->site, level);
+				s_zoneList[id].frame = s_currentFrame;
+				zoneStack[level] = id;
+				timeStack[level] = ev->time;
+				level++;
+			}
+			else if (level > 0)
+			{
+				level--;
+				s_zoneList[zoneStack[level]].timeInZone[s_writeBuffer] += TFE_System::convertFromTicksToSeconds(ev->time - timeStack[level]);
+			}
 		}
 	}
 
 	void frameEnd()
 	{
-		s_frameTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - s_frameBegin);
+		endZone(FRAME_SITE);
+		const u64 frameEnd = TFE_System::getCurrentTimeInTicks();
+		s_frameTime = TFE_System::convertFromTicksToSeconds(frameEnd - s_frameBegin);
+		if (s_frameThread)
+		{
+			aggregateFrameEvents(s_frameEventStart, s_frameThread->writeCount.load(std::memory_order_relaxed));
+		}
 		const size_t zoneCount = s_zoneList.size();
 		const f64 expBlend = 0.99;
 
@@ -240,7 +413,11 @@ namespace TFE_Profiler
 		const size_t rootCount = s_roots.size();
 		for (size_t r = 0; r < rootCount; r++)
 		{
-			traverseZoneTree(s_roots[r]);
+			if (s_zoneList[s_roots[r]].frame == s_currentFrame)
+			{
+				s_sortedZoneList.push_back(s_roots[r]);
+				traverseZoneTree(s_zoneList[s_roots[r]].child);
+			}
 		}
 
 		// First compute delta times for each zone.
@@ -249,7 +426,7 @@ namespace TFE_Profiler
 			s_zoneList[i].timeInZoneAve = expBlend * s_zoneList[i].timeInZoneAve + (1.0 - expBlend)*s_zoneList[i].timeInZone[s_writeBuffer];
 		}
 
-		// Then handle percentage of parent and clear
+		// Then handle percentage of parent.
 		for (size_t i = 0; i < zoneCount; i++)
 		{
 			f64 parentTime = (s_zoneList[i].parent != NULL_ZONE) ? s_zoneList[s_zoneList[i].parent].timeInZone[s_writeBuffer] : s_frameTime;
@@ -260,14 +437,85 @@ namespace TFE_Profiler
 			{
 				s_zoneList[i].fractOfParentAve = 0.0;
 			}
+		}
 
-			s_zoneList[i].child = NULL_ZONE;
-			s_zoneList[i].sibling = NULL_ZONE;
+		// Finish the trace capture.
+		if (s_captureFrames)
+		{
+			s_captureFrames--;
+			if (!s_captureFrames)
+			{
+				writeTrace(s_captureBegin.load(), frameEnd);
+				s_captureActive.store(0u);
+			}
 		}
 
 		s_currentFrame++;
 	}
 
+	/////////////////////////////////////////////
+	// Trace Export
+	/////////////////////////////////////////////
+	// Write the name with JSON escaping.
+	void writeJsonString(FileStream* file, const char* str)
+	{
+		char buffer[256];
+		size_t len = 0;
+		for (; *str && len < sizeof(buffer) - 2; str++)
+		{
+			if (*str == '"' || *str == '\\') { buffer[len++] = '\\'; }
+			buffer[len++] = (*str >= 32) ? *str : ' ';
+		}
+		buffer[len] = 0;
+		file->writeString("\"%s\"", buffer);
+	}
+
+	void writeTrace(u64 beginTime, u64 endTime)
+	{
+		FileStream file;
+		if (!file.open(s_capturePath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Profiler", "Cannot write trace '%s'.", s_capturePath);
+			return;
+		}
+
+		file.writeString("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		bool first = true;
+		u32 eventCount = 0;
+		const u32 threadCount = std::min(s_threadCount.load(), u32(MAX_PROFILE_THREADS));
+		const u32 siteCount = s_siteCount.load(std::memory_order_acquire);
+		for (u32 t = 0; t < threadCount; t++)
+		{
+			const ThreadEvents* thread = &s_threads[t];
+			if (!thread->events) { continue; }
+
+			file.writeString("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", t);
+			writeJsonString(&file, thread->name);
+			file.writeString("}}");
+			first = false;
+
+			// Only the most recent events are still in the ring, this is racy for other threads but older
+			// events are skipped by time anyway.
+			const u64 end = thread->writeCount.load(std::memory_order_acquire);
+			const u64 start = end > THREAD_EVENT_COUNT ? end - THREAD_EVENT_COUNT : 0;
+			for (u64 e = start; e < end; e++)
+			{
+				const Event ev = thread->events[e & (THREAD_EVENT_COUNT - 1)];
+				if (ev.time < beginTime || ev.time > endTime || ev.site >= siteCount) { continue; }
+
+				const f64 ts = TFE_System::convertFromTicksToSeconds(ev.time - beginTime) * 1000000.0;
+				file.writeString(",\n{\"name\":");
+				writeJsonString(&file, s_sites[ev.site].name);
+				file.writeString(",\"cat\":\"zone\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", ev.type == EVENT_BEGIN ? "B" : "E", ts, t);
+				eventCount++;
+			}
+		}
+		file.writeString("\n]}\n");
+		file.close();
+
+		TFE_System::logWrite(LOG_MSG, "Profiler", "Wrote %u trace events to '%s'.", eventCount, s_capturePath);
+	}
+
 	u32 getZoneCount()
 	{
 		return (u32)s_sortedZoneList.size();
@@ -278,10 +526,11 @@ namespace TFE_Profiler
 		if (index >= (u32)s_sortedZoneList.size()) { return; }
 
 		Zone& zone = s_zoneList[s_sortedZoneList[index]];
-		info->name = zone.name;
-		info->func = zone.func;
+		const ZoneSite& site = s_sites[zone.site];
+		info->name = site.name;
+		info->func = site.func;
 		info->level = zone.level;
-		info->lineNumber = zone.lineNumber;
+		info->lineNumber = site.lineNumber;
 		info->timeInZone = zone.timeInZone[s_readBuffer];
 		info->timeInZoneAve = zone.timeInZoneAve;
 		info->fractOfParentAve = zone.fractOfParentAve;
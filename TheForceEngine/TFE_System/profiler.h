@@ -3,7 +3,14 @@
 // The Force Engine Profiler
 // Simple "zone" based profiler.
 // Add TFE_PROFILE_ENABLED to preprocessor defines in the build to enable.
-// Currently does not respect the call path, that is TODO.
+//
+// Each zone site is registered once, the first time it is reached, and
+// from then on entering or leaving a zone only writes a timestamped
+// event into the ring buffer of the current thread.
+// At the end of each frame the main thread events are aggregated by
+// call path for the profiler view. Events from all threads can be
+// captured for a number of frames and exported as a Chrome trace
+// (JSON), which can be viewed in chrome://tracing or Perfetto.
 //////////////////////////////////////////////////////////////////////
 
 #include "types.h"
@@ -14,12 +21,15 @@
 #define TOKENPASTE(x, y) x ## y
 #define TOKENPASTE2(x, y) TOKENPASTE(x, y)
 #ifdef  TFE_PROFILE_ENABLED
-#define TFE_ZONE(name)  TFE_Profiler_Zone TOKENPASTE2(__localZone, __LINE__)(name, __FUNCTION__, __LINE__)
-#define TFE_ZONE_BEGIN(varName, name)  TFE_Profiler_ZoneManual varName(name, __FUNCTION__, __LINE__)
+#define TFE_ZONE(name)  static const u32 TOKENPASTE2(__zoneSite, __LINE__) = TFE_Profiler::registerZone(name, __FUNCTION__, __LINE__); \
+						TFE_Profiler_Zone TOKENPASTE2(__localZone, __LINE__)(TOKENPASTE2(__zoneSite, __LINE__))
+#define TFE_ZONE_BEGIN(varName, name)  static const u32 TOKENPASTE2(varName, _site) = TFE_Profiler::registerZone(name, __FUNCTION__, __LINE__); \
+									   TFE_Profiler_ZoneManual varName(TOKENPASTE2(varName, _site))
 #define TFE_ZONE_END(varName)  varName.end()
 #define TFE_FRAME_BEGIN() TFE_Profiler::frameBegin()
 #define TFE_FRAME_END() TFE_Profiler::frameEnd()
 #define TFE_COUNTER(varName, name) TFE_Profiler::addCounter(name, &varName)
+#define TFE_THREAD_NAME(name) TFE_Profiler::setThreadName(name)
 #else
 #define TFE_ZONE(name)
 #define TFE_ZONE_BEGIN(varName, name)
@@ -27,6 +37,7 @@
 #define TFE_FRAME_BEGIN()
 #define TFE_FRAME_END()
 #define TFE_COUNTER(varName, name)
+#define TFE_THREAD_NAME(name)
 #endif
 
 #define NULL_ZONE 0xffffffff
@@ -34,8 +45,8 @@
 #ifdef TFE_PROFILE_ENABLED
 struct TFE_ZoneInfo
 {
-	char* name;
-	char* func;
+	const char* name;
+	const char* func;
 	u32  lineNumber;
 	u32  level;
 	u32  parentId;
@@ -53,20 +64,28 @@ struct TFE_CounterInfo
 namespace TFE_Profiler
 {
 	// The main profiling API is used through Macros which can be disabled based on build flags.
-	u32  beginZone(const char* name, const char* func, u32 lineNumber);
-	void endZone(u32 id, u64 dt);
-		
+	// Register a zone site, returns the site id. This is called once per site.
+	u32  registerZone(const char* name, const char* func, u32 lineNumber);
+	void beginZone(u32 site);
+	void endZone(u32 site);
+	// Name the current thread in trace captures.
+	void setThreadName(const char* name);
+
 	void frameBegin();
 	void frameEnd();
 
 	void addCounter(const char* name, s32* counter);
 
+	// Capture the events from all threads for 'frameCount' frames and then write them to 'path' as a Chrome trace.
+	bool beginCapture(u32 frameCount, const char* path);
+	bool isCapturing();
+
 	// Profile data API, this is used directly.
 	f64  getTimeInFrame();
 
 	u32  getZoneCount();
 	void getZoneInfo(u32 index, TFE_ZoneInfo* info);
-	
+
 	u32  getCounterCount();
 	void getCounterInfo(u32 index, TFE_CounterInfo* info);
 }
@@ -74,38 +93,32 @@ namespace TFE_Profiler
 class TFE_Profiler_Zone
 {
 public:
-	TFE_Profiler_Zone(const char* name, const char* func, u32 lineNumber)
+	TFE_Profiler_Zone(u32 site) : m_site(site)
 	{
-		m_time = TFE_System::getCurrentTimeInTicks();
-		m_id = TFE_Profiler::beginZone(name, func, lineNumber);
+		TFE_Profiler::beginZone(site);
 	}
 
 	~TFE_Profiler_Zone()
 	{
-		const u64 deltaTime = TFE_System::getCurrentTimeInTicks() - m_time;
-		TFE_Profiler::endZone(m_id, deltaTime);
+		TFE_Profiler::endZone(m_site);
 	}
 private:
-	u64 m_time;
-	s32 m_id;
+	u32 m_site;
 };
 
 class TFE_Profiler_ZoneManual
 {
 public:
-	TFE_Profiler_ZoneManual(const char* name, const char* func, u32 lineNumber)
+	TFE_Profiler_ZoneManual(u32 site) : m_site(site)
 	{
-		m_time = TFE_System::getCurrentTimeInTicks();
-		m_id = TFE_Profiler::beginZone(name, func, lineNumber);
+		TFE_Profiler::beginZone(site);
 	}
 
 	void end()
 	{
-		const u64 deltaTime = TFE_System::getCurrentTimeInTicks() - m_time;
-		TFE_Profiler::endZone(m_id, deltaTime);
+		TFE_Profiler::endZone(m_site);
 	}
 private:
-	u64 m_time;
-	s32 m_id;
+	u32 m_site;
 };
 #endif
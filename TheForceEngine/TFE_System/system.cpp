@@ -35,6 +35,8 @@ namespace TFE_System
 	
 	static f64 s_dt = 1.0 / 60.0;		// This is just to handle the first frame, so any reasonable value will work.
 	static f64 s_dtRaw = 1.0 / 60.0;
+	static bool s_frameTimeOverride = false;
+	static f64 s_frameTime = 0.0;
 	static const f64 c_maxDt = 0.05;	// 20 fps
 
 	static bool s_synced = false;
@@ -170,10 +172,25 @@ namespace TFE_System
 	// Get time since "start time"
 	f64 getTime()
 	{
+		if (s_frameTimeOverride) { return s_frameTime; }
+
 		const u64 uDt = s_time - s_startTime;
 		return f64(uDt) * s_freq;
 	}
 	
+	void setFrameTime(f64 time, f64 dt)
+	{
+		s_frameTimeOverride = true;
+		s_frameTime = time;
+		s_dt = dt;
+		s_dtRaw = dt;
+	}
+
+	void clearFrameTime()
+	{
+		s_frameTimeOverride = false;
+	}
+
 	u64 getCurrentTimeInTicks()
 	{
 		return SDL_GetPerformanceCounter() - s_startTime;
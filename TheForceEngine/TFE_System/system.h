@@ -19,6 +19,10 @@
 #define ENABLE_FORCE_SCRIPT 1
 #endif
 
+#if defined(BUILD_NULL_RENDERER)
+#define ENABLE_NULL_RENDERER 1
+#endif
+
 enum LogWriteType
 {
 	LOG_MSG = 0,
@@ -47,6 +51,10 @@ namespace TFE_System
 	f64 getDeltaTimeRaw();
 	// Get the absolute time since the last start time.
 	f64 getTime();
+	// Override the time and delta time for the current frame, used by input replay.
+	// This must be called after update() each frame until cleared.
+	void setFrameTime(f64 time, f64 dt);
+	void clearFrameTime();
 
 	u64 getCurrentTimeInTicks();
 	f64 convertFromTicksToSeconds(u64 ticks);
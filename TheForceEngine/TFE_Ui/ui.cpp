@@ -1,14 +1,19 @@
 #include <TFE_Ui/ui.h>
 #include <TFE_FileSystem/paths.h>
 #include <TFE_FileSystem/fileutil.h>
+#include <TFE_System/system.h>
 
 #include "imGUI/imgui.h"
 #include "imGUI/imgui_impl_sdl.h"
+#if ENABLE_NULL_RENDERER == 0
 #include "imGUI/imgui_impl_opengl3.h"
+#endif
 #include "portable-file-dialogs.h"
 #include "markdown.h"
 #include <SDL.h>
+#if ENABLE_NULL_RENDERER == 0
 #include <GL/glew.h>
+#endif
 
 namespace TFE_Ui
 {
@@ -33,7 +38,9 @@ bool init(void* window, void* context, s32 uiScale)
 	// Setup Platform/Renderer bindings
 	s_window = (SDL_Window*)window;
 	ImGui_ImplSDL2_InitForOpenGL(s_window, context);
+#if ENABLE_NULL_RENDERER == 0
 	ImGui_ImplOpenGL3_Init(glsl_version);
+#endif
 
 	// Set the default font (13 px)
 	// TODO: Allow scaled UI, so loading a different font for larger scales.
@@ -65,7 +72,9 @@ void shutdown()
 {
 	TFE_Markdown::shutdown();
 
+#if ENABLE_NULL_RENDERER == 0
 	ImGui_ImplOpenGL3_Shutdown();
+#endif
 	ImGui_ImplSDL2_Shutdown();
 	ImGui::DestroyContext();
 }
@@ -88,7 +97,18 @@ void setUiInput(const void* inputEvent)
 
 void begin()
 {
+#if ENABLE_NULL_RENDERER == 0
 	ImGui_ImplOpenGL3_NewFrame();
+#else
+	// Without a renderer the font atlas still has to be built before starting a new frame.
+	ImGuiIO& io = ImGui::GetIO();
+	if (!io.Fonts->IsBuilt())
+	{
+		u8* pixels;
+		s32 width, height;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+	}
+#endif
 	ImGui_ImplSDL2_NewFrame(s_window);
 	ImGui::NewFrame();
 }
@@ -96,12 +116,18 @@ void begin()
 void render()
 {
 	ImGui::Render();
+#if ENABLE_NULL_RENDERER == 0
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+#endif
 }
 
 void invalidateFontAtlas()
 {
+#if ENABLE_NULL_RENDERER == 0
 	ImGui_ImplOpenGL3_DestroyFontsTexture();
+#else
+	ImGui::GetIO().Fonts->ClearTexData();
+#endif
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
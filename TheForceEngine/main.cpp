@@ -8,6 +8,7 @@
 #include <TFE_Game/igame.h>
 #include <TFE_Game/saveSystem.h>
 #include <TFE_Game/reticle.h>
+#include <TFE_Game/inputReplay.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
 #include <TFE_FileSystem/fileutil.h>
 #include <TFE_Audio/audioSystem.h>
@@ -24,6 +25,8 @@
 #include <TFE_RenderShared/texturePacker.h>
 #include <TFE_Asset/paletteAsset.h>
 #include <TFE_Asset/imageAsset.h>
+#include <TFE_Asset/videoWriter.h>
+#include <TFE_Jedi/Renderer/virtualFramebuffer.h>
 #include <TFE_Ui/ui.h>
 #include <TFE_FrontEndUI/frontEndUi.h>
 #include <TFE_FrontEndUI/modLoader.h>
@@ -79,6 +82,9 @@ static char s_screenshotTime[TFE_MAX_PATH];
 static s32  s_startupGame = -1;
 static IGame* s_curGame = nullptr;
 static const char* s_loadRequestFilename = nullptr;
+static const char* s_recordFilename = nullptr;
+static const char* s_timedemoFilename = nullptr;
+static bool s_recordStateHash = false;
 
 void parseOption(const char* name, const std::vector<const char*>& values, bool longName);
 bool validatePath();
@@ -169,24 +175,37 @@ void handleEvent(SDL_Event& Event)
 				else if (code == KeyboardCode::KEY_F2 && altHeld)
 				{
 					static u64 _gifIndex = 0;
-					static bool _recording = false;
+					static bool _recordingGif = false;
 
-					if (!_recording)
+					// The framebuffer recording stops itself if the resolution changes, so ask it directly rather than tracking it here.
+					if (TFE_Jedi::vfb_isRecording())
+					{
+						TFE_Jedi::vfb_stopRecording();
+					}
+					else if (_recordingGif)
+					{
+						TFE_RenderBackend::stopGifRecording();
+						_recordingGif = false;
+					}
+					else
 					{
 						char screenshotDir[TFE_MAX_PATH];
 						TFE_Paths::appendPath(TFE_PathType::PATH_USER_DOCUMENTS, "Screenshots/", screenshotDir);
 
-						char gifPath[TFE_MAX_PATH];
-						sprintf(gifPath, "%stfe_gif_%s_%" PRIu64 ".gif", screenshotDir, s_screenshotTime, _gifIndex);
+						// The software renderer frames are recorded directly from the 8-bit framebuffer,
+						// otherwise the screen is captured from the GPU.
+						TFE_Settings_System* systemSettings = TFE_Settings::getSystemSettings();
+						const VideoFormat format = VideoFormat(systemSettings->recordingFormat);
+						char videoPath[TFE_MAX_PATH];
+						sprintf(videoPath, "%s%s_%s_%" PRIu64 ".%s", screenshotDir, format == VIDEO_GIF ? "tfe_gif" : "tfe_video", s_screenshotTime, _gifIndex, TFE_VideoWriter::getExtension(format));
+						if (!s_curGame || !TFE_Jedi::vfb_startRecording(videoPath, format, systemSettings->gifRecordingFramerate))
+						{
+							char gifPath[TFE_MAX_PATH];
+							sprintf(gifPath, "%stfe_gif_%s_%" PRIu64 ".gif", screenshotDir, s_screenshotTime, _gifIndex);
+							TFE_RenderBackend::startGifRecording(gifPath);
+							_recordingGif = true;
+						}
 						_gifIndex++;
-
-						TFE_RenderBackend::startGifRecording(gifPath);
-						_recording = true;
-					}
-					else
-					{
-						TFE_RenderBackend::stopGifRecording();
-						_recording = false;
 					}
 				}
 			}
@@ -246,6 +265,10 @@ void handleEvent(SDL_Event& Event)
 
 bool sdlInit()
 {
+#if ENABLE_NULL_RENDERER == 1
+	// No display is required, but an explicit SDL_VIDEODRIVER environment variable still takes priority.
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+#endif
 	const int code = SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_GAMECONTROLLER | SDL_INIT_AUDIO);
 	if (code != 0) { return false; }
 
@@ -350,6 +373,7 @@ void setAppState(AppState newState, int argc, char* argv[])
 			s_soundPaused = false;
 			s_curGame = createGame(gameInfo->id);
 			TFE_SaveSystem::setCurrentGame(s_curGame);
+			TFE_InputReplay::setGame(s_curGame);
 			if (!s_curGame)
 			{
 				TFE_System::logWrite(LOG_ERROR, "AppMain", "Cannot create game '%s'.", gameInfo->game);
@@ -391,6 +415,7 @@ void setAppState(AppState newState, int argc, char* argv[])
 				}
 				s_curGame = createGame(gameInfo->id);
 				TFE_SaveSystem::setCurrentGame(s_curGame);
+				TFE_InputReplay::setGame(s_curGame);
 				if (!s_curGame)
 				{
 					TFE_System::logWrite(LOG_ERROR, "AppMain", "Cannot create game '%s'.", gameInfo->game);
@@ -687,6 +712,20 @@ int main(int argc, char* argv[])
 	// Start reading the mods immediately?
 	TFE_FrontEndUI::modLoader_read();
 
+	// Input recording or timedemo playback.
+	// Playback must use the same command line and settings as the recording.
+	if (s_timedemoFilename && TFE_InputReplay::startPlayback(s_timedemoFilename))
+	{
+		// Run as fast as possible.
+		TFE_System::frameLimiter_set(0.0);
+		TFE_System::setVsync(false);
+		TFE_RenderBackend::enableVsync(false);
+	}
+	else if (s_recordFilename)
+	{
+		TFE_InputReplay::startRecording(s_recordFilename, s_recordStateHash);
+	}
+
 	// Game loop
 	u32 frame = 0u;
 	bool showPerf = false;
@@ -715,6 +754,7 @@ int main(int argc, char* argv[])
 		SDL_GetMouseState(&mouseAbsX, &mouseAbsY);
 		TFE_Input::setRelativeMousePos(mouseX, mouseY);
 		TFE_Input::setMousePos(mouseAbsX, mouseAbsY);
+		TFE_InputReplay::beginFrame();
 		inputMapping_updateInput();
 
 		// Can we save?
@@ -765,6 +805,7 @@ int main(int argc, char* argv[])
 		if (TFE_A11Y::hasPendingFont()) { TFE_A11Y::loadPendingFont(); } // Can't load new fonts between TFE_Ui::begin() and TFE_Ui::render();
 		TFE_Ui::begin();
 		TFE_System::update();
+		TFE_InputReplay::updateTime();
 
 		// Update
 		if (TFE_FrontEndUI::uiControlsEnabled() && task_canRun())
@@ -860,7 +901,13 @@ int main(int argc, char* argv[])
 			{
 				TFE_SaveSystem::update();
 				s_curGame->loopGame();
+
+				const u64 taskStart = TFE_System::getCurrentTimeInTicks();
 				endInputFrame = TFE_Jedi::task_run() != 0;
+				if (endInputFrame)
+				{
+					TFE_InputReplay::addTaskTime(TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - taskStart));
+				}
 			}
 		}
 		else
@@ -907,8 +954,16 @@ int main(int argc, char* argv[])
 		{
 			TFE_FRAME_END();
 		}
+
+		// Timedemo playback quits once all of the frames have played.
+		if (!TFE_InputReplay::endFrame(s_curGame))
+		{
+			s_loop = false;
+		}
 	}
 
+	TFE_InputReplay::stop();
+	TFE_Jedi::vfb_stopRecording();
 	if (s_curGame)
 	{
 		freeGame(s_curGame);
@@ -995,5 +1050,20 @@ void parseOption(const char* name, const std::vector<const char*>& values, bool
 		{
 			TFE_Settings::getTempSettings()->skipLoadDelay = true;
 		}
+		else if (strcasecmp(name, "record") == 0 && values.size() >= 1)
+		{
+			// --record demo.tfr
+			s_recordFilename = values[0];
+		}
+		else if (strcasecmp(name, "timedemo") == 0 && values.size() >= 1)
+		{
+			// --timedemo demo.tfr
+			s_timedemoFilename = values[0];
+		}
+		else if (strcasecmp(name, "statehash") == 0)
+		{
+			// --statehash, record a hash of the game state every frame so desyncs are caught during playback.
+			s_recordStateHash = true;
+		}
 	}
 }
\ No newline at end of file